@@ -8,6 +8,7 @@
 #include "tmr.h"
 #include "dev_i2c.h"
 #include "mxc_delay.h"
+#include "scheduler_log.h"
 
 /** I2C functions provided in dev_I2C files 
  * 
@@ -63,14 +64,14 @@ int32_t MAX77958_Init(){
     int8_t rslt = 0;
     //Read and confirm the ID number
     if((rslt = read_reg(DEVICE_ID, (uint16_t)1, &device_id))){
-        printf("Error initializing MAX77958! Error Code: %d\n",rslt);
+        SCHEDULER_LOG(LOG_MAX77958_INIT, rslt);
         return (rslt);
     }
     if (device_id != MAX77958_DEV_ID){
-        printf("MAX77958 Device ID does not match! Expected Device ID: 0x%X but got 0x%X\n", MAX77958_DEV_ID, device_id);
+        SCHEDULER_LOG(LOG_MAX77958_ID, MAX77958_DEV_ID, device_id);
         return (-1);
     }
-    printf("MAX77958 initialized succesfully and Device ID confirmed\n");
+    SCHEDULER_LOG(LOG_MAX77958_READY);
     return 0;
 }
 
@@ -78,7 +79,7 @@ int32_t write_reg(MAX77958_REG_ADD register_address, uint16_t len, uint8_t *data
     int8_t rslt = 0;
     
     if((rslt = dev_I2C_Write(MAX77958_ADDRESS, register_address, data, len))){
-        printf("Bad I2C write at register: 0x%X\n",register_address);
+        SCHEDULER_LOG(LOG_MAX77958_WRITE_REG, register_address);
         return (rslt);
     }
 
@@ -89,7 +90,7 @@ int32_t read_reg(MAX77958_REG_ADD register_address, uint16_t len, uint8_t *data)
     int8_t rslt = 0;
     
     if((rslt = dev_I2C_Read(MAX77958_ADDRESS, register_address, data, len))){
-        printf("Bad I2C read at register: 0x%X\n",register_address);
+        SCHEDULER_LOG(LOG_MAX77958_READ_REG, register_address);
         return (rslt);
     }
 
@@ -104,13 +105,13 @@ int32_t write_opcode(MAX77958_USBC_DATA_t *USBC_data){
 
     //Send opcode data array
     if((rslt = write_reg(OPCODE_IN_S, 32, USBC_data->AP_DATA_IN))){
-        printf("Error writing OpCode %d (Error Code: %d)\n",USBC_data->AP_DATA_IN[0], rslt);
+        SCHEDULER_LOG(LOG_MAX77958_WRITE_OP, USBC_data->AP_DATA_IN[0], rslt);
         return (rslt);
     }
 
     //Send the final byte to update OpCode
     if((rslt = write_reg(OPCODE_IN_E, 1, &end_byte))){
-        printf("Error writing OpCode %d (Error Code: %d)\n",USBC_data->AP_DATA_IN[0], rslt);
+        SCHEDULER_LOG(LOG_MAX77958_WRITE_OP, USBC_data->AP_DATA_IN[0], rslt);
         return (rslt);
     }
     return (0);
@@ -120,7 +121,7 @@ int32_t read_opcode(MAX77958_USBC_DATA_t *USBC_data){
     int8_t rslt = 0;
     uint8_t timeout_counter = 0;
     if((rslt = read_reg(OPCODE_OUT_S, 32, USBC_data->AP_DATA_OUT))){
-        printf("Error reading OpCode (Error Code: %d)\n",rslt);
+        SCHEDULER_LOG(LOG_MAX77958_READ_OP, rslt);
         return (rslt);
     }
     return(0);
@@ -145,7 +146,7 @@ int32_t get_SRC_Cap(MAX77958_USBC_DATA_t *USBC_data){
     memset(&(USBC_data->AP_DATA_IN[1]),0,31);
     
     if((rslt = write_opcode(USBC_data))){
-        printf("Error writing OpCode: %d (Error Code: %d)\n",rslt);
+        SCHEDULER_LOG(LOG_MAX77958_WRITE_OP, USBC_data->AP_DATA_IN[0], rslt);
         return (rslt);
     }
     return(rslt);
@@ -156,7 +157,7 @@ int32_t read_get_SRC_Cap(MAX77958_USBC_DATA_t *USBC_data){
     
     //Read Response
     if((rslt = read_opcode(USBC_data))){
-        printf("Error reading OpCode (Error Code: %d)\n",rslt);
+        SCHEDULER_LOG(LOG_MAX77958_READ_OP, rslt);
         return (rslt);
     }
     //Copy PDO data
@@ -183,7 +184,7 @@ uint8_t check_PDO_param(uint32_t PDO, USBC_PDO_Voltage_t target_voltage, USBC_PD
 int32_t set_SRC_Cap(MAX77958_USBC_DATA_t *USBC_data, uint8_t desired_PDO_pos){
     int8_t rslt = 0;    
     if(((MAX77958_PDO_FixedSupply_t)(USBC_data->PDO_DATA[desired_PDO_pos])).PDO_SRC_Supply_Type != USBC_FIXEDOUT){
-        printf("Trying to set a non fixed-out PDO\n");
+        SCHEDULER_LOG(LOG_MAX77958_NOT_FIXED);
         return(-2);
     }
     //Setup the AP data to send request
@@ -193,7 +194,7 @@ int32_t set_SRC_Cap(MAX77958_USBC_DATA_t *USBC_data, uint8_t desired_PDO_pos){
 
     //Write Opcode
     if((rslt = write_opcode(USBC_data))){
-        printf("Error writing OpCode: %d (Error Code: %d)\n",rslt);
+        SCHEDULER_LOG(LOG_MAX77958_WRITE_OP, USBC_data->AP_DATA_IN[0], rslt);
         return (rslt);
     }
 
@@ -210,7 +211,7 @@ uint8_t find_SRC_Cap_target(MAX77958_USBC_DATA_t *USBC_data, USBC_PDO_Voltage_t
     
     //Could not find PDO, so set to safe 5V at PDO 0
     if(desired_PDO_pos == 0xff){
-        printf("Could not find Fixed PDO with %d mV and %d mA capabilities\n",target_voltage*50,target_current*10);
+        SCHEDULER_LOG(LOG_MAX77958_NO_PDO, target_voltage*50, target_current*10);
         desired_PDO_pos = 0x00;
     }
     
@@ -1,9 +1,12 @@
 #include "dev_i2c.h"
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "mxc_delay.h"
 #include "i2c.h"
 #include "i2c_regs.h"
+#include "scheduler_log.h"
 
 /*****  Global Variables *****/  
 
@@ -30,13 +33,13 @@ int8_t dev_I2C_Init(){
 
     //Initilize the I2C Port as a master
     if((rslt = MXC_I2C_Init(I2C_MASTER, I2C_CONFIG, 0)) != E_NO_ERROR){
-        printf("Error initializing the I2C Port 2 (Error: %d)\n",rslt);
+        SCHEDULER_LOG(LOG_I2C_INIT, rslt);
         return E_BAD_PARAM;
     }
     
     //Set the frequency of communication over I2C port
     if((rslt = MXC_I2C_SetFrequency(I2C_MASTER, I2C_FREQ)) < E_NO_ERROR){
-        printf("Error setting I2C speed (Error: %d)\n",rslt);
+        SCHEDULER_LOG(LOG_I2C_FREQUENCY, rslt);
         return E_BAD_PARAM;
     }
 
@@ -50,7 +53,11 @@ int8_t dev_I2C_Write(uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, uint16_t
     int rslt = E_NO_ERROR;
 
     //Allocate memory for register address and data
-    uint8_t *TXData = (uint8_t *)malloc(sizeof(data)+sizeof(reg_addr));
+    uint8_t *TXData = (uint8_t *)malloc(len + 1);
+    if(TXData == NULL){
+        SCHEDULER_LOG(LOG_I2C_NO_MEMORY, len + 1);
+        return E_NULL_PTR;
+    }
     memcpy(TXData, &reg_addr, 1);
     memcpy(TXData+1, data, len);
 
@@ -65,12 +72,14 @@ int8_t dev_I2C_Write(uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, uint16_t
     if ((rslt = MXC_I2C_MasterTransaction(&reqMaster)) != E_NO_ERROR) {
         //Communication error
         if(rslt != 1){
-            printf("Error (%d) writing data: Device = 0x%X; Register = 0x%X\n", rslt, dev_addr, reg_addr);
+            SCHEDULER_LOG(LOG_I2C_WRITE, rslt, dev_addr, reg_addr);
+            free(TXData);
             return E_UNDERFLOW;
         }
         //Message not acknowledged
         else{
-            printf("Write was not acknowledged: Device = 0x%X; Register = 0x%X\n", dev_addr, reg_addr);
+            SCHEDULER_LOG(LOG_I2C_WRITE_NACK, dev_addr, reg_addr);
+            free(TXData);
             return E_NO_RESPONSE;
         }
     }
@@ -97,12 +106,12 @@ int8_t dev_I2C_Read(uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, uint16_t
         
         //Communication error
         if(rslt != 1){
-            printf("Error (%d) reading data: Device = 0x%X; Register = 0x%X\n", rslt, dev_addr, reg_addr);
+            SCHEDULER_LOG(LOG_I2C_READ, rslt, dev_addr, reg_addr);
             return E_UNDERFLOW;
         }
         //Message not acknowledged
         else{
-            printf("Read was not acknowledged: Device = 0x%X; Register = 0x%X\n", dev_addr, reg_addr);
+            SCHEDULER_LOG(LOG_I2C_READ_NACK, dev_addr, reg_addr);
             return E_NO_RESPONSE;
         }
     }
@@ -7,6 +7,8 @@
  *              - If a USB-C cable is not rated for 100W, then the SRC will advertise for 60W max PDOs only
  *              - It takes ~300ms or so before you can request a new PDO (Experimental)
  *              - It takes ~70ms or so before you can request a PDO (Experimental)
+ *              - The driver reports its errors through SCHEDULER_LOG(). Nothing here runs the scheduler, so the
+ *                example drains the log itself after each driver call
  */
 
 /* **** Includes **** */
@@ -14,6 +16,8 @@
 #include "servoctrl.h"
 #include "kws.h"
 #include "scheduler.h"
+#include "scheduler_log.h"
+#include "timebase.h"
 #include "MAX77958.h"
 #include <string.h>
 #include <stdio.h>
@@ -35,11 +39,14 @@ int main(void)
 {
     printf("USB-C Testing for MAX77958\n");
     MXC_Delay(MXC_DELAY_SEC(2)); // Create window for debugger to connect after reset
+    timebase_init();    //Log timestamps
     //Initialize MAX77958
     printf("MAX77958 initialization returned %d (0 for Sucess)\n\n",MAX77958_Init());
+    scheduler_log_drain();
 
     
     if(get_SRC_Cap(&USBC_data) < 0){
+        scheduler_log_drain();
         printf("Error reading PDOs\n");
         //TODO: Handle errors
 
@@ -48,11 +55,13 @@ int main(void)
         uint8_t PDMsg_reg;
         do{
             Poll_Reg(PD_STATUS0,&PDMsg_reg);
+            scheduler_log_drain();
             MXC_Delay(500);
         } while(PDMsg_reg != Sink_PD_Evaluate_State_SrcCap_Received);
 
         //Read the PDO data once it is ready
         read_get_SRC_Cap(&USBC_data);
+        scheduler_log_drain();
         printf("Number of PDOs: %i\n", USBC_data.num_PDOs);
     }
 
@@ -73,6 +82,7 @@ int main(void)
         //TODO: Handle if PDO not found
     
     }
+    scheduler_log_drain();
     
     
     MXC_Delay(MXC_DELAY_SEC(2));
@@ -82,16 +92,19 @@ int main(void)
     for(int i =0;i<USBC_data.num_PDOs;i++){
         printf("Selecting PDO Source %i\n",i+1);
         set_SRC_Cap(&USBC_data,i+1);
+        scheduler_log_drain();
 
         MXC_Delay(300000);  //Minimum delay to allow USB-C bus SRC to allow for changes again-- Normally
                             //this should not matter because you won't keep changin PDOs over and over again
 
         MAX77958_USBC_Status1_REG_t temp;
         temp.reg_value = get_VBus_Voltage();
+        scheduler_log_drain();
         printf("Current VBus reading from MAX77958 ADC    : %d V\n",(temp.VbADC+3));
     }
 
     while(1) {
-     
+        scheduler_log_drain();
+        MXC_Delay(MXC_DELAY_MSEC(100));
     }
 }
@@ -40,15 +40,15 @@
 #include <stdio.h>
 #include <math.h>
 #include "Coord_Asimov.h"
+#include "Coord_Trig.h"
+#ifndef COORD_HOST
 #include "mxc_delay.h"
+#endif
 
 
 
 /*****  Global Variables *****/  
-float PI = 22.0/7.0;
-float Distance_Flat = 0.0;
-float Distance_Adjusted = 0.0;
-float Distance_Adjusted_Sqrd = 0.0;
+float PI = 3.14159265;
 
 struct RobotArm Asimov = {
 
@@ -70,6 +70,9 @@ struct RobotArm Asimov = {
     .Wrist_Grab = 0.0
 };
 
+//Scratch of the global arm, used by the functions that work on Asimov
+struct IK_Scratch Asimov_Scratch;
+
 
 /***** Function Prototypes *****/
 int Update_Grabber_Position(uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results);
@@ -87,6 +90,16 @@ float RadToDeg(float Radians);
 float DegToRad(float Degrees);
 int Init_Coords(uint16_t BaseToElbow, uint16_t ElbowToWrist, uint16_t Wrist);
 
+//Reentrant versions, every stage reads the arm and passes its results on through the scratch
+int Arm_Init(struct RobotArm *arm, uint16_t BaseToElbow, uint16_t ElbowToWrist, uint16_t Wrist);
+int Arm_Solve(const struct RobotArm *arm, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results);
+void Arm_Set_Position(struct RobotArm *arm, const float *results);
+int Arm_Forward(const struct RobotArm *arm, const float *angles, float *wrist, float *tip);
+void Arm_Base_Angle(struct IK_Scratch *scratch, uint16_t x, uint16_t y);
+void Arm_Wrist_Offset(const struct RobotArm *arm, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle);
+float Arm_Shoulder_Angle(const struct RobotArm *arm, const struct IK_Scratch *scratch);
+float Arm_Elbow_Angle(const struct RobotArm *arm, const struct IK_Scratch *scratch);
+
 
 /***** Driver implementation *****/
 
@@ -95,68 +108,33 @@ int Init_Coords(uint16_t BaseToElbow, uint16_t ElbowToWrist, uint16_t Wrist);
 
 
 int Update_Grabber_Position(uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results){
-    uint16_t Updated_Coords[3];
-    
-    //Find the base angle
-    Update_BaseAngle(x,y,z);
-    
-    //Update coordinates based on grabbing angle
-    Update_WristAngle(x, y,  z, Grabber_Angle, Updated_Coords);
-
-    //Update the Distances
-    Distance_Flat = Distance_Calc(Updated_Coords[0], Updated_Coords[1], 0.0);
-    Distance_Adjusted = Distance_Calc(Updated_Coords[0], Updated_Coords[1], Updated_Coords[2]);
-    Distance_Adjusted_Sqrd = Distance_Adjusted*Distance_Adjusted;
-
-    Update_ShoulderAngle(Updated_Coords);
+    int rslt;
 
-    Update_ElbowAngle(Updated_Coords);
+    if((rslt = Arm_Solve(&Asimov, &Asimov_Scratch, x, y, z, Grabber_Angle, results)) != E_NO_ERROR){
+        return(rslt);
+    }
 
     //Update arm structure
-    results[0] = Asimov.Base_Angle;
-    results[1] = Asimov.Shoulder_Angle;
-    results[2] = Asimov.Elbow_Angle;
-    results[3] = Asimov.Wrist_Angle;
-    results[4] = Asimov.Wrist_Rotation;
-    results[5] = Asimov.Wrist_Grab;
-
+    Arm_Set_Position(&Asimov, results);
+    return(E_NO_ERROR);
 }
 
 int Update_WristAngle(uint16_t x,uint16_t  y, uint16_t z, float Grabber_Angle, uint16_t *Updated_Coords){
+    Asimov_Scratch.Base_Angle = Asimov.Base_Angle;
+    Arm_Wrist_Offset(&Asimov, &Asimov_Scratch, x, y, z, Grabber_Angle);
+    Asimov.Wrist_Angle = Asimov_Scratch.Wrist_Angle;
 
-    //Variable to hold the adjustment measurment
-    uint16_t Delta_X, Delta_Y, Delta_Z;
-    float Delta_XY;
-
-    //Have to figure this one out a litte...
-    if (Grabber_Angle > 90){
-        Asimov.Wrist_Angle = 0.0;
-    }
-    else{
-        Asimov.Wrist_Angle = 90.0 - Grabber_Angle;
-
-        Delta_Z = (uint16_t)round(Asimov.Len_Wrist*cosf(DegToRad(Asimov.Wrist_Angle)));
-    
-        Delta_XY = Asimov.Len_Wrist * sinf(DegToRad(Asimov.Wrist_Angle));
-
-        Delta_X = (uint16_t)round(Delta_XY * sinf(DegToRad(90.0-Asimov.Base_Angle)));
-        Delta_Y = (uint16_t)round(Delta_XY * cosf(DegToRad(90.0-Asimov.Base_Angle)));
-    }    
-
-    Updated_Coords[0] = x-Delta_X;
-    Updated_Coords[1] = y-Delta_Y;
-    Updated_Coords[2] = z+Delta_Z;
+    Updated_Coords[0] = Asimov_Scratch.Updated_Coords[0];
+    Updated_Coords[1] = Asimov_Scratch.Updated_Coords[1];
+    Updated_Coords[2] = Asimov_Scratch.Updated_Coords[2];
 
     return(E_NO_ERROR);
 }
 
 
 int Update_ElbowAngle(uint16_t *Updated_Coords){
-    uint16_t x = Updated_Coords[0];
-    uint16_t y = Updated_Coords[1]; 
-    uint16_t z = Updated_Coords[2];
+    (void)Updated_Coords;       //Elbow_Angle_Calc() works from the distances already in Asimov_Scratch
 
-    
     //Update Elbow Angle
     Asimov.Elbow_Angle = Elbow_Angle_Calc();
 
@@ -164,63 +142,44 @@ int Update_ElbowAngle(uint16_t *Updated_Coords){
 }
 
 int Update_ShoulderAngle(uint16_t *Updated_Coords){
-    uint16_t x = Updated_Coords[0];
-    uint16_t y = Updated_Coords[1]; 
-    uint16_t z = Updated_Coords[2];
     //Update Shoulder Angle
-    Asimov.Shoulder_Angle = Shoulder_Angle_Calc(z); 
+    Asimov.Shoulder_Angle = Shoulder_Angle_Calc(Updated_Coords[2]); 
 
     return(E_NO_ERROR);
 }
 
 int Update_BaseAngle(uint16_t x,uint16_t y, uint16_t z){
-    Distance_Flat = Distance_Calc(x, y, 0.0);
+    (void)z;                    //Independent of Z coord
+
+    Arm_Base_Angle(&Asimov_Scratch, x, y);
 
     //Update Base Angle
-    Asimov.Base_Angle = Base_Angle_Calc(x);
+    Asimov.Base_Angle = Asimov_Scratch.Base_Angle;
     return(E_NO_ERROR);
 }
 
 
 
 int Init_Coords(uint16_t BaseToElbow, uint16_t ElbowToWrist, uint16_t Wrist){
-    
-    //Initialize the arm dimensions
-    Asimov.Len_BaseToElbow = BaseToElbow;
-    Asimov.Len_ElbowToWrist = ElbowToWrist;
-    Asimov.Len_Wrist = Wrist;
-
-    //Calculate squared values for faster computation
-    Asimov.Len_BaseToElbow_Sqrd = BaseToElbow*BaseToElbow;
-    Asimov.Len_ElbowToWrist_Sqrd = ElbowToWrist*ElbowToWrist;
-
-    return (E_NO_ERROR);
+    return(Arm_Init(&Asimov, BaseToElbow, ElbowToWrist, Wrist));
 }
 
 //Independent of Z coord
 float Base_Angle_Calc(uint16_t x){
-    float temp = (float)acosf(((float)x/Distance_Flat));
-
-    return(RadToDeg(temp));
+    return(Trig_Acos_Deg(((float)x/Asimov_Scratch.Distance_Flat)));
 }
 
 float Shoulder_Angle_Calc(uint16_t z){
-    float Theta_Z = 0.0;
-    float Theta_Shoulder = 0.0;
+    struct IK_Scratch scratch = Asimov_Scratch;
 
-    //Calculate the Z component of theta
-    if(z) Theta_Z = acosf((Distance_Flat/Distance_Adjusted));
-    else Theta_Z = 0;
-
-    //Calculate Shoulder component using SSS formula of triangle
-    Theta_Shoulder = acosf(((Distance_Adjusted_Sqrd+Asimov.Len_BaseToElbow_Sqrd-Asimov.Len_ElbowToWrist_Sqrd)/(2*Asimov.Len_BaseToElbow*Distance_Adjusted)));
-
-    return(RadToDeg(Theta_Z+Theta_Shoulder));
+    //The Z component of theta is only added for a z above 0
+    scratch.Updated_Coords[2] = z;
+    return(Arm_Shoulder_Angle(&Asimov, &scratch));
 }
 
 
 float Elbow_Angle_Calc(){
-    return(RadToDeg(acosf(((Asimov.Len_BaseToElbow_Sqrd+Asimov.Len_ElbowToWrist_Sqrd-Distance_Adjusted_Sqrd)/(2*Asimov.Len_BaseToElbow*Asimov.Len_ElbowToWrist)))));
+    return(Arm_Elbow_Angle(&Asimov, &Asimov_Scratch));
 }
 
 
@@ -234,4 +193,148 @@ float RadToDeg(float Radians){
 
 float DegToRad(float Degrees){
     return(Degrees*PI/180.0);
-}
\ No newline at end of file
+}
+
+
+/***** Reentrant solver *****/
+
+int Arm_Init(struct RobotArm *arm, uint16_t BaseToElbow, uint16_t ElbowToWrist, uint16_t Wrist){
+    if(arm == NULL){
+        return(E_NULL_PTR);
+    }
+
+    //Initialize the arm dimensions
+    arm->Len_BaseToElbow = BaseToElbow;
+    arm->Len_ElbowToWrist = ElbowToWrist;
+    arm->Len_Wrist = Wrist;
+
+    //Calculate squared values for faster computation
+    arm->Len_BaseToElbow_Sqrd = BaseToElbow*BaseToElbow;
+    arm->Len_ElbowToWrist_Sqrd = ElbowToWrist*ElbowToWrist;
+
+    arm->Base_Angle = 0.0;
+    arm->Shoulder_Angle = 0.0;
+    arm->Elbow_Angle = 0.0;
+    arm->Wrist_Angle = 0.0;
+    arm->Wrist_Rotation = 0.0;
+    arm->Wrist_Grab = 0.0;
+
+    return (E_NO_ERROR);
+}
+
+int Arm_Solve(const struct RobotArm *arm, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results){
+    if(arm == NULL || scratch == NULL || results == NULL){
+        return(E_NULL_PTR);
+    }
+
+    //Find the base angle
+    Arm_Base_Angle(scratch, x, y);
+
+    //Update coordinates based on grabbing angle
+    Arm_Wrist_Offset(arm, scratch, x, y, z, Grabber_Angle);
+
+    //Update the Distances
+    scratch->Distance_Flat = Distance_Calc(scratch->Updated_Coords[0], scratch->Updated_Coords[1], 0.0);
+    scratch->Distance_Adjusted = Distance_Calc(scratch->Updated_Coords[0], scratch->Updated_Coords[1], scratch->Updated_Coords[2]);
+    scratch->Distance_Adjusted_Sqrd = scratch->Distance_Adjusted*scratch->Distance_Adjusted;
+
+    results[0] = scratch->Base_Angle;
+    results[1] = Arm_Shoulder_Angle(arm, scratch);
+    results[2] = Arm_Elbow_Angle(arm, scratch);
+    results[3] = scratch->Wrist_Angle;
+    results[4] = arm->Wrist_Rotation;
+    results[5] = arm->Wrist_Grab;
+
+    return(E_NO_ERROR);
+}
+
+void Arm_Set_Position(struct RobotArm *arm, const float *results){
+    arm->Base_Angle = results[0];
+    arm->Shoulder_Angle = results[1];
+    arm->Elbow_Angle = results[2];
+    arm->Wrist_Angle = results[3];
+    arm->Wrist_Rotation = results[4];
+    arm->Wrist_Grab = results[5];
+}
+
+int Arm_Forward(const struct RobotArm *arm, const float *angles, float *wrist, float *tip){
+    float Base_Cos, Base_Sin, Forearm, Reach, Height, Tip_Reach;
+
+    if(arm == NULL || angles == NULL){
+        return(E_NULL_PTR);
+    }
+
+    Base_Cos = Trig_Cos_Deg(angles[0]);
+    Base_Sin = Trig_Sin_Deg(angles[0]);
+
+    //The elbow angle is inside the triangle, so the forearm points at Shoulder + Elbow - 180 from horizontal
+    Forearm = angles[1] + angles[2] - 180.0;
+    Reach = arm->Len_BaseToElbow*Trig_Cos_Deg(angles[1]) + arm->Len_ElbowToWrist*Trig_Cos_Deg(Forearm);
+    Height = arm->Len_BaseToElbow*Trig_Sin_Deg(angles[1]) + arm->Len_ElbowToWrist*Trig_Sin_Deg(Forearm);
+
+    if(wrist != NULL){
+        wrist[0] = Reach*Base_Cos;
+        wrist[1] = Reach*Base_Sin;
+        wrist[2] = Height;
+    }
+
+    //Same offsets as Arm_Wrist_Offset(), without the rounding to whole units
+    if(tip != NULL){
+        Tip_Reach = Reach + arm->Len_Wrist*Trig_Sin_Deg(angles[3]);
+        tip[0] = Tip_Reach*Base_Cos;
+        tip[1] = Tip_Reach*Base_Sin;
+        tip[2] = Height - arm->Len_Wrist*Trig_Cos_Deg(angles[3]);
+    }
+
+    return(E_NO_ERROR);
+}
+
+//Independent of Z coord
+void Arm_Base_Angle(struct IK_Scratch *scratch, uint16_t x, uint16_t y){
+    scratch->Distance_Flat = Distance_Calc(x, y, 0.0);
+    scratch->Base_Angle = Trig_Acos_Deg(((float)x/scratch->Distance_Flat));
+}
+
+void Arm_Wrist_Offset(const struct RobotArm *arm, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle){
+
+    //Variable to hold the adjustment measurment (no adjustment when the wrist stays straight)
+    uint16_t Delta_X = 0, Delta_Y = 0, Delta_Z = 0;
+    float Delta_XY;
+
+    //Have to figure this one out a litte...
+    if (Grabber_Angle > 90){
+        scratch->Wrist_Angle = 0.0;
+    }
+    else{
+        scratch->Wrist_Angle = 90.0 - Grabber_Angle;
+
+        Delta_Z = (uint16_t)round(arm->Len_Wrist*Trig_Cos_Deg(scratch->Wrist_Angle));
+    
+        Delta_XY = arm->Len_Wrist * Trig_Sin_Deg(scratch->Wrist_Angle);
+
+        Delta_X = (uint16_t)round(Delta_XY * Trig_Sin_Deg(90.0-scratch->Base_Angle));
+        Delta_Y = (uint16_t)round(Delta_XY * Trig_Cos_Deg(90.0-scratch->Base_Angle));
+    }    
+
+    scratch->Updated_Coords[0] = x-Delta_X;
+    scratch->Updated_Coords[1] = y-Delta_Y;
+    scratch->Updated_Coords[2] = z+Delta_Z;
+}
+
+float Arm_Shoulder_Angle(const struct RobotArm *arm, const struct IK_Scratch *scratch){
+    float Theta_Z = 0.0;
+    float Theta_Shoulder = 0.0;
+
+    //Calculate the Z component of theta
+    if(scratch->Updated_Coords[2]) Theta_Z = Trig_Acos_Deg((scratch->Distance_Flat/scratch->Distance_Adjusted));
+    else Theta_Z = 0;
+
+    //Calculate Shoulder component using SSS formula of triangle
+    Theta_Shoulder = Trig_Acos_Deg(((scratch->Distance_Adjusted_Sqrd+arm->Len_BaseToElbow_Sqrd-arm->Len_ElbowToWrist_Sqrd)/(2*arm->Len_BaseToElbow*scratch->Distance_Adjusted)));
+
+    return(Theta_Z+Theta_Shoulder);
+}
+
+float Arm_Elbow_Angle(const struct RobotArm *arm, const struct IK_Scratch *scratch){
+    return(Trig_Acos_Deg(((arm->Len_BaseToElbow_Sqrd+arm->Len_ElbowToWrist_Sqrd-scratch->Distance_Adjusted_Sqrd)/(2*arm->Len_BaseToElbow*arm->Len_ElbowToWrist))));
+}
@@ -41,7 +41,18 @@
 #ifndef _COORD_ASIMOV_H_    
 #define _COORD_ASIMOV_H_
 
+#include <stdint.h>
+#ifdef COORD_HOST
+//Host builds (benchmarks) have no MSDK, only the error codes used here
+#define E_NO_ERROR      0
+#define E_NULL_PTR      -1
+#define E_BAD_PARAM     -3
+#define E_INVALID       -4
+#define E_BUSY          -6
+#define E_NONE_AVAIL    -14
+#else
 #include "mxc_errors.h"
+#endif
 /***** Definitions *****/ 
 
 //Setting Comments with an asterisks(*) refer to default conditions
@@ -66,11 +77,26 @@ struct RobotArm {
     float Wrist_Grab;
 };
 
+//Values handed from one stage of a solve to the next. Every solve that can run at the same time as another
+//(second arm, another routine, another thread) needs its own
+struct IK_Scratch {
+    float Distance_Flat;            //Distance to the target in the XY plane
+    float Distance_Adjusted;        //Distance from the shoulder to the wrist joint
+    float Distance_Adjusted_Sqrd;
+    float Base_Angle;
+    float Wrist_Angle;
+    uint16_t Updated_Coords[3];     //Wrist joint position (target moved back along the grabber)
+};
+
 /***** Global Variables *****/
 
 
 /***** Function Prototypes *****/
 
+/* Init_Coords() and Update_Grabber_Position() work on the one global arm. The Arm_ functions below do the same
+ * work on an arm and a scratch structure passed in by the caller and touch nothing else, so several arms can be
+ * solved, and one arm can be solved from several routines or threads, as long as each solve has its own scratch. */
+
 /**
 * @brief        Initialize the Coordinate System
 *
@@ -82,6 +108,48 @@ int Update_Grabber_Position(uint16_t x, uint16_t y, uint16_t z, float Grabber_An
 int Update_WristAngles(uint16_t x,uint16_t y, uint16_t z, float Grabber_Angle, uint16_t *Updated_Coords);
 int Update_BaseAngles(uint16_t x, uint16_t y, uint16_t z);
 
+/**
+* @brief        Set the link lengths of an arm and clear its remembered position
+* @param[out]   arm - Arm to initialize
+* @param[in]    BaseToElbow - Shoulder to elbow length
+* @param[in]    ElbowToWrist - Elbow to wrist length
+* @param[in]    Wrist - Wrist joint to grabber tip length
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Arm_Init(struct RobotArm *arm, uint16_t BaseToElbow, uint16_t ElbowToWrist, uint16_t Wrist);
+
+/**
+* @brief        Solve the joint angles for a grabber position. The arm is only read
+* @param[in]    arm - Arm geometry
+* @param[in]    scratch - Working values of this solve
+* @param[in]    x, y, z - Grabber position
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in degrees (over 90 leaves the wrist straight)
+* @param[out]   results - Base, Shoulder, Elbow, Wrist, Wrist Rotation and Wrist Grab angles in degrees (6 floats)
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Arm_Solve(const struct RobotArm *arm, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results);
+
+/**
+* @brief        Remember a solved position in the arm (what Update_Grabber_Position() does for the global arm)
+* @param[out]   arm - Arm to update
+* @param[in]    results - Angles from Arm_Solve()
+*/
+void Arm_Set_Position(struct RobotArm *arm, const float *results);
+
+/**
+* @brief        Forward kinematics: where the wrist joint and the grabber tip are for a set of joint angles
+* @param[in]    arm - Arm geometry
+* @param[in]    angles - Base, Shoulder, Elbow and Wrist angles in degrees (as Arm_Solve() returns them)
+* @param[out]   wrist - x, y, z of the wrist joint (3 floats), or NULL
+* @param[out]   tip - x, y, z of the grabber tip (3 floats), or NULL. Arm_Solve() with a grabber angle over 90
+*               solves for the wrist joint itself, so check those solutions against wrist
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Arm_Forward(const struct RobotArm *arm, const float *angles, float *wrist, float *tip);
+
 
 
 #endif  /* _COORD_ASIMOV_H_ */
\ No newline at end of file
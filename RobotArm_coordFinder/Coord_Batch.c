@@ -0,0 +1,331 @@
+/**
+* @file             Coord_Batch.c
+* @brief            Struct-of-arrays inverse kinematics, IK_BATCH_LANES targets per step
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "Coord_Batch.h"
+
+#if defined(__AVX2__) && !defined(IK_BATCH_SCALAR)
+#include <immintrin.h>
+#define IK_BATCH_AVX2
+#elif defined(__SSE2__) && !defined(IK_BATCH_SCALAR)
+#include <immintrin.h>
+#define IK_BATCH_SSE2
+#elif defined(ARM_MATH_CM4)
+#include "arm_math.h"
+#define IK_BATCH_CMSIS
+#endif
+
+
+/***** Definitions *****/
+
+#define IK_PI               3.14159265359f
+#define IK_HALF_PI          1.57079632679f
+#define IK_TWO_PI           6.28318530718f
+#define IK_RAD_TO_DEG       (180.0f/IK_PI)
+#define IK_DEG_TO_RAD       (IK_PI/180.0f)
+
+/* Vector operations used by the solve. ik_vec holds IK_BATCH_LANES floats, ik_mask one compare result per lane */
+#if defined(IK_BATCH_AVX2)
+#define IK_BATCH_LANES      8
+typedef __m256 ik_vec;
+typedef __m256 ik_mask;
+#define V_SET(a)            _mm256_set1_ps(a)
+#define V_ADD(a, b)         _mm256_add_ps((a), (b))
+#define V_SUB(a, b)         _mm256_sub_ps((a), (b))
+#define V_MUL(a, b)         _mm256_mul_ps((a), (b))
+#define V_DIV(a, b)         _mm256_div_ps((a), (b))
+#define V_SQRT(a)           _mm256_sqrt_ps(a)
+#define V_MIN(a, b)         _mm256_min_ps((a), (b))
+#define V_MAX(a, b)         _mm256_max_ps((a), (b))
+#define V_ABS(a)            _mm256_andnot_ps(_mm256_set1_ps(-0.0f), (a))
+#define V_FLOOR(a)          _mm256_floor_ps(a)
+#ifdef __FMA__
+#define V_MADD(a, b, c)     _mm256_fmadd_ps((a), (b), (c))
+#else
+#define V_MADD(a, b, c)     _mm256_add_ps(_mm256_mul_ps((a), (b)), (c))
+#endif
+#define V_LT(a, b)          _mm256_cmp_ps((a), (b), _CMP_LT_OQ)
+#define V_GT(a, b)          _mm256_cmp_ps((a), (b), _CMP_GT_OQ)
+#define V_LE(a, b)          _mm256_cmp_ps((a), (b), _CMP_LE_OQ)
+#define V_GE(a, b)          _mm256_cmp_ps((a), (b), _CMP_GE_OQ)
+#define M_AND(a, b)         _mm256_and_ps((a), (b))
+#define V_SELECT(m, a, b)   _mm256_blendv_ps((b), (a), (m))
+#define M_BITS(m)           ((uint32_t)_mm256_movemask_ps(m))
+#define V_LOAD(p)           _mm256_loadu_ps(p)
+#define V_STORE(p, a)       _mm256_storeu_ps((p), (a))
+#define V_LOAD_U16(p)       _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(p))))
+#define V_SIN(a)            ik_vsin(a)
+#define V_COS(a)            ik_vsin(_mm256_add_ps((a), _mm256_set1_ps(IK_HALF_PI)))
+
+#elif defined(IK_BATCH_SSE2)
+#define IK_BATCH_LANES      4
+typedef __m128 ik_vec;
+typedef __m128 ik_mask;
+#define V_SET(a)            _mm_set1_ps(a)
+#define V_ADD(a, b)         _mm_add_ps((a), (b))
+#define V_SUB(a, b)         _mm_sub_ps((a), (b))
+#define V_MUL(a, b)         _mm_mul_ps((a), (b))
+#define V_DIV(a, b)         _mm_div_ps((a), (b))
+#define V_SQRT(a)           _mm_sqrt_ps(a)
+#define V_MIN(a, b)         _mm_min_ps((a), (b))
+#define V_MAX(a, b)         _mm_max_ps((a), (b))
+#define V_ABS(a)            _mm_andnot_ps(_mm_set1_ps(-0.0f), (a))
+#define V_FLOOR(a)          ik_floor_sse2(a)
+#define V_MADD(a, b, c)     _mm_add_ps(_mm_mul_ps((a), (b)), (c))
+#define V_LT(a, b)          _mm_cmplt_ps((a), (b))
+#define V_GT(a, b)          _mm_cmpgt_ps((a), (b))
+#define V_LE(a, b)          _mm_cmple_ps((a), (b))
+#define V_GE(a, b)          _mm_cmpge_ps((a), (b))
+#define M_AND(a, b)         _mm_and_ps((a), (b))
+#define V_SELECT(m, a, b)   _mm_or_ps(_mm_and_ps((m), (a)), _mm_andnot_ps((m), (b)))
+#define M_BITS(m)           ((uint32_t)_mm_movemask_ps(m))
+#define V_LOAD(p)           _mm_loadu_ps(p)
+#define V_STORE(p, a)       _mm_storeu_ps((p), (a))
+#define V_LOAD_U16(p)       _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(p)), _mm_setzero_si128()))
+#define V_SIN(a)            ik_vsin(a)
+#define V_COS(a)            ik_vsin(_mm_add_ps((a), _mm_set1_ps(IK_HALF_PI)))
+
+//SSE2 has no floor (SSE4.1), truncate and step down the lanes that were negative
+static inline __m128 ik_floor_sse2(__m128 a){
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    return(_mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f))));
+}
+
+#else
+#define IK_BATCH_LANES      1
+typedef float ik_vec;
+typedef uint32_t ik_mask;
+#define V_SET(a)            ((float)(a))
+#define V_ADD(a, b)         ((a) + (b))
+#define V_SUB(a, b)         ((a) - (b))
+#define V_MUL(a, b)         ((a) * (b))
+#define V_DIV(a, b)         ((a) / (b))
+#define V_MIN(a, b)         (((a) < (b)) ? (a) : (b))
+#define V_MAX(a, b)         (((a) > (b)) ? (a) : (b))
+#define V_ABS(a)            fabsf(a)
+#define V_FLOOR(a)          floorf(a)
+#define V_MADD(a, b, c)     ((a) * (b) + (c))
+#define V_LT(a, b)          ((uint32_t)((a) < (b)))
+#define V_GT(a, b)          ((uint32_t)((a) > (b)))
+#define V_LE(a, b)          ((uint32_t)((a) <= (b)))
+#define V_GE(a, b)          ((uint32_t)((a) >= (b)))
+#define M_AND(a, b)         ((a) & (b))
+#define V_SELECT(m, a, b)   ((m) ? (a) : (b))
+#define M_BITS(m)           (m)
+#define V_LOAD(p)           (*(p))
+#define V_STORE(p, a)       (*(p) = (a))
+#define V_LOAD_U16(p)       ((float)*(p))
+#ifdef IK_BATCH_CMSIS
+#define V_SQRT(a)           ik_sqrt_cmsis(a)
+#define V_SIN(a)            arm_sin_f32(a)
+#define V_COS(a)            arm_cos_f32(a)
+
+//VSQRT through CMSIS-DSP (negative inputs give 0 instead of NaN, the range checks catch them either way)
+static inline float ik_sqrt_cmsis(float a){
+    float out;
+    arm_sqrt_f32(a, &out);
+    return(out);
+}
+#else
+#define V_SQRT(a)           sqrtf(a)
+#define V_SIN(a)            sinf(a)
+#define V_COS(a)            cosf(a)
+#endif
+#endif
+
+/*
+*   Per arm values, worked out once per batch
+*/
+struct ik_batch_arm {
+    float Len_Wrist;
+    float BaseToElbow_Sqrd;
+    float ElbowToWrist_Sqrd;
+    float Inv_2_BaseToElbow;                    //1 / (2 * BaseToElbow)
+    float Inv_2_BaseToElbow_ElbowToWrist;       //1 / (2 * BaseToElbow * ElbowToWrist)
+};
+
+
+/***** Function Prototypes *****/
+int32_t Arm_Solve_Batch(const struct RobotArm *arm, const uint16_t *x, const uint16_t *y, const uint16_t *z, const float *Grabber_Angle,
+                        uint32_t count, struct IK_Batch_Angles *angles, uint32_t *reachable);
+
+
+/***** Lane math *****/
+
+//acos of every lane (Cephes asinf polynomial, about 2 ulp). Inputs must already be in [-1, 1]
+static inline ik_vec ik_vacos(ik_vec a){
+    ik_vec abs_a = V_ABS(a);
+    ik_mask big = V_GT(abs_a, V_SET(0.5f));
+
+    //Above 0.5 use acos(a) = 2 * asin(sqrt((1 - a) / 2)) to stay on the accurate part of the polynomial
+    ik_vec zz = V_SELECT(big, V_MUL(V_SUB(V_SET(1.0f), abs_a), V_SET(0.5f)), V_MUL(abs_a, abs_a));
+    ik_vec s = V_SELECT(big, V_SQRT(zz), abs_a);
+
+    ik_vec p = V_MADD(V_SET(4.2163199048e-2f), zz, V_SET(2.4181311049e-2f));
+    p = V_MADD(p, zz, V_SET(4.5470025998e-2f));
+    p = V_MADD(p, zz, V_SET(7.4953002686e-2f));
+    p = V_MADD(p, zz, V_SET(1.6666752422e-1f));
+    p = V_MADD(V_MUL(p, zz), s, s);                                 //asin(s)
+
+    ik_vec r = V_SELECT(big, V_ADD(p, p), V_SUB(V_SET(IK_HALF_PI), p));
+    return(V_SELECT(V_LT(a, V_SET(0.0f)), V_SUB(V_SET(IK_PI), r), r));
+}
+
+#if IK_BATCH_LANES > 1
+//sin of every lane. Fold into [-pi/2, pi/2] and use the series up to x^11 (error under 6e-8)
+static inline ik_vec ik_vsin(ik_vec a){
+    ik_vec r = V_SUB(a, V_MUL(V_SET(IK_TWO_PI), V_FLOOR(V_MADD(a, V_SET(1.0f / IK_TWO_PI), V_SET(0.5f)))));
+    r = V_SELECT(V_GT(r, V_SET(IK_HALF_PI)), V_SUB(V_SET(IK_PI), r), r);
+    r = V_SELECT(V_LT(r, V_SET(-IK_HALF_PI)), V_SUB(V_SET(-IK_PI), r), r);
+
+    ik_vec r2 = V_MUL(r, r);
+    ik_vec p = V_MADD(V_SET(-2.5052108e-8f), r2, V_SET(2.7557319e-6f));
+    p = V_MADD(p, r2, V_SET(-1.9841270e-4f));
+    p = V_MADD(p, r2, V_SET(8.3333333e-3f));
+    p = V_MADD(p, r2, V_SET(-1.6666667e-1f));
+    return(V_MADD(V_MUL(p, r2), r, r));
+}
+#endif
+
+static inline ik_vec ik_clamp_unit(ik_vec a){
+    return(V_MIN(V_MAX(a, V_SET(-1.0f)), V_SET(1.0f)));
+}
+
+static inline ik_mask ik_in_unit(ik_vec a){
+    return(M_AND(V_GE(a, V_SET(-1.0f)), V_LE(a, V_SET(1.0f))));
+}
+
+//Round half up like round() does for the positive offsets
+static inline ik_vec ik_round(ik_vec a){
+    return(V_FLOOR(V_ADD(a, V_SET(0.5f))));
+}
+
+//Solve IK_BATCH_LANES targets, same steps as Arm_Solve(). Returns the reachable lanes
+static inline ik_mask ik_solve_lanes(const struct ik_batch_arm *k, ik_vec x, ik_vec y, ik_vec z, ik_vec grabber,
+                                     ik_vec *base, ik_vec *shoulder, ik_vec *elbow, ik_vec *wrist){
+    ik_vec zero = V_SET(0.0f);
+
+    //Base angle. cos and sin of it are x and y over the flat distance, so the wrist offset needs no more trig
+    ik_vec flat = V_SQRT(V_MADD(x, x, V_MUL(y, y)));
+    ik_mask has_flat = V_GT(flat, zero);
+    ik_vec safe_flat = V_SELECT(has_flat, flat, V_SET(1.0f));
+    ik_vec cos_base = V_DIV(x, safe_flat);                          //Divide, a reciprocal leaves y = 0 just off 1
+    ik_vec sin_base = V_DIV(y, safe_flat);
+    *base = V_MUL(ik_vacos(ik_clamp_unit(cos_base)), V_SET(IK_RAD_TO_DEG));
+
+    //Move the target back along the grabber to the wrist joint (over 90 degrees the wrist stays straight)
+    ik_mask bent = V_LE(grabber, V_SET(90.0f));
+    ik_vec wrist_angle = V_SELECT(bent, V_SUB(V_SET(90.0f), grabber), zero);
+    ik_vec wrist_rad = V_MUL(wrist_angle, V_SET(IK_DEG_TO_RAD));
+    ik_vec len_wrist = V_SET(k->Len_Wrist);
+    ik_vec delta_z = V_SELECT(bent, ik_round(V_MUL(len_wrist, V_COS(wrist_rad))), zero);
+    ik_vec delta_xy = V_MUL(len_wrist, V_SIN(wrist_rad));
+    ik_vec coord_x = V_SUB(x, ik_round(V_MUL(delta_xy, cos_base)));
+    ik_vec coord_y = V_SUB(y, ik_round(V_MUL(delta_xy, sin_base)));
+    ik_vec coord_z = V_ADD(z, delta_z);
+    *wrist = wrist_angle;
+
+    //Updated_Coords are unsigned, a wrist joint behind the base would wrap
+    ik_mask ok = M_AND(has_flat, M_AND(V_GE(coord_x, zero), V_GE(coord_y, zero)));
+    ok = M_AND(ok, M_AND(V_GE(coord_z, zero), V_LE(coord_z, V_SET(65535.0f))));
+
+    //Shoulder to wrist joint distance
+    ik_vec flat_sqrd = V_MADD(coord_x, coord_x, V_MUL(coord_y, coord_y));
+    ik_vec dist_sqrd = V_MADD(coord_z, coord_z, flat_sqrd);
+    ik_vec dist = V_SQRT(dist_sqrd);
+    ik_mask has_dist = V_GT(dist, zero);
+    ik_vec inv_dist = V_SELECT(has_dist, V_DIV(V_SET(1.0f), dist), zero);
+    ok = M_AND(ok, has_dist);
+
+    //Shoulder: elevation of the wrist joint plus the SSS angle at the shoulder
+    ik_vec theta_z = ik_vacos(V_MIN(V_MUL(V_SQRT(flat_sqrd), inv_dist), V_SET(1.0f)));
+    ik_vec shoulder_arg = V_MUL(V_MUL(V_ADD(dist_sqrd, V_SET(k->BaseToElbow_Sqrd - k->ElbowToWrist_Sqrd)), inv_dist), V_SET(k->Inv_2_BaseToElbow));
+    ik_vec elbow_arg = V_MUL(V_SUB(V_SET(k->BaseToElbow_Sqrd + k->ElbowToWrist_Sqrd), dist_sqrd), V_SET(k->Inv_2_BaseToElbow_ElbowToWrist));
+    ok = M_AND(ok, M_AND(ik_in_unit(shoulder_arg), ik_in_unit(elbow_arg)));
+
+    *shoulder = V_MUL(V_ADD(theta_z, ik_vacos(ik_clamp_unit(shoulder_arg))), V_SET(IK_RAD_TO_DEG));
+    *elbow = V_MUL(ik_vacos(ik_clamp_unit(elbow_arg)), V_SET(IK_RAD_TO_DEG));
+    return(ok);
+}
+
+
+/***** Driver implementation *****/
+
+int32_t Arm_Solve_Batch(const struct RobotArm *arm, const uint16_t *x, const uint16_t *y, const uint16_t *z, const float *Grabber_Angle,
+                        uint32_t count, struct IK_Batch_Angles *angles, uint32_t *reachable){
+    struct ik_batch_arm k;
+    ik_vec base, shoulder, elbow, wrist;
+    uint32_t num_reachable = 0;
+    uint32_t i = 0;
+
+    if(arm == NULL || x == NULL || y == NULL || z == NULL || Grabber_Angle == NULL || angles == NULL || reachable == NULL){
+        return(E_NULL_PTR);
+    }
+    if(!arm->Len_BaseToElbow || !arm->Len_ElbowToWrist){
+        return(E_BAD_PARAM);
+    }
+
+    k.Len_Wrist = arm->Len_Wrist;
+    k.BaseToElbow_Sqrd = arm->Len_BaseToElbow_Sqrd;
+    k.ElbowToWrist_Sqrd = arm->Len_ElbowToWrist_Sqrd;
+    k.Inv_2_BaseToElbow = 1.0f / (2.0f * arm->Len_BaseToElbow);
+    k.Inv_2_BaseToElbow_ElbowToWrist = 1.0f / (2.0f * arm->Len_BaseToElbow * arm->Len_ElbowToWrist);
+
+    for(uint32_t w = 0; w < IK_BATCH_WORDS(count); w++){
+        reachable[w] = 0;
+    }
+
+    for(; i + IK_BATCH_LANES <= count; i += IK_BATCH_LANES){
+        ik_mask ok = ik_solve_lanes(&k, V_LOAD_U16(&x[i]), V_LOAD_U16(&y[i]), V_LOAD_U16(&z[i]), V_LOAD(&Grabber_Angle[i]),
+                                    &base, &shoulder, &elbow, &wrist);
+        V_STORE(&angles->Base[i], base);
+        V_STORE(&angles->Shoulder[i], shoulder);
+        V_STORE(&angles->Elbow[i], elbow);
+        V_STORE(&angles->Wrist[i], wrist);
+
+        //IK_BATCH_LANES divides 32, so a step never straddles two mask words
+        uint32_t bits = M_BITS(ok);
+        reachable[i >> 5] |= bits << (i & 31);
+        num_reachable += bits ? __builtin_popcount(bits) : 0;
+    }
+
+#if IK_BATCH_LANES > 1
+    //Tail, padded out to a full step on the stack
+    if(i < count){
+        uint16_t tail_x[IK_BATCH_LANES] = {0}, tail_y[IK_BATCH_LANES] = {0}, tail_z[IK_BATCH_LANES] = {0};
+        float tail_grabber[IK_BATCH_LANES] = {0};
+        float tail_out[4][IK_BATCH_LANES];
+        uint32_t left = count - i;
+
+        for(uint32_t l = 0; l < left; l++){
+            tail_x[l] = x[i + l];
+            tail_y[l] = y[i + l];
+            tail_z[l] = z[i + l];
+            tail_grabber[l] = Grabber_Angle[i + l];
+        }
+        ik_mask ok = ik_solve_lanes(&k, V_LOAD_U16(tail_x), V_LOAD_U16(tail_y), V_LOAD_U16(tail_z), V_LOAD(tail_grabber),
+                                    &base, &shoulder, &elbow, &wrist);
+        V_STORE(tail_out[0], base);
+        V_STORE(tail_out[1], shoulder);
+        V_STORE(tail_out[2], elbow);
+        V_STORE(tail_out[3], wrist);
+        for(uint32_t l = 0; l < left; l++){
+            angles->Base[i + l] = tail_out[0][l];
+            angles->Shoulder[i + l] = tail_out[1][l];
+            angles->Elbow[i + l] = tail_out[2][l];
+            angles->Wrist[i + l] = tail_out[3][l];
+        }
+
+        uint32_t bits = M_BITS(ok) & ((1u << left) - 1);
+        reachable[i >> 5] |= bits << (i & 31);
+        num_reachable += bits ? __builtin_popcount(bits) : 0;
+    }
+#endif
+
+    return((int32_t)num_reachable);
+}
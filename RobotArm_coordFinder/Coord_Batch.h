@@ -0,0 +1,66 @@
+/**
+* @file             Coord_Batch.h
+* @brief            Solve the arm for many grabber positions in one call
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_BATCH_H_
+#define _COORD_BATCH_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+
+/* Glossary for Coord_Batch.h and Coord_Batch.c
+ *
+ *  Batch          - Targets given as separate x[], y[], z[] and Grabber_Angle[] arrays (struct-of-arrays), entry i of
+ *                   every array is target i. The joint angles come back the same way in struct IK_Batch_Angles.
+ *  Lane           - One target inside a vector step. The solve runs on IK_BATCH_LANES targets at a time:
+ *                      AVX2            8 lanes on the host (build with -mavx2, add -mfma to fuse the multiply-adds)
+ *                      SSE2            4 lanes on the host
+ *                      Scalar          1 lane everywhere else, using the CMSIS-DSP sqrt/sin/cos on a Cortex-M
+ *                                      built with ARM_MATH_CM4 (-DIK_BATCH_SCALAR forces this path on the host)
+ *  Reachable Mask - One bit per target, set when the arm can reach it. Unreachable targets still get angles, but
+ *                   they are not a pose of the arm (the out of range acos arguments are clamped).
+ *
+ * The math is the same as Arm_Solve(): the wrist joint is found by moving the target back along the grabber
+ * (rounded to whole units like Updated_Coords) and the shoulder and elbow come from the SSS triangle. Every lane is
+ * solved without branches, so acos, sin and cos are polynomials instead of the libm calls. The angles agree with
+ * Arm_Solve() built with IK_TRIG_LIBM to within 1e-3 degrees, unless a wrist offset lands right on a .5 and rounds
+ * the other way.
+ */
+
+#define IK_BATCH_WORDS(count)           (((count) + 31) / 32)                       //Reachable mask words for count targets
+#define IK_BATCH_REACHABLE(mask, i)     (((mask)[(i) >> 5] >> ((i) & 31)) & 1)     //Is target i reachable
+
+/*
+*   Joint angles of a batch in degrees, each array holds one angle per target
+*/
+struct IK_Batch_Angles {
+    float *Base;
+    float *Shoulder;
+    float *Elbow;
+    float *Wrist;
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Solve the joint angles for count grabber positions. The arm is only read, so batches for the same
+*               arm can run at the same time
+* @param[in]    arm - Arm geometry (Arm_Init())
+* @param[in]    x, y, z - Grabber positions, count entries each
+* @param[in]    Grabber_Angle - Grabber angle of each target in degrees (over 90 leaves the wrist straight)
+* @param[in]    count - Number of targets
+* @param[out]   angles - Arrays of count entries for the Base, Shoulder, Elbow and Wrist angles
+* @param[out]   reachable - Reachable mask, IK_BATCH_WORDS(count) words
+*
+* @return       Number of reachable targets (Success), E_NULL_PTR or E_BAD_PARAM (arm not initialized)
+*/
+int32_t Arm_Solve_Batch(const struct RobotArm *arm, const uint16_t *x, const uint16_t *y, const uint16_t *z, const float *Grabber_Angle,
+                        uint32_t count, struct IK_Batch_Angles *angles, uint32_t *reachable);
+
+
+
+#endif  /* _COORD_BATCH_H_ */
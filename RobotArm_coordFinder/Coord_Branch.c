@@ -0,0 +1,250 @@
+/**
+* @file             Coord_Branch.c
+* @brief            Open a solution into its elbow and base branches and pick the one with the least joint travel
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include <math.h>
+#include "Coord_Branch.h"
+#include "Coord_Trig.h"
+
+
+/***** Definitions *****/
+
+#define BRANCH_BATCH_CHUNK      64          //Targets per Arm_Solve_Batch() call, sizes the reachable mask on the stack
+
+
+/***** Global Variables *****/
+
+extern struct RobotArm Asimov;
+
+static const float default_weights[4] = {
+    IK_BRANCH_WEIGHT_BASE, IK_BRANCH_WEIGHT_SHOULDER, IK_BRANCH_WEIGHT_ELBOW, IK_BRANCH_WEIGHT_WRIST
+};
+
+
+/***** Function Prototypes *****/
+static uint32_t Branch_Expand(const struct RobotArm *arm, const float *solution, const struct IK_Joint_Limits *limits, float candidates[4][IK_BRANCHES]);
+static int Branch_In_Limits(float *angle, float min, float max);
+static int Branch_Pick(const float candidates[4][IK_BRANCHES], uint32_t valid, const float *from, const float *weights);
+
+
+/***** Driver implementation *****/
+
+int Arm_Solve_All(const struct RobotArm *arm, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle,
+                  const struct IK_Joint_Limits *limits, struct IK_Solutions *solutions){
+    float results[6], candidates[4][IK_BRANCHES];
+    uint32_t valid;
+    int rslt;
+
+    if(solutions == NULL){
+        return(E_NULL_PTR);
+    }
+    if((rslt = Arm_Solve(arm, scratch, x, y, z, Grabber_Angle, results)) != E_NO_ERROR){
+        return(rslt);
+    }
+
+    valid = Branch_Expand(arm, results, limits, candidates);
+    solutions->Count = 0;
+    for(uint32_t b = 0; b < IK_BRANCHES; b++){
+        if(valid & (1u << b)){
+            float *angles = solutions->Angles[solutions->Count];
+
+            for(uint32_t j = 0; j < 4; j++){
+                angles[j] = candidates[j][b];
+            }
+            angles[4] = results[4];
+            angles[5] = results[5];
+            solutions->Branch[solutions->Count++] = (uint8_t)b;
+        }
+    }
+
+    return(solutions->Count);
+}
+
+int Arm_Solve_Nearest(const struct RobotArm *arm, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle,
+                      const struct IK_Joint_Limits *limits, const float *from, const float *weights, float *results){
+    float solution[6], candidates[4][IK_BRANCHES];
+    int rslt, branch;
+
+    if(from == NULL || results == NULL){
+        return(E_NULL_PTR);
+    }
+    if((rslt = Arm_Solve(arm, scratch, x, y, z, Grabber_Angle, solution)) != E_NO_ERROR){
+        return(rslt);
+    }
+
+    branch = Branch_Pick(candidates, Branch_Expand(arm, solution, limits, candidates), from, (weights != NULL) ? weights : default_weights);
+    if(branch < 0){
+        return(E_NONE_AVAIL);
+    }
+
+    for(uint32_t j = 0; j < 4; j++){
+        results[j] = candidates[j][branch];
+    }
+    results[4] = solution[4];
+    results[5] = solution[5];
+    return(branch);
+}
+
+int32_t Arm_Solve_Nearest_Batch(const struct RobotArm *arm, const uint16_t *x, const uint16_t *y, const uint16_t *z, const float *Grabber_Angle,
+                                uint32_t count, const struct IK_Joint_Limits *limits, const float *from, const float *weights,
+                                struct IK_Batch_Angles *angles, uint8_t *branches){
+    uint32_t reachable[IK_BATCH_WORDS(BRANCH_BATCH_CHUNK)];
+    float previous[4], solution[4], candidates[4][IK_BRANCHES];
+    int32_t rslt, num_valid = 0;
+
+    if(arm == NULL || from == NULL || angles == NULL || branches == NULL){
+        return(E_NULL_PTR);
+    }
+    if(weights == NULL){
+        weights = default_weights;
+    }
+    for(uint32_t j = 0; j < 4; j++){
+        previous[j] = from[j];
+    }
+
+    for(uint32_t start = 0; start < count; start += BRANCH_BATCH_CHUNK){
+        uint32_t chunk = (count - start < BRANCH_BATCH_CHUNK) ? count - start : BRANCH_BATCH_CHUNK;
+        struct IK_Batch_Angles part = { &angles->Base[start], &angles->Shoulder[start], &angles->Elbow[start], &angles->Wrist[start] };
+
+        //Elbow up solutions of the whole chunk in vector lanes
+        if((rslt = Arm_Solve_Batch(arm, &x[start], &y[start], &z[start], &Grabber_Angle[start], chunk, &part, reachable)) < 0){
+            return(rslt);
+        }
+
+        //Then the walk, where every pick depends on the one before
+        for(uint32_t i = 0; i < chunk; i++){
+            int branch = -1;
+
+            if(IK_BATCH_REACHABLE(reachable, i)){
+                solution[0] = part.Base[i];
+                solution[1] = part.Shoulder[i];
+                solution[2] = part.Elbow[i];
+                solution[3] = part.Wrist[i];
+                branch = Branch_Pick(candidates, Branch_Expand(arm, solution, limits, candidates), previous, weights);
+            }
+            if(branch < 0){
+                branches[start + i] = IK_BRANCH_NONE;
+                continue;
+            }
+
+            for(uint32_t j = 0; j < 4; j++){
+                previous[j] = candidates[j][branch];
+            }
+            part.Base[i] = previous[0];
+            part.Shoulder[i] = previous[1];
+            part.Elbow[i] = previous[2];
+            part.Wrist[i] = previous[3];
+            branches[start + i] = (uint8_t)branch;
+            num_valid++;
+        }
+    }
+
+    return(num_valid);
+}
+
+int Update_Grabber_Position_Nearest(uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, const struct IK_Joint_Limits *limits, float *results){
+    struct IK_Scratch scratch;
+    float from[4] = { Asimov.Base_Angle, Asimov.Shoulder_Angle, Asimov.Elbow_Angle, Asimov.Wrist_Angle };
+    int branch;
+
+    if((branch = Arm_Solve_Nearest(&Asimov, &scratch, x, y, z, Grabber_Angle, limits, from, NULL, results)) < 0){
+        return(branch);
+    }
+
+    //Update arm structure
+    Arm_Set_Position(&Asimov, results);
+    return(branch);
+}
+
+//Every branch of an elbow up solution (Base, Shoulder, Elbow, Wrist) into candidates[joint][branch]. Returns a bit per
+//valid branch, none for an unreachable (NaN) solution
+static uint32_t Branch_Expand(const struct RobotArm *arm, const float *solution, const struct IK_Joint_Limits *limits, float candidates[4][IK_BRANCHES]){
+    float Elbow_Cos, Reach, Alpha, Theta_Z, Ratio;
+    uint32_t valid = 0;
+
+    //Shoulder to wrist joint distance from the elbow angle, then the SSS angle at the shoulder. The shoulder angle is
+    //the elevation of the wrist joint plus this angle with the elbow up, minus it with the elbow down
+    Elbow_Cos = Trig_Cos_Deg(solution[2]);
+    Reach = sqrtf(arm->Len_BaseToElbow_Sqrd + arm->Len_ElbowToWrist_Sqrd - 2.0f*arm->Len_BaseToElbow*arm->Len_ElbowToWrist*Elbow_Cos);
+    if(!(Reach > 0)){
+        //No branch, but Branch_Pick() still costs every candidate
+        for(uint32_t j = 0; j < 4; j++){
+            for(uint32_t b = 0; b < IK_BRANCHES; b++){
+                candidates[j][b] = NAN;
+            }
+        }
+        return(0);
+    }
+    Ratio = (arm->Len_BaseToElbow - arm->Len_ElbowToWrist*Elbow_Cos)/Reach;
+    Alpha = Trig_Acos_Deg((Ratio > 1.0f) ? 1.0f : ((Ratio < -1.0f) ? -1.0f : Ratio));
+    Theta_Z = solution[1] - Alpha;
+
+    candidates[0][IK_BRANCH_UP] = solution[0];
+    candidates[1][IK_BRANCH_UP] = solution[1];
+    candidates[2][IK_BRANCH_UP] = solution[2];
+    candidates[3][IK_BRANCH_UP] = solution[3];
+
+    candidates[0][IK_BRANCH_DOWN] = solution[0];
+    candidates[1][IK_BRANCH_DOWN] = Theta_Z - Alpha;
+    candidates[2][IK_BRANCH_DOWN] = 360.0f - solution[2];
+    candidates[3][IK_BRANCH_DOWN] = solution[3];
+
+    //Turning the base round mirrors the vertical plane: shoulder 180 - S, elbow bent the other way, wrist too
+    for(uint32_t b = IK_BRANCH_FLIP_UP; b <= IK_BRANCH_FLIP_DOWN; b++){
+        uint32_t same = b - IK_BRANCH_FLIP_UP;
+
+        candidates[0][b] = candidates[0][same] + 180.0f;
+        candidates[1][b] = 180.0f - candidates[1][same];
+        candidates[2][b] = 360.0f - candidates[2][same];
+        candidates[3][b] = 0.0f - candidates[3][same];
+    }
+
+    for(uint32_t b = 0; b < IK_BRANCHES; b++){
+        int in_limits = 1;
+
+        for(uint32_t j = 0; j < 4 && limits != NULL; j++){
+            in_limits &= Branch_In_Limits(&candidates[j][b], limits->Min[j], limits->Max[j]);
+        }
+        if(in_limits && !isnan(candidates[1][b]) && !isnan(candidates[2][b])){
+            valid |= 1u << b;
+        }
+    }
+    return(valid);
+}
+
+//Angle within the limits, turned a whole way round if that brings it in. NaN is never in
+static int Branch_In_Limits(float *angle, float min, float max){
+    float turned = (*angle < min) ? *angle + 360.0f : *angle - 360.0f;
+
+    if(*angle >= min && *angle <= max){
+        return(1);
+    }
+    if(turned >= min && turned <= max){
+        *angle = turned;
+        return(1);
+    }
+    return(0);
+}
+
+//Valid branch with the least weighted joint travel from the from angles, -1 when none is valid
+static int Branch_Pick(const float candidates[4][IK_BRANCHES], uint32_t valid, const float *from, const float *weights){
+    float cost[IK_BRANCHES], best_cost = INFINITY;
+    int best = -1;
+
+    //Cost every branch in one pass, invalid ones included, then pick
+    for(uint32_t b = 0; b < IK_BRANCHES; b++){
+        cost[b] = weights[0]*fabsf(candidates[0][b] - from[0]) + weights[1]*fabsf(candidates[1][b] - from[1]) +
+                  weights[2]*fabsf(candidates[2][b] - from[2]) + weights[3]*fabsf(candidates[3][b] - from[3]);
+    }
+    for(uint32_t b = 0; b < IK_BRANCHES; b++){
+        if((valid & (1u << b)) && cost[b] < best_cost){
+            best_cost = cost[b];
+            best = (int)b;
+        }
+    }
+    return(best);
+}
@@ -0,0 +1,144 @@
+/**
+* @file             Coord_Branch.h
+* @brief            Every joint configuration that reaches a grabber position, and the one closest to the current pose
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_BRANCH_H_
+#define _COORD_BRANCH_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+#include "Coord_Batch.h"
+
+/* Glossary for Coord_Branch.h and Coord_Branch.c
+ *
+ *  Branch         - One of the ways the arm can put the grabber on a target. Arm_Solve() only gives the first:
+ *                      IK_BRANCH_UP                Elbow above the shoulder to wrist line (Arm_Solve())
+ *                      IK_BRANCH_DOWN              Elbow below the line: shoulder lower by twice the SSS angle at the
+ *                                                  shoulder, the elbow bent the other way (360 - Elbow)
+ *                      IK_BRANCH_FLIP_UP           Base turned 180 degrees, shoulder and elbow reach back over the top
+ *                      IK_BRANCH_FLIP_DOWN         Base turned 180 degrees, elbow below the line
+ *                   The wrist joint and the grabber end up in the same place and at the same angle in every branch,
+ *                   so a flipped branch bends the wrist the other way (-Wrist).
+ *  Joint Limits   - Range of each servo. A branch angle out of range is moved by 360 degrees when that brings it in,
+ *                   otherwise the branch is not valid. NULL limits take every branch.
+ *  Joint Travel   - Cost of moving from the current angles to a branch: sum over the base, shoulder, elbow and wrist
+ *                   of weight * |change in degrees|. Weights of 1 / (joint speed) make the cost the time each joint
+ *                   spends moving. The branch with the lowest cost is picked.
+ *  Batched        - Arm_Solve_Nearest_Batch() solves a whole list of targets through Arm_Solve_Batch() (vector
+ *                   lanes), opens every one into its branches, then walks the list picking each branch from the
+ *                   one picked before, as the arm would move through them.
+ */
+
+#define IK_BRANCHES             4
+#define IK_BRANCH_NONE          0xFF        //No branch of a target is reachable within the limits
+
+#ifndef IK_BRANCH_WEIGHT_BASE
+#define IK_BRANCH_WEIGHT_BASE       1.0f    //Default joint travel weights (weights argument NULL)
+#endif
+#ifndef IK_BRANCH_WEIGHT_SHOULDER
+#define IK_BRANCH_WEIGHT_SHOULDER   1.0f
+#endif
+#ifndef IK_BRANCH_WEIGHT_ELBOW
+#define IK_BRANCH_WEIGHT_ELBOW      1.0f
+#endif
+#ifndef IK_BRANCH_WEIGHT_WRIST
+#define IK_BRANCH_WEIGHT_WRIST      1.0f
+#endif
+
+/***** Definitions *****/
+
+typedef enum {
+    IK_BRANCH_UP = 0,
+    IK_BRANCH_DOWN,
+    IK_BRANCH_FLIP_UP,
+    IK_BRANCH_FLIP_DOWN
+} IK_Branch;
+
+/*
+*   Range of the Base, Shoulder, Elbow and Wrist servos in degrees
+*/
+struct IK_Joint_Limits {
+    float Min[4];
+    float Max[4];
+};
+
+/*
+*   Valid branches of one target, in IK_Branch order
+*/
+struct IK_Solutions {
+    uint8_t Count;
+    uint8_t Branch[IK_BRANCHES];        //IK_Branch of each solution
+    float Angles[IK_BRANCHES][6];       //Base, Shoulder, Elbow, Wrist, Wrist Rotation and Wrist Grab as Arm_Solve()
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Every branch that reaches a grabber position within the joint limits
+* @param[in]    arm - Arm geometry, only read
+* @param[in]    scratch - Working values of this solve
+* @param[in]    x, y, z - Grabber position
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in degrees (over 90 leaves the wrist straight)
+* @param[in]    limits - Joint limits, or NULL for none
+* @param[out]   solutions - Valid branches
+*
+* @return       Number of valid branches, 0 when the target is out of reach (Success), E_NULL_PTR (Failure)
+*/
+int Arm_Solve_All(const struct RobotArm *arm, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle,
+                  const struct IK_Joint_Limits *limits, struct IK_Solutions *solutions);
+
+/**
+* @brief        The branch with the least joint travel from a set of angles
+* @param[in]    arm - Arm geometry, only read
+* @param[in]    scratch - Working values of this solve
+* @param[in]    x, y, z - Grabber position
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in degrees
+* @param[in]    limits - Joint limits, or NULL for none
+* @param[in]    from - Base, Shoulder, Elbow and Wrist angles the arm moves from
+* @param[in]    weights - Base, Shoulder, Elbow and Wrist travel weights, or NULL for the IK_BRANCH_WEIGHT_ defaults
+* @param[out]   results - 6 angles as Arm_Solve(), not written when no branch is valid
+*
+* @return       IK_Branch picked (Success), E_NULL_PTR or E_NONE_AVAIL (no valid branch)
+*/
+int Arm_Solve_Nearest(const struct RobotArm *arm, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle,
+                      const struct IK_Joint_Limits *limits, const float *from, const float *weights, float *results);
+
+/**
+* @brief        Arm_Solve_Nearest() for a list of targets visited in order: each target moves from the branch picked
+*               for the one before it, the first from the from angles
+* @param[in]    arm - Arm geometry (Arm_Init()), only read
+* @param[in]    x, y, z - Grabber positions, count entries each
+* @param[in]    Grabber_Angle - Grabber angle of each target in degrees
+* @param[in]    count - Number of targets
+* @param[in]    limits - Joint limits, or NULL for none
+* @param[in]    from - Base, Shoulder, Elbow and Wrist angles before the first target
+* @param[in]    weights - Travel weights, or NULL for the defaults
+* @param[out]   angles - Arrays of count entries for the picked Base, Shoulder, Elbow and Wrist angles (left as
+*               Arm_Solve_Batch() wrote them for a target with no valid branch)
+* @param[out]   branches - IK_Branch picked for each target, IK_BRANCH_NONE when it has no valid branch
+*
+* @return       Number of targets with a valid branch (Success), E_NULL_PTR or E_BAD_PARAM (arm not initialized)
+*/
+int32_t Arm_Solve_Nearest_Batch(const struct RobotArm *arm, const uint16_t *x, const uint16_t *y, const uint16_t *z, const float *Grabber_Angle,
+                                uint32_t count, const struct IK_Joint_Limits *limits, const float *from, const float *weights,
+                                struct IK_Batch_Angles *angles, uint8_t *branches);
+
+/**
+* @brief        Update_Grabber_Position() that picks the branch nearest the angles the global arm is at now, and
+*               moves the global arm there
+* @param[in]    x, y, z - Grabber position
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in degrees
+* @param[in]    limits - Joint limits, or NULL for none
+* @param[out]   results - 6 angles as Update_Grabber_Position()
+*
+* @return       IK_Branch picked (Success), E_NULL_PTR or E_NONE_AVAIL (no valid branch, the arm is not updated)
+*/
+int Update_Grabber_Position_Nearest(uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, const struct IK_Joint_Limits *limits, float *results);
+
+
+
+#endif  /* _COORD_BRANCH_H_ */
@@ -0,0 +1,321 @@
+/**
+* @file             Coord_Calib.c
+* @brief            Levenberg-Marquardt fit of link lengths and joint offsets to measured grabber positions
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include <math.h>
+#include "Coord_Calib.h"
+#include "Coord_Trig.h"
+
+
+/***** Definitions *****/
+
+#define CALIB_RAD_PER_DEG       0.017453292519943f
+#define CALIB_LAMBDA_MIN        1e-9f
+#define CALIB_PIVOT_MIN         1e-6f       //Cholesky pivot against its diagonal, under it the matrix is singular
+#define CALIB_MAX_LENGTH        65535.0f
+
+
+/***** Function Prototypes *****/
+static void Calib_Model(const float *params, const float *angles, float *tip, float (*jacobian)[CALIB_PARAMS]);
+static float Calib_Cost(const float *params, const struct Calib_Sample *samples, uint32_t count);
+static int Calib_Cholesky_Solve(float (*a)[CALIB_PARAMS], float *b, uint32_t n);
+
+
+/***** Driver implementation *****/
+
+int Calib_Init(struct Arm_Calibration *calibration, const struct RobotArm *arm){
+    if(calibration == NULL || arm == NULL){
+        return(E_NULL_PTR);
+    }
+
+    calibration->Lengths[0] = arm->Len_BaseToElbow;
+    calibration->Lengths[1] = arm->Len_ElbowToWrist;
+    calibration->Lengths[2] = arm->Len_Wrist;
+    for(int j = 0; j < 4; j++){
+        calibration->Offsets[j] = 0;
+    }
+    calibration->RMS_Before = NAN;
+    calibration->RMS_After = NAN;
+    calibration->Iterations = 0;
+
+    return(E_NO_ERROR);
+}
+
+int Calib_Fit(struct Arm_Calibration *calibration, const struct Calib_Sample *samples, uint32_t count, uint8_t fit){
+    float params[CALIB_PARAMS], trial[CALIB_PARAMS], gradient[CALIB_PARAMS], step[CALIB_PARAMS];
+    float normal[CALIB_PARAMS][CALIB_PARAMS], damped[CALIB_PARAMS][CALIB_PARAMS];
+    float tip[3], jacobian[3][CALIB_PARAMS];
+    float cost, trial_cost, lambda = CALIB_LAMBDA_START, decrease = 1.0f;
+    uint8_t active[CALIB_PARAMS];
+    uint32_t n = 0, iterations = 0;
+
+    if(calibration == NULL || samples == NULL){
+        return(E_NULL_PTR);
+    }
+    if(count < 3 || !fit || (fit & ~CALIB_FIT_ALL)){
+        return(E_BAD_PARAM);
+    }
+
+    for(uint32_t i = 0; i < CALIB_PARAMS; i++){
+        params[i] = (i < 3) ? calibration->Lengths[i] : calibration->Offsets[i - 3];
+        if(fit & (1u << i)){
+            active[n++] = (uint8_t)i;
+        }
+    }
+    cost = Calib_Cost(params, samples, count);
+    if(!isfinite(cost)){
+        return(E_BAD_PARAM);
+    }
+    calibration->RMS_Before = sqrtf(cost / count);
+
+    while(iterations < CALIB_MAX_ITERATIONS && decrease > CALIB_TOLERANCE){
+        uint8_t kept = 0;
+
+        //Normal equations of the active parameters, one sample at a time
+        for(uint32_t r = 0; r < n; r++){
+            gradient[r] = 0;
+            for(uint32_t c = 0; c < n; c++){
+                normal[r][c] = 0;
+            }
+        }
+        for(uint32_t s = 0; s < count; s++){
+            Calib_Model(params, samples[s].Angles, tip, jacobian);
+            for(int k = 0; k < 3; k++){
+                float residual = tip[k] - samples[s].Position[k];
+                for(uint32_t r = 0; r < n; r++){
+                    float jr = jacobian[k][active[r]];
+                    gradient[r] += jr * residual;
+                    for(uint32_t c = 0; c <= r; c++){
+                        normal[r][c] += jr * jacobian[k][active[c]];
+                    }
+                }
+            }
+        }
+        for(uint32_t r = 0; r < n; r++){
+            for(uint32_t c = 0; c < r; c++){
+                normal[c][r] = normal[r][c];
+            }
+        }
+
+        //The samples have to pin every parameter down without any damping
+        if(!iterations){
+            for(uint32_t r = 0; r < n; r++){
+                step[r] = gradient[r];
+                for(uint32_t c = 0; c < n; c++){
+                    damped[r][c] = normal[r][c];
+                }
+            }
+            if(Calib_Cholesky_Solve(damped, step, n) != E_NO_ERROR){
+                return(E_INVALID);
+            }
+        }
+
+        //Raise lambda until a step lowers the cost
+        while(!kept && lambda <= CALIB_LAMBDA_MAX){
+            for(uint32_t r = 0; r < n; r++){
+                step[r] = -gradient[r];
+                for(uint32_t c = 0; c < n; c++){
+                    damped[r][c] = normal[r][c];
+                }
+                damped[r][r] *= 1.0f + lambda;
+            }
+            if(Calib_Cholesky_Solve(damped, step, n) == E_NO_ERROR){
+                for(uint32_t i = 0; i < CALIB_PARAMS; i++){
+                    trial[i] = params[i];
+                }
+                for(uint32_t r = 0; r < n; r++){
+                    trial[active[r]] += step[r];
+                }
+                trial_cost = Calib_Cost(trial, samples, count);
+                if(trial_cost < cost){
+                    decrease = (cost - trial_cost) / cost;
+                    cost = trial_cost;
+                    for(uint32_t i = 0; i < CALIB_PARAMS; i++){
+                        params[i] = trial[i];
+                    }
+                    lambda = fmaxf(lambda * 0.1f, CALIB_LAMBDA_MIN);
+                    iterations++;
+                    kept = 1;
+                    continue;
+                }
+            }
+            lambda *= 10.0f;
+        }
+
+        //No step lowers the cost: at the minimum as far as float goes
+        if(!kept){
+            break;
+        }
+    }
+
+    for(int i = 0; i < 3; i++){
+        calibration->Lengths[i] = params[i];
+    }
+    for(int j = 0; j < 4; j++){
+        calibration->Offsets[j] = params[j + 3];
+    }
+    calibration->RMS_After = sqrtf(cost / count);
+    calibration->Iterations = iterations;
+
+    return(E_NO_ERROR);
+}
+
+float Calib_RMS(const struct Arm_Calibration *calibration, const struct Calib_Sample *samples, uint32_t count){
+    float params[CALIB_PARAMS];
+
+    if(calibration == NULL || samples == NULL || !count){
+        return(NAN);
+    }
+
+    for(int i = 0; i < 3; i++){
+        params[i] = calibration->Lengths[i];
+    }
+    for(int j = 0; j < 4; j++){
+        params[j + 3] = calibration->Offsets[j];
+    }
+    return(sqrtf(Calib_Cost(params, samples, count) / count));
+}
+
+int Calib_Apply(struct Arm_Calibration *calibration, struct RobotArm *arm, const struct Calib_Sample *samples, uint32_t count){
+    float position[6];
+    uint16_t lengths[3];
+
+    if(calibration == NULL || arm == NULL){
+        return(E_NULL_PTR);
+    }
+
+    for(int i = 0; i < 3; i++){
+        if(!(calibration->Lengths[i] >= 0.5f && calibration->Lengths[i] < CALIB_MAX_LENGTH + 0.5f)){
+            return(E_BAD_PARAM);
+        }
+        lengths[i] = (uint16_t)lroundf(calibration->Lengths[i]);
+        calibration->Lengths[i] = lengths[i];
+    }
+
+    //Arm_Init() clears the pose the arm remembers, keep it
+    position[0] = arm->Base_Angle;
+    position[1] = arm->Shoulder_Angle;
+    position[2] = arm->Elbow_Angle;
+    position[3] = arm->Wrist_Angle;
+    position[4] = arm->Wrist_Rotation;
+    position[5] = arm->Wrist_Grab;
+    Arm_Init(arm, lengths[0], lengths[1], lengths[2]);
+    Arm_Set_Position(arm, position);
+
+    if(samples == NULL){
+        return(E_NO_ERROR);
+    }
+    return(Calib_Fit(calibration, samples, count, CALIB_FIT_OFFSETS));
+}
+
+void Calib_Servo_Angles(const struct Arm_Calibration *calibration, const float *angles, float *servo){
+    for(int j = 0; j < 4; j++){
+        servo[j] = angles[j] - calibration->Offsets[j];
+    }
+}
+
+//Tip from the angles sent the way Arm_Forward() places it, and its derivative by every parameter when jacobian is
+//not NULL. Offsets are in degrees, so their columns carry the degree to radian factor
+static void Calib_Model(const float *params, const float *angles, float *tip, float (*jacobian)[CALIB_PARAMS]){
+    float Base = angles[0] + params[3];
+    float Shoulder = angles[1] + params[4];
+    float Forearm = Shoulder + angles[2] + params[5] - 180.0f;
+    float Wrist = angles[3] + params[6];
+    float Base_Cos = Trig_Cos_Deg(Base), Base_Sin = Trig_Sin_Deg(Base);
+    float Shoulder_Cos = Trig_Cos_Deg(Shoulder), Shoulder_Sin = Trig_Sin_Deg(Shoulder);
+    float Forearm_Cos = Trig_Cos_Deg(Forearm), Forearm_Sin = Trig_Sin_Deg(Forearm);
+    float Wrist_Cos = Trig_Cos_Deg(Wrist), Wrist_Sin = Trig_Sin_Deg(Wrist);
+    float Reach = params[0] * Shoulder_Cos + params[1] * Forearm_Cos + params[2] * Wrist_Sin;
+    float Height = params[0] * Shoulder_Sin + params[1] * Forearm_Sin - params[2] * Wrist_Cos;
+    float reach[CALIB_PARAMS], height[CALIB_PARAMS];
+
+    tip[0] = Reach * Base_Cos;
+    tip[1] = Reach * Base_Sin;
+    tip[2] = Height;
+    if(jacobian == NULL){
+        return;
+    }
+
+    //Every parameter but the base offset moves the tip in the plane through the base axis
+    reach[0] = Shoulder_Cos;
+    height[0] = Shoulder_Sin;
+    reach[1] = Forearm_Cos;
+    height[1] = Forearm_Sin;
+    reach[2] = Wrist_Sin;
+    height[2] = -Wrist_Cos;
+    reach[4] = -(params[0] * Shoulder_Sin + params[1] * Forearm_Sin) * CALIB_RAD_PER_DEG;
+    height[4] = (params[0] * Shoulder_Cos + params[1] * Forearm_Cos) * CALIB_RAD_PER_DEG;
+    reach[5] = -params[1] * Forearm_Sin * CALIB_RAD_PER_DEG;
+    height[5] = params[1] * Forearm_Cos * CALIB_RAD_PER_DEG;
+    reach[6] = params[2] * Wrist_Cos * CALIB_RAD_PER_DEG;
+    height[6] = params[2] * Wrist_Sin * CALIB_RAD_PER_DEG;
+    for(int i = 0; i < CALIB_PARAMS; i++){
+        if(i == 3){
+            continue;
+        }
+        jacobian[0][i] = reach[i] * Base_Cos;
+        jacobian[1][i] = reach[i] * Base_Sin;
+        jacobian[2][i] = height[i];
+    }
+
+    //The base offset turns the tip round the base axis
+    jacobian[0][3] = -Reach * Base_Sin * CALIB_RAD_PER_DEG;
+    jacobian[1][3] = Reach * Base_Cos * CALIB_RAD_PER_DEG;
+    jacobian[2][3] = 0;
+}
+
+//Sum of the squared residuals
+static float Calib_Cost(const float *params, const struct Calib_Sample *samples, uint32_t count){
+    float tip[3], cost = 0;
+
+    for(uint32_t s = 0; s < count; s++){
+        Calib_Model(params, samples[s].Angles, tip, NULL);
+        for(int k = 0; k < 3; k++){
+            float residual = tip[k] - samples[s].Position[k];
+            cost += residual * residual;
+        }
+    }
+    return(cost);
+}
+
+//Solve a x = b for a symmetric positive definite n x n, in place: a is overwritten by its Cholesky factor, b by x
+static int Calib_Cholesky_Solve(float (*a)[CALIB_PARAMS], float *b, uint32_t n){
+    for(uint32_t c = 0; c < n; c++){
+        float diagonal = a[c][c];
+
+        for(uint32_t k = 0; k < c; k++){
+            diagonal -= a[c][k] * a[c][k];
+        }
+        if(!(diagonal > CALIB_PIVOT_MIN * a[c][c])){
+            return(E_INVALID);
+        }
+        a[c][c] = sqrtf(diagonal);
+        for(uint32_t r = c + 1; r < n; r++){
+            float sum = a[r][c];
+            for(uint32_t k = 0; k < c; k++){
+                sum -= a[r][k] * a[c][k];
+            }
+            a[r][c] = sum / a[c][c];
+        }
+    }
+
+    //L y = b, then L^T x = y
+    for(uint32_t r = 0; r < n; r++){
+        for(uint32_t k = 0; k < r; k++){
+            b[r] -= a[r][k] * b[k];
+        }
+        b[r] /= a[r][r];
+    }
+    for(uint32_t r = n; r-- > 0;){
+        for(uint32_t k = r + 1; k < n; k++){
+            b[r] -= a[k][r] * b[k];
+        }
+        b[r] /= a[r][r];
+    }
+
+    return(E_NO_ERROR);
+}
@@ -0,0 +1,116 @@
+/**
+* @file             Coord_Calib.h
+* @brief            Fit link lengths and joint zero offsets to measured poses (Levenberg-Marquardt)
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_CALIB_H_
+#define _COORD_CALIB_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+
+/* Glossary for Coord_Calib.h and Coord_Calib.c
+ *
+ *  Sample         - Joint angles the servos were sent (Base, Shoulder, Elbow, Wrist) and the grabber tip position
+ *                   measured there (camera, touch probe, ruler), in arm units (struct Calib_Sample).
+ *  Parameters     - The 3 link lengths (shoulder to elbow, elbow to wrist, wrist to tip) and a zero offset for each
+ *                   of the 4 joints. The real joint angle is the angle sent plus its offset, and the tip is placed
+ *                   from the real angles the way Arm_Forward() does it.
+ *  Residual       - Model tip minus measured tip, 3 per sample. The fit makes the sum of their squares smallest.
+ *  Levenberg-     - Gauss-Newton steps from the normal equations (J^T J + lambda diag(J^T J)) step = -J^T r, built one
+ *  Marquardt        sample at a time from the analytic Jacobian (7x7 at most, no sample matrix is kept) and solved by
+ *                   Cholesky. A step that lowers the cost is kept and lambda drops, one that does not is retried with
+ *                   a larger lambda. Nothing is allocated; the cost per iteration grows with the number of samples.
+ *  Whole Units    - struct RobotArm keeps whole unit link lengths. Calib_Apply() rounds the fitted lengths into the
+ *                   arm, then fits the offsets again with the rounded lengths so they soak up what the rounding
+ *                   moved. Send Calib_Servo_Angles() of the solved angles to the servos so the offsets come off.
+ *
+ * The samples should cover the workspace: poses with the arm stretched and folded, reaching high and low, the wrist
+ * turned both ways. With every sample at the same shoulder and elbow angles the lengths and offsets cannot be told
+ * apart and the fit returns E_INVALID.
+ */
+
+#define CALIB_PARAMS            7           //3 lengths, 4 offsets
+#define CALIB_FIT_LENGTHS       0x07        //Parameter masks for Calib_Fit()
+#define CALIB_FIT_OFFSETS       0x78
+#define CALIB_FIT_ALL           0x7F
+
+#ifndef CALIB_MAX_ITERATIONS
+#define CALIB_MAX_ITERATIONS    50
+#endif
+#define CALIB_LAMBDA_START      1e-3f
+#define CALIB_LAMBDA_MAX        1e8f        //Give up when no step lowers the cost even this damped
+#define CALIB_TOLERANCE         1e-7f       //Stop when a step lowers the cost by less than this fraction
+
+/***** Definitions *****/
+
+struct Calib_Sample {
+    float Angles[4];                    //Base, Shoulder, Elbow and Wrist angles sent, degrees
+    float Position[3];                  //Grabber tip measured, units
+};
+
+/*
+*   Fitted geometry. Create with Calib_Init()
+*/
+struct Arm_Calibration {
+    float Lengths[3];                   //Shoulder to elbow, elbow to wrist, wrist to tip
+    float Offsets[4];                   //Degrees added to the angles sent to get the real joint angles
+
+    //Last fit
+    float RMS_Before;                   //Root mean square tip error, units
+    float RMS_After;
+    uint32_t Iterations;                //Steps kept
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Start from the arm's link lengths (measured by hand) and no offsets
+* @param[out]   calibration - Calibration to initialize
+* @param[in]    arm - Arm geometry (Arm_Init())
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Calib_Init(struct Arm_Calibration *calibration, const struct RobotArm *arm);
+
+/**
+* @brief        Fit the parameters in fit, starting from the values in calibration and leaving the others as they are
+* @param[in]    samples - Measured poses
+* @param[in]    count - Number of samples, at least 3 (more parameters than residuals cannot be fitted)
+* @param[in]    fit - CALIB_FIT_LENGTHS, CALIB_FIT_OFFSETS or CALIB_FIT_ALL
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR, E_BAD_PARAM or E_INVALID (samples do not pin the parameters down)
+*/
+int Calib_Fit(struct Arm_Calibration *calibration, const struct Calib_Sample *samples, uint32_t count, uint8_t fit);
+
+/**
+* @brief        Root mean square distance between the model tip and the measured tip
+*
+* @return       Units, NaN when count is 0
+*/
+float Calib_RMS(const struct Arm_Calibration *calibration, const struct Calib_Sample *samples, uint32_t count);
+
+/**
+* @brief        Write the fitted lengths into an arm (rounded to whole units, Arm_Init()) and fit the offsets again to
+*               the rounded lengths
+* @param[out]   arm - Arm to set up, e.g. &Asimov
+* @param[in]    samples - Samples of the fit, or NULL to keep the offsets
+* @param[in]    count - Number of samples
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR, E_BAD_PARAM (a length outside 1 to 65535) or E_INVALID
+*/
+int Calib_Apply(struct Arm_Calibration *calibration, struct RobotArm *arm, const struct Calib_Sample *samples, uint32_t count);
+
+/**
+* @brief        Angles to send to the servos to get solved joint angles: the offsets taken off
+* @param[in]    angles - Base, Shoulder, Elbow and Wrist angles from the solver (results[0] to results[3])
+* @param[out]   servo - The 4 angles to send, may be angles
+*/
+void Calib_Servo_Angles(const struct Arm_Calibration *calibration, const float *angles, float *servo);
+
+
+
+#endif  /* _COORD_CALIB_H_ */
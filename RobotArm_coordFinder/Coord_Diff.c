@@ -0,0 +1,260 @@
+/**
+* @file             Coord_Diff.c
+* @brief            Jacobian, damped least squares tracking steps and anchoring to Arm_Solve()
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include <math.h>
+#include "Coord_Diff.h"
+#include "Coord_Trig.h"
+
+
+/***** Definitions *****/
+
+#define DIFF_PI                 3.14159265358979f
+#define DIFF_DEG_PER_RAD        (180.0f / DIFF_PI)
+#define DIFF_RAD_PER_DEG        (DIFF_PI / 180.0f)
+#define DIFF_SERIES_RAD         0.05f       //Largest joint step turned with the series (error under 3e-7)
+#define DIFF_MAX_COORD          65535.0f
+
+
+/***** Function Prototypes *****/
+static void Diff_Exact_Trig(struct IK_Diff *diff);
+static void Diff_Turn(float *c, float *s, float d);
+static float Diff_Damping_Sqrd(float closeness, float reach);
+static void Diff_Track(struct IK_Diff *diff);
+
+
+/***** Driver implementation *****/
+
+int Arm_Jacobian(const struct RobotArm *arm, const float *angles, float jacobian[3][3]){
+    float cb, sb, cs, ss, cf, sf, r, h, reach;
+
+    if(arm == NULL || angles == NULL || jacobian == NULL){
+        return(E_NULL_PTR);
+    }
+
+    cb = Trig_Cos_Deg(angles[0]);
+    sb = Trig_Sin_Deg(angles[0]);
+    cs = Trig_Cos_Deg(angles[1]);
+    ss = Trig_Sin_Deg(angles[1]);
+    cf = Trig_Cos_Deg(angles[1] + angles[2] - 180.0f);
+    sf = Trig_Sin_Deg(angles[1] + angles[2] - 180.0f);
+
+    //Wrist joint at r from the base axis and h over the shoulder, the grabber tip reach further out
+    r = arm->Len_BaseToElbow * cs + arm->Len_ElbowToWrist * cf;
+    h = arm->Len_BaseToElbow * ss + arm->Len_ElbowToWrist * sf;
+    reach = arm->Len_Wrist * Trig_Sin_Deg(angles[3]);
+
+    //Base
+    jacobian[0][0] = -(r + reach) * sb * DIFF_RAD_PER_DEG;
+    jacobian[1][0] = (r + reach) * cb * DIFF_RAD_PER_DEG;
+    jacobian[2][0] = 0;
+    //Shoulder
+    jacobian[0][1] = -h * cb * DIFF_RAD_PER_DEG;
+    jacobian[1][1] = -h * sb * DIFF_RAD_PER_DEG;
+    jacobian[2][1] = r * DIFF_RAD_PER_DEG;
+    //Elbow
+    jacobian[0][2] = -arm->Len_ElbowToWrist * sf * cb * DIFF_RAD_PER_DEG;
+    jacobian[1][2] = -arm->Len_ElbowToWrist * sf * sb * DIFF_RAD_PER_DEG;
+    jacobian[2][2] = arm->Len_ElbowToWrist * cf * DIFF_RAD_PER_DEG;
+
+    return(E_NO_ERROR);
+}
+
+int Arm_Diff_Init(struct IK_Diff *diff, const struct RobotArm *arm, float x, float y, float z, float Grabber_Angle, uint32_t Anchor_Interval){
+    int rslt;
+
+    if(diff == NULL || arm == NULL){
+        return(E_NULL_PTR);
+    }
+
+    diff->arm = arm;
+    diff->Target[0] = x;
+    diff->Target[1] = y;
+    diff->Target[2] = z;
+    diff->Grabber_Angle = Grabber_Angle;
+
+    //Same offsets as Arm_Wrist_Offset(), unrounded. Over 90 the wrist stays straight and the tip is the wrist joint
+    if(Grabber_Angle > 90){
+        diff->Wrist_Angle = 0;
+        diff->Wrist_Reach = 0;
+        diff->Wrist_Drop = 0;
+    }
+    else{
+        diff->Wrist_Angle = 90.0f - Grabber_Angle;
+        diff->Wrist_Reach = arm->Len_Wrist * Trig_Sin_Deg(diff->Wrist_Angle);
+        diff->Wrist_Drop = arm->Len_Wrist * Trig_Cos_Deg(diff->Wrist_Angle);
+    }
+    diff->Anchor_Interval = Anchor_Interval ? Anchor_Interval : IK_DIFF_ANCHOR_STEPS;
+    diff->Residual = 0;
+    diff->Anchors = 0;
+    diff->Anchor_Failures = 0;
+
+    if((rslt = Arm_Diff_Anchor(diff)) != E_NO_ERROR){
+        return(rslt);
+    }
+    return(E_NO_ERROR);
+}
+
+int Arm_Diff_Step(struct IK_Diff *diff, float dx, float dy, float dz, float *results){
+    if(diff == NULL || results == NULL){
+        return(E_NULL_PTR);
+    }
+
+    diff->Target[0] += dx;
+    diff->Target[1] += dy;
+    diff->Target[2] += dz;
+
+    //A failed anchor (target out of reach of Arm_Solve()) still leaves a tracking step to follow it
+    if(++diff->Steps >= diff->Anchor_Interval || dx * dx + dy * dy + dz * dz > IK_DIFF_MAX_STEP * IK_DIFF_MAX_STEP){
+        if(Arm_Diff_Anchor(diff) != E_NO_ERROR){
+            Diff_Track(diff);
+        }
+    }
+    else{
+        Diff_Track(diff);
+    }
+
+    results[0] = diff->Angles[0];
+    results[1] = diff->Angles[1];
+    results[2] = diff->Angles[2];
+    results[3] = diff->Wrist_Angle;
+    results[4] = diff->arm->Wrist_Rotation;
+    results[5] = diff->arm->Wrist_Grab;
+
+    return(E_NO_ERROR);
+}
+
+int Arm_Diff_Velocity(struct IK_Diff *diff, float vx, float vy, float vz, float dt, float *results){
+    return(Arm_Diff_Step(diff, vx * dt, vy * dt, vz * dt, results));
+}
+
+int Arm_Diff_Anchor(struct IK_Diff *diff){
+    uint16_t target[3];
+    float results[6];
+
+    if(diff == NULL){
+        return(E_NULL_PTR);
+    }
+
+    diff->Steps = 0;
+    for(int i = 0; i < 3; i++){
+        if(!(diff->Target[i] >= 0 && diff->Target[i] <= DIFF_MAX_COORD)){
+            diff->Anchor_Failures++;
+            return(E_INVALID);
+        }
+        target[i] = (uint16_t)(diff->Target[i] + 0.5f);
+    }
+
+    Arm_Solve(diff->arm, &diff->scratch, target[0], target[1], target[2], diff->Grabber_Angle, results);
+    if(isnan(results[0]) || isnan(results[1]) || isnan(results[2])){
+        diff->Anchor_Failures++;
+        return(E_INVALID);
+    }
+
+    diff->Angles[0] = results[0];
+    diff->Angles[1] = results[1];
+    diff->Angles[2] = results[2];
+    Diff_Exact_Trig(diff);
+    diff->Anchors++;
+
+    //Whole units and a rounded wrist offset in, so the tip is up to about a unit off: one step takes it the rest
+    Diff_Track(diff);
+    return(E_NO_ERROR);
+}
+
+static void Diff_Exact_Trig(struct IK_Diff *diff){
+    float forearm = diff->Angles[1] + diff->Angles[2] - 180.0f;
+
+    diff->Base_Cos = Trig_Cos_Deg(diff->Angles[0]);
+    diff->Base_Sin = Trig_Sin_Deg(diff->Angles[0]);
+    diff->Shoulder_Cos = Trig_Cos_Deg(diff->Angles[1]);
+    diff->Shoulder_Sin = Trig_Sin_Deg(diff->Angles[1]);
+    diff->Forearm_Cos = Trig_Cos_Deg(forearm);
+    diff->Forearm_Sin = Trig_Sin_Deg(forearm);
+}
+
+//Turn a cos/sin pair by d radians: cos d = 1 - d^2/2, sin d = d - d^3/6
+static void Diff_Turn(float *c, float *s, float d){
+    float d2 = d * d;
+    float cd = 1.0f - 0.5f * d2;
+    float sd = d * (1.0f - d2 * (1.0f / 6.0f));
+    float c0 = *c;
+
+    *c = c0 * cd - *s * sd;
+    *s = *s * cd + c0 * sd;
+}
+
+//lambda^2 for a closeness to a singularity from 0 (at it) to 1
+static float Diff_Damping_Sqrd(float closeness, float reach){
+    float lambda;
+
+    if(closeness >= IK_DIFF_SINGULAR){
+        return(0);
+    }
+    lambda = IK_DIFF_DAMPING * reach * (1.0f - closeness * (1.0f / IK_DIFF_SINGULAR));
+    return(lambda * lambda);
+}
+
+//One damped least squares step from the joint angles towards the target
+static void Diff_Track(struct IK_Diff *diff){
+    const float l1 = diff->arm->Len_BaseToElbow, l2 = diff->arm->Len_ElbowToWrist;
+    float cb = diff->Base_Cos, sb = diff->Base_Sin;
+    float r, h, tip_reach, error[3], error_radial, error_side, sin_elbow;
+    float lambda_sqrd, a00, a01, a11, det, y0, y1;
+    float d_base, d_shoulder, d_elbow;
+
+    //Tip from the carried sin/cos
+    r = l1 * diff->Shoulder_Cos + l2 * diff->Forearm_Cos;
+    h = l1 * diff->Shoulder_Sin + l2 * diff->Forearm_Sin;
+    tip_reach = r + diff->Wrist_Reach;
+    error[0] = diff->Target[0] - tip_reach * cb;
+    error[1] = diff->Target[1] - tip_reach * sb;
+    error[2] = diff->Target[2] - (h - diff->Wrist_Drop);
+    diff->Residual = sqrtf(error[0] * error[0] + error[1] * error[1] + error[2] * error[2]);
+
+    //Split the error into away from the base axis, round it, and up
+    error_radial = cb * error[0] + sb * error[1];
+    error_side = -sb * error[0] + cb * error[1];
+
+    //Base: one column of length tip_reach, square to the other two
+    lambda_sqrd = Diff_Damping_Sqrd(fabsf(tip_reach) / (l1 + l2), l1 + l2);
+    d_base = (tip_reach * error_side) / (tip_reach * tip_reach + lambda_sqrd);
+
+    //Shoulder and elbow: K = [-h, -l2 sin(forearm); r, l2 cos(forearm)], step = K^T (K K^T + lambda^2 I)^-1 e
+    sin_elbow = diff->Shoulder_Sin * diff->Forearm_Cos - diff->Shoulder_Cos * diff->Forearm_Sin;
+    lambda_sqrd = Diff_Damping_Sqrd(fabsf(sin_elbow), l1 + l2);
+    a00 = h * h + l2 * l2 * diff->Forearm_Sin * diff->Forearm_Sin + lambda_sqrd;
+    a01 = -h * r - l2 * l2 * diff->Forearm_Sin * diff->Forearm_Cos;
+    a11 = r * r + l2 * l2 * diff->Forearm_Cos * diff->Forearm_Cos + lambda_sqrd;
+    det = a00 * a11 - a01 * a01;
+    if(det > 0){
+        y0 = (a11 * error_radial - a01 * error[2]) / det;
+        y1 = (a00 * error[2] - a01 * error_radial) / det;
+        d_shoulder = -h * y0 + r * y1;
+        d_elbow = l2 * (diff->Forearm_Cos * y1 - diff->Forearm_Sin * y0);
+    }
+    else{
+        d_shoulder = 0;
+        d_elbow = 0;
+    }
+
+    diff->Angles[0] += d_base * DIFF_DEG_PER_RAD;
+    diff->Angles[1] += d_shoulder * DIFF_DEG_PER_RAD;
+    diff->Angles[2] += d_elbow * DIFF_DEG_PER_RAD;
+
+    //The elbow cannot fold past straight or back on itself, and a big step is turned exactly
+    if(diff->Angles[2] < 0 || diff->Angles[2] > 180.0f || fabsf(d_base) > DIFF_SERIES_RAD ||
+       fabsf(d_shoulder) > DIFF_SERIES_RAD || fabsf(d_shoulder + d_elbow) > DIFF_SERIES_RAD){
+        diff->Angles[2] = (diff->Angles[2] < 0) ? 0 : (diff->Angles[2] > 180.0f) ? 180.0f : diff->Angles[2];
+        Diff_Exact_Trig(diff);
+        return;
+    }
+
+    Diff_Turn(&diff->Base_Cos, &diff->Base_Sin, d_base);
+    Diff_Turn(&diff->Shoulder_Cos, &diff->Shoulder_Sin, d_shoulder);
+    Diff_Turn(&diff->Forearm_Cos, &diff->Forearm_Sin, d_shoulder + d_elbow);
+}
@@ -0,0 +1,122 @@
+/**
+* @file             Coord_Diff.h
+* @brief            Differential inverse kinematics: small grabber moves through the Jacobian of the arm
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_DIFF_H_
+#define _COORD_DIFF_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+
+/* Glossary for Coord_Diff.h and Coord_Diff.c
+ *
+ *  Jacobian       - How far the grabber tip moves in x, y and z for a small turn of the base, shoulder and elbow,
+ *                   with the grabber angle held. The base moves the tip sideways and the shoulder and elbow move it
+ *                   in the vertical plane through the base axis, so the 3x3 splits into a 1x1 and a 2x2 that are
+ *                   solved separately.
+ *  Damped Least   - Joint step = J^T (J J^T + lambda^2 I)^-1 * tip error. lambda is 0 away from a singularity and
+ *  Squares (DLS)    rises to IK_DIFF_DAMPING * (shoulder to wrist reach) as the arm gets to one: elbow straight or
+ *                   folded (sin of the elbow angle under IK_DIFF_SINGULAR), or the grabber over the base axis (reach
+ *                   from the axis under IK_DIFF_SINGULAR of the arm length). There the step stays bounded and the
+ *                   tip lags the target instead of the joints whipping round.
+ *  Tracking Step  - Arm_Diff_Step(): move the target, compare it with the tip position worked out from the joint
+ *                   angles (so errors do not pile up) and take one DLS step. The sin and cos of the joint angles are
+ *                   carried from step to step and turned by the small joint step with a short series, so a step
+ *                   calls no trig function.
+ *  Anchor         - Every Anchor_Interval steps, and whenever a move is over IK_DIFF_MAX_STEP units, the joints are
+ *                   solved again with Arm_Solve() at the target and the sin/cos worked out exactly. Arm_Solve()
+ *                   takes whole units, so one tracking step after it brings the tip onto the fractional target.
+ */
+
+#ifndef IK_DIFF_ANCHOR_STEPS
+#define IK_DIFF_ANCHOR_STEPS    50          //Default tracking steps between anchors
+#endif
+#define IK_DIFF_MAX_STEP        5.0f        //Largest move in units that is tracked instead of anchored
+#define IK_DIFF_SINGULAR        0.1f        //Closeness to a singularity where damping starts (see glossary)
+#define IK_DIFF_DAMPING         0.05f       //Damping at the singularity, in units of reach
+
+/***** Definitions *****/
+
+/*
+*   Differential solve state of one arm. Create with Arm_Diff_Init()
+*/
+struct IK_Diff {
+    const struct RobotArm *arm;
+    struct IK_Scratch scratch;          //Used by the anchor solves
+
+    float Target[3];                    //Grabber position being tracked
+    float Angles[3];                    //Base, Shoulder and Elbow angles in degrees
+    float Grabber_Angle;                //Held between Arm_Diff_Init() calls
+    float Wrist_Angle;                  //From the grabber angle like Arm_Solve()
+    float Wrist_Reach;                  //Grabber tip past the wrist joint, away from the base axis
+    float Wrist_Drop;                   //Grabber tip under the wrist joint
+
+    //sin and cos of the base, the shoulder and the forearm (shoulder + elbow - 180) carried between steps
+    float Base_Cos, Base_Sin;
+    float Shoulder_Cos, Shoulder_Sin;
+    float Forearm_Cos, Forearm_Sin;
+
+    uint32_t Anchor_Interval;
+    uint32_t Steps;                     //Tracking steps since the last anchor
+    float Residual;                     //Distance from the tip to the target before the last step, in units
+    uint32_t Anchors;
+    uint32_t Anchor_Failures;           //Anchors skipped because Arm_Solve() could not reach the target
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Jacobian of the grabber tip at a joint state
+* @param[in]    arm - Arm geometry
+* @param[in]    angles - Base, Shoulder, Elbow and Wrist angles in degrees (as Arm_Solve() returns them)
+* @param[out]   jacobian - jacobian[axis][joint]: units of x, y, z per degree of base, shoulder, elbow
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Arm_Jacobian(const struct RobotArm *arm, const float *angles, float jacobian[3][3]);
+
+/**
+* @brief        Anchor the differential solver at a grabber position
+* @param[out]   diff - State to initialize
+* @param[in]    arm - Arm geometry, only read
+* @param[in]    x, y, z - Grabber position, 0 to 65535
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in degrees, held until the next Arm_Diff_Init()
+* @param[in]    Anchor_Interval - Tracking steps between anchors (1 anchors every step), 0 for IK_DIFF_ANCHOR_STEPS
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR or E_INVALID (position out of reach)
+*/
+int Arm_Diff_Init(struct IK_Diff *diff, const struct RobotArm *arm, float x, float y, float z, float Grabber_Angle, uint32_t Anchor_Interval);
+
+/**
+* @brief        Move the target by a small delta and track it
+* @param[in]    dx, dy, dz - Move in units
+* @param[out]   results - Base, Shoulder, Elbow, Wrist, Wrist Rotation and Wrist Grab angles in degrees (6 floats,
+*               as Arm_Solve())
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure). A target out of reach is followed as closely as the
+*               damping allows, diff->Residual shows how far off the tip was
+*/
+int Arm_Diff_Step(struct IK_Diff *diff, float dx, float dy, float dz, float *results);
+
+/**
+* @brief        Arm_Diff_Step() with a velocity: the target moves by velocity * dt
+* @param[in]    vx, vy, vz - Units per second
+* @param[in]    dt - Seconds since the last step
+*/
+int Arm_Diff_Velocity(struct IK_Diff *diff, float vx, float vy, float vz, float dt, float *results);
+
+/**
+* @brief        Solve the joints again from the target with Arm_Solve() and one tracking step
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR or E_INVALID (target out of reach, the joints are left as they
+*               were)
+*/
+int Arm_Diff_Anchor(struct IK_Diff *diff);
+
+
+
+#endif  /* _COORD_DIFF_H_ */
@@ -0,0 +1,270 @@
+/**
+* @file             Coord_Fixed.c
+* @brief            Q16.16 inverse kinematics with CORDIC trig and an integer square root
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stdio.h>
+#include "Coord_Fixed.h"
+
+
+/***** Definitions *****/
+
+#define IK_FIXED_CORDIC_STEPS   23                  //atan(2^-22) is the last step worth a Q16.16 LSB
+#define IK_FIXED_CORDIC_GAIN    652032874           //Product of cos(atan(2^-i)) over the steps, Q2.30
+#define IK_FIXED_CORDIC_MAX     (1 << 29)           //Vectoring inputs stay under this so the gain of 1.65 fits
+
+#define Q16_DEG_90              Q16_FROM_INT(90)
+#define Q16_DEG_180             Q16_FROM_INT(180)
+#define Q16_DEG_360             ((int64_t)Q16_FROM_INT(360))
+
+
+/***** Global Variables *****/
+
+//atan(2^-i) in Q16.16 degrees
+static const int32_t cordic_atan[IK_FIXED_CORDIC_STEPS] = {
+    2949120, 1740967, 919879, 466945, 234379, 117304, 58666, 29335, 14668, 7334, 3667, 1833,
+    917, 458, 229, 115, 57, 29, 14, 7, 4, 2, 1
+};
+
+extern struct RobotArm Asimov;
+
+
+/***** Function Prototypes *****/
+int Arm_Solve_Fixed(const struct RobotArm *arm, uint16_t x, uint16_t y, uint16_t z, q16_t Grabber_Angle, q16_t *results);
+int Update_Grabber_Position_Fixed(uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results);
+void Fixed_SinCos(q16_t angle, int32_t *sine, int32_t *cosine);
+q16_t Fixed_Atan2(int64_t y, int64_t x);
+uint32_t Fixed_Sqrt(uint64_t value);
+static int Fixed_Acos_Ratio(int64_t num, uint64_t den_sqrd, q16_t *angle);
+
+
+/***** Driver implementation *****/
+
+int Arm_Solve_Fixed(const struct RobotArm *arm, uint16_t x, uint16_t y, uint16_t z, q16_t Grabber_Angle, q16_t *results){
+    int32_t sin_base, cos_base, sin_wrist, cos_wrist;
+    int64_t Delta_X = 0, Delta_Y = 0, Delta_Z = 0;
+    int64_t Updated_X, Updated_Y, Updated_Z;
+    uint64_t Flat_Sqrd, Adjusted_Sqrd;
+    uint64_t BaseToElbow_Sqrd, ElbowToWrist_Sqrd;
+    q16_t Base_Angle, Wrist_Angle, Theta_Z, Theta_Shoulder, Theta_Elbow;
+
+    if(arm == NULL || results == NULL){
+        return(E_NULL_PTR);
+    }
+    if(arm->Len_BaseToElbow > IK_FIXED_MAX_LINK || arm->Len_ElbowToWrist > IK_FIXED_MAX_LINK || arm->Len_Wrist > IK_FIXED_MAX_LINK){
+        return(E_BAD_PARAM);
+    }
+    if(!x && !y){
+        return(E_INVALID);
+    }
+    BaseToElbow_Sqrd = (uint64_t)arm->Len_BaseToElbow * arm->Len_BaseToElbow;
+    ElbowToWrist_Sqrd = (uint64_t)arm->Len_ElbowToWrist * arm->Len_ElbowToWrist;
+
+    //Base angle, x and y are never negative so this is 0 to 90 degrees
+    Base_Angle = Fixed_Atan2(y, x);
+
+    //Move the target back along the grabber to the wrist joint, rounded to whole units like Updated_Coords
+    if(Grabber_Angle > Q16_DEG_90){
+        Wrist_Angle = 0;
+    }
+    else{
+        int64_t Delta_XY;
+
+        Wrist_Angle = Q16_DEG_90 - Grabber_Angle;
+        Fixed_SinCos(Wrist_Angle, &sin_wrist, &cos_wrist);
+        Fixed_SinCos(Base_Angle, &sin_base, &cos_base);
+
+        Delta_Z = ((int64_t)arm->Len_Wrist * cos_wrist + (1 << 29)) >> 30;
+        Delta_XY = ((int64_t)arm->Len_Wrist * sin_wrist) >> 14;             //Q16.16
+        Delta_X = (Delta_XY * cos_base + ((int64_t)1 << 45)) >> 46;
+        Delta_Y = (Delta_XY * sin_base + ((int64_t)1 << 45)) >> 46;
+    }
+    Updated_X = (int64_t)x - Delta_X;
+    Updated_Y = (int64_t)y - Delta_Y;
+    Updated_Z = (int64_t)z + Delta_Z;
+
+    //Updated_Coords are unsigned, a wrist joint behind the base would wrap
+    if(Updated_X < 0 || Updated_Y < 0 || Updated_Z < 0 || Updated_Z > 0xFFFF){
+        return(E_INVALID);
+    }
+
+    //Exact squared distances. Past the reach of the arm the triangle is impossible, and stopping here keeps the
+    //products below 64 bits
+    Flat_Sqrd = (uint64_t)(Updated_X * Updated_X + Updated_Y * Updated_Y);
+    Adjusted_Sqrd = Flat_Sqrd + (uint64_t)(Updated_Z * Updated_Z);
+    if(!Adjusted_Sqrd || Adjusted_Sqrd > (uint64_t)(arm->Len_BaseToElbow + arm->Len_ElbowToWrist) * (arm->Len_BaseToElbow + arm->Len_ElbowToWrist)){
+        return(E_INVALID);
+    }
+
+    //Calculate the Z component of theta, the flat distance only has to be to the same scale as z
+    Theta_Z = Fixed_Atan2(Updated_Z << 16, Fixed_Sqrt(Flat_Sqrd << 32));
+
+    //Shoulder and elbow by SSS: cos = num / den, with den^2 = 4 * a^2 * b^2 exact
+    if(Fixed_Acos_Ratio((int64_t)(Adjusted_Sqrd + BaseToElbow_Sqrd) - (int64_t)ElbowToWrist_Sqrd,
+                        4 * BaseToElbow_Sqrd * Adjusted_Sqrd, &Theta_Shoulder) != E_NO_ERROR){
+        return(E_INVALID);
+    }
+    if(Fixed_Acos_Ratio((int64_t)(BaseToElbow_Sqrd + ElbowToWrist_Sqrd) - (int64_t)Adjusted_Sqrd,
+                        4 * BaseToElbow_Sqrd * ElbowToWrist_Sqrd, &Theta_Elbow) != E_NO_ERROR){
+        return(E_INVALID);
+    }
+
+    results[0] = Base_Angle;
+    results[1] = Theta_Z + Theta_Shoulder;
+    results[2] = Theta_Elbow;
+    results[3] = Wrist_Angle;
+    return(E_NO_ERROR);
+}
+
+int Update_Grabber_Position_Fixed(uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results){
+    q16_t angles[4];
+    int rslt;
+
+    if(results == NULL){
+        return(E_NULL_PTR);
+    }
+    if((rslt = Arm_Solve_Fixed(&Asimov, x, y, z, Q16_FROM_FLOAT(Grabber_Angle), angles)) != E_NO_ERROR){
+        return(rslt);
+    }
+
+    results[0] = Q16_TO_FLOAT(angles[0]);
+    results[1] = Q16_TO_FLOAT(angles[1]);
+    results[2] = Q16_TO_FLOAT(angles[2]);
+    results[3] = Q16_TO_FLOAT(angles[3]);
+    results[4] = Asimov.Wrist_Rotation;
+    results[5] = Asimov.Wrist_Grab;
+
+    //Update arm structure
+    Arm_Set_Position(&Asimov, results);
+    return(E_NO_ERROR);
+}
+
+void Fixed_SinCos(q16_t angle, int32_t *sine, int32_t *cosine){
+    int64_t wrapped = angle;
+    int32_t x = IK_FIXED_CORDIC_GAIN, y = 0, z;
+    int32_t negate_cos = 0;
+
+    //Bring the angle into -90 to 90, where CORDIC converges. sin(180 - a) = sin(a), cos(180 - a) = -cos(a)
+    //(subtract instead of %, a 64-bit divide is a library call on a Cortex-M0+)
+    while(wrapped > Q16_DEG_180) wrapped -= Q16_DEG_360;
+    while(wrapped < -Q16_DEG_180) wrapped += Q16_DEG_360;
+    if(wrapped > Q16_DEG_90){
+        wrapped = Q16_DEG_180 - wrapped;
+        negate_cos = 1;
+    }
+    else if(wrapped < -Q16_DEG_90){
+        wrapped = -Q16_DEG_180 - wrapped;
+        negate_cos = 1;
+    }
+    z = (int32_t)wrapped;
+
+    //Rotation mode: turn (gain, 0) by the angle. sign is 0 to turn up and -1 to turn down, (a ^ sign) - sign
+    //negates a without a branch
+    for(uint32_t i = 0; i < IK_FIXED_CORDIC_STEPS; i++){
+        int32_t sign = z >> 31;
+        int32_t x_step = x >> i;
+        int32_t y_step = y >> i;
+        x -= (y_step ^ sign) - sign;
+        y += (x_step ^ sign) - sign;
+        z -= (cordic_atan[i] ^ sign) - sign;
+    }
+
+    *sine = y;
+    *cosine = negate_cos ? -x : x;
+}
+
+q16_t Fixed_Atan2(int64_t y, int64_t x){
+    int32_t x32, y32, z = 0;
+    uint64_t largest;
+
+    if(!x && !y){
+        return(0);
+    }
+
+    //Turn the left half plane by 90 degrees so the vector starts within CORDIC's range
+    if(x < 0){
+        int64_t t = x;
+        if(y >= 0){
+            x = y;
+            y = -t;
+            z = Q16_DEG_90;
+        }
+        else{
+            x = -y;
+            y = t;
+            z = -Q16_DEG_90;
+        }
+    }
+
+    //Scale both into [2^28, 2^29) for the most resolution without overflowing on the gain
+    largest = (uint64_t)((x > (y < 0 ? -y : y)) ? x : (y < 0 ? -y : y));
+    while(largest >= IK_FIXED_CORDIC_MAX){
+        x >>= 1;
+        y >>= 1;
+        largest >>= 1;
+    }
+    while(largest < (IK_FIXED_CORDIC_MAX >> 1)){
+        x <<= 1;
+        y <<= 1;
+        largest <<= 1;
+    }
+    x32 = (int32_t)x;
+    y32 = (int32_t)y;
+
+    //Vectoring mode: turn the vector onto the x axis and add up the turns (sign is 0 while y is above the axis)
+    for(uint32_t i = 0; i < IK_FIXED_CORDIC_STEPS; i++){
+        int32_t sign = ~(-y32 >> 31);
+        int32_t x_step = x32 >> i;
+        int32_t y_step = y32 >> i;
+        x32 += (y_step ^ sign) - sign;
+        y32 -= (x_step ^ sign) - sign;
+        z += (cordic_atan[i] ^ sign) - sign;
+    }
+    return(z);
+}
+
+uint32_t Fixed_Sqrt(uint64_t value){
+    uint64_t root = 0;
+    uint64_t bit;
+
+    if(!value){
+        return(0);
+    }
+
+    //Bit by bit, two bits of the value per bit of the root, starting at the highest even bit of the value
+    bit = (uint64_t)1 << ((63 - __builtin_clzll(value)) & ~1);
+    while(bit){
+        if(value >= root + bit){
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else{
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return((uint32_t)root);
+}
+
+//acos(num / den) as atan2(sqrt(den^2 - num^2), num). E_INVALID when |num| > den (the triangle cannot close)
+static int Fixed_Acos_Ratio(int64_t num, uint64_t den_sqrd, q16_t *angle){
+    uint64_t num_sqrd = (uint64_t)(num * num);
+    uint64_t rest;
+    uint32_t shift = 0;
+
+    if(num_sqrd > den_sqrd){
+        return(E_INVALID);
+    }
+    rest = den_sqrd - num_sqrd;
+
+    //Scale up before the square root so a small sine keeps its resolution (rest by 4^shift, num by 2^shift)
+    while(shift < 16 && rest < ((uint64_t)1 << 60) && (uint64_t)(num < 0 ? -num : num) < ((uint64_t)1 << 60)){
+        rest <<= 2;
+        num <<= 1;
+        shift++;
+    }
+    *angle = Fixed_Atan2(Fixed_Sqrt(rest), num);
+    return(E_NO_ERROR);
+}
@@ -0,0 +1,86 @@
+/**
+* @file             Coord_Fixed.h
+* @brief            Integer only inverse kinematics for cores without an FPU
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_FIXED_H_
+#define _COORD_FIXED_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+
+/* Glossary for Coord_Fixed.h and Coord_Fixed.c
+ *
+ *  Q16.16         - Signed 32-bit value with 16 fraction bits (q16_t). All angles in and out are Q16.16 degrees,
+ *                   1 LSB = 1/65536 degree.
+ *  CORDIC         - Shift and add rotations through a table of atan(2^-i). Rotation mode gives sin and cos of an
+ *                   angle, vectoring mode gives atan2. IK_FIXED_CORDIC_STEPS steps resolve about 1/65536 degree.
+ *  Exact Triangle - The wrist joint lands on whole units, so the squared shoulder to wrist distance and both SSS
+ *                   numerators are exact integers. acos(num / den) is solved as atan2(sqrt(den^2 - num^2), num),
+ *                   which needs no division and tells reachable (den^2 >= num^2) from unreachable exactly.
+ *
+ * Same steps as Arm_Solve() (base angle, wrist offset rounded to whole units, shoulder, elbow) with integer math
+ * only: no float, no double and no divide, so a Cortex-M0+ does not pull in the soft-float library.
+ */
+
+#ifndef IK_FIXED_MAX_LINK
+#define IK_FIXED_MAX_LINK       16383       //Longest link the 64-bit triangle math can hold without overflow
+#endif
+
+typedef int32_t q16_t;
+
+#define Q16_ONE                 65536
+#define Q16_FROM_INT(a)         ((q16_t)((a) * Q16_ONE))
+#define Q16_FROM_FLOAT(a)       ((q16_t)((a) * 65536.0f + (((a) < 0) ? -0.5f : 0.5f)))
+#define Q16_TO_FLOAT(a)         ((float)(a) * (1.0f / 65536.0f))
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Solve the joint angles for a grabber position with integer math only. The arm is only read
+* @param[in]    arm - Arm geometry (Arm_Init()), links up to IK_FIXED_MAX_LINK long
+* @param[in]    x, y, z - Grabber position
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in Q16.16 degrees (over 90 leaves the wrist straight)
+* @param[out]   results - Base, Shoulder, Elbow and Wrist angles in Q16.16 degrees (4 values)
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR, E_BAD_PARAM (link too long) or E_INVALID (target out of reach,
+*               results are not written)
+*/
+int Arm_Solve_Fixed(const struct RobotArm *arm, uint16_t x, uint16_t y, uint16_t z, q16_t Grabber_Angle, q16_t *results);
+
+/**
+* @brief        Update_Grabber_Position() through the fixed point solver: same arguments and the same 6 results,
+*               and the global arm is updated the same way. Only the conversions in and out use float
+*
+* @return       E_NO_ERROR (Success), E_BAD_PARAM or E_INVALID (see Arm_Solve_Fixed())
+*/
+int Update_Grabber_Position_Fixed(uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results);
+
+/**
+* @brief        sin and cos of an angle by CORDIC
+* @param[in]    angle - Q16.16 degrees, any value
+* @param[out]   sine, cosine - Q2.30 (1.0 = 1 << 30)
+*/
+void Fixed_SinCos(q16_t angle, int32_t *sine, int32_t *cosine);
+
+/**
+* @brief        atan2 by CORDIC
+* @param[in]    y, x - Any scale, both the same
+*
+* @return       Angle in Q16.16 degrees (-180 to 180)
+*/
+q16_t Fixed_Atan2(int64_t y, int64_t x);
+
+/**
+* @brief        Integer square root
+*
+* @return       floor(sqrt(value))
+*/
+uint32_t Fixed_Sqrt(uint64_t value);
+
+
+
+#endif  /* _COORD_FIXED_H_ */
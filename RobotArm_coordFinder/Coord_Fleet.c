@@ -0,0 +1,255 @@
+/**
+* @file             Coord_Fleet.c
+* @brief            Batches of many arms solved chunk by chunk, on the caller or across a pool of threads
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include "Coord_Fleet.h"
+
+
+/***** Function Prototypes *****/
+static uint32_t Fleet_Chunk_Arm(const struct Fleet *fleet, uint32_t start);
+static void Fleet_Solve_Chunk(struct Fleet *fleet, uint32_t chunk);
+static void Fleet_Work(struct Fleet *fleet);
+#ifdef COORD_HOST
+static void *Fleet_Worker(void *arg);
+#endif
+
+
+/***** Driver implementation *****/
+
+uint32_t Fleet_Layout(struct Fleet_Batch *batches, const uint32_t *counts, uint32_t num_arms){
+    uint64_t first = 0;
+
+    if(batches == NULL || counts == NULL){
+        return(0);
+    }
+
+    for(uint32_t a = 0; a < num_arms; a++){
+        batches[a].First = (uint32_t)first;
+        batches[a].Count = counts[a];
+        batches[a].Reachable = 0;
+        first += ((uint64_t)counts[a] + FLEET_CHUNK - 1) / FLEET_CHUNK * FLEET_CHUNK;
+        if(first > UINT32_MAX - FLEET_CHUNK){
+            return(0);
+        }
+    }
+
+    return((uint32_t)first);
+}
+
+int Fleet_Init(struct Fleet *fleet, const struct RobotArm *arms, struct Fleet_Batch *batches, uint32_t num_arms, const uint16_t *x,
+               const uint16_t *y, const uint16_t *z, const float *Grabber_Angle, const struct IK_Batch_Angles *angles, uint32_t *reachable){
+    uint32_t end = 0;
+
+    if(fleet == NULL || arms == NULL || batches == NULL || x == NULL || y == NULL || z == NULL || Grabber_Angle == NULL ||
+       angles == NULL || reachable == NULL){
+        return(E_NULL_PTR);
+    }
+
+    //Every arm on a chunk of its own, in order and not overlapping
+    for(uint32_t a = 0; a < num_arms; a++){
+        if(batches[a].First % FLEET_CHUNK || batches[a].First < end){
+            return(E_BAD_PARAM);
+        }
+        end = batches[a].First + (batches[a].Count + FLEET_CHUNK - 1) / FLEET_CHUNK * FLEET_CHUNK;
+    }
+
+    fleet->Arms = arms;
+    fleet->Batches = batches;
+    fleet->Num_Arms = num_arms;
+    fleet->Num_Chunks = end / FLEET_CHUNK;
+    fleet->x = x;
+    fleet->y = y;
+    fleet->z = z;
+    fleet->Grabber_Angle = Grabber_Angle;
+    fleet->Angles = *angles;
+    fleet->Reachable = reachable;
+    fleet->Next_Chunk = 0;
+    fleet->Done_Chunks = 0;
+#ifdef COORD_HOST
+    fleet->Num_Workers = 0;
+    fleet->Generation = 0;
+    fleet->Running = 0;
+#endif
+
+    return(E_NO_ERROR);
+}
+
+int Fleet_Start(struct Fleet *fleet, uint32_t threads){
+    if(fleet == NULL){
+        return(E_NULL_PTR);
+    }
+    if(threads == 0 || threads > FLEET_MAX_THREADS){
+        return(E_BAD_PARAM);
+    }
+
+#ifdef COORD_HOST
+    if(fleet->Running){
+        return(E_BUSY);
+    }
+    pthread_mutex_init(&fleet->Lock, NULL);
+    pthread_cond_init(&fleet->Start, NULL);
+    pthread_cond_init(&fleet->Done, NULL);
+    fleet->Running = 1;
+
+    //The caller of Fleet_Solve() is one of the threads
+    for(fleet->Num_Workers = 0; fleet->Num_Workers < threads - 1; fleet->Num_Workers++){
+        if(pthread_create(&fleet->Threads[fleet->Num_Workers], NULL, Fleet_Worker, fleet)){
+            Fleet_Stop(fleet);
+            return(E_NONE_AVAIL);
+        }
+    }
+    return(E_NO_ERROR);
+#else
+    return(E_NONE_AVAIL);
+#endif
+}
+
+int32_t Fleet_Solve(struct Fleet *fleet){
+    int32_t reachable = 0;
+
+    if(fleet == NULL){
+        return(E_NULL_PTR);
+    }
+
+    //Everything a worker reads is set before Next_Chunk lets it take a chunk
+    for(uint32_t a = 0; a < fleet->Num_Arms; a++){
+        fleet->Batches[a].Reachable = 0;
+    }
+    __atomic_store_n(&fleet->Done_Chunks, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&fleet->Next_Chunk, 0, __ATOMIC_RELEASE);
+
+#ifdef COORD_HOST
+    if(fleet->Running && fleet->Num_Workers){
+        pthread_mutex_lock(&fleet->Lock);
+        fleet->Generation++;
+        pthread_cond_broadcast(&fleet->Start);
+        pthread_mutex_unlock(&fleet->Lock);
+
+        Fleet_Work(fleet);
+
+        pthread_mutex_lock(&fleet->Lock);
+        while(__atomic_load_n(&fleet->Done_Chunks, __ATOMIC_ACQUIRE) < fleet->Num_Chunks){
+            pthread_cond_wait(&fleet->Done, &fleet->Lock);
+        }
+        pthread_mutex_unlock(&fleet->Lock);
+    }
+    else{
+        Fleet_Work(fleet);
+    }
+#else
+    Fleet_Work(fleet);
+#endif
+
+    for(uint32_t a = 0; a < fleet->Num_Arms; a++){
+        reachable += fleet->Batches[a].Reachable;
+    }
+    return(reachable);
+}
+
+void Fleet_Stop(struct Fleet *fleet){
+#ifdef COORD_HOST
+    if(fleet == NULL || !fleet->Running){
+        return;
+    }
+
+    pthread_mutex_lock(&fleet->Lock);
+    fleet->Running = 0;
+    pthread_cond_broadcast(&fleet->Start);
+    pthread_mutex_unlock(&fleet->Lock);
+
+    for(uint32_t i = 0; i < fleet->Num_Workers; i++){
+        pthread_join(fleet->Threads[i], NULL);
+    }
+    fleet->Num_Workers = 0;
+    pthread_cond_destroy(&fleet->Done);
+    pthread_cond_destroy(&fleet->Start);
+    pthread_mutex_destroy(&fleet->Lock);
+#else
+    (void)fleet;
+#endif
+}
+
+//Arm owning the chunk that starts at start: the last one starting at or before it (empty arms share a First with
+//the next arm, so the last one is the arm with the targets)
+static uint32_t Fleet_Chunk_Arm(const struct Fleet *fleet, uint32_t start){
+    uint32_t low = 0, high = fleet->Num_Arms - 1;
+
+    while(low < high){
+        uint32_t middle = (low + high + 1) / 2;
+        if(fleet->Batches[middle].First <= start){
+            low = middle;
+        }
+        else{
+            high = middle - 1;
+        }
+    }
+    return(low);
+}
+
+static void Fleet_Solve_Chunk(struct Fleet *fleet, uint32_t chunk){
+    uint32_t start = chunk * FLEET_CHUNK;
+    uint32_t arm = Fleet_Chunk_Arm(fleet, start);
+    uint32_t count = fleet->Batches[arm].First + fleet->Batches[arm].Count - start;
+    struct IK_Batch_Angles angles = {
+        fleet->Angles.Base + start, fleet->Angles.Shoulder + start, fleet->Angles.Elbow + start, fleet->Angles.Wrist + start
+    };
+    int32_t reachable;
+
+    if(count > FLEET_CHUNK){
+        count = FLEET_CHUNK;
+    }
+    reachable = Arm_Solve_Batch(&fleet->Arms[arm], fleet->x + start, fleet->y + start, fleet->z + start, fleet->Grabber_Angle + start,
+                                count, &angles, fleet->Reachable + start / 32);
+    if(reachable > 0){
+        __atomic_fetch_add(&fleet->Batches[arm].Reachable, reachable, __ATOMIC_RELAXED);
+    }
+}
+
+//Take chunks until none are left. The thread that finishes the last one wakes Fleet_Solve()
+static void Fleet_Work(struct Fleet *fleet){
+    uint32_t chunk;
+
+    while((chunk = __atomic_fetch_add(&fleet->Next_Chunk, 1, __ATOMIC_ACQUIRE)) < fleet->Num_Chunks){
+        Fleet_Solve_Chunk(fleet, chunk);
+        if(__atomic_add_fetch(&fleet->Done_Chunks, 1, __ATOMIC_RELEASE) == fleet->Num_Chunks){
+#ifdef COORD_HOST
+            if(fleet->Running && fleet->Num_Workers){
+                pthread_mutex_lock(&fleet->Lock);
+                pthread_cond_signal(&fleet->Done);
+                pthread_mutex_unlock(&fleet->Lock);
+            }
+#endif
+        }
+    }
+}
+
+#ifdef COORD_HOST
+//Sleep until Fleet_Solve() starts a new Generation, work on it, repeat until Fleet_Stop()
+static void *Fleet_Worker(void *arg){
+    struct Fleet *fleet = (struct Fleet *)arg;
+    uint32_t seen;
+
+    pthread_mutex_lock(&fleet->Lock);
+    seen = fleet->Generation;
+    while(1){
+        while(fleet->Running && fleet->Generation == seen){
+            pthread_cond_wait(&fleet->Start, &fleet->Lock);
+        }
+        if(!fleet->Running){
+            break;
+        }
+        seen = fleet->Generation;
+        pthread_mutex_unlock(&fleet->Lock);
+
+        Fleet_Work(fleet);
+
+        pthread_mutex_lock(&fleet->Lock);
+    }
+    pthread_mutex_unlock(&fleet->Lock);
+    return(NULL);
+}
+#endif
@@ -0,0 +1,141 @@
+/**
+* @file             Coord_Fleet.h
+* @brief            Solve batches of targets for many arms of different sizes at once, split across a thread pool
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_FLEET_H_
+#define _COORD_FLEET_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+#include "Coord_Batch.h"
+#ifdef COORD_HOST
+#include <pthread.h>
+#endif
+
+/* Glossary for Coord_Fleet.h and Coord_Fleet.c
+ *
+ *  Fleet          - Arms of their own geometry (one struct RobotArm each, Arm_Init()), none of them the global Asimov,
+ *                   and a batch of targets for each. Solved with Arm_Solve_Batch() (Coord_Batch.h), which only
+ *                   reads its arm, so any number of arms can be solved at the same time.
+ *  Layout         - Every array of the fleet (targets in, angles and reachable mask out) is one contiguous buffer
+ *                   for all the arms. Arm a owns the entries from Batches[a].First to First + Count - 1. Fleet_Layout()
+ *                   starts every arm on a multiple of FLEET_CHUNK, so the arms' reachable masks start on a word of
+ *                   their own and no chunk has two arms. The entries in between are padding, never read or written.
+ *  Chunk          - FLEET_CHUNK entries of one arm, the piece of work a thread takes at a time. Threads take the
+ *                   next chunk from a shared counter until none are left, so arms with long batches are shared out
+ *                   the same as many arms with short ones.
+ *  Pool           - Host build (-DCOORD_HOST, link with -lpthread): Fleet_Start() starts threads - 1 workers that
+ *                   sleep between solves; Fleet_Solve() wakes them and works on chunks itself until all are done.
+ *                   Without a pool (or on the target) Fleet_Solve() works through the chunks on its own.
+ */
+
+#ifndef FLEET_CHUNK
+#define FLEET_CHUNK             256         //Entries per chunk (multiple of 32)
+#endif
+#ifndef FLEET_MAX_THREADS
+#define FLEET_MAX_THREADS       64
+#endif
+
+#if (FLEET_CHUNK % 32) || (FLEET_CHUNK == 0)
+#error "FLEET_CHUNK must be a multiple of 32"
+#endif
+
+/***** Definitions *****/
+
+/*
+*   Where one arm's targets are in the fleet buffers
+*/
+struct Fleet_Batch {
+    uint32_t First;                     //Index of the arm's first entry, a multiple of FLEET_CHUNK
+    uint32_t Count;                     //Targets of the arm
+    int32_t Reachable;                  //Reachable targets of the arm after Fleet_Solve()
+};
+
+/*
+*   Arms, their targets and their results. Create with Fleet_Init()
+*/
+struct Fleet {
+    const struct RobotArm *Arms;
+    struct Fleet_Batch *Batches;
+    uint32_t Num_Arms;
+    uint32_t Num_Chunks;
+
+    //Buffers, Fleet_Layout() entries each (reachable: IK_BATCH_WORDS of them)
+    const uint16_t *x;
+    const uint16_t *y;
+    const uint16_t *z;
+    const float *Grabber_Angle;
+    struct IK_Batch_Angles Angles;
+    uint32_t *Reachable;
+
+    //Solve in progress
+    uint32_t Next_Chunk;
+    uint32_t Done_Chunks;
+
+#ifdef COORD_HOST
+    pthread_t Threads[FLEET_MAX_THREADS];
+    pthread_mutex_t Lock;
+    pthread_cond_t Start;               //Workers wait on it for the next Generation
+    pthread_cond_t Done;                //Fleet_Solve() waits on it for the last chunk
+    uint32_t Num_Workers;
+    uint32_t Generation;                //Solves started, bumped to wake the workers
+    uint8_t Running;
+#endif
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Place each arm's batch in the fleet buffers
+* @param[out]   batches - One per arm, First and Count are set
+* @param[in]    counts - Targets of each arm
+* @param[in]    num_arms - Number of arms
+*
+* @return       Entries every fleet buffer needs (the reachable mask IK_BATCH_WORDS() of them), 0 if it would not fit
+*               in 32 bits
+*/
+uint32_t Fleet_Layout(struct Fleet_Batch *batches, const uint32_t *counts, uint32_t num_arms);
+
+/**
+* @brief        Set up a fleet on buffers laid out by Fleet_Layout(), with no pool
+* @param[out]   fleet - Fleet to initialize
+* @param[in]    arms - num_arms arm geometries (Arm_Init()), only read
+* @param[in]    batches - Laid out by Fleet_Layout() for these arms
+* @param[in]    num_arms - Number of arms
+* @param[in]    x, y, z, Grabber_Angle - Targets of all the arms. Filled in by the caller, read at every Fleet_Solve()
+* @param[out]   angles - Base, Shoulder, Elbow and Wrist angles of all the arms
+* @param[out]   reachable - Reachable mask of all the arms
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR or E_BAD_PARAM (batches not from Fleet_Layout())
+*/
+int Fleet_Init(struct Fleet *fleet, const struct RobotArm *arms, struct Fleet_Batch *batches, uint32_t num_arms, const uint16_t *x,
+               const uint16_t *y, const uint16_t *z, const float *Grabber_Angle, const struct IK_Batch_Angles *angles, uint32_t *reachable);
+
+/**
+* @brief        Start a pool that Fleet_Solve() splits the chunks across. Host build only
+* @param[in]    threads - Threads to solve on, the caller of Fleet_Solve() included (1 to FLEET_MAX_THREADS)
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR, E_BAD_PARAM, E_BUSY (pool already started) or E_NONE_AVAIL (a
+*               thread could not be started, or not a host build)
+*/
+int Fleet_Start(struct Fleet *fleet, uint32_t threads);
+
+/**
+* @brief        Solve every arm's batch. Returns when all are done
+*
+* @return       Reachable targets of all the arms (Success), E_NULL_PTR
+*/
+int32_t Fleet_Solve(struct Fleet *fleet);
+
+/**
+* @brief        Stop and join the pool, Fleet_Solve() carries on without it
+*/
+void Fleet_Stop(struct Fleet *fleet);
+
+
+
+#endif  /* _COORD_FLEET_H_ */
@@ -0,0 +1,225 @@
+/**
+* @file             Coord_Grid.c
+* @brief            Build and interpolate the grid of IK solutions
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include <math.h>
+#include "Coord_Grid.h"
+
+
+/***** Definitions *****/
+
+#define GRID_ANGLE_TOL          0.001f      //Degrees a grabber angle may be off one in the set
+
+
+/***** Function Prototypes *****/
+static uint32_t Grid_Points(const struct RobotArm *arm, uint8_t Cell_Shift);
+static int Grid_Slice(const struct IK_Grid *grid, float Grabber_Angle);
+static int16_t Grid_Store(float angle);
+static int Grid_Corners_Reachable(const struct IK_Grid *grid, uint32_t slice, uint32_t cx, uint32_t cy, uint32_t cz);
+static void Grid_Interpolate(const struct IK_Grid *grid, uint32_t slice, uint32_t x, uint32_t y, uint32_t z, float *angles);
+
+
+/***** Driver implementation *****/
+
+uint32_t IK_Grid_Size(const struct RobotArm *arm, uint8_t Cell_Shift, uint8_t Num_Angles){
+    uint32_t points, slice_points;
+
+    if(arm == NULL || Cell_Shift < 1 || Cell_Shift > 8 || Num_Angles < 1 || Num_Angles > IK_GRID_MAX_ANGLES){
+        return(0);
+    }
+    points = Grid_Points(arm, Cell_Shift);
+    slice_points = points * points * points;
+
+    return(points * points * sizeof(int16_t) + Num_Angles * slice_points * 2 * sizeof(int16_t) + (Num_Angles * slice_points + 7) / 8);
+}
+
+int IK_Grid_Build(struct IK_Grid *grid, const struct RobotArm *arm, uint8_t Cell_Shift, const float *Grabber_Angles, uint8_t Num_Angles, void *memory, uint32_t bytes){
+    struct IK_Scratch scratch;
+    uint32_t points, index, checks;
+    float results[6], angles[3];
+
+    if(grid == NULL || arm == NULL || Grabber_Angles == NULL || memory == NULL){
+        return(E_NULL_PTR);
+    }
+    if(IK_Grid_Size(arm, Cell_Shift, Num_Angles) == 0 || bytes < IK_Grid_Size(arm, Cell_Shift, Num_Angles)){
+        return(E_BAD_PARAM);
+    }
+    points = Grid_Points(arm, Cell_Shift);
+    if(((points - 1) << Cell_Shift) > 65535){
+        return(E_BAD_PARAM);
+    }
+
+    grid->arm = arm;
+    grid->Cell_Shift = Cell_Shift;
+    grid->Num_Angles = Num_Angles;
+    grid->Points = (uint16_t)points;
+    grid->Slice_Points = points * points * points;
+    grid->Base = (int16_t *)memory;
+    grid->Joints = grid->Base + points * points;
+    grid->Trusted = (uint8_t *)(grid->Joints + Num_Angles * grid->Slice_Points * 2);
+    grid->Hits = 0;
+    grid->Fallbacks = 0;
+    for(uint32_t a = 0; a < Num_Angles; a++){
+        grid->Grabber_Angles[a] = Grabber_Angles[a];
+    }
+
+    //Solve every grid point. The base angle comes out the same for every grabber angle and z, keep it from the first
+    for(uint32_t a = 0; a < Num_Angles; a++){
+        for(uint32_t z = 0; z < points; z++){
+            for(uint32_t y = 0; y < points; y++){
+                for(uint32_t x = 0; x < points; x++){
+                    Arm_Solve(arm, &scratch, (uint16_t)(x << Cell_Shift), (uint16_t)(y << Cell_Shift), (uint16_t)(z << Cell_Shift), Grabber_Angles[a], results);
+                    index = (z * points + y) * points + x;
+                    if(a == 0 && z == 0){
+                        grid->Base[y * points + x] = Grid_Store(results[0]);
+                    }
+                    grid->Joints[(a * grid->Slice_Points + index) * 2] = Grid_Store(results[1]);
+                    grid->Joints[(a * grid->Slice_Points + index) * 2 + 1] = Grid_Store(results[2]);
+                }
+            }
+        }
+    }
+
+    //Trust a cell if every check point in it interpolates close enough to the real solution. Cells no wider than
+    //IK_GRID_CHECKS units are checked at every whole unit position, which is every position IK_Grid_Solve() takes
+    checks = (1u << Cell_Shift) < IK_GRID_CHECKS ? (1u << Cell_Shift) : IK_GRID_CHECKS;
+    for(uint32_t a = 0; a < Num_Angles; a++){
+        for(uint32_t z = 0; z < points; z++){
+            for(uint32_t y = 0; y < points; y++){
+                for(uint32_t x = 0; x < points; x++){
+                    uint32_t bit = a * grid->Slice_Points + (z * points + y) * points + x;
+                    int trusted = (x + 1 < points && y + 1 < points && z + 1 < points && Grid_Corners_Reachable(grid, a, x, y, z));
+
+                    for(uint32_t check = 0; trusted && check < (checks + 1) * (checks + 1) * (checks + 1); check++){
+                        uint32_t px = (x << Cell_Shift) + ((check % (checks + 1)) << Cell_Shift) / checks;
+                        uint32_t py = (y << Cell_Shift) + (((check / (checks + 1)) % (checks + 1)) << Cell_Shift) / checks;
+                        uint32_t pz = (z << Cell_Shift) + ((check / ((checks + 1) * (checks + 1))) << Cell_Shift) / checks;
+
+                        Grid_Interpolate(grid, a, px, py, pz, angles);
+                        Arm_Solve(arm, &scratch, (uint16_t)px, (uint16_t)py, (uint16_t)pz, Grabber_Angles[a], results);
+
+                        //NaN compares false, so an unreachable check point is not trusted either
+                        trusted = fabsf(angles[0] - results[0]) <= IK_GRID_TOL_DEG && fabsf(angles[1] - results[1]) <= IK_GRID_TOL_DEG &&
+                                  fabsf(angles[2] - results[2]) <= IK_GRID_TOL_DEG;
+                    }
+                    if(trusted){
+                        grid->Trusted[bit / 8] |= (uint8_t)(1u << (bit % 8));
+                    }
+                    else{
+                        grid->Trusted[bit / 8] &= (uint8_t)~(1u << (bit % 8));
+                    }
+                }
+            }
+        }
+    }
+
+    return(E_NO_ERROR);
+}
+
+int IK_Grid_Solve(struct IK_Grid *grid, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results){
+    uint32_t cx, cy, cz, bit;
+    int slice;
+
+    if(grid == NULL || results == NULL){
+        return(E_NULL_PTR);
+    }
+
+    slice = Grid_Slice(grid, Grabber_Angle);
+    cx = x >> grid->Cell_Shift;
+    cy = y >> grid->Cell_Shift;
+    cz = z >> grid->Cell_Shift;
+    if(slice >= 0 && cx + 1 < grid->Points && cy + 1 < grid->Points && cz + 1 < grid->Points){
+        bit = slice * grid->Slice_Points + (cz * grid->Points + cy) * grid->Points + cx;
+        if((grid->Trusted[bit / 8] >> (bit % 8)) & 1){
+            Grid_Interpolate(grid, (uint32_t)slice, x, y, z, results);
+            results[3] = (Grabber_Angle > 90) ? 0.0f : 90.0f - Grabber_Angle;
+            results[4] = grid->arm->Wrist_Rotation;
+            results[5] = grid->arm->Wrist_Grab;
+            grid->Hits++;
+            return(E_NO_ERROR);
+        }
+    }
+
+    if(scratch == NULL){
+        return(E_NONE_AVAIL);
+    }
+    grid->Fallbacks++;
+    return(Arm_Solve(grid->arm, scratch, x, y, z, Grabber_Angle, results));
+}
+
+//Grid points along each axis: enough cells to cover the reach of the arm (see reach_map_gen_host.c), plus the far corner
+static uint32_t Grid_Points(const struct RobotArm *arm, uint8_t Cell_Shift){
+    uint32_t extent = (uint32_t)arm->Len_BaseToElbow + arm->Len_ElbowToWrist + arm->Len_Wrist + 1;
+
+    return((extent >> Cell_Shift) + 2);
+}
+
+//Slice of a grabber angle, -1 if it is not in the set. Every angle over 90 leaves the wrist straight, so they match
+static int Grid_Slice(const struct IK_Grid *grid, float Grabber_Angle){
+    for(int a = 0; a < grid->Num_Angles; a++){
+        if(fabsf(Grabber_Angle - grid->Grabber_Angles[a]) < GRID_ANGLE_TOL || (Grabber_Angle > 90 && grid->Grabber_Angles[a] > 90)){
+            return(a);
+        }
+    }
+    return(-1);
+}
+
+static int16_t Grid_Store(float angle){
+    if(isnan(angle)){
+        return(IK_GRID_UNREACHABLE);
+    }
+    return((int16_t)lrintf(angle * IK_GRID_SCALE));
+}
+
+//All 8 corners of a cell have a solution
+static int Grid_Corners_Reachable(const struct IK_Grid *grid, uint32_t slice, uint32_t cx, uint32_t cy, uint32_t cz){
+    const uint32_t points = grid->Points;
+    const int16_t *base = &grid->Base[cy * points + cx];
+
+    if(base[0] == IK_GRID_UNREACHABLE || base[1] == IK_GRID_UNREACHABLE || base[points] == IK_GRID_UNREACHABLE ||
+       base[points + 1] == IK_GRID_UNREACHABLE){
+        return(0);
+    }
+    for(uint32_t corner = 0; corner < 8; corner++){
+        uint32_t index = ((cz + (corner >> 2)) * points + cy + ((corner >> 1) & 1)) * points + cx + (corner & 1);
+        const int16_t *joint = &grid->Joints[(slice * grid->Slice_Points + index) * 2];
+
+        if(joint[0] == IK_GRID_UNREACHABLE || joint[1] == IK_GRID_UNREACHABLE){
+            return(0);
+        }
+    }
+    return(1);
+}
+
+//Base, Shoulder and Elbow at a position inside a cell whose corners are all reachable
+static void Grid_Interpolate(const struct IK_Grid *grid, uint32_t slice, uint32_t x, uint32_t y, uint32_t z, float *angles){
+    const uint32_t points = grid->Points, mask = (1u << grid->Cell_Shift) - 1;
+    const float per_unit = 1.0f / (float)(1u << grid->Cell_Shift);
+    uint32_t cx = x >> grid->Cell_Shift, cy = y >> grid->Cell_Shift, cz = z >> grid->Cell_Shift;
+    float fx = (float)(x & mask) * per_unit, fy = (float)(y & mask) * per_unit, fz = (float)(z & mask) * per_unit;
+    const int16_t *base = &grid->Base[cy * points + cx];
+    const int16_t *joint = &grid->Joints[(slice * grid->Slice_Points + (cz * points + cy) * points + cx) * 2];
+    const uint32_t dy = points * 2, dz = points * points * 2;
+    float c00, c10, c01, c11, c0, c1;
+
+    c0 = base[0] + fx * (base[1] - base[0]);
+    c1 = base[points] + fx * (base[points + 1] - base[points]);
+    angles[0] = (c0 + fy * (c1 - c0)) * (1.0f / IK_GRID_SCALE);
+
+    //Shoulder and elbow sit side by side, so the neighbour in x is 2 values on
+    for(int j = 0; j < 2; j++){
+        const int16_t *c = joint + j;
+
+        c00 = c[0] + fx * (c[2] - c[0]);
+        c10 = c[dy] + fx * (c[dy + 2] - c[dy]);
+        c01 = c[dz] + fx * (c[dz + 2] - c[dz]);
+        c11 = c[dz + dy] + fx * (c[dz + dy + 2] - c[dz + dy]);
+        c0 = c00 + fy * (c10 - c00);
+        c1 = c01 + fy * (c11 - c01);
+        angles[1 + j] = (c0 + fz * (c1 - c0)) * (1.0f / IK_GRID_SCALE);
+    }
+}
@@ -0,0 +1,107 @@
+/**
+* @file             Coord_Grid.h
+* @brief            Approximate inverse kinematics from a precomputed grid of solutions with trilinear interpolation
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_GRID_H_
+#define _COORD_GRID_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+
+/* Glossary for Coord_Grid.h and Coord_Grid.c
+ *
+ *  Grid Point     - Arm_Solve() result at every 2^Cell_Shift units of x, y and z, built once for one arm (the link
+ *                   lengths from Init_Coords()/Arm_Init()) and a fixed set of grabber angles. Shoulder and elbow
+ *                   are kept per grabber angle, the base angle only depends on x and y and is kept once. Angles are
+ *                   int16_t hundredths of a degree.
+ *  Trusted Cell   - A cell whose 8 corners are all reachable, and where interpolating comes within IK_GRID_TOL_DEG
+ *                   of Arm_Solve() on every joint at every check point. Cells up to IK_GRID_CHECKS units wide are
+ *                   checked at every whole unit position, so for them the tolerance is a bound. Wider cells are
+ *                   checked IK_GRID_CHECKS steps along each edge and can be slightly worse in between. Cells along
+ *                   the edge of the workspace, near a straight or folded elbow and round the base axis fail the check
+ *                   and are solved exactly instead.
+ *  Fallback       - IK_Grid_Solve() with a scratch structure calls Arm_Solve() for a position in an untrusted cell
+ *                   or a grabber angle that is not in the set, so the caller always gets an answer.
+ *
+ * Memory is IK_Grid_Size() bytes from the caller, 4 bytes per grid point per grabber angle and 2 per grid point
+ * in x and y for the base. For a 120/120/60 arm with one grabber angle: 4 unit cells 1.8 MB, 8 unit cells 242 KB,
+ * 16 unit cells 33 KB, 32 unit cells 5.6 KB (with no trusted cells, too coarse to be useful).
+ */
+
+#ifndef IK_GRID_TOL_DEG
+#define IK_GRID_TOL_DEG         0.5f        //Accuracy a cell has to reach at every check point to be trusted
+#endif
+#ifndef IK_GRID_CHECKS
+#define IK_GRID_CHECKS          8           //Most steps a cell edge is checked in (one more point than steps, corners included)
+#endif
+#define IK_GRID_MAX_ANGLES      8
+#define IK_GRID_SCALE           100.0f      //Stored angles are degrees * IK_GRID_SCALE
+#define IK_GRID_UNREACHABLE     INT16_MIN
+
+/***** Definitions *****/
+
+/*
+*   Grid of solutions for one arm. Create with IK_Grid_Build()
+*/
+struct IK_Grid {
+    const struct RobotArm *arm;
+    uint8_t Cell_Shift;
+    uint8_t Num_Angles;
+    uint16_t Points;                    //Grid points along each axis
+    uint32_t Slice_Points;              //Points^3
+    float Grabber_Angles[IK_GRID_MAX_ANGLES];
+    int16_t *Base;                      //[y][x]
+    int16_t *Joints;                    //[angle][z][y][x][Shoulder, Elbow]
+    uint8_t *Trusted;                   //[angle][z][y][x] one bit per cell, indexed by its lowest corner
+
+    uint32_t Hits;                      //Solves answered from the grid
+    uint32_t Fallbacks;                 //Solves passed to Arm_Solve()
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Bytes IK_Grid_Build() needs
+* @param[in]    arm - Arm geometry
+* @param[in]    Cell_Shift - Cells are 2^Cell_Shift units on a side (1 to 8)
+* @param[in]    Num_Angles - Number of grabber angles
+*
+* @return       Bytes of memory, 0 for a bad Cell_Shift or Num_Angles
+*/
+uint32_t IK_Grid_Size(const struct RobotArm *arm, uint8_t Cell_Shift, uint8_t Num_Angles);
+
+/**
+* @brief        Solve every grid point and check every cell. Runs Arm_Solve() up to (IK_GRID_CHECKS + 1)^3 times per
+*               cell, so build it once at start up or after the link lengths change
+* @param[out]   grid - Grid to build
+* @param[in]    arm - Arm geometry, only read. The grid is only valid for these link lengths
+* @param[in]    Cell_Shift - Cells are 2^Cell_Shift units on a side (1 to 8)
+* @param[in]    Grabber_Angles - Grabber angles in degrees to build slices for
+* @param[in]    Num_Angles - 1 to IK_GRID_MAX_ANGLES
+* @param[in]    memory - IK_Grid_Size() bytes, 2 byte aligned
+* @param[in]    bytes - Bytes available at memory
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR or E_BAD_PARAM (bad shift or angle count, or not enough memory)
+*/
+int IK_Grid_Build(struct IK_Grid *grid, const struct RobotArm *arm, uint8_t Cell_Shift, const float *Grabber_Angles, uint8_t Num_Angles, void *memory, uint32_t bytes);
+
+/**
+* @brief        Joint angles for a grabber position from the grid, or from Arm_Solve() where the grid is not trusted
+* @param[in]    grid - Built grid
+* @param[in]    scratch - Scratch for the fallback solve, or NULL to return E_NONE_AVAIL instead of falling back
+* @param[in]    x, y, z - Grabber position
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in degrees
+* @param[out]   results - Base, Shoulder, Elbow, Wrist, Wrist Rotation and Wrist Grab angles in degrees (6 floats,
+*               as Arm_Solve(), NaN when a fallback solve is out of reach)
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR or E_NONE_AVAIL (no trusted cell and no scratch)
+*/
+int IK_Grid_Solve(struct IK_Grid *grid, struct IK_Scratch *scratch, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, float *results);
+
+
+
+#endif  /* _COORD_GRID_H_ */
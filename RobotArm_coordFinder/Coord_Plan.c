@@ -0,0 +1,615 @@
+/**
+* @file             Coord_Plan.c
+* @brief            Arena, BVH scene, link collision checks and the RRT-Connect search
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include <math.h>
+#include "Coord_Plan.h"
+#include "Coord_Trig.h"
+
+
+/***** Definitions *****/
+
+#define PLAN_ALIGN              8
+#define PLAN_RAD_PER_DEG        0.017453292519943f
+
+typedef enum {
+    PLAN_TRAPPED = 0,                   //Hit something (or out of nodes), nothing added
+    PLAN_ADVANCED,                      //Added a node part of the way
+    PLAN_REACHED                        //Added a node on the configuration
+} Plan_Extend_Result;
+
+/*
+*   One search tree, nodes from the arena
+*/
+struct Plan_Tree {
+    struct Plan_Node *Nodes;
+    uint32_t Count;
+    uint32_t Capacity;
+};
+
+
+/***** Function Prototypes *****/
+static void *Plan_Alloc(struct Plan_Arena *arena, uint32_t bytes);
+static uint16_t Plan_Bvh_Build(struct Plan_Scene *scene, uint16_t *next_node, uint16_t first, uint16_t count);
+static int Plan_Segment_Hits(const float *from, const float *to, const float *min, const float *max, float radius);
+static int Plan_Link_Free(const struct Plan_Scene *scene, const float *from, const float *to, float radius);
+static int Plan_Config_Clear(struct Planner *planner, const float *angles, float margin);
+static float Plan_End_Margin(struct Planner *planner, const float *angles);
+static int Plan_Edge_Point(struct Planner *planner, const float *from, const float *to, float distance, float sweep, float margin);
+static int Plan_Edge_Free(struct Planner *planner, const float *from, const float *to);
+static uint32_t Plan_Random(struct Planner *planner);
+static int32_t Plan_Nearest(const struct Plan_Tree *tree, const float *angles);
+static Plan_Extend_Result Plan_Extend(struct Planner *planner, struct Plan_Tree *tree, const float *angles);
+static int32_t Plan_Search(struct Planner *planner, const float *start, const float (*goals)[4], uint32_t num_goals,
+                           float (*waypoints)[4], uint32_t max_waypoints);
+
+
+/***** Driver implementation *****/
+
+int Plan_Arena_Init(struct Plan_Arena *arena, void *memory, uint32_t size){
+    if(arena == NULL || memory == NULL){
+        return(E_NULL_PTR);
+    }
+
+    arena->Memory = (uint8_t *)memory;
+    arena->Size = size;
+    arena->Used = 0;
+
+    return(E_NO_ERROR);
+}
+
+int Plan_Scene_Build(struct Plan_Scene *scene, struct Plan_Arena *arena, const struct Plan_Box *boxes, uint32_t count){
+    uint16_t next_node = 0;
+    uint32_t mark;
+
+    if(scene == NULL || arena == NULL || (boxes == NULL && count)){
+        return(E_NULL_PTR);
+    }
+    //The BVH takes up to 2 * count + 1 nodes, numbered in 16 bits
+    if(count > PLAN_MAX_BOXES){
+        return(E_BAD_PARAM);
+    }
+    for(uint32_t i = 0; i < count; i++){
+        for(int axis = 0; axis < 3; axis++){
+            //Written so NaN fails too
+            if(!(boxes[i].Min[axis] <= boxes[i].Max[axis])){
+                return(E_BAD_PARAM);
+            }
+        }
+    }
+
+    //A leaf per PLAN_BVH_LEAF boxes at most, and one fewer inner nodes than leaves
+    mark = arena->Used;
+    scene->Boxes = (struct Plan_Box *)Plan_Alloc(arena, count * sizeof(struct Plan_Box));
+    scene->Nodes = (struct Plan_Bvh_Node *)Plan_Alloc(arena, (2 * count + 1) * sizeof(struct Plan_Bvh_Node));
+    if(scene->Boxes == NULL || scene->Nodes == NULL){
+        arena->Used = mark;
+        return(E_NONE_AVAIL);
+    }
+    for(uint32_t i = 0; i < count; i++){
+        scene->Boxes[i] = boxes[i];
+    }
+    scene->Num_Boxes = (uint16_t)count;
+
+    Plan_Bvh_Build(scene, &next_node, 0, (uint16_t)count);
+    scene->Num_Nodes = next_node;
+
+    return(E_NO_ERROR);
+}
+
+int Plan_Init(struct Planner *planner, const struct RobotArm *arm, const struct Plan_Scene *scene, const struct IK_Joint_Limits *limits,
+              const float *Link_Radius, struct Plan_Arena *arena, uint32_t seed){
+    if(planner == NULL || arm == NULL || scene == NULL || limits == NULL || Link_Radius == NULL || arena == NULL){
+        return(E_NULL_PTR);
+    }
+    if(seed == 0){
+        return(E_BAD_PARAM);
+    }
+    for(int j = 0; j < 4; j++){
+        if(!(limits->Min[j] <= limits->Max[j])){
+            return(E_BAD_PARAM);
+        }
+    }
+
+    planner->arm = arm;
+    planner->scene = scene;
+    planner->arena = arena;
+    planner->Limits = *limits;
+    for(int k = 0; k < 3; k++){
+        planner->Link_Radius[k] = Link_Radius[k];
+    }
+    planner->Random = seed;
+    planner->Iterations = 0;
+    planner->Nodes = 0;
+    planner->Checks = 0;
+
+    return(E_NO_ERROR);
+}
+
+int Plan_Config_Free(struct Planner *planner, const float *angles){
+    return(Plan_Config_Clear(planner, angles, 0));
+}
+
+int32_t Plan_Path(struct Planner *planner, const float *start, const float *goal, float (*waypoints)[4], uint32_t max_waypoints){
+    float goals[1][4];
+
+    if(planner == NULL || start == NULL || goal == NULL || waypoints == NULL){
+        return(E_NULL_PTR);
+    }
+
+    for(int j = 0; j < 4; j++){
+        goals[0][j] = goal[j];
+    }
+    if(!Plan_Config_Free(planner, goal)){
+        return(E_BAD_PARAM);
+    }
+    return(Plan_Search(planner, start, (const float (*)[4])goals, 1, waypoints, max_waypoints));
+}
+
+int32_t Plan_To_Pose(struct Planner *planner, const float *start, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle,
+                     float (*waypoints)[4], uint32_t max_waypoints){
+    struct IK_Scratch scratch;
+    struct IK_Solutions solutions;
+    float goals[IK_BRANCHES][4];
+    uint32_t num_goals = 0;
+    int rslt;
+
+    if(planner == NULL || start == NULL || waypoints == NULL){
+        return(E_NULL_PTR);
+    }
+
+    //Every branch within the limits and clear of the fixtures is a goal
+    if((rslt = Arm_Solve_All(planner->arm, &scratch, x, y, z, Grabber_Angle, &planner->Limits, &solutions)) < 0){
+        return(rslt);
+    }
+    for(uint32_t s = 0; s < solutions.Count; s++){
+        if(Plan_Config_Free(planner, solutions.Angles[s])){
+            for(int j = 0; j < 4; j++){
+                goals[num_goals][j] = solutions.Angles[s][j];
+            }
+            num_goals++;
+        }
+    }
+    if(!num_goals){
+        return(E_BAD_PARAM);
+    }
+    return(Plan_Search(planner, start, (const float (*)[4])goals, num_goals, waypoints, max_waypoints));
+}
+
+//Bump allocation, 8 byte aligned. NULL when the arena is full
+static void *Plan_Alloc(struct Plan_Arena *arena, uint32_t bytes){
+    uint32_t start = (arena->Used + PLAN_ALIGN - 1) & ~(uint32_t)(PLAN_ALIGN - 1);
+
+    if(start > arena->Size || bytes > arena->Size - start){
+        return(NULL);
+    }
+    arena->Used = start + bytes;
+    return(arena->Memory + start);
+}
+
+//Node over count boxes from first: bound them, then split at the middle box along the longest side. Returns the node.
+//Depth is about log2(count / PLAN_BVH_LEAF), so the recursion stays shallow
+static uint16_t Plan_Bvh_Build(struct Plan_Scene *scene, uint16_t *next_node, uint16_t first, uint16_t count){
+    uint16_t index = (*next_node)++;
+    struct Plan_Bvh_Node *node = &scene->Nodes[index];
+    struct Plan_Box *boxes = &scene->Boxes[first];
+    int axis = 0;
+
+    //An empty scene gets one leaf that bounds nothing
+    for(int a = 0; a < 3; a++){
+        node->Min[a] = INFINITY;
+        node->Max[a] = -INFINITY;
+    }
+    for(uint16_t i = 0; i < count; i++){
+        for(int a = 0; a < 3; a++){
+            node->Min[a] = fminf(node->Min[a], boxes[i].Min[a]);
+            node->Max[a] = fmaxf(node->Max[a], boxes[i].Max[a]);
+        }
+    }
+
+    if(count <= PLAN_BVH_LEAF){
+        node->First = first;
+        node->Count = count;
+        node->Right = 0;
+        return(index);
+    }
+
+    for(int a = 1; a < 3; a++){
+        if(node->Max[a] - node->Min[a] > node->Max[axis] - node->Min[axis]){
+            axis = a;
+        }
+    }
+
+    //Insertion sort by center, a work cell has tens of fixtures
+    for(uint16_t i = 1; i < count; i++){
+        struct Plan_Box box = boxes[i];
+        float center = box.Min[axis] + box.Max[axis];
+        uint16_t j = i;
+
+        while(j > 0 && boxes[j - 1].Min[axis] + boxes[j - 1].Max[axis] > center){
+            boxes[j] = boxes[j - 1];
+            j--;
+        }
+        boxes[j] = box;
+    }
+
+    node->First = 0;
+    node->Count = 0;
+    Plan_Bvh_Build(scene, next_node, first, count / 2);
+    node->Right = Plan_Bvh_Build(scene, next_node, first + count / 2, count - count / 2);
+    return(index);
+}
+
+//Does the segment pass through the box grown by radius (slab test)
+static int Plan_Segment_Hits(const float *from, const float *to, const float *min, const float *max, float radius){
+    float enter = 0.0f, leave = 1.0f;
+
+    for(int a = 0; a < 3; a++){
+        float low = min[a] - radius, high = max[a] + radius;
+        float delta = to[a] - from[a];
+
+        if(fabsf(delta) < 1e-6f){
+            //Parallel to the slab, inside it or never
+            if(from[a] < low || from[a] > high){
+                return(0);
+            }
+        }
+        else{
+            float inverse = 1.0f / delta;
+            float t_low = (low - from[a]) * inverse, t_high = (high - from[a]) * inverse;
+
+            if(t_low > t_high){
+                float swap = t_low;
+                t_low = t_high;
+                t_high = swap;
+            }
+            enter = fmaxf(enter, t_low);
+            leave = fminf(leave, t_high);
+            if(enter > leave){
+                return(0);
+            }
+        }
+    }
+    return(1);
+}
+
+//Walk the BVH down the nodes the link passes through
+static int Plan_Link_Free(const struct Plan_Scene *scene, const float *from, const float *to, float radius){
+    uint16_t stack[PLAN_BVH_DEPTH];
+    uint32_t top = 0;
+    uint16_t index = 0;
+
+    //The one node of an empty scene is a leaf with no boxes, which would read as an inner node
+    if(!scene->Num_Boxes){
+        return(1);
+    }
+    while(1){
+        const struct Plan_Bvh_Node *node = &scene->Nodes[index];
+
+        if(Plan_Segment_Hits(from, to, node->Min, node->Max, radius)){
+            if(!node->Count){
+                stack[top++] = node->Right;
+                index++;
+                continue;
+            }
+            for(uint16_t i = 0; i < node->Count; i++){
+                if(Plan_Segment_Hits(from, to, scene->Boxes[node->First + i].Min, scene->Boxes[node->First + i].Max, radius)){
+                    return(0);
+                }
+            }
+        }
+        if(!top){
+            return(1);
+        }
+        index = stack[--top];
+    }
+}
+
+//Is every link margin further than its radius from the table and the boxes
+static int Plan_Config_Clear(struct Planner *planner, const float *angles, float margin){
+    const struct RobotArm *arm = planner->arm;
+    float Base_Cos, Base_Sin, Forearm, Reach[4], Height[4], points[4][3];
+
+    planner->Checks++;
+
+    //Shoulder, elbow, wrist joint and grabber tip in the vertical plane of the base, as Arm_Forward()
+    Forearm = angles[1] + angles[2] - 180.0f;
+    Reach[0] = Height[0] = 0;
+    Reach[1] = arm->Len_BaseToElbow*Trig_Cos_Deg(angles[1]);
+    Height[1] = arm->Len_BaseToElbow*Trig_Sin_Deg(angles[1]);
+    Reach[2] = Reach[1] + arm->Len_ElbowToWrist*Trig_Cos_Deg(Forearm);
+    Height[2] = Height[1] + arm->Len_ElbowToWrist*Trig_Sin_Deg(Forearm);
+    Reach[3] = Reach[2] + arm->Len_Wrist*Trig_Sin_Deg(angles[3]);
+    Height[3] = Height[2] - arm->Len_Wrist*Trig_Cos_Deg(angles[3]);
+
+    //The table, the shoulder sits on it
+    if(Height[1] < margin || Height[2] < margin || Height[3] < margin){
+        return(0);
+    }
+
+    Base_Cos = Trig_Cos_Deg(angles[0]);
+    Base_Sin = Trig_Sin_Deg(angles[0]);
+    for(int p = 0; p < 4; p++){
+        points[p][0] = Reach[p]*Base_Cos;
+        points[p][1] = Reach[p]*Base_Sin;
+        points[p][2] = Height[p];
+    }
+
+    for(int k = 0; k < 3; k++){
+        if(!Plan_Link_Free(planner->scene, points[k], points[k + 1], planner->Link_Radius[k] + margin)){
+            return(0);
+        }
+    }
+    return(1);
+}
+
+//Largest of PLAN_CHECK_MOVE / 2, / 4, ... PLAN_CHECK_HALVINGS times that a configuration is clear by, -1 when none
+static float Plan_End_Margin(struct Planner *planner, const float *angles){
+    float margin = 0.5f * PLAN_CHECK_MOVE;
+
+    for(int h = 0; h <= PLAN_CHECK_HALVINGS; h++){
+        if(Plan_Config_Clear(planner, angles, margin)){
+            return(margin);
+        }
+        margin *= 0.5f;
+    }
+    return(-1.0f);
+}
+
+//Is the configuration at distance along the edge clear by margin. Distances are in units of link travel (sweep)
+static int Plan_Edge_Point(struct Planner *planner, const float *from, const float *to, float distance, float sweep, float margin){
+    float t = distance / sweep, angles[4];
+
+    for(int j = 0; j < 4; j++){
+        angles[j] = from[j] + (to[j] - from[j]) * t;
+    }
+    return(Plan_Config_Clear(planner, angles, margin));
+}
+
+//Configurations along a joint space edge, each with the links grown by a margin. No point of a link moves further
+//than sweep * dt, so a check clear by margin also clears the motion margin either side of it, and the checks are
+//placed so those stretches join up over the whole edge. Each end is clear by what Plan_End_Margin() finds, and the
+//margins double from there up to PLAN_CHECK_MOVE / 2, so a pose grazing a fixture can still be left
+static int Plan_Edge_Free(struct Planner *planner, const float *from, const float *to){
+    const struct RobotArm *arm = planner->arm;
+    float lever[4], sweep = 0, low, high, low_margin, high_margin;
+
+    //Furthest any link point can be from each joint's axis: the base turns the whole reach, the shoulder and elbow
+    //move the wrist joint and carry the grabber along without turning it (its angle is from vertical)
+    lever[0] = (float)arm->Len_BaseToElbow + arm->Len_ElbowToWrist + arm->Len_Wrist;
+    lever[1] = (float)arm->Len_BaseToElbow + arm->Len_ElbowToWrist;
+    lever[2] = (float)arm->Len_ElbowToWrist;
+    lever[3] = (float)arm->Len_Wrist;
+    for(int j = 0; j < 4; j++){
+        sweep += fabsf(to[j] - from[j]) * lever[j];
+    }
+    sweep *= PLAN_RAD_PER_DEG;
+
+    if((low_margin = Plan_End_Margin(planner, from)) < 0 || (high_margin = Plan_End_Margin(planner, to)) < 0){
+        return(0);
+    }
+
+    //Covered from the start up to low and from the end down to high, the side with the smaller margin moves first.
+    //The check that fits the rest of the gap ends the loop, rather than relying on the sums meeting exactly
+    low = low_margin;
+    high = sweep - high_margin;
+    while(low < high){
+        float gap = 0.5f * (high - low);
+
+        if(low_margin <= high_margin){
+            low_margin = fminf(2.0f * low_margin, 0.5f * PLAN_CHECK_MOVE);
+            if(low_margin >= gap){
+                return(Plan_Edge_Point(planner, from, to, low + gap, sweep, gap));
+            }
+            if(!Plan_Edge_Point(planner, from, to, low + low_margin, sweep, low_margin)){
+                return(0);
+            }
+            low += 2.0f * low_margin;
+        }
+        else{
+            high_margin = fminf(2.0f * high_margin, 0.5f * PLAN_CHECK_MOVE);
+            if(high_margin >= gap){
+                return(Plan_Edge_Point(planner, from, to, high - gap, sweep, gap));
+            }
+            if(!Plan_Edge_Point(planner, from, to, high - high_margin, sweep, high_margin)){
+                return(0);
+            }
+            high -= 2.0f * high_margin;
+        }
+    }
+    return(1);
+}
+
+//xorshift32
+static uint32_t Plan_Random(struct Planner *planner){
+    uint32_t x = planner->Random;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    planner->Random = x;
+    return(x);
+}
+
+static int32_t Plan_Nearest(const struct Plan_Tree *tree, const float *angles){
+    float best = INFINITY;
+    int32_t nearest = 0;
+
+    for(uint32_t n = 0; n < tree->Count; n++){
+        const float *node = tree->Nodes[n].Angles;
+        float d0 = node[0] - angles[0], d1 = node[1] - angles[1], d2 = node[2] - angles[2], d3 = node[3] - angles[3];
+        float distance = d0 * d0 + d1 * d1 + d2 * d2 + d3 * d3;
+
+        if(distance < best){
+            best = distance;
+            nearest = (int32_t)n;
+        }
+    }
+    return(nearest);
+}
+
+//One step of the tree towards a configuration
+static Plan_Extend_Result Plan_Extend(struct Planner *planner, struct Plan_Tree *tree, const float *angles){
+    int32_t nearest = Plan_Nearest(tree, angles);
+    const float *from = tree->Nodes[nearest].Angles;
+    float step[4], distance = 0, scale = 1.0f;
+    struct Plan_Node *node;
+
+    if(tree->Count >= tree->Capacity){
+        return(PLAN_TRAPPED);
+    }
+
+    for(int j = 0; j < 4; j++){
+        step[j] = angles[j] - from[j];
+        distance += step[j] * step[j];
+    }
+    distance = sqrtf(distance);
+    if(distance > PLAN_STEP_DEG){
+        scale = PLAN_STEP_DEG / distance;
+    }
+
+    node = &tree->Nodes[tree->Count];
+    for(int j = 0; j < 4; j++){
+        node->Angles[j] = (scale < 1.0f) ? from[j] + step[j] * scale : angles[j];
+    }
+    if(!Plan_Edge_Free(planner, from, node->Angles)){
+        return(PLAN_TRAPPED);
+    }
+    node->Parent = nearest;
+    tree->Count++;
+
+    return((scale < 1.0f) ? PLAN_ADVANCED : PLAN_REACHED);
+}
+
+//RRT-Connect from start to any of the goals, then shortcuts. Everything it takes from the arena is given back
+static int32_t Plan_Search(struct Planner *planner, const float *start, const float (*goals)[4], uint32_t num_goals,
+                           float (*waypoints)[4], uint32_t max_waypoints){
+    struct Plan_Arena *arena = planner->arena;
+    struct Plan_Tree trees[2], *grow, *other;
+    float (*path)[4], sample[4];
+    uint32_t mark = arena->Used, capacity, count = 0;
+    int32_t joint[2] = { -1, -1 };
+    int32_t rslt = E_NONE_AVAIL;
+    int straight = 0;
+
+    planner->Iterations = 0;
+    planner->Nodes = 0;
+    planner->Checks = 0;
+    if(!Plan_Config_Free(planner, start)){
+        return(E_BAD_PARAM);
+    }
+
+    //Two trees and room for a path through every node of both
+    capacity = (arena->Size > mark + 4 * PLAN_ALIGN) ? (arena->Size - mark - 4 * PLAN_ALIGN) / (2 * sizeof(struct Plan_Node) + 2 * sizeof(float[4])) : 0;
+    if(capacity < num_goals + 2){
+        return(E_NONE_AVAIL);
+    }
+    trees[0].Nodes = (struct Plan_Node *)Plan_Alloc(arena, capacity * sizeof(struct Plan_Node));
+    trees[1].Nodes = (struct Plan_Node *)Plan_Alloc(arena, capacity * sizeof(struct Plan_Node));
+    path = (float (*)[4])Plan_Alloc(arena, 2 * capacity * sizeof(float[4]));
+    trees[0].Capacity = trees[1].Capacity = capacity;
+
+    //trees[0] grows from the start, trees[1] from every goal
+    for(int j = 0; j < 4; j++){
+        trees[0].Nodes[0].Angles[j] = start[j];
+    }
+    trees[0].Nodes[0].Parent = -1;
+    trees[0].Count = 1;
+    for(uint32_t g = 0; g < num_goals; g++){
+        for(int j = 0; j < 4; j++){
+            trees[1].Nodes[g].Angles[j] = goals[g][j];
+        }
+        trees[1].Nodes[g].Parent = -1;
+    }
+    trees[1].Count = num_goals;
+
+    //Straight there is worth one try before any tree grows
+    for(uint32_t g = 0; g < num_goals && joint[0] < 0; g++){
+        if(Plan_Edge_Free(planner, start, goals[g])){
+            joint[0] = 0;
+            joint[1] = (int32_t)g;
+            straight = 1;
+        }
+    }
+
+    grow = &trees[0];
+    other = &trees[1];
+    while(joint[0] < 0 && planner->Iterations < PLAN_MAX_ITERATIONS){
+        Plan_Extend_Result result;
+        struct Plan_Tree *swap;
+
+        planner->Iterations++;
+        for(int j = 0; j < 4; j++){
+            float range = planner->Limits.Max[j] - planner->Limits.Min[j];
+            sample[j] = planner->Limits.Min[j] + range * (float)(Plan_Random(planner) >> 8) * (1.0f / 16777216.0f);
+        }
+
+        if(Plan_Extend(planner, grow, sample) != PLAN_TRAPPED){
+            const float *added = grow->Nodes[grow->Count - 1].Angles;
+
+            //Connect: the other tree heads straight for the new node
+            do{
+                result = Plan_Extend(planner, other, added);
+            }while(result == PLAN_ADVANCED);
+
+            if(result == PLAN_REACHED){
+                joint[grow == &trees[0] ? 0 : 1] = (int32_t)grow->Count - 1;
+                joint[grow == &trees[0] ? 1 : 0] = (int32_t)other->Count - 1;
+            }
+        }
+        if(grow->Count >= grow->Capacity && other->Count >= other->Capacity){
+            break;
+        }
+
+        swap = grow;
+        grow = other;
+        other = swap;
+    }
+    planner->Nodes = trees[0].Count + trees[1].Count;
+
+    if(joint[0] >= 0){
+        //Start tree back from the joint, turned round, then the goal tree on to its root. The two joint nodes are the
+        //same configuration, unless the straight edge was taken and they are the start and the goal
+        for(int32_t n = joint[0]; n >= 0; n = trees[0].Nodes[n].Parent){
+            count++;
+        }
+        for(int32_t n = joint[0], i = (int32_t)count - 1; n >= 0; n = trees[0].Nodes[n].Parent, i--){
+            for(int j = 0; j < 4; j++) path[i][j] = trees[0].Nodes[n].Angles[j];
+        }
+        for(int32_t n = (straight ? joint[1] : trees[1].Nodes[joint[1]].Parent); n >= 0; n = trees[1].Nodes[n].Parent){
+            for(int j = 0; j < 4; j++) path[count][j] = trees[1].Nodes[n].Angles[j];
+            count++;
+        }
+
+        //Shortcuts
+        for(uint32_t s = 0; s < PLAN_SHORTCUTS && count > 2; s++){
+            uint32_t a = Plan_Random(planner) % count, b = Plan_Random(planner) % count;
+
+            if(a > b){
+                uint32_t swap = a;
+                a = b;
+                b = swap;
+            }
+            if(b - a > 1 && Plan_Edge_Free(planner, path[a], path[b])){
+                for(uint32_t i = b; i < count; i++){
+                    for(int j = 0; j < 4; j++) path[a + 1 + i - b][j] = path[i][j];
+                }
+                count -= b - a - 1;
+            }
+        }
+
+        if(count <= max_waypoints){
+            for(uint32_t i = 0; i < count; i++){
+                for(int j = 0; j < 4; j++) waypoints[i][j] = path[i][j];
+            }
+            rslt = (int32_t)count;
+        }
+    }
+
+    arena->Used = mark;
+    return(rslt);
+}
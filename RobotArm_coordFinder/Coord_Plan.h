@@ -0,0 +1,200 @@
+/**
+* @file             Coord_Plan.h
+* @brief            Joint space motion planning round box shaped fixtures (RRT-Connect over a BVH)
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_PLAN_H_
+#define _COORD_PLAN_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+#include "Coord_Branch.h"
+
+/* Glossary for Coord_Plan.h and Coord_Plan.c
+ *
+ *  Arena          - Memory handed in by the caller (struct Plan_Arena). The scene and every plan take what they need
+ *                   from it in order, nothing calls malloc. A plan gives its memory back when it returns, so a scene
+ *                   built first stays put and plans can run one after another from the same arena.
+ *  Scene          - Fixtures as axis aligned boxes in arm coordinates, in a bounding volume hierarchy (BVH): each
+ *                   node bounds its boxes, split along its longest side at the middle box until PLAN_BVH_LEAF or
+ *                   fewer are left. The table top (z = 0) is always there: no elbow, wrist or tip below it.
+ *  Links          - The upper arm (shoulder to elbow), the forearm (elbow to wrist joint) and the grabber (wrist joint
+ *                   to tip), from the joint angles the way Arm_Forward() works them out, each a segment with a
+ *                   radius. A link hits a box when its segment passes through the box grown by the radius, which
+ *                   also counts the corners of the grown box, so it errs on the safe side.
+ *  Edge           - Straight line in joint space between two configurations (Base, Shoulder, Elbow, Wrist). It is
+ *                   checked at configurations close enough that no point of a link moves more than PLAN_CHECK_MOVE
+ *                   between them (bounded by how far each joint turns times the longest lever on it), with the
+ *                   links grown by half of that, so the motion between the checks is clear too. Towards the ends
+ *                   the steps and the growth shrink to what the end configuration is clear by, down to
+ *                   PLAN_CHECK_MOVE / 2^(PLAN_CHECK_HALVINGS + 1), so a pose right against a fixture can be left.
+ *  RRT-Connect    - One tree grows from the start and one from the goal (every collision free branch of the goal
+ *                   pose is a root of it). Each round one tree takes a step of up to PLAN_STEP_DEG towards a random
+ *                   configuration within the joint limits, and the other tree steps straight at the new node until
+ *                   it reaches it or hits something. Then the trees swap. Nearest nodes are found by a scan.
+ *  Shortcut       - After a path is found, PLAN_SHORTCUTS random pairs of its waypoints are joined straight when
+ *                   that edge is free, dropping the waypoints in between.
+ *
+ * The waypoints are joint angles to stop at, one Profile_Move() each (Coord_Profile.h) turns them into timed samples.
+ */
+
+#ifndef PLAN_BVH_LEAF
+#define PLAN_BVH_LEAF           2           //Most boxes in a BVH leaf
+#endif
+#ifndef PLAN_STEP_DEG
+#define PLAN_STEP_DEG           15.0f       //Longest tree step in joint space (degrees, Euclidean)
+#endif
+#ifndef PLAN_CHECK_MOVE
+#define PLAN_CHECK_MOVE         2.0f        //Most any link point moves between collision checks along an edge (units)
+#endif
+#ifndef PLAN_CHECK_HALVINGS
+#define PLAN_CHECK_HALVINGS     6           //Times the growth is halved at an edge end before the end counts as touching
+#endif
+#ifndef PLAN_MAX_ITERATIONS
+#define PLAN_MAX_ITERATIONS     5000        //Rounds before a plan gives up
+#endif
+#ifndef PLAN_SHORTCUTS
+#define PLAN_SHORTCUTS          50
+#endif
+#define PLAN_BVH_DEPTH          32          //Traversal stack, enough for 2^32 boxes
+#define PLAN_MAX_BOXES          ((UINT16_MAX - 1) / 2)  //So every BVH node has a uint16_t index
+
+/***** Definitions *****/
+
+struct Plan_Arena {
+    uint8_t *Memory;
+    uint32_t Size;
+    uint32_t Used;
+};
+
+struct Plan_Box {
+    float Min[3];
+    float Max[3];
+};
+
+/*
+*   BVH node. The left child is the next node, the right child is at Right. A leaf has Count boxes from First
+*/
+struct Plan_Bvh_Node {
+    float Min[3];
+    float Max[3];
+    uint16_t First;
+    uint16_t Count;                     //0 for an inner node
+    uint16_t Right;
+};
+
+/*
+*   Fixtures of a work cell. Create with Plan_Scene_Build()
+*/
+struct Plan_Scene {
+    struct Plan_Box *Boxes;             //Copy in the arena, in BVH order
+    struct Plan_Bvh_Node *Nodes;
+    uint16_t Num_Boxes;
+    uint16_t Num_Nodes;
+};
+
+/*
+*   Tree node, joint angles and the node it grew from
+*/
+struct Plan_Node {
+    float Angles[4];
+    int32_t Parent;                     //-1 for a root
+};
+
+/*
+*   Planner for one arm in one scene. Create with Plan_Init()
+*/
+struct Planner {
+    const struct RobotArm *arm;
+    const struct Plan_Scene *scene;
+    struct Plan_Arena *arena;
+    struct IK_Joint_Limits Limits;
+    float Link_Radius[3];               //Upper arm, forearm and grabber
+    uint32_t Random;                    //xorshift32 state
+
+    //Last plan
+    uint32_t Iterations;
+    uint32_t Nodes;
+    uint32_t Checks;                    //Configurations checked for collision
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Use caller memory as an arena
+* @param[out]   arena - Arena to set up
+* @param[in]    memory - Memory, 8 byte aligned
+* @param[in]    size - Bytes at memory
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Plan_Arena_Init(struct Plan_Arena *arena, void *memory, uint32_t size);
+
+/**
+* @brief        Copy the boxes into the arena and build the BVH over them
+* @param[out]   scene - Scene to build
+* @param[in]    arena - Arena the scene lives in until it is reset
+* @param[in]    boxes - Fixtures, Min under Max on every axis
+* @param[in]    count - Number of boxes, 0 to PLAN_MAX_BOXES
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR, E_BAD_PARAM (bad box or too many) or E_NONE_AVAIL (arena too small)
+*/
+int Plan_Scene_Build(struct Plan_Scene *scene, struct Plan_Arena *arena, const struct Plan_Box *boxes, uint32_t count);
+
+/**
+* @brief        Set up a planner
+* @param[out]   planner - Planner to initialize
+* @param[in]    arm - Arm geometry (Arm_Init()), only read
+* @param[in]    scene - Built scene, only read
+* @param[in]    limits - Joint limits, random configurations are drawn from them
+* @param[in]    Link_Radius - Upper arm, forearm and grabber radius in units (3 floats)
+* @param[in]    arena - Arena the plans take their memory from
+* @param[in]    seed - Seed of the random configurations, not 0. The same seed plans the same path
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR or E_BAD_PARAM (Failure)
+*/
+int Plan_Init(struct Planner *planner, const struct RobotArm *arm, const struct Plan_Scene *scene, const struct IK_Joint_Limits *limits,
+              const float *Link_Radius, struct Plan_Arena *arena, uint32_t seed);
+
+/**
+* @brief        Is a configuration clear of the table and every fixture
+* @param[in]    angles - Base, Shoulder, Elbow and Wrist angles in degrees
+*
+* @return       1 clear, 0 in collision
+*/
+int Plan_Config_Free(struct Planner *planner, const float *angles);
+
+/**
+* @brief        Plan a collision free path in joint space from one configuration to another
+* @param[in]    planner - Planner
+* @param[in]    start - Base, Shoulder, Elbow and Wrist angles now
+* @param[in]    goal - Base, Shoulder, Elbow and Wrist angles to get to
+* @param[out]   waypoints - Path from start to goal, both included
+* @param[in]    max_waypoints - Room in waypoints
+*
+* @return       Number of waypoints (Success), E_NULL_PTR, E_BAD_PARAM (start or goal in collision), E_NONE_AVAIL
+*               (no path within PLAN_MAX_ITERATIONS, or the arena or waypoints ran out)
+*/
+int32_t Plan_Path(struct Planner *planner, const float *start, const float *goal, float (*waypoints)[4], uint32_t max_waypoints);
+
+/**
+* @brief        Plan_Path() to a grabber pose, to whichever branch of it (Arm_Solve_All()) the trees reach first
+* @param[in]    planner - Planner
+* @param[in]    start - Base, Shoulder, Elbow and Wrist angles now
+* @param[in]    x, y, z - Grabber position
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in degrees
+* @param[out]   waypoints - Path from start to the goal branch, both included
+* @param[in]    max_waypoints - Room in waypoints
+*
+* @return       Number of waypoints (Success), E_NULL_PTR, E_BAD_PARAM (start in collision, or no free branch),
+*               E_NONE_AVAIL or an error of Arm_Solve_All()
+*/
+int32_t Plan_To_Pose(struct Planner *planner, const float *start, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle,
+                     float (*waypoints)[4], uint32_t max_waypoints);
+
+
+
+#endif  /* _COORD_PLAN_H_ */
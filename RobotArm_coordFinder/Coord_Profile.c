@@ -0,0 +1,248 @@
+/**
+* @file             Coord_Profile.c
+* @brief            Plan and sample synchronized S-curve and trapezoid joint moves
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include <math.h>
+#include "Coord_Profile.h"
+
+
+/***** Definitions *****/
+
+#define PROFILE_MAX_SAMPLES     4000000000.0f   //Keeps the sample count inside uint32_t
+
+
+/***** Function Prototypes *****/
+static void Profile_Speed_Up(const struct Profile *profile, float time, float *s, float *speed, float *accel);
+static void Profile_Path(const struct Profile *profile, float time, float *s, float *rest, float *speed, float *accel);
+
+
+/***** Driver implementation *****/
+
+int Profile_Init(struct Profile *profile, void (*Output)(const struct Traj_Setpoint *setpoint)){
+    if(profile == NULL){
+        return(E_NULL_PTR);
+    }
+
+    profile->Output = Output;
+    profile->State = PROFILE_IDLE;
+    profile->Duration = 0;
+    profile->Samples = 0;
+    profile->Next_Sample = 0;
+
+    return(E_NO_ERROR);
+}
+
+int Profile_Move(struct Profile *profile, const float *from, const float *to, const struct Profile_Limits *limits){
+    float Speed = INFINITY, Accel = INFINITY, Jerk = INFINITY, distance;
+    float Jerk_Time, Accel_Time, Cruise_Time;
+
+    if(profile == NULL || from == NULL || to == NULL || limits == NULL){
+        return(E_NULL_PTR);
+    }
+    if(profile->State == PROFILE_RUNNING){
+        return(E_BUSY);
+    }
+
+    //Limits of each joint turned into limits of s. Written so NaN fails every test
+    for(int j = 0; j < 4; j++){
+        if(!(limits->Velocity[j] > 0) || !(limits->Acceleration[j] > 0) || !(limits->Jerk[j] >= 0) || from[j] != from[j] || to[j] != to[j]){
+            return(E_BAD_PARAM);
+        }
+        distance = fabsf(to[j] - from[j]);
+        if(distance > 0){
+            Speed = fminf(Speed, limits->Velocity[j] / distance);
+            Accel = fminf(Accel, limits->Acceleration[j] / distance);
+            if(limits->Jerk[j] > 0){
+                Jerk = fminf(Jerk, limits->Jerk[j] / distance);
+            }
+        }
+    }
+
+    if(isinf(Speed)){
+        //Nothing moves, the one sample is the end angles
+        Jerk = Accel = Speed = 0;
+        Jerk_Time = Accel_Time = Cruise_Time = 0;
+    }
+    else{
+        //Up to full speed: with the acceleration limit reached, or with the jerk phases meeting in the middle
+        if(isinf(Jerk)){
+            Jerk_Time = 0;
+            Accel_Time = Speed / Accel;
+        }
+        else if(Speed * Jerk >= Accel * Accel){
+            Jerk_Time = Accel / Jerk;
+            Accel_Time = Jerk_Time + Speed / Accel;
+        }
+        else{
+            Jerk_Time = sqrtf(Speed / Jerk);
+            Accel_Time = 2.0f * Jerk_Time;
+        }
+        Cruise_Time = 1.0f / Speed - Accel_Time;
+
+        //Too short to get to full speed: no cruise, and the highest speed is where the speed up meets the slow down
+        if(Cruise_Time < 0){
+            Cruise_Time = 0;
+            if(isinf(Jerk)){
+                Accel_Time = sqrtf(1.0f / Accel);
+            }
+            else{
+                Jerk_Time = Accel / Jerk;
+                Accel_Time = 0.5f * (Jerk_Time + sqrtf(Jerk_Time * Jerk_Time + 4.0f / Accel));
+
+                //Too short to get to full acceleration too
+                if(Accel_Time < 2.0f * Jerk_Time){
+                    Jerk_Time = cbrtf(0.5f / Jerk);
+                    Accel_Time = 2.0f * Jerk_Time;
+                }
+            }
+        }
+        if(isinf(Jerk)){
+            Jerk = 0;
+        }
+        else{
+            Accel = Jerk * Jerk_Time;
+        }
+        Speed = Accel * (Accel_Time - Jerk_Time);
+    }
+
+    if(!((2.0f * Accel_Time + Cruise_Time) * TRAJ_RATE_HZ < PROFILE_MAX_SAMPLES)){
+        return(E_BAD_PARAM);
+    }
+
+    for(int j = 0; j < 4; j++){
+        profile->From[j] = from[j];
+        profile->To[j] = to[j];
+        profile->Delta[j] = to[j] - from[j];
+    }
+    profile->Jerk = Jerk;
+    profile->Accel = Accel;
+    profile->Speed = Speed;
+    profile->Jerk_Time = Jerk_Time;
+    profile->Accel_Time = Accel_Time;
+    profile->Cruise_Time = Cruise_Time;
+    profile->Duration = 2.0f * Accel_Time + Cruise_Time;
+    profile->Samples = (uint32_t)ceilf(profile->Duration * TRAJ_RATE_HZ);
+    profile->Next_Sample = 0;
+
+    profile->State = PROFILE_RUNNING;
+    return(E_NO_ERROR);
+}
+
+int Profile_Evaluate(const struct Profile *profile, float time, float *angles, float *velocity, float *acceleration){
+    float s, rest, speed, accel;
+
+    if(profile == NULL || angles == NULL){
+        return(E_NULL_PTR);
+    }
+
+    //Work from the nearer end, so the angles land exactly on From and To and float rounding never takes a joint past one
+    Profile_Path(profile, time, &s, &rest, &speed, &accel);
+    for(int j = 0; j < 4; j++){
+        angles[j] = (s <= 0.5f) ? profile->From[j] + profile->Delta[j] * s : profile->To[j] - profile->Delta[j] * rest;
+        if(velocity != NULL){
+            velocity[j] = profile->Delta[j] * speed;
+        }
+        if(acceleration != NULL){
+            acceleration[j] = profile->Delta[j] * accel;
+        }
+    }
+
+    return(E_NO_ERROR);
+}
+
+int Profile_Sample(const struct Profile *profile, uint32_t sample, struct Traj_Setpoint *setpoint){
+    if(profile == NULL || setpoint == NULL){
+        return(E_NULL_PTR);
+    }
+
+    setpoint->Sample = sample;
+    if(sample >= profile->Samples){
+        for(int j = 0; j < 4; j++){
+            setpoint->Angles[j] = profile->To[j];
+        }
+        return(E_NO_ERROR);
+    }
+    return(Profile_Evaluate(profile, (float)sample * (1.0f / TRAJ_RATE_HZ), setpoint->Angles, NULL, NULL));
+}
+
+void Profile_Routine(struct Profile *profile){
+    struct Traj_Setpoint setpoint;
+
+    if(profile == NULL || profile->State != PROFILE_RUNNING){
+        return;
+    }
+
+    Profile_Sample(profile, profile->Next_Sample, &setpoint);
+    if(profile->Output != NULL){
+        profile->Output(&setpoint);
+    }
+
+    if(profile->Next_Sample >= profile->Samples){
+        profile->State = PROFILE_DONE;
+    }
+    else{
+        profile->Next_Sample++;
+    }
+}
+
+//s, its speed and its acceleration a time into the speed up (0 to Accel_Time)
+static void Profile_Speed_Up(const struct Profile *profile, float time, float *s, float *speed, float *accel){
+    float left;
+
+    if(time < profile->Jerk_Time){
+        //Jerk up
+        *s = profile->Jerk * time * time * time * (1.0f / 6.0f);
+        *speed = 0.5f * profile->Jerk * time * time;
+        *accel = profile->Jerk * time;
+    }
+    else if(time < profile->Accel_Time - profile->Jerk_Time){
+        //Constant acceleration
+        *s = profile->Accel * (1.0f / 6.0f) * (3.0f * time * time - 3.0f * profile->Jerk_Time * time + profile->Jerk_Time * profile->Jerk_Time);
+        *speed = profile->Accel * (time - 0.5f * profile->Jerk_Time);
+        *accel = profile->Accel;
+    }
+    else{
+        //Jerk down into full speed, worked back from the end of the speed up
+        left = profile->Accel_Time - time;
+        *s = profile->Speed * (0.5f * profile->Accel_Time - left) + profile->Jerk * left * left * left * (1.0f / 6.0f);
+        *speed = profile->Speed - 0.5f * profile->Jerk * left * left;
+        *accel = profile->Jerk * left;
+    }
+}
+
+//s(t) over the whole move, and rest = 1 - s without the rounding of the subtraction near the end. The slow down is the
+//speed up run backwards from the end
+static void Profile_Path(const struct Profile *profile, float time, float *s, float *rest, float *speed, float *accel){
+    float cruise_end = profile->Accel_Time + profile->Cruise_Time;
+
+    if(!(time > 0)){
+        *s = *speed = *accel = 0;
+        *rest = 1.0f;
+    }
+    else if(time >= profile->Duration){
+        *s = 1.0f;
+        *rest = *speed = *accel = 0;
+    }
+    else if(time < profile->Accel_Time){
+        Profile_Speed_Up(profile, time, s, speed, accel);
+        *rest = 1.0f - *s;
+    }
+    else if(time < cruise_end){
+        *s = profile->Speed * (0.5f * profile->Accel_Time + time - profile->Accel_Time);
+        *rest = profile->Speed * (0.5f * profile->Accel_Time + cruise_end - time);
+        *speed = profile->Speed;
+        *accel = 0;
+    }
+    else{
+        Profile_Speed_Up(profile, profile->Duration - time, rest, speed, accel);
+        *s = 1.0f - *rest;
+        *accel = -*accel;
+    }
+
+    *s = fminf(fmaxf(*s, 0.0f), 1.0f);
+    *rest = fminf(fmaxf(*rest, 0.0f), 1.0f);
+}
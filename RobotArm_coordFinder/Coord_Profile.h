@@ -0,0 +1,127 @@
+/**
+* @file             Coord_Profile.h
+* @brief            Time optimal joint moves under joint speed, acceleration and jerk limits, sampled for the servos
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_PROFILE_H_
+#define _COORD_PROFILE_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+#include "Coord_Trajectory.h"
+
+/* Glossary for Coord_Profile.h and Coord_Profile.c
+ *
+ *  Move           - Base, shoulder, elbow and wrist from one set of angles to another, starting and ending at rest.
+ *                   Every joint follows angle = From + (To - From) * s(t), a straight line in joint space, so all
+ *                   joints start and finish together and none can pass its end angle (s only rises, 0 to 1).
+ *  Path Limits    - The joint limits seen from s: speed limit of s = min over the moving joints of Velocity / |To -
+ *                   From|, and the same for acceleration and jerk. s(t) is the fastest profile under them, so the
+ *                   joint that binds in each phase runs at its limit and the move takes the least time the line
+ *                   allows.
+ *  S-curve        - s(t) in up to 7 phases: jerk up, constant acceleration, jerk down, cruise, and the same mirrored
+ *                   to stop. Short moves drop the cruise and then the constant acceleration. A Jerk limit of 0 on
+ *                   every joint gives a trapezoid (acceleration steps, no jerk phases).
+ *  Sample         - One setpoint every 1 / TRAJ_RATE_HZ seconds, the period of the servo routine, as the same
+ *                   struct Traj_Setpoint a path from Coord_Trajectory.c gives. The last sample is the end angles
+ *                   exactly. A sample is worked out straight from the time, so there is no ring to fill:
+ *
+ *      Profile_Init(&profile, Servo_Write);
+ *      scheduler_addroutine(SCHEDULER_MS(1), Profile_Routine, HIGH_PRIORITY_ROUTINE, 1, &profile);
+ *      Update_Grabber_Position(x, y, z, angle, results);
+ *      Profile_Move(&profile, from, results, &limits);
+ */
+
+/***** Definitions *****/
+
+/*
+*   Limits of the Base, Shoulder, Elbow and Wrist servos
+*/
+struct Profile_Limits {
+    float Velocity[4];                  //Degrees per second
+    float Acceleration[4];              //Degrees per second^2
+    float Jerk[4];                      //Degrees per second^3, 0 for no jerk limit
+};
+
+typedef enum {
+    PROFILE_IDLE = 0,                   //No move started
+    PROFILE_RUNNING,                    //Samples left to send
+    PROFILE_DONE                        //The last sample (the end angles) has been sent
+} Profile_State;
+
+/*
+*   One joint move and where Profile_Routine() is in it. Create with Profile_Init()
+*/
+struct Profile {
+    void (*Output)(const struct Traj_Setpoint *setpoint);      //Called by Profile_Routine() with every sample
+
+    volatile Profile_State State;
+    float From[4];
+    float Delta[4];                     //To - From
+    float To[4];
+
+    //s(t) with s from 0 to 1
+    float Jerk;                         //Jerk of s, 0 for a trapezoid
+    float Accel;                        //Highest acceleration of s
+    float Speed;                        //Highest speed of s
+    float Jerk_Time;                    //Length of each jerk phase
+    float Accel_Time;                   //Length of the speed up (jerk phases included), the slow down is the same
+    float Cruise_Time;
+    float Duration;                     //Seconds from start to stop
+
+    uint32_t Samples;                   //Last sample number, at or just after Duration
+    uint32_t Next_Sample;
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Set up an idle profile
+* @param[out]   profile - Profile to initialize
+* @param[in]    Output - Function Profile_Routine() hands each sample to, or NULL
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Profile_Init(struct Profile *profile, void (*Output)(const struct Traj_Setpoint *setpoint));
+
+/**
+* @brief        Plan the fastest move from one set of angles to another and start sending it
+* @param[in]    profile - Profile (not PROFILE_RUNNING)
+* @param[in]    from - Base, Shoulder, Elbow and Wrist angles now
+* @param[in]    to - Base, Shoulder, Elbow and Wrist angles to move to (the first 4 results of Arm_Solve())
+* @param[in]    limits - Joint limits, Velocity and Acceleration over 0 and Jerk 0 or over
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR, E_BAD_PARAM (bad limits, or an angle is NaN) or E_BUSY
+*/
+int Profile_Move(struct Profile *profile, const float *from, const float *to, const struct Profile_Limits *limits);
+
+/**
+* @brief        Angles, and optionally speeds and accelerations, of the planned move at a time
+* @param[in]    profile - Planned profile
+* @param[in]    time - Seconds from the start, clamped to 0 to Duration
+* @param[out]   angles - 4 angles in degrees
+* @param[out]   velocity - 4 joint speeds in degrees per second, or NULL
+* @param[out]   acceleration - 4 joint accelerations in degrees per second^2, or NULL
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Profile_Evaluate(const struct Profile *profile, float time, float *angles, float *velocity, float *acceleration);
+
+/**
+* @brief        Setpoint of one sample of the planned move, sample Samples and later are the end angles
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Profile_Sample(const struct Profile *profile, uint32_t sample, struct Traj_Setpoint *setpoint);
+
+/**
+* @brief        Servo routine: pass the next sample of a running move to profile->Output every call
+*/
+void Profile_Routine(struct Profile *profile);
+
+
+
+#endif  /* _COORD_PROFILE_H_ */
@@ -0,0 +1,108 @@
+/**
+* @file             Coord_Reach.c
+* @brief            Attach and look up reachability map images
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include "Coord_Reach.h"
+#include "Coord_Trig.h"
+
+
+/***** Definitions *****/
+
+#define REACH_CELLS_PER_BYTE    4
+#define REACH_CELL_MASK         0x3
+
+
+/***** Function Prototypes *****/
+static uint32_t Reach_Cell_Index(const struct Reach_Map_Header *header, uint32_t cx, uint32_t cy, uint32_t cz);
+
+
+/***** Driver implementation *****/
+
+uint32_t Reach_Map_Size(struct Reach_Map_Header *header){
+    uint32_t cells = (uint32_t)header->Cells[0] * header->Cells[1] * header->Cells[2];
+
+    header->Slice_Bytes = (cells + REACH_CELLS_PER_BYTE - 1) / REACH_CELLS_PER_BYTE;
+    return(sizeof(struct Reach_Map_Header) + header->Slice_Bytes * (header->Angled_Slices + header->Straight_Slice));
+}
+
+int Reach_Map_Attach(struct Reach_Map *map, const void *image, uint32_t size, const struct RobotArm *arm){
+    const struct Reach_Map_Header *header = (const struct Reach_Map_Header *)image;
+    struct Reach_Map_Header expected;
+
+    if(map == NULL || image == NULL || arm == NULL){
+        return(E_NULL_PTR);
+    }
+    if(size < sizeof(struct Reach_Map_Header) || header->Magic != REACH_MAP_MAGIC || header->Version != REACH_MAP_VERSION){
+        return(E_INVALID);
+    }
+
+    //Work the size out again rather than trust Slice_Bytes
+    expected = *header;
+    if(size < Reach_Map_Size(&expected) || expected.Slice_Bytes != header->Slice_Bytes){
+        return(E_INVALID);
+    }
+
+    if(header->Len_BaseToElbow != arm->Len_BaseToElbow || header->Len_ElbowToWrist != arm->Len_ElbowToWrist ||
+       header->Len_Wrist != arm->Len_Wrist || header->Trig != IK_TRIG){
+        return(E_BAD_PARAM);
+    }
+
+    map->header = header;
+    map->cells = (const uint8_t *)image + sizeof(struct Reach_Map_Header);
+    map->Slices_Per_Degree = (header->Angle_Step > 0) ? 1.0f / header->Angle_Step : 0;
+
+    return(E_NO_ERROR);
+}
+
+Reach_Result Reach_Map_Lookup(const struct Reach_Map *map, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle){
+    const struct Reach_Map_Header *header = map->header;
+    uint32_t cx = x >> header->Cell_Shift, cy = y >> header->Cell_Shift, cz = z >> header->Cell_Shift;
+    uint32_t slice, index;
+    float position;
+
+    if(Grabber_Angle > 90){
+        if(!header->Straight_Slice){
+            return(REACH_MAYBE);
+        }
+        slice = header->Angled_Slices;
+    }
+    else{
+        position = (Grabber_Angle - header->Angle_First) * map->Slices_Per_Degree;
+
+        //Written so NaN fails too
+        if(!(position > -0.5f && position < header->Angled_Slices - 0.5f)){
+            return(REACH_MAYBE);
+        }
+        slice = (uint32_t)(position + 0.5f);
+        if(!((position - (float)slice) * header->Angle_Step < REACH_ANGLE_TOL &&
+             ((float)slice - position) * header->Angle_Step < REACH_ANGLE_TOL)){
+            return(REACH_MAYBE);
+        }
+    }
+
+    //The map covers the whole reach of the arm, anything past its edge is out of reach
+    if(cx >= header->Cells[0] || cy >= header->Cells[1] || cz >= header->Cells[2]){
+        return(REACH_NO);
+    }
+
+    index = Reach_Cell_Index(header, cx, cy, cz);
+    return((Reach_Result)((map->cells[slice * header->Slice_Bytes + index / REACH_CELLS_PER_BYTE] >>
+                           ((index % REACH_CELLS_PER_BYTE) * 2)) & REACH_CELL_MASK));
+}
+
+void Reach_Map_Set(void *image, uint32_t slice, uint32_t cx, uint32_t cy, uint32_t cz, Reach_Result state){
+    const struct Reach_Map_Header *header = (const struct Reach_Map_Header *)image;
+    uint8_t *cell_bytes = (uint8_t *)image + sizeof(struct Reach_Map_Header) + slice * header->Slice_Bytes;
+    uint32_t index = Reach_Cell_Index(header, cx, cy, cz);
+    uint32_t shift = (index % REACH_CELLS_PER_BYTE) * 2;
+
+    cell_bytes[index / REACH_CELLS_PER_BYTE] = (uint8_t)((cell_bytes[index / REACH_CELLS_PER_BYTE] & ~(REACH_CELL_MASK << shift)) | ((uint32_t)state << shift));
+}
+
+static uint32_t Reach_Cell_Index(const struct Reach_Map_Header *header, uint32_t cx, uint32_t cy, uint32_t cz){
+    return((cz * header->Cells[1] + cy) * header->Cells[0] + cx);
+}
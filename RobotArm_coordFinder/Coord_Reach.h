@@ -0,0 +1,118 @@
+/**
+* @file             Coord_Reach.h
+* @brief            Precomputed workspace map: is a grabber position reachable, without solving
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_REACH_H_
+#define _COORD_REACH_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+
+/* Glossary for Coord_Reach.h and Coord_Reach.c
+ *
+ *  Map Image      - Header followed by the cells, built offline by reach_map_gen_host.c from Arm_Solve() itself.
+ *                   The same bytes work in place as a file mapped with mmap() on the host, or as the const array
+ *                   the generator writes as C source, which the linker puts in flash on the target. Nothing is copied
+ *                   or decoded when it is attached.
+ *  Cell           - Cube of 2^Cell_Shift units on a side. 2 bits each, 4 to a byte, x fastest then y then z:
+ *                      REACH_NO        no whole unit position in the cell is reachable
+ *                      REACH_YES       every whole unit position in the cell is reachable
+ *                      REACH_MAYBE     some are: solve to find out
+ *                   Arm_Solve() only takes whole units, so YES and NO are exact, not sampled. Positions past the
+ *                   edge of the map are out of reach of the arm the map was built for.
+ *  Slice          - All the cells for one grabber angle: Angle_First + i * Angle_Step, plus one more for grabber
+ *                   angles over 90 (straight wrist) when Straight_Slice is set. A grabber angle between slices
+ *                   answers REACH_MAYBE.
+ *
+ * A lookup is a shift per axis, one multiply for the grabber angle and one byte read. Planners reject NO, accept YES
+ * and only solve MAYBE, which is the thin shell of cells along the edge of the workspace.
+ */
+
+#define REACH_MAP_MAGIC         0x50414D52      //"RMAP"
+#define REACH_MAP_VERSION       1
+#define REACH_ANGLE_TOL         0.001f          //Degrees a grabber angle may be off a slice and still use it
+
+/***** Definitions *****/
+
+typedef enum {
+    REACH_NO = 0,
+    REACH_YES = 1,
+    REACH_MAYBE = 2
+} Reach_Result;
+
+/*
+*   Start of a map image. The cells follow straight after it, slice by slice
+*/
+struct Reach_Map_Header {
+    uint32_t Magic;
+    uint16_t Version;
+    uint8_t Cell_Shift;                 //Cells are 2^Cell_Shift units on a side
+    uint8_t Trig;                       //IK_TRIG of the solver the map was built with
+    uint16_t Cells[3];                  //Cells along x, y and z
+    uint16_t Angled_Slices;
+    uint16_t Len_BaseToElbow;           //Arm the map was built for
+    uint16_t Len_ElbowToWrist;
+    uint16_t Len_Wrist;
+    uint16_t Straight_Slice;            //1 if a slice for grabber angles over 90 follows the angled ones
+    float Angle_First;                  //Grabber angle of the first slice in degrees
+    float Angle_Step;
+    uint32_t Slice_Bytes;
+};
+
+/*
+*   Attached map. Create with Reach_Map_Attach()
+*/
+struct Reach_Map {
+    const struct Reach_Map_Header *header;
+    const uint8_t *cells;
+    float Slices_Per_Degree;
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Bytes a map image takes (header and cells)
+* @param[in]    header - Header with every field but Magic, Version and Slice_Bytes filled in
+*
+* @return       Size of the whole image. Slice_Bytes is set in header
+*/
+uint32_t Reach_Map_Size(struct Reach_Map_Header *header);
+
+/**
+* @brief        Check a map image and attach it for lookups. The image is used in place and has to stay valid
+* @param[out]   map - Map to attach
+* @param[in]    image - Map image, 4 byte aligned (a mapped file or a const array in flash)
+* @param[in]    size - Bytes available at image
+* @param[in]    arm - Arm the lookups are for, its link lengths have to match the map
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR, E_INVALID (not a map, wrong version or too short) or
+*               E_BAD_PARAM (built for a different arm or IK_TRIG backend)
+*/
+int Reach_Map_Attach(struct Reach_Map *map, const void *image, uint32_t size, const struct RobotArm *arm);
+
+/**
+* @brief        Is a grabber position reachable at a grabber angle
+* @param[in]    map - Attached map
+* @param[in]    x, y, z - Grabber position
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in degrees
+*
+* @return       REACH_NO, REACH_YES or REACH_MAYBE (edge cell, or a grabber angle the map has no slice for)
+*/
+Reach_Result Reach_Map_Lookup(const struct Reach_Map *map, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle);
+
+/**
+* @brief        Set the state of one cell while building a map image
+* @param[in]    image - Map image with its header filled in
+* @param[in]    slice - Slice index (the straight wrist slice is Angled_Slices)
+* @param[in]    cx, cy, cz - Cell
+* @param[in]    state - REACH_NO, REACH_YES or REACH_MAYBE
+*/
+void Reach_Map_Set(void *image, uint32_t slice, uint32_t cx, uint32_t cy, uint32_t cz, Reach_Result state);
+
+
+
+#endif  /* _COORD_REACH_H_ */
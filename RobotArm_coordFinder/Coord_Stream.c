@@ -0,0 +1,145 @@
+/**
+* @file             Coord_Stream.c
+* @brief            Lock free target ring and triple buffered solutions between a producer, the solver and the servo loop
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include <math.h>
+#include "Coord_Stream.h"
+#ifndef COORD_HOST
+#include "mxc_device.h"
+#endif
+
+
+/***** Definitions *****/
+
+/* A target has to be written before the head moves and read before the tail moves. Cortex-M4 does not reorder
+ * normal memory accesses, so on the target the barrier is there to stop the compiler from doing it */
+#ifdef COORD_HOST
+#define STREAM_BARRIER()        __sync_synchronize()
+#else
+#define STREAM_BARRIER()        __DMB()
+#endif
+
+//Swaps a buffer index with Middle. Acquire so the buffer taken is read after the swap, release so the one handed over
+//is written before it (LDREX/STREX on the Cortex-M4)
+#define STREAM_EXCHANGE(stream, index)  __atomic_exchange_n(&(stream)->Middle, (index), __ATOMIC_ACQ_REL)
+
+
+/***** Function Prototypes *****/
+static void Stream_Publish(struct IK_Stream *stream);
+
+
+/***** Driver implementation *****/
+
+int Stream_Init(struct IK_Stream *stream, const struct RobotArm *arm){
+    if(stream == NULL || arm == NULL){
+        return(E_NULL_PTR);
+    }
+
+    stream->arm = arm;
+    stream->Head = 0;
+    stream->Tail = 0;
+    for(int b = 0; b < 3; b++){
+        stream->Buffers[b].Number = 0;
+    }
+    stream->Back = 0;
+    stream->Middle = 1;
+    stream->Front = 2;
+    stream->Dropped = 0;
+    stream->Skipped = 0;
+    stream->Solved = 0;
+    stream->Unreachable = 0;
+
+    return(E_NO_ERROR);
+}
+
+int Stream_Push(struct IK_Stream *stream, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, uint32_t Stamp){
+    struct Stream_Target *target;
+    uint32_t head;
+
+    if(stream == NULL){
+        return(E_NULL_PTR);
+    }
+
+    head = stream->Head;
+    if(head - stream->Tail >= STREAM_RING_SLOTS){
+        stream->Dropped++;
+        return(E_BUSY);
+    }
+    target = &stream->Ring[head & (STREAM_RING_SLOTS - 1)];
+    target->x = x;
+    target->y = y;
+    target->z = z;
+    target->Grabber_Angle = Grabber_Angle;
+    target->Stamp = Stamp;
+
+    //Target has to be in memory before the solver can see the slot
+    STREAM_BARRIER();
+    stream->Head = head + 1;
+
+    return(E_NO_ERROR);
+}
+
+int Stream_Solve(struct IK_Stream *stream){
+    struct Stream_Target target;
+    struct Stream_Solution *solution;
+    uint32_t head, tail;
+
+    if(stream == NULL){
+        return(E_NULL_PTR);
+    }
+
+    head = stream->Head;
+    tail = stream->Tail;
+    if(head == tail){
+        return(0);
+    }
+
+    //Only the newest target is solved, every slot up to it is handed back at once
+    STREAM_BARRIER();
+    target = stream->Ring[(head - 1) & (STREAM_RING_SLOTS - 1)];
+    STREAM_BARRIER();
+    stream->Tail = head;
+    stream->Skipped += head - tail - 1;
+
+    solution = &stream->Buffers[stream->Back];
+    Arm_Solve(stream->arm, &stream->scratch, target.x, target.y, target.z, target.Grabber_Angle, solution->Angles);
+    if(isnan(solution->Angles[0]) || isnan(solution->Angles[1]) || isnan(solution->Angles[2])){
+        stream->Unreachable++;
+        return(E_INVALID);
+    }
+    solution->Stamp = target.Stamp;
+    solution->Number = ++stream->Solved;
+    Stream_Publish(stream);
+
+    return(1);
+}
+
+void Stream_Routine(struct IK_Stream *stream){
+    Stream_Solve(stream);
+}
+
+int Stream_Read(struct IK_Stream *stream, struct Stream_Solution *solution){
+    if(stream == NULL || solution == NULL){
+        return(E_NULL_PTR);
+    }
+
+    //Take the newest solution when there is one, otherwise keep reading the one already taken
+    if(__atomic_load_n(&stream->Middle, __ATOMIC_RELAXED) & STREAM_FRESH){
+        stream->Front = STREAM_EXCHANGE(stream, stream->Front) & STREAM_INDEX_MASK;
+    }
+    if(stream->Buffers[stream->Front].Number == 0){
+        return(E_NONE_AVAIL);
+    }
+    *solution = stream->Buffers[stream->Front];
+
+    return(E_NO_ERROR);
+}
+
+//Hand the finished Back buffer over as Middle and take the old Middle to write next
+static void Stream_Publish(struct IK_Stream *stream){
+    stream->Back = STREAM_EXCHANGE(stream, stream->Back | STREAM_FRESH) & STREAM_INDEX_MASK;
+}
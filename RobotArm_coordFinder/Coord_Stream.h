@@ -0,0 +1,138 @@
+/**
+* @file             Coord_Stream.h
+* @brief            Target ring in, latest joint solution out: IK between an asynchronous producer and the servo loop
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_STREAM_H_
+#define _COORD_STREAM_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+
+/* Glossary for Coord_Stream.h and Coord_Stream.c
+ *
+ *  Producer       - Whatever finds the grabber targets (vision, a host link). Stream_Push() is its only call. It can
+ *                   run from an interrupt or its own thread at any rate.
+ *  Target Ring    - STREAM_RING_SLOTS targets waiting to be solved, single producer and single consumer with free
+ *                   running indexes like the setpoint ring of Coord_Trajectory.h. A full ring refuses the target and
+ *                   counts it in Dropped, the producer never waits.
+ *  Solver         - Stream_Solve()/Stream_Routine(), the ring's only consumer. It empties the ring and solves only
+ *                   the newest target (the older ones are counted in Skipped, an arm chasing a moving target has no
+ *                   use for where it was). A reachable solution is published, an unreachable target leaves the last
+ *                   solution in place.
+ *  Triple Buffer  - Three solutions: one the solver writes (Back), one the servo loop reads (Front) and the latest
+ *                   published one in between (Middle). Publishing swaps Back with Middle and reading swaps Front
+ *                   with Middle, each one atomic exchange of a buffer index, so neither side waits for the other
+ *                   and the servo loop always sees all six angles of one solve. A seqlock would make the reader
+ *                   retry, which never ends when the servo loop preempts the solver in the middle of a write on one
+ *                   core.
+ *  Consumer       - The servo loop. Stream_Read() is its only call; Number tells a new solution from one it has
+ *                   already seen.
+ *
+ * The solver works on its own arm and scratch, never on the global Asimov, and each side only writes its own fields,
+ * so no side masks interrupts or takes a lock. With the scheduler:
+ *
+ *      Stream_Init(&stream, &arm);
+ *      scheduler_addroutine(SCHEDULER_MS(1), Servo_Routine, HIGH_PRIORITY_ROUTINE, 1, &stream);   //Calls Stream_Read()
+ *      scheduler_addroutine(SCHEDULER_MS(5), Stream_Routine, LOW_PRIORITY_ROUTINE, 1, &stream);
+ *      Camera interrupt:   Stream_Push(&stream, x, y, z, Grabber_Angle, frame);
+ */
+
+#ifndef STREAM_RING_SLOTS
+#define STREAM_RING_SLOTS       16          //Targets the ring holds (power of 2)
+#endif
+
+#if (STREAM_RING_SLOTS & (STREAM_RING_SLOTS - 1))
+#error "STREAM_RING_SLOTS must be a power of 2"
+#endif
+
+#define STREAM_FRESH            0x4         //Set in Middle when it holds a solution Front has not taken
+#define STREAM_INDEX_MASK       0x3
+
+/***** Definitions *****/
+
+struct Stream_Target {
+    uint16_t x;
+    uint16_t y;
+    uint16_t z;
+    float Grabber_Angle;
+    uint32_t Stamp;                     //From the producer (frame number, time), handed on with the solution
+};
+
+struct Stream_Solution {
+    float Angles[6];                    //Same order as Update_Grabber_Position() results
+    uint32_t Stamp;                     //Stamp of the target it solves
+    uint32_t Number;                    //Published solutions so far, this one included
+};
+
+/*
+*   One pipeline for one arm. Create with Stream_Init()
+*/
+struct IK_Stream {
+    const struct RobotArm *arm;
+    struct IK_Scratch scratch;
+
+    //Target ring, free running indexes (Head only written by the producer, Tail only by the solver)
+    struct Stream_Target Ring[STREAM_RING_SLOTS];
+    volatile uint32_t Head;
+    volatile uint32_t Tail;
+
+    //Triple buffer. Back is only used by the solver, Front only by the consumer, Middle is swapped by both
+    struct Stream_Solution Buffers[3];
+    uint32_t Back;
+    uint32_t Front;
+    uint32_t Middle;                    //Buffer index, with STREAM_FRESH
+
+    uint32_t Dropped;                   //Producer: targets refused by a full ring
+    uint32_t Skipped;                   //Solver: targets replaced by a newer one before they were solved
+    uint32_t Solved;                    //Solver: solutions published
+    uint32_t Unreachable;               //Solver: newest targets out of reach
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Set up an empty pipeline for an arm
+* @param[out]   stream - Pipeline to initialize
+* @param[in]    arm - Arm geometry (Arm_Init()), only read
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Stream_Init(struct IK_Stream *stream, const struct RobotArm *arm);
+
+/**
+* @brief        Producer: queue a grabber target
+* @param[in]    x, y, z - Grabber position
+* @param[in]    Grabber_Angle - Grabber angle from horizontal in degrees
+* @param[in]    Stamp - Passed on in the solution of this target
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR or E_BUSY (Ring full, counted in Dropped)
+*/
+int Stream_Push(struct IK_Stream *stream, uint16_t x, uint16_t y, uint16_t z, float Grabber_Angle, uint32_t Stamp);
+
+/**
+* @brief        Solver: take every queued target, solve the newest and publish it when it is reachable
+*
+* @return       1 published, 0 nothing queued, E_NULL_PTR or E_INVALID (newest target out of reach)
+*/
+int Stream_Solve(struct IK_Stream *stream);
+
+/**
+* @brief        Stream_Solve() as a routine
+*/
+void Stream_Routine(struct IK_Stream *stream);
+
+/**
+* @brief        Consumer: copy the latest published solution, never waits
+* @param[out]   solution - Latest solution
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR or E_NONE_AVAIL (nothing published yet)
+*/
+int Stream_Read(struct IK_Stream *stream, struct Stream_Solution *solution);
+
+
+
+#endif  /* _COORD_STREAM_H_ */
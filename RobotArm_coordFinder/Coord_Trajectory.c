@@ -0,0 +1,344 @@
+/**
+* @file             Coord_Trajectory.c
+* @brief            Line and arc paths sampled at TRAJ_RATE_HZ and solved into a setpoint ring
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <stddef.h>
+#include <math.h>
+#include "Coord_Trajectory.h"
+#ifndef COORD_HOST
+#include "mxc_device.h"
+#endif
+
+
+/***** Definitions *****/
+
+/* A setpoint has to be written before the head moves and read before the tail moves. Ring is not volatile, and
+ * Cortex-M4 does not reorder normal memory accesses, so on the target the barrier is there to stop the compiler */
+#ifdef COORD_HOST
+#define TRAJ_BARRIER()          __sync_synchronize()
+#else
+#define TRAJ_BARRIER()          __DMB()
+#endif
+
+#define TRAJ_MAX_COORD          65535.0f
+#define TRAJ_MAX_SAMPLES        4000000000.0f   //Keeps the sample count inside uint32_t
+
+
+/***** Function Prototypes *****/
+static int Traj_Pose_Valid(const struct Traj_Pose *pose);
+static int Traj_Start(struct Trajectory *traj, const struct Traj_Pose *start, const struct Traj_Pose *end, float Length, float Duration, float Speed);
+static int Traj_Solve_Sample(struct Trajectory *traj, float *angles);
+static void Traj_Advance(struct Trajectory *traj);
+
+
+/***** Driver implementation *****/
+
+int Traj_Init(struct Trajectory *traj, const struct RobotArm *arm, void (*Output)(const struct Traj_Setpoint *setpoint)){
+    if(traj == NULL || arm == NULL){
+        return(E_NULL_PTR);
+    }
+
+    traj->arm = arm;
+    traj->Output = Output;
+    traj->State = TRAJ_IDLE;
+    traj->Samples = 0;
+    traj->Next_Sample = 0;
+    traj->Have_Last = 0;
+    traj->Head = 0;
+    traj->Tail = 0;
+    traj->Solved = 0;
+    traj->Reused = 0;
+    traj->Underruns = 0;
+
+    return(E_NO_ERROR);
+}
+
+int Traj_Line(struct Trajectory *traj, const struct Traj_Pose *start, const struct Traj_Pose *end, float Duration, float Speed){
+    float delta[3];
+    int rslt;
+
+    if(traj == NULL || start == NULL || end == NULL){
+        return(E_NULL_PTR);
+    }
+    if(traj->State == TRAJ_RUNNING){
+        return(E_BUSY);
+    }
+
+    delta[0] = end->x - start->x;
+    delta[1] = end->y - start->y;
+    delta[2] = end->z - start->z;
+
+    if((rslt = Traj_Start(traj, start, end, sqrtf(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]), Duration, Speed)) != E_NO_ERROR){
+        return(rslt);
+    }
+
+    traj->Path = TRAJ_PATH_LINE;
+    for(int i = 0; i < 3; i++){
+        traj->Step[i] = delta[i] / (float)traj->Samples;
+    }
+
+    traj->State = TRAJ_RUNNING;
+    return(E_NO_ERROR);
+}
+
+int Traj_Arc(struct Trajectory *traj, const struct Traj_Pose *start, const struct Traj_Pose *end, const struct Traj_Pose *center, float Duration, float Speed){
+    float from[3], to[3], along_u = 0, along_v = 0, radius_to = 0, length_v = 0;
+    double sweep, step;
+    int rslt;
+
+    if(traj == NULL || start == NULL || end == NULL || center == NULL){
+        return(E_NULL_PTR);
+    }
+    if(traj->State == TRAJ_RUNNING){
+        return(E_BUSY);
+    }
+
+    from[0] = start->x - center->x;
+    from[1] = start->y - center->y;
+    from[2] = start->z - center->z;
+    to[0] = end->x - center->x;
+    to[1] = end->y - center->y;
+    to[2] = end->z - center->z;
+
+    //U points at the start, V is the part of the end direction square to U. Together they span the plane of the arc
+    traj->Radius = sqrtf(from[0] * from[0] + from[1] * from[1] + from[2] * from[2]);
+    if(!(traj->Radius >= TRAJ_ARC_RADIUS_TOL)){
+        return(E_BAD_PARAM);
+    }
+    for(int i = 0; i < 3; i++){
+        traj->Axis_U[i] = from[i] / traj->Radius;
+        along_u += to[i] * traj->Axis_U[i];
+        radius_to += to[i] * to[i];
+    }
+    radius_to = sqrtf(radius_to);
+    if(fabsf(radius_to - traj->Radius) > TRAJ_ARC_RADIUS_TOL){
+        return(E_BAD_PARAM);
+    }
+    for(int i = 0; i < 3; i++){
+        traj->Axis_V[i] = to[i] - along_u * traj->Axis_U[i];
+        length_v += traj->Axis_V[i] * traj->Axis_V[i];
+    }
+    length_v = sqrtf(length_v);
+
+    //End straight across from the start (or on top of it): no plane, or no arc
+    if(length_v < 1e-3f * traj->Radius){
+        return(E_BAD_PARAM);
+    }
+    for(int i = 0; i < 3; i++){
+        traj->Axis_V[i] /= length_v;
+        along_v += to[i] * traj->Axis_V[i];
+    }
+    sweep = atan2((double)along_v, (double)along_u);
+
+    if((rslt = Traj_Start(traj, start, end, traj->Radius * (float)sweep, Duration, Speed)) != E_NO_ERROR){
+        return(rslt);
+    }
+
+    traj->Path = TRAJ_PATH_ARC;
+    traj->Center[0] = center->x;
+    traj->Center[1] = center->y;
+    traj->Center[2] = center->z;
+    traj->Arc_Cos = 1.0f;
+    traj->Arc_Sin = 0.0f;
+
+    //Worked out once in double, every sample after this is a rotation by it
+    step = sweep / traj->Samples;
+    traj->Step_Cos = (float)cos(step);
+    traj->Step_Sin = (float)sin(step);
+    traj->Step_Rad = (float)step;
+
+    traj->State = TRAJ_RUNNING;
+    return(E_NO_ERROR);
+}
+
+int32_t Traj_Fill(struct Trajectory *traj){
+    struct Traj_Setpoint *setpoint;
+    int32_t added = 0;
+
+    if(traj == NULL){
+        return(E_NULL_PTR);
+    }
+
+    while(traj->State == TRAJ_RUNNING && (traj->Head - traj->Tail) < TRAJ_RING_SLOTS){
+        setpoint = &traj->Ring[traj->Head & (TRAJ_RING_SLOTS - 1)];
+
+        if(Traj_Solve_Sample(traj, setpoint->Angles) != E_NO_ERROR){
+            traj->State = TRAJ_FAULT;
+            return(E_INVALID);
+        }
+        setpoint->Sample = traj->Next_Sample;
+
+        //Setpoint has to be in memory before the consumer can see the slot
+        TRAJ_BARRIER();
+        traj->Head++;
+        added++;
+
+        Traj_Advance(traj);
+    }
+    return(added);
+}
+
+int Traj_Pop(struct Trajectory *traj, struct Traj_Setpoint *setpoint){
+    uint32_t tail;
+
+    if(traj == NULL || setpoint == NULL){
+        return(E_NULL_PTR);
+    }
+
+    tail = traj->Tail;
+    if(tail == traj->Head){
+        return(E_NONE_AVAIL);
+    }
+    TRAJ_BARRIER();
+    *setpoint = traj->Ring[tail & (TRAJ_RING_SLOTS - 1)];
+    TRAJ_BARRIER();
+    traj->Tail = tail + 1;
+
+    return(E_NO_ERROR);
+}
+
+void Traj_Routine(struct Trajectory *traj){
+    struct Traj_Setpoint setpoint;
+
+    if(Traj_Pop(traj, &setpoint) == E_NO_ERROR){
+        if(traj->Output != NULL){
+            traj->Output(&setpoint);
+        }
+    }
+    else if(traj != NULL && traj->State == TRAJ_RUNNING){
+        traj->Underruns++;
+    }
+}
+
+uint32_t Traj_Count(const struct Trajectory *traj){
+    return(traj->Head - traj->Tail);
+}
+
+static int Traj_Pose_Valid(const struct Traj_Pose *pose){
+    //Written so NaN fails every test
+    return(pose->x >= 0 && pose->x <= TRAJ_MAX_COORD && pose->y >= 0 && pose->y <= TRAJ_MAX_COORD &&
+           pose->z >= 0 && pose->z <= TRAJ_MAX_COORD && pose->Grabber_Angle == pose->Grabber_Angle);
+}
+
+//Checks and the state shared by both paths. Sets Samples, the first sample and the grabber angle steps
+static int Traj_Start(struct Trajectory *traj, const struct Traj_Pose *start, const struct Traj_Pose *end, float Length, float Duration, float Speed){
+    float samples;
+
+    if(!Traj_Pose_Valid(start) || !Traj_Pose_Valid(end)){
+        return(E_BAD_PARAM);
+    }
+
+    if(Duration == 0){
+        if(!(Speed > 0)){
+            return(E_BAD_PARAM);
+        }
+        Duration = Length / Speed;
+    }
+    if(!(Duration >= 0)){
+        return(E_BAD_PARAM);
+    }
+    samples = ceilf(Duration * TRAJ_RATE_HZ);
+    if(samples > TRAJ_MAX_SAMPLES){
+        return(E_BAD_PARAM);
+    }
+
+    traj->Samples = (samples < 1) ? 1 : (uint32_t)samples;
+    traj->Next_Sample = 0;
+    traj->End = *end;
+    traj->Position[0] = start->x;
+    traj->Position[1] = start->y;
+    traj->Position[2] = start->z;
+    traj->Grabber_Angle = start->Grabber_Angle;
+    traj->Grabber_Step = (end->Grabber_Angle - start->Grabber_Angle) / (float)traj->Samples;
+
+    return(E_NO_ERROR);
+}
+
+//Solve the path point of the next sample, or copy the previous angles if it lands on the same whole units
+static int Traj_Solve_Sample(struct Trajectory *traj, float *angles){
+    uint16_t target[3];
+    float results[6];
+
+    for(int i = 0; i < 3; i++){
+        if(!(traj->Position[i] >= 0 && traj->Position[i] <= TRAJ_MAX_COORD)){
+            return(E_INVALID);
+        }
+        target[i] = (uint16_t)(traj->Position[i] + 0.5f);
+    }
+
+    if(traj->Have_Last && target[0] == traj->Last_Target[0] && target[1] == traj->Last_Target[1] &&
+       target[2] == traj->Last_Target[2] && traj->Grabber_Angle == traj->Last_Grabber){
+        for(int j = 0; j < 4; j++){
+            angles[j] = traj->Last_Angles[j];
+        }
+        traj->Reused++;
+        return(E_NO_ERROR);
+    }
+
+    Arm_Solve(traj->arm, &traj->scratch, target[0], target[1], target[2], traj->Grabber_Angle, results);
+
+    //Arm_Solve() marks out of reach with NaN (and a target on the z axis has no base angle)
+    if(isnan(results[0]) || isnan(results[1]) || isnan(results[2])){
+        return(E_INVALID);
+    }
+
+    for(int j = 0; j < 4; j++){
+        angles[j] = results[j];
+        traj->Last_Angles[j] = results[j];
+    }
+    traj->Last_Target[0] = target[0];
+    traj->Last_Target[1] = target[1];
+    traj->Last_Target[2] = target[2];
+    traj->Last_Grabber = traj->Grabber_Angle;
+    traj->Have_Last = 1;
+    traj->Solved++;
+
+    return(E_NO_ERROR);
+}
+
+//Move Position and the grabber angle on to the next sample
+static void Traj_Advance(struct Trajectory *traj){
+    uint32_t sample = ++traj->Next_Sample;
+    float c, s;
+
+    if(sample > traj->Samples){
+        traj->State = TRAJ_DONE;
+        return;
+    }
+
+    //The last sample is the end pose itself, whatever rounding built up on the way
+    if(sample == traj->Samples){
+        traj->Position[0] = traj->End.x;
+        traj->Position[1] = traj->End.y;
+        traj->Position[2] = traj->End.z;
+        traj->Grabber_Angle = traj->End.Grabber_Angle;
+        return;
+    }
+
+    traj->Grabber_Angle += traj->Grabber_Step;
+
+    if(traj->Path == TRAJ_PATH_LINE){
+        traj->Position[0] += traj->Step[0];
+        traj->Position[1] += traj->Step[1];
+        traj->Position[2] += traj->Step[2];
+        return;
+    }
+
+    if((sample & (TRAJ_ARC_REANCHOR - 1)) == 0){
+        c = cosf(traj->Step_Rad * (float)sample);
+        s = sinf(traj->Step_Rad * (float)sample);
+    }
+    else{
+        c = traj->Arc_Cos * traj->Step_Cos - traj->Arc_Sin * traj->Step_Sin;
+        s = traj->Arc_Sin * traj->Step_Cos + traj->Arc_Cos * traj->Step_Sin;
+    }
+    traj->Arc_Cos = c;
+    traj->Arc_Sin = s;
+
+    for(int i = 0; i < 3; i++){
+        traj->Position[i] = traj->Center[i] + traj->Radius * (c * traj->Axis_U[i] + s * traj->Axis_V[i]);
+    }
+}
@@ -0,0 +1,197 @@
+/**
+* @file             Coord_Trajectory.h
+* @brief            Straight line and circular arc grabber paths, solved into a ring of joint setpoints
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_TRAJECTORY_H_
+#define _COORD_TRAJECTORY_H_
+
+#include <stdint.h>
+#include "Coord_Asimov.h"
+
+/* Glossary for Coord_Trajectory.h and Coord_Trajectory.c
+ *
+ *  Pose           - Grabber position and grabber angle (struct Traj_Pose). Positions are float so a path can move
+ *                   less than one unit per sample; each sample is rounded to whole units for Arm_Solve().
+ *  Path           - Traj_Line() or Traj_Arc() from a start pose to an end pose at constant speed, given either as
+ *                   a duration or as a speed along the path. Sample 0 is the start pose and the last sample is
+ *                   exactly the end pose. The grabber angle moves linearly over the same samples.
+ *  Sample         - One point of the path every 1 / TRAJ_RATE_HZ seconds, solved into a setpoint.
+ *  Setpoint Ring  - TRAJ_RING_SLOTS solved setpoints waiting for the servo routine. Traj_Fill() is the only
+ *                   producer and Traj_Routine()/Traj_Pop() the only consumer, so, like scheduler_queue.c, neither
+ *                   side masks interrupts.
+ *  Reuse          - Each sample carries on from the one before instead of starting over:
+ *                      Line    one add per axis (the step is worked out once when the path starts)
+ *                      Arc     one 2x2 rotation of the previous point, with an exact sin/cos every
+ *                              TRAJ_ARC_REANCHOR samples so rounding does not pile up
+ *                      Solve   a sample that rounds to the same whole units and grabber angle as the previous
+ *                              one copies the previous joint angles. Below TRAJ_RATE_HZ units per second
+ *                              (1 m/s in mm at 1 kHz) most samples do, and only the rest run Arm_Solve()
+ *
+ * Running a path with the scheduler: the servo routine runs every sample period and is never held up by a solve,
+ * the fill routine runs at a lower priority and keeps the ring topped up. TRAJ_RING_SLOTS samples is how far the
+ * fill routine may fall behind.
+ *
+ *      Traj_Init(&traj, &arm, Servo_Write);
+ *      scheduler_addroutine(SCHEDULER_MS(1), Traj_Routine, HIGH_PRIORITY_ROUTINE, 1, &traj);
+ *      scheduler_addroutine(SCHEDULER_MS(10), Traj_Fill, LOW_PRIORITY_ROUTINE, 1, &traj);
+ *      Traj_Line(&traj, &start, &end, 2.0f, 0);
+ *
+ * A path can be started as soon as Traj_Fill() has generated the last sample of the one before (TRAJ_DONE); its
+ * setpoints queue up behind the ones still in the ring.
+ */
+
+#ifndef TRAJ_RATE_HZ
+#define TRAJ_RATE_HZ            1000        //Samples per second, the period of the servo routine
+#endif
+#ifndef TRAJ_RING_SLOTS
+#define TRAJ_RING_SLOTS         64          //Setpoints the ring holds (power of 2)
+#endif
+#ifndef TRAJ_ARC_REANCHOR
+#define TRAJ_ARC_REANCHOR       64          //Arc samples between exact sin/cos (power of 2)
+#endif
+#define TRAJ_ARC_RADIUS_TOL     1.0f        //Units the end pose may be off the circle through the start pose
+
+#if (TRAJ_RING_SLOTS & (TRAJ_RING_SLOTS - 1)) || (TRAJ_ARC_REANCHOR & (TRAJ_ARC_REANCHOR - 1))
+#error "TRAJ_RING_SLOTS and TRAJ_ARC_REANCHOR must be powers of 2"
+#endif
+
+/***** Definitions *****/
+
+struct Traj_Pose {
+    float x;
+    float y;
+    float z;
+    float Grabber_Angle;                //Degrees from horizontal (over 90 leaves the wrist straight)
+};
+
+struct Traj_Setpoint {
+    float Angles[4];                    //Base, Shoulder, Elbow and Wrist angles in degrees
+    uint32_t Sample;                    //Sample number in its path, 0 is the start pose
+};
+
+typedef enum {
+    TRAJ_IDLE = 0,                      //No path started
+    TRAJ_RUNNING,                       //Samples left to generate
+    TRAJ_DONE,                          //Every sample of the path is in the ring (or already consumed)
+    TRAJ_FAULT                          //A sample was out of reach, the rest of the path was dropped
+} Traj_State;
+
+typedef enum {
+    TRAJ_PATH_LINE = 0,
+    TRAJ_PATH_ARC
+} Traj_Path;
+
+/*
+*   One stream of setpoints for one arm. Create with Traj_Init()
+*/
+struct Trajectory {
+    const struct RobotArm *arm;
+    struct IK_Scratch scratch;
+    void (*Output)(const struct Traj_Setpoint *setpoint);      //Called by Traj_Routine() with every setpoint
+
+    //Path, only written by the producer
+    volatile Traj_State State;
+    Traj_Path Path;
+    uint32_t Samples;                   //Last sample number of the path
+    uint32_t Next_Sample;
+    struct Traj_Pose End;
+    float Position[3];                  //Path point of the next sample
+    float Grabber_Angle;
+    float Grabber_Step;
+    float Step[3];                      //Line: added to Position every sample
+    float Center[3];                    //Arc: Position = Center + Radius * (Arc_Cos * Axis_U + Arc_Sin * Axis_V)
+    float Axis_U[3];
+    float Axis_V[3];
+    float Radius;
+    float Arc_Cos;
+    float Arc_Sin;
+    float Step_Cos;                     //Rotation by one sample
+    float Step_Sin;
+    float Step_Rad;
+
+    //Previous solution
+    uint8_t Have_Last;
+    uint16_t Last_Target[3];
+    float Last_Grabber;
+    float Last_Angles[4];
+
+    //Setpoint ring, free running indexes (Head only written by the producer, Tail only by the consumer)
+    struct Traj_Setpoint Ring[TRAJ_RING_SLOTS];
+    volatile uint32_t Head;
+    volatile uint32_t Tail;
+
+    uint32_t Solved;                    //Samples that ran Arm_Solve()
+    uint32_t Reused;                    //Samples that copied the previous solution
+    uint32_t Underruns;                 //Servo periods with an empty ring while a path was running
+};
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        Set up an empty trajectory for an arm
+* @param[out]   traj - Trajectory to initialize
+* @param[in]    arm - Arm geometry (Arm_Init()), only read
+* @param[in]    Output - Function Traj_Routine() hands each setpoint to, or NULL to only use Traj_Pop()
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR (Failure)
+*/
+int Traj_Init(struct Trajectory *traj, const struct RobotArm *arm, void (*Output)(const struct Traj_Setpoint *setpoint));
+
+/**
+* @brief        Start a straight line path
+* @param[in]    traj - Trajectory (not TRAJ_RUNNING)
+* @param[in]    start, end - Poses, x, y and z from 0 to 65535
+* @param[in]    Duration - Seconds from start to end, or 0 to use Speed
+* @param[in]    Speed - Units per second along the path, used when Duration is 0
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR, E_BAD_PARAM or E_BUSY (a path is still running)
+*/
+int Traj_Line(struct Trajectory *traj, const struct Traj_Pose *start, const struct Traj_Pose *end, float Duration, float Speed);
+
+/**
+* @brief        Start a circular arc path, the short way round the center from start to end
+* @param[in]    traj - Trajectory (not TRAJ_RUNNING)
+* @param[in]    start, end - Poses, x, y and z from 0 to 65535. end must be within TRAJ_ARC_RADIUS_TOL of the circle
+*               through start, and not straight across from it (the plane would be undefined)
+* @param[in]    center - Center of the circle (its Grabber_Angle is not used)
+* @param[in]    Duration - Seconds from start to end, or 0 to use Speed
+* @param[in]    Speed - Units per second along the arc, used when Duration is 0
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR, E_BAD_PARAM or E_BUSY (a path is still running)
+*/
+int Traj_Arc(struct Trajectory *traj, const struct Traj_Pose *start, const struct Traj_Pose *end, const struct Traj_Pose *center, float Duration, float Speed);
+
+/**
+* @brief        Solve samples of the running path into the ring until it is full or the path is done.
+*               Samples that leave 0 to 65535 or the reach of the arm stop the path with TRAJ_FAULT
+*
+* @return       Number of setpoints added (Success), E_NULL_PTR or E_INVALID (sample out of reach)
+*/
+int32_t Traj_Fill(struct Trajectory *traj);
+
+/**
+* @brief        Take the oldest setpoint out of the ring
+* @param[out]   setpoint - Copy of the setpoint
+*
+* @return       E_NO_ERROR (Success), E_NULL_PTR or E_NONE_AVAIL (Ring empty)
+*/
+int Traj_Pop(struct Trajectory *traj, struct Traj_Setpoint *setpoint);
+
+/**
+* @brief        Servo routine: pass one setpoint to traj->Output every call. Counts an underrun when the ring is
+*               empty while a path is running (the arm holds its last setpoint)
+*/
+void Traj_Routine(struct Trajectory *traj);
+
+/**
+* @brief        Number of setpoints waiting in the ring
+*/
+uint32_t Traj_Count(const struct Trajectory *traj);
+
+
+
+#endif  /* _COORD_TRAJECTORY_H_ */
@@ -0,0 +1,154 @@
+/**
+* @file             Coord_Trig.c
+* @brief            libm, minimax polynomial and table backends for the IK trig
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+#include <math.h>
+#include "Coord_Trig.h"
+
+
+/***** Definitions *****/
+
+#define TRIG_PI                 3.14159265358979f
+#define TRIG_DEG_PER_RAD        (180.0f / TRIG_PI)
+#define TRIG_RAD_PER_DEG        (TRIG_PI / 180.0f)
+
+//acos(a) = sqrt(1 - a) * (c0 + c1 a + c2 a^2 + c3 a^3) on [0, 1], minimax, in degrees. Max error 0.0022 degrees
+#define ACOS_C0                 (1.570758340e+00f * TRIG_DEG_PER_RAD)
+#define ACOS_C1                 (-2.128751817e-01f * TRIG_DEG_PER_RAD)
+#define ACOS_C2                 (7.689737898e-02f * TRIG_DEG_PER_RAD)
+#define ACOS_C3                 (-2.089203024e-02f * TRIG_DEG_PER_RAD)
+
+//sin(x) = x (s1 + s3 x^2 + s5 x^4) on [-pi/2, pi/2], minimax, with x in degrees. Max error 6.8e-5
+#define SIN_S1                  (9.996967737e-01f * TRIG_RAD_PER_DEG)
+#define SIN_S3                  (-1.656730800e-01f * TRIG_RAD_PER_DEG * TRIG_RAD_PER_DEG * TRIG_RAD_PER_DEG)
+#define SIN_S5                  (7.514377393e-03f * TRIG_RAD_PER_DEG * TRIG_RAD_PER_DEG * TRIG_RAD_PER_DEG * TRIG_RAD_PER_DEG * TRIG_RAD_PER_DEG)
+
+#define TRIG_LUT_SEGMENTS       64
+
+
+/***** Global Variables *****/
+
+//sin_table[i] = sin(90 * i / 64 degrees)
+static const float sin_table[TRIG_LUT_SEGMENTS + 1] = {
+    0.00000000f, 0.02454123f, 0.04906767f, 0.07356456f, 0.09801714f, 0.12241068f, 0.14673047f, 0.17096189f,
+    0.19509032f, 0.21910124f, 0.24298018f, 0.26671276f, 0.29028468f, 0.31368174f, 0.33688985f, 0.35989504f,
+    0.38268343f, 0.40524131f, 0.42755509f, 0.44961133f, 0.47139674f, 0.49289819f, 0.51410274f, 0.53499762f,
+    0.55557023f, 0.57580819f, 0.59569930f, 0.61523159f, 0.63439328f, 0.65317284f, 0.67155895f, 0.68954054f,
+    0.70710678f, 0.72424708f, 0.74095113f, 0.75720885f, 0.77301045f, 0.78834643f, 0.80320753f, 0.81758481f,
+    0.83146961f, 0.84485357f, 0.85772861f, 0.87008699f, 0.88192126f, 0.89322430f, 0.90398929f, 0.91420976f,
+    0.92387953f, 0.93299280f, 0.94154407f, 0.94952818f, 0.95694034f, 0.96377607f, 0.97003125f, 0.97570213f,
+    0.98078528f, 0.98527764f, 0.98917651f, 0.99247953f, 0.99518473f, 0.99729046f, 0.99879546f, 0.99969882f,
+    1.00000000f,
+};
+
+//acos_table[i] = acos(1 - (i / 64)^2) in degrees. Indexed by t = sqrt(1 - a), where acos is smooth enough to
+//interpolate all the way to a = 1 (in a itself the slope goes to infinity there)
+static const float acos_table[TRIG_LUT_SEGMENTS + 1] = {
+    0.00000000f, 1.26609558f, 2.53234575f, 3.79890528f, 5.06592926f, 6.33357331f, 7.60199373f, 8.87134769f,
+    10.14179337f, 11.41349019f, 12.68659898f, 13.96128216f, 15.23770391f, 16.51603045f, 17.79643014f, 19.07907378f,
+    20.36413481f, 21.65178949f, 22.94221722f, 24.23560074f, 25.53212640f, 26.83198443f, 28.13536927f, 29.44247982f,
+    30.75351981f, 32.06869809f, 33.38822904f, 34.71233294f, 36.04123634f, 37.37517256f, 38.71438210f, 40.05911314f,
+    41.40962211f, 42.76617421f, 44.12904404f, 45.49851627f, 46.87488633f, 48.25846118f, 49.64956014f, 51.04851578f,
+    52.45567490f, 53.87139959f, 55.29606837f, 56.73007748f, 58.17384222f, 59.62779849f, 61.09240442f, 62.56814223f,
+    64.05552023f, 65.55507504f, 67.06737407f, 68.59301829f, 70.13264524f, 71.68693248f, 73.25660146f, 74.84242175f,
+    76.44521596f, 78.06586523f, 79.70531544f, 81.36458437f, 83.04476981f, 84.74705894f, 86.47273911f, 88.22321035f,
+    90.00000000f,
+};
+
+
+/***** Function Prototypes *****/
+static float Trig_Fold_Deg(float degrees);
+static float Trig_Lerp(const float *table, float position);
+
+
+/***** Driver implementation *****/
+
+float Trig_Acos_Deg_Libm(float a){
+    return(acosf(a) * TRIG_DEG_PER_RAD);
+}
+
+float Trig_Sin_Deg_Libm(float degrees){
+    return(sinf(degrees * TRIG_RAD_PER_DEG));
+}
+
+float Trig_Cos_Deg_Libm(float degrees){
+    return(cosf(degrees * TRIG_RAD_PER_DEG));
+}
+
+float Trig_Acos_Deg_Poly(float a){
+    float abs_a = fabsf(a);
+    float result;
+
+    if(!(abs_a <= 1.0f)){
+        return(NAN);
+    }
+    result = sqrtf(1.0f - abs_a) * (ACOS_C0 + abs_a * (ACOS_C1 + abs_a * (ACOS_C2 + abs_a * ACOS_C3)));
+
+    //acos(-a) = 180 - acos(a)
+    return((a < 0) ? 180.0f - result : result);
+}
+
+float Trig_Sin_Deg_Poly(float degrees){
+    float x = Trig_Fold_Deg(degrees);
+    float x2 = x * x;
+
+    return(x * (SIN_S1 + x2 * (SIN_S3 + x2 * SIN_S5)));
+}
+
+float Trig_Cos_Deg_Poly(float degrees){
+    return(Trig_Sin_Deg_Poly(degrees + 90.0f));
+}
+
+float Trig_Acos_Deg_Lut(float a){
+    float abs_a = fabsf(a);
+    float result;
+
+    if(!(abs_a <= 1.0f)){
+        return(NAN);
+    }
+    result = Trig_Lerp(acos_table, sqrtf(1.0f - abs_a) * TRIG_LUT_SEGMENTS);
+    return((a < 0) ? 180.0f - result : result);
+}
+
+float Trig_Sin_Deg_Lut(float degrees){
+    float x = Trig_Fold_Deg(degrees);
+    float result = Trig_Lerp(sin_table, fabsf(x) * (TRIG_LUT_SEGMENTS / 90.0f));
+
+    return((x < 0) ? -result : result);
+}
+
+float Trig_Cos_Deg_Lut(float degrees){
+    return(Trig_Sin_Deg_Lut(degrees + 90.0f));
+}
+
+//Bring an angle into -90 to 90 degrees with the same sine: wrap into -180 to 180, then sin(180 - a) = sin(a)
+static float Trig_Fold_Deg(float degrees){
+    int32_t turns = (int32_t)(degrees * (1.0f / 360.0f) + ((degrees < 0) ? -0.5f : 0.5f));      //Round to nearest, no floorf call
+    float x = degrees - 360.0f * (float)turns;
+
+    if(x > 90.0f){
+        x = 180.0f - x;
+    }
+    else if(x < -90.0f){
+        x = -180.0f - x;
+    }
+    return(x);
+}
+
+//Linear interpolation between table[i] and table[i + 1], position from 0 to TRIG_LUT_SEGMENTS
+static float Trig_Lerp(const float *table, float position){
+    int32_t index;
+
+    //NaN in, NaN out (the base angle of a target on the z axis), and never index with it
+    if(!(position >= 0.0f)){
+        return(NAN);
+    }
+    index = (int32_t)position;
+    if(index >= TRIG_LUT_SEGMENTS){
+        return(table[TRIG_LUT_SEGMENTS]);
+    }
+    return(table[index] + (position - (float)index) * (table[index + 1] - table[index]));
+}
@@ -0,0 +1,86 @@
+/**
+* @file             Coord_Trig.h
+* @brief            acos, sin and cos in degrees for the IK solver, with a choice of libm, polynomial or table
+* @version          1.0.0
+* @notes
+*****************************************************************************/
+
+/* Define to prevent redundant inclusion */
+#ifndef _COORD_TRIG_H_
+#define _COORD_TRIG_H_
+
+#include <stdint.h>
+
+/* Glossary for Coord_Trig.h and Coord_Trig.c
+ *
+ *  Backend        - Set with -DIK_TRIG=... at build time. Trig_Acos_Deg(), Trig_Sin_Deg() and Trig_Cos_Deg() go to
+ *                   the chosen one, and every backend can also be called by name (bench_ik_trig.c compares them).
+ *                      IK_TRIG_LIBM    acosf, sinf and cosf with the degree conversion (default)
+ *                      IK_TRIG_POLY    Minimax polynomials with the degree conversion folded into the coefficients
+ *                      IK_TRIG_LUT     64 segment tables with linear interpolation
+ *  Degrees        - The solver works in degrees, so each function takes or returns degrees directly and the
+ *                   radian round trips of RadToDeg()/DegToRad() go away.
+ *  Error Budget   - IK_TRIG_BUDGET_DEG. A 180 degree servo driven in 1 us steps over a 1000 us pulse range moves
+ *                   0.18 degrees per step, and a 12-bit PWM over the same range 0.044 degrees. Each function stays
+ *                   under 0.01 degrees (sin and cos: 1.7e-4 of value, 0.01 degrees of angle), so even the two acos
+ *                   that add up in the shoulder angle stay under a quarter of the finest servo step.
+ *
+ * Worst case error against double precision (bench_ik_trig.c):
+ *                      acos                sin, cos
+ *      IK_TRIG_LIBM    0.00003 deg         2.9e-7
+ *      IK_TRIG_POLY    0.0022 deg          6.8e-5 (0.0039 deg)
+ *      IK_TRIG_LUT     0.0034 deg          7.5e-5 (0.0043 deg)
+ * The solver rounds the wrist offset to whole units, so a target whose offset sits within about 1e-4 of a .5 can
+ * round the other way with a fast backend. Near a straight elbow that one unit moves the joints by more than the
+ * budget, the same as any other change of rounding.
+ */
+
+#define IK_TRIG_LIBM            0
+#define IK_TRIG_POLY            1
+#define IK_TRIG_LUT             2
+
+#ifndef IK_TRIG
+#define IK_TRIG                 IK_TRIG_LIBM
+#endif
+
+#define IK_TRIG_BUDGET_DEG      0.01f       //Largest error allowed from any backend, see Error Budget above
+
+/***** Function Prototypes *****/
+
+/**
+* @brief        acos in degrees
+* @param[in]    a - Cosine, -1 to 1 (anything else returns NaN like acosf, the solver uses that as out of reach)
+*
+* @return       0 to 180 degrees
+*/
+float Trig_Acos_Deg_Libm(float a);
+float Trig_Acos_Deg_Poly(float a);
+float Trig_Acos_Deg_Lut(float a);
+
+/**
+* @brief        sin and cos of an angle in degrees (any value, accurate to the budget within +-3600 degrees)
+*/
+float Trig_Sin_Deg_Libm(float degrees);
+float Trig_Sin_Deg_Poly(float degrees);
+float Trig_Sin_Deg_Lut(float degrees);
+float Trig_Cos_Deg_Libm(float degrees);
+float Trig_Cos_Deg_Poly(float degrees);
+float Trig_Cos_Deg_Lut(float degrees);
+
+#if IK_TRIG == IK_TRIG_POLY
+#define Trig_Acos_Deg(a)        Trig_Acos_Deg_Poly(a)
+#define Trig_Sin_Deg(a)         Trig_Sin_Deg_Poly(a)
+#define Trig_Cos_Deg(a)         Trig_Cos_Deg_Poly(a)
+#elif IK_TRIG == IK_TRIG_LUT
+#define Trig_Acos_Deg(a)        Trig_Acos_Deg_Lut(a)
+#define Trig_Sin_Deg(a)         Trig_Sin_Deg_Lut(a)
+#define Trig_Cos_Deg(a)         Trig_Cos_Deg_Lut(a)
+#else
+#define Trig_Acos_Deg(a)        Trig_Acos_Deg_Libm(a)
+#define Trig_Sin_Deg(a)         Trig_Sin_Deg_Libm(a)
+#define Trig_Cos_Deg(a)         Trig_Cos_Deg_Libm(a)
+#endif
+
+
+
+#endif  /* _COORD_TRIG_H_ */
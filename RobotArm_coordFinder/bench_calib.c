@@ -0,0 +1,171 @@
+/**
+ * @file    bench_calib.c
+ * @brief   Link length and joint offset calibration (Coord_Calib.c) on simulated measurements: fit, time and tip error
+ * @details Target build: add bench_calib.c, Coord_Calib.c, Coord_Asimov.c and Coord_Trig.c to the project. The time
+ *          of a fit is counted with the DWT cycle counter, so fits of many seconds still fit in 32 bits.
+ *          Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_calib.c Coord_Calib.c Coord_Asimov.c Coord_Trig.c -lm -o bench_calib
+ *
+ *          The arm really is true_lengths and true_offsets but was measured by hand as BENCH_LINK_1/2/WRIST
+ *          (bench_common.h) with no offsets.
+ *          Random poses over the joint ranges are "measured" by placing the true tip and adding BENCH_NOISE units of
+ *          Gaussian noise to each axis. The fit and Calib_Apply() are run on 100 to BENCH_MAX_SAMPLES samples. Then BENCH_CHECKS
+ *          random targets are solved with the hand measured arm and with the calibrated one (with
+ *          Calib_Servo_Angles()), and the true arm is moved to the angles sent: the distance from the target is the
+ *          grabber error each way. Arm_Solve() takes whole units, so even a perfect calibration is left with some.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "Coord_Asimov.h"
+#include "Coord_Calib.h"
+#define BENCH_USE_DWT                   //Fits run longer than 2^24 cycles
+#include "bench_common.h"
+
+#define BENCH_MAX_SAMPLES   500
+#define BENCH_CHECKS        1000
+#define BENCH_NOISE         0.5f        //Units, standard deviation of each measured axis
+
+//The arm as it really is
+static const float true_lengths[3] = { 123.4f, 117.2f, 62.7f };
+static const float true_offsets[4] = { 2.0f, -1.5f, 2.5f, -3.0f };
+
+static const uint32_t sample_counts[] = { 100, 300, BENCH_MAX_SAMPLES };
+
+static struct Calib_Sample samples[BENCH_MAX_SAMPLES];
+static uint32_t seed = 11;
+
+#ifdef COORD_HOST
+#define BENCH_MS(elapsed)           ((elapsed) * 1e-6)
+#else
+#define BENCH_MS(elapsed)           ((elapsed) * 1e3 / SystemCoreClock)
+#endif
+
+static float Random_Uniform(float low, float high){
+    seed = seed * 1664525u + 1013904223u;
+    return(low + (high - low) * (float)(seed >> 8) * (1.0f / 16777216.0f));
+}
+
+static float Random_Gaussian(void){
+    float u = Random_Uniform(1e-7f, 1.0f), v = Random_Uniform(0.0f, 1.0f);
+    return(sqrtf(-2.0f * logf(u)) * cosf(6.2831853f * v));
+}
+
+//Tip of the true arm for the angles sent, in double
+static void True_Tip(const float *angles, double *tip){
+    const double k = 3.14159265358979323846 / 180.0;
+    double base = (angles[0] + true_offsets[0]) * k;
+    double shoulder = (angles[1] + true_offsets[1]) * k;
+    double forearm = shoulder + (angles[2] + true_offsets[2] - 180.0) * k;
+    double wrist = (angles[3] + true_offsets[3]) * k;
+    double reach = true_lengths[0] * cos(shoulder) + true_lengths[1] * cos(forearm) + true_lengths[2] * sin(wrist);
+
+    tip[0] = reach * cos(base);
+    tip[1] = reach * sin(base);
+    tip[2] = true_lengths[0] * sin(shoulder) + true_lengths[1] * sin(forearm) - true_lengths[2] * cos(wrist);
+}
+
+//Mean and worst grabber error over BENCH_CHECKS targets, solved with arm and sent through calibration (or as is)
+static void Check_Targets(const struct RobotArm *arm, const struct Arm_Calibration *calibration, float *mean, float *worst){
+    struct IK_Scratch scratch;
+    float results[6], servo[4];
+    double tip[3], total = 0;
+    uint32_t checked = 0;
+
+    seed = 99;
+    *worst = 0;
+    while(checked < BENCH_CHECKS){
+        uint16_t x = (uint16_t)Random_Uniform(40, 200), y = (uint16_t)Random_Uniform(40, 200), z = (uint16_t)Random_Uniform(0, 150);
+        float grabber = (float)(int)Random_Uniform(0, 91);
+
+        Arm_Solve(arm, &scratch, x, y, z, grabber, results);
+        if(isnan(results[0]) || isnan(results[1]) || isnan(results[2])){
+            continue;
+        }
+        if(calibration != NULL){
+            Calib_Servo_Angles(calibration, results, servo);
+        }
+        else{
+            for(int j = 0; j < 4; j++) servo[j] = results[j];
+        }
+        True_Tip(servo, tip);
+
+        float error = (float)sqrt((tip[0] - x) * (tip[0] - x) + (tip[1] - y) * (tip[1] - y) + (tip[2] - z) * (tip[2] - z));
+        total += error;
+        if(error > *worst) *worst = error;
+        checked++;
+    }
+    *mean = (float)(total / checked);
+}
+
+int main(void){
+    struct RobotArm hand, calibrated;
+    struct Arm_Calibration calibration;
+    double tip[3];
+    float mean, worst;
+    char label[40];
+
+    Bench_Init();
+
+    //Measured poses over the joint ranges
+    for(uint32_t s = 0; s < BENCH_MAX_SAMPLES; s++){
+        samples[s].Angles[0] = Random_Uniform(0, 180);
+        samples[s].Angles[1] = Random_Uniform(10, 170);
+        samples[s].Angles[2] = Random_Uniform(40, 320);
+        samples[s].Angles[3] = Random_Uniform(-90, 90);
+        True_Tip(samples[s].Angles, tip);
+        for(int k = 0; k < 3; k++){
+            samples[s].Position[k] = (float)tip[k] + BENCH_NOISE * Random_Gaussian();
+        }
+    }
+
+    Arm_Init(&hand, BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+    printf("True arm %.1f/%.1f/%.1f, offsets %.1f/%.1f/%.1f/%.1f deg, hand measured %u/%u/%u, noise %.2f units\n\n",
+           true_lengths[0], true_lengths[1], true_lengths[2], true_offsets[0], true_offsets[1], true_offsets[2], true_offsets[3],
+           BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST, BENCH_NOISE);
+    printf("Samples  Iter  ms       RMS before  RMS after  L1       L2       Wrist   Base   Shldr  Elbow  Wrist  RMS whole units\n");
+
+    for(uint32_t n = 0; n < sizeof(sample_counts) / sizeof(sample_counts[0]); n++){
+        uint32_t count = sample_counts[n], start, elapsed;
+        float before, after;
+        int rslt;
+
+        Calib_Init(&calibration, &hand);
+        start = Bench_Now();
+        rslt = Calib_Fit(&calibration, samples, count, CALIB_FIT_ALL);
+        elapsed = BENCH_ELAPSED(start, Bench_Now());
+        if(rslt != E_NO_ERROR){
+            printf("Fit failed (%d)\n", rslt);
+            return(1);
+        }
+        before = calibration.RMS_Before;
+        after = calibration.RMS_After;
+        printf("%-7u  %-4u  %-7.2f  %-10.3f  %-9.3f  %-7.2f  %-7.2f  %-6.2f  %-5.2f  %-5.2f  %-5.2f  %-5.2f  ", count,
+               calibration.Iterations, BENCH_MS(elapsed), before, after, calibration.Lengths[0], calibration.Lengths[1],
+               calibration.Lengths[2], calibration.Offsets[0], calibration.Offsets[1], calibration.Offsets[2], calibration.Offsets[3]);
+
+        calibrated = hand;
+        if(Calib_Apply(&calibration, &calibrated, samples, count) != E_NO_ERROR){
+            printf("\nApply failed\n");
+            return(1);
+        }
+        printf("%.3f\n", calibration.RMS_After);
+    }
+
+    //The last calibration against the hand measurement, on targets the fit never saw
+    Check_Targets(&hand, NULL, &mean, &worst);
+    printf("\nGrabber error over %u targets   Mean    Worst\n", BENCH_CHECKS);
+    printf("%-32s  %-6.2f  %.2f\n", "Hand measured", mean, worst);
+    Check_Targets(&calibrated, &calibration, &mean, &worst);
+    snprintf(label, sizeof(label), "Calibrated %u/%u/%u", calibrated.Len_BaseToElbow, calibrated.Len_ElbowToWrist, calibrated.Len_Wrist);
+    printf("%-32s  %-6.2f  %.2f\n", label, mean, worst);
+
+#ifndef COORD_HOST
+    while(1) {
+
+    }
+#endif
+    return(0);
+}
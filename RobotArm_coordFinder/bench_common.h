@@ -0,0 +1,78 @@
+/**
+ * @file    bench_common.h
+ * @brief   Timer, target start up and the reference arm shared by the bench_*.c programs
+ * @details Every benchmark includes this header instead of keeping its own copy. Built with -DCOORD_HOST the
+ *          timer is CLOCK_MONOTONIC in nanoseconds. On the target it is SysTick counting down from 0xFFFFFF at the
+ *          core clock, so each timed stretch has to stay under 2^24 cycles; SysTick is also there on a Cortex-M0+.
+ *          Define BENCH_USE_DWT before the include to count with the 32-bit DWT cycle counter instead, for
+ *          stretches of many seconds on a Cortex-M3/M4.
+ *
+ *          Call Bench_Init() first thing in main(). On the target it waits for the debugger and starts the counter.
+ */
+
+/* Define to prevent redundant inclusion */
+#ifndef _BENCH_COMMON_H_
+#define _BENCH_COMMON_H_
+
+#include <stdint.h>
+#ifdef COORD_HOST
+#include <time.h>
+#else
+#include "mxc_device.h"
+#include "mxc_delay.h"
+#endif
+
+//The arm most of the benchmarks run on
+#define BENCH_LINK_1        120         //Shoulder to elbow
+#define BENCH_LINK_2        120         //Elbow to wrist
+#define BENCH_LINK_WRIST    60          //Wrist to grabber tip
+
+#ifdef COORD_HOST
+//Wraps every 4.3 seconds, BENCH_ELAPSED() is right across one wrap
+static inline uint32_t Bench_Now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec));
+}
+#define BENCH_ELAPSED(start, end)   ((end) - (start))
+#define BENCH_UNIT                  "ns"
+
+//For the host only benchmarks that time whole runs
+static inline double Bench_Seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((double)ts.tv_sec + (double)ts.tv_nsec * 1e-9);
+}
+#elif defined(BENCH_USE_DWT)
+static inline uint32_t Bench_Now(void){
+    return(DWT->CYCCNT);
+}
+#define BENCH_ELAPSED(start, end)   ((end) - (start))
+#define BENCH_UNIT                  "cycles"
+#else
+//SysTick counts down from 0xFFFFFF at the core clock
+static inline uint32_t Bench_Now(void){
+    return(SysTick->VAL);
+}
+#define BENCH_ELAPSED(start, end)   (((start) - (end)) & 0xFFFFFF)
+#define BENCH_UNIT                  "cycles"
+#endif
+
+static inline void Bench_Init(void){
+#ifndef COORD_HOST
+    MXC_Delay(MXC_DELAY_SEC(2)); // Create window for debugger to connect after reset
+#ifdef BENCH_USE_DWT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#else
+    SysTick->LOAD = 0xFFFFFF;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+#endif
+#endif
+}
+
+
+
+#endif  /* _BENCH_COMMON_H_ */
@@ -0,0 +1,172 @@
+/**
+ * @file    bench_fleet.c
+ * @brief   Scaling of Fleet_Solve() (Coord_Fleet.c) from 1 to N threads against solving the arms one by one
+ * @details Host build, for example:
+ *              gcc -O2 -mavx2 -mfma -DCOORD_HOST -I. bench_fleet.c Coord_Fleet.c Coord_Batch.c Coord_Asimov.c Coord_Trig.c -lm -lpthread -o bench_fleet
+ *              ./bench_fleet [max threads]
+ *          BENCH_ARMS arms, each with its own link lengths, get BENCH_TARGETS_MIN to BENCH_TARGETS_MAX random targets
+ *          around their reach. The baseline is what a simulator on the global arm has to do: Init_Coords() for each
+ *          arm, then Update_Grabber_Position() for each of its targets. The fleet is then solved with 1 to max threads
+ *          (the number of cores by default), best of BENCH_PASSES each. Every thread count must give the same bits as
+ *          1 thread, and the reachable angles are compared with Arm_Solve() on the arm's own geometry.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "Coord_Asimov.h"
+#include "Coord_Fleet.h"
+#include "bench_common.h"
+
+#define BENCH_ARMS          64
+#define BENCH_TARGETS_MIN   2048
+#define BENCH_TARGETS_MAX   8192
+#define BENCH_PASSES        10
+#define BENCH_TOLERANCE     0.01f       //Degrees, differences above this are counted as mismatches
+
+static struct RobotArm arms[BENCH_ARMS];
+static struct Fleet_Batch batches[BENCH_ARMS];
+static uint32_t counts[BENCH_ARMS];
+
+int main(int argc, char **argv){
+    struct Fleet fleet;
+    struct IK_Scratch scratch;
+    struct IK_Batch_Angles angles, reference;
+    uint16_t *x, *y, *z;
+    float *grabber, *one_thread, results[6];
+    uint32_t *reachable, *reachable_one;
+    uint32_t entries, targets = 0, seed = 3, max_threads, compared = 0, mismatched = 0;
+    int32_t num_reachable = 0;
+    double start, elapsed, serial, single = 0;
+    volatile float sink = 0;
+
+    max_threads = (argc > 1) ? (uint32_t)atoi(argv[1]) : (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    if(max_threads < 1) max_threads = 1;
+    if(max_threads > FLEET_MAX_THREADS) max_threads = FLEET_MAX_THREADS;
+
+    //Arms from 80/80/30 up to 200/200/80, each with its own batch size
+    for(uint32_t a = 0; a < BENCH_ARMS; a++){
+        seed = seed * 1664525u + 1013904223u;
+        Arm_Init(&arms[a], (uint16_t)(80 + (seed >> 8) % 121), (uint16_t)(80 + (seed >> 16) % 121), (uint16_t)(30 + (seed >> 4) % 51));
+        seed = seed * 1664525u + 1013904223u;
+        counts[a] = BENCH_TARGETS_MIN + (seed >> 8) % (BENCH_TARGETS_MAX - BENCH_TARGETS_MIN + 1);
+        targets += counts[a];
+    }
+    entries = Fleet_Layout(batches, counts, BENCH_ARMS);
+
+    x = malloc(entries * sizeof(*x));
+    y = malloc(entries * sizeof(*y));
+    z = malloc(entries * sizeof(*z));
+    grabber = malloc(entries * sizeof(*grabber));
+    one_thread = malloc(4 * entries * sizeof(*one_thread));
+    reachable = calloc(IK_BATCH_WORDS(entries), sizeof(*reachable));
+    reachable_one = calloc(IK_BATCH_WORDS(entries), sizeof(*reachable_one));
+    angles.Base = calloc(4 * entries, sizeof(float));
+    if(!x || !y || !z || !grabber || !one_thread || !reachable || !reachable_one || !angles.Base){
+        printf("Out of memory\n");
+        return(1);
+    }
+    angles.Shoulder = angles.Base + entries;
+    angles.Elbow = angles.Base + 2 * entries;
+    angles.Wrist = angles.Base + 3 * entries;
+    reference.Base = one_thread;
+    reference.Shoulder = one_thread + entries;
+    reference.Elbow = one_thread + 2 * entries;
+    reference.Wrist = one_thread + 3 * entries;
+
+    //Targets out to a bit past each arm's reach, so some are unreachable
+    srand(1);
+    for(uint32_t a = 0; a < BENCH_ARMS; a++){
+        uint32_t reach = arms[a].Len_BaseToElbow + arms[a].Len_ElbowToWrist + arms[a].Len_Wrist;
+        for(uint32_t i = batches[a].First; i < batches[a].First + batches[a].Count; i++){
+            x[i] = (uint16_t)(rand() % reach);
+            y[i] = (uint16_t)(rand() % reach);
+            z[i] = (uint16_t)(rand() % reach);
+            grabber[i] = (float)(rand() % 91);
+        }
+    }
+    Fleet_Init(&fleet, arms, batches, BENCH_ARMS, x, y, z, grabber, &angles, reachable);
+
+    //Baseline: one arm after another through the global arm
+    serial = INFINITY;
+    for(uint32_t pass = 0; pass < BENCH_PASSES; pass++){
+        start = Bench_Seconds();
+        for(uint32_t a = 0; a < BENCH_ARMS; a++){
+            Init_Coords(arms[a].Len_BaseToElbow, arms[a].Len_ElbowToWrist, arms[a].Len_Wrist);
+            for(uint32_t i = batches[a].First; i < batches[a].First + batches[a].Count; i++){
+                Update_Grabber_Position(x[i], y[i], z[i], grabber[i], results);
+                sink += results[1];
+            }
+        }
+        elapsed = Bench_Seconds() - start;
+        if(elapsed < serial) serial = elapsed;
+    }
+
+    printf("%u arms, %u targets (%u entries with padding), FLEET_CHUNK %u, best of %u\n\n", BENCH_ARMS, targets, entries,
+           FLEET_CHUNK, BENCH_PASSES);
+    printf("Threads  ms per fleet  M solves/s  vs 1 thread  vs global arm  Same bits\n");
+    printf("global   %-12.3f  %-10.2f  %-11s  %-13.2f  -\n", serial * 1e3, targets / serial * 1e-6, "-", 1.0);
+
+    for(uint32_t threads = 1; threads <= max_threads; threads = (threads < max_threads && threads * 2 > max_threads) ? max_threads : threads * 2){
+        double best = INFINITY;
+        int same;
+
+        if(Fleet_Start(&fleet, threads) != E_NO_ERROR){
+            printf("Cannot start %u threads\n", threads);
+            return(1);
+        }
+        memset(angles.Base, 0, 4 * entries * sizeof(float));
+        for(uint32_t pass = 0; pass < BENCH_PASSES; pass++){
+            start = Bench_Seconds();
+            num_reachable = Fleet_Solve(&fleet);
+            elapsed = Bench_Seconds() - start;
+            if(elapsed < best) best = elapsed;
+        }
+        Fleet_Stop(&fleet);
+
+        if(threads == 1){
+            single = best;
+            memcpy(one_thread, angles.Base, 4 * entries * sizeof(float));
+            memcpy(reachable_one, reachable, IK_BATCH_WORDS(entries) * sizeof(*reachable));
+        }
+        same = !memcmp(one_thread, angles.Base, 4 * entries * sizeof(float)) &&
+               !memcmp(reachable_one, reachable, IK_BATCH_WORDS(entries) * sizeof(*reachable));
+        printf("%-7u  %-12.3f  %-10.2f  %-11.2f  %-13.2f  %s\n", threads, best * 1e3, targets / best * 1e-6, single / best,
+               serial / best, same ? "yes" : "NO");
+        if(threads == max_threads) break;
+    }
+
+    //Reachable angles against Arm_Solve() on each arm
+    for(uint32_t a = 0; a < BENCH_ARMS; a++){
+        for(uint32_t i = batches[a].First; i < batches[a].First + batches[a].Count; i++){
+            float fleet_angles[4] = { reference.Base[i], reference.Shoulder[i], reference.Elbow[i], reference.Wrist[i] };
+            float error = 0;
+
+            if(!IK_BATCH_REACHABLE(reachable_one, i)){
+                continue;
+            }
+            Arm_Solve(&arms[a], &scratch, x[i], y[i], z[i], grabber[i], results);
+            for(int j = 0; j < 4; j++){
+                float diff = fabsf(fleet_angles[j] - results[j]);
+                error = (diff > error || isnan(diff)) ? diff : error;
+            }
+            compared++;
+            mismatched += !(error <= BENCH_TOLERANCE);
+        }
+    }
+    printf("\n%d reachable, %u compared with Arm_Solve(), %u over %.2f deg\n", num_reachable, compared, mismatched, BENCH_TOLERANCE);
+
+    free(x);
+    free(y);
+    free(z);
+    free(grabber);
+    free(one_thread);
+    free(reachable);
+    free(reachable_one);
+    free(angles.Base);
+    return(0);
+}
@@ -0,0 +1,200 @@
+/**
+ * @file    bench_ik_accuracy.c
+ * @brief   Speed and Cartesian accuracy of Update_Grabber_Position() over the whole workspace, with a regression gate
+ * @details Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_ik_accuracy.c Coord_Asimov.c Coord_Trig.c -lm -o bench_ik_accuracy
+ *          Add -DIK_TRIG=IK_TRIG_POLY or -DIK_TRIG=IK_TRIG_LUT to measure another trig backend.
+ *
+ *          Every grabber position on a BENCH_STEP grid in front of the arm is solved at every BENCH_GRABBER_STEP
+ *          grabber angle from 0 to 90 degrees. The solve is timed over the whole sweep, best of BENCH_PASSES. Each
+ *          result is then checked in double precision:
+ *              Reference       The wrist joint is the target moved back along the grabber, without rounding. The
+ *                              target is reachable when the wrist is off the base axis and between |L1 - L2| and
+ *                              L1 + L2 from the shoulder
+ *              Error           Distance from the target to the grabber tip that forward kinematics puts at the
+ *                              solved angles
+ *              Missed          Reachable, but the solver gave NaN
+ *              False reach     Not reachable, but the solver gave angles
+ *          The program exits with 1 when a result is past a BENCH_GATE_* limit, so it can gate changes to the solver.
+ *          BENCH_GATE_NS is off (0) by default because times depend on the host.
+ *          Grabber angles above 90 are not swept: Arm_Wrist_Offset() leaves out the grabber length there.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "Coord_Asimov.h"
+#include "bench_common.h"
+
+#define BENCH_STEP          4           //Grid step in units
+#define BENCH_MAX_XY        300         //x and y from 0 to this
+#define BENCH_MAX_Z         300
+#define BENCH_GRABBER_STEP  15          //Degrees
+#define BENCH_PASSES        5
+
+#define BENCH_SIDE_XY       (BENCH_MAX_XY / BENCH_STEP + 1)
+#define BENCH_SIDE_Z        (BENCH_MAX_Z / BENCH_STEP + 1)
+#define BENCH_ANGLES        (90 / BENCH_GRABBER_STEP + 1)
+#define BENCH_TARGETS       (BENCH_SIDE_XY * BENCH_SIDE_XY * BENCH_SIDE_Z * BENCH_ANGLES)
+
+//Regression gate, set from the libm backend with some room. Override with -D to tighten
+#ifndef BENCH_GATE_MAX_ERROR
+#define BENCH_GATE_MAX_ERROR    1.5         //Units, worst tip error
+#endif
+#ifndef BENCH_GATE_P99_ERROR
+#define BENCH_GATE_P99_ERROR    1.0
+#endif
+#ifndef BENCH_GATE_MISSED
+#define BENCH_GATE_MISSED       0.005       //Fraction of the reachable targets
+#endif
+#ifndef BENCH_GATE_FALSE_REACH
+#define BENCH_GATE_FALSE_REACH  0.002       //Fraction of the unreachable targets
+#endif
+#ifndef BENCH_GATE_NS
+#define BENCH_GATE_NS           0           //ns per solve, 0 for no time gate
+#endif
+
+#define BENCH_PI            3.14159265358979323846
+#define BENCH_RAD(deg)      ((deg) * (BENCH_PI / 180.0))
+
+static float errors[BENCH_TARGETS];
+
+static int Compare_Float(const void *a, const void *b){
+    float fa = *(const float *)a, fb = *(const float *)b;
+    return((fa > fb) - (fa < fb));
+}
+
+//Reachable in exact arithmetic: the wrist joint off the base axis and within the annulus the two links sweep
+static int Reference_Reachable(double x, double y, double z, double Grabber_Angle){
+    double flat = sqrt(x * x + y * y);
+    double wrist_flat, wrist_z, distance;
+
+    if(flat == 0){
+        return(0);
+    }
+    wrist_flat = flat - BENCH_LINK_WRIST * cos(BENCH_RAD(Grabber_Angle));
+    wrist_z = z + BENCH_LINK_WRIST * sin(BENCH_RAD(Grabber_Angle));
+    distance = sqrt(wrist_flat * wrist_flat + wrist_z * wrist_z);
+    return(wrist_flat > 0 && distance >= abs(BENCH_LINK_1 - BENCH_LINK_2) && distance <= BENCH_LINK_1 + BENCH_LINK_2);
+}
+
+//Grabber tip from the joint angles, the way Arm_Forward() places them, in double
+static void Reference_Forward(const float *angles, double *tip){
+    double forearm = BENCH_RAD((double)angles[1] + angles[2] - 180.0);
+    double reach = BENCH_LINK_1 * cos(BENCH_RAD(angles[1])) + BENCH_LINK_2 * cos(forearm);
+    double height = BENCH_LINK_1 * sin(BENCH_RAD(angles[1])) + BENCH_LINK_2 * sin(forearm);
+
+    reach += BENCH_LINK_WRIST * sin(BENCH_RAD(angles[3]));
+    tip[0] = reach * cos(BENCH_RAD(angles[0]));
+    tip[1] = reach * sin(BENCH_RAD(angles[0]));
+    tip[2] = height - BENCH_LINK_WRIST * cos(BENCH_RAD(angles[3]));
+}
+
+int main(void){
+    float results[6];
+    double start, best = INFINITY, ns;
+    volatile float sink = 0;
+    uint32_t total = 0, reachable = 0, unreachable = 0, nan_results = 0, missed = 0, false_reach = 0, measured = 0;
+    double mean_error = 0;
+    float p50, p99, worst;
+    int failed = 0;
+
+    Init_Coords(BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+
+    //Speed: the whole sweep through the global arm, as the application calls it
+    for(uint32_t pass = 0; pass < BENCH_PASSES; pass++){
+        start = Bench_Seconds();
+        for(uint16_t g = 0; g <= 90; g += BENCH_GRABBER_STEP){
+            for(uint16_t z = 0; z <= BENCH_MAX_Z; z += BENCH_STEP){
+                for(uint16_t y = 0; y <= BENCH_MAX_XY; y += BENCH_STEP){
+                    for(uint16_t x = 0; x <= BENCH_MAX_XY; x += BENCH_STEP){
+                        Update_Grabber_Position(x, y, z, (float)g, results);
+                        sink += results[1];
+                    }
+                }
+            }
+        }
+        start = Bench_Seconds() - start;
+        if(start < best) best = start;
+    }
+    ns = best * 1e9 / BENCH_TARGETS;
+
+    //Accuracy against the double precision reference
+    for(uint16_t g = 0; g <= 90; g += BENCH_GRABBER_STEP){
+        for(uint16_t z = 0; z <= BENCH_MAX_Z; z += BENCH_STEP){
+            for(uint16_t y = 0; y <= BENCH_MAX_XY; y += BENCH_STEP){
+                for(uint16_t x = 0; x <= BENCH_MAX_XY; x += BENCH_STEP){
+                    int expected = Reference_Reachable(x, y, z, g);
+                    int solved = 1;
+                    double tip[3], error;
+
+                    Update_Grabber_Position(x, y, z, (float)g, results);
+                    for(int j = 0; j < 4; j++){
+                        solved &= !isnan(results[j]);
+                    }
+                    total++;
+                    reachable += expected;
+                    unreachable += !expected;
+                    nan_results += !solved;
+                    if(expected && !solved){
+                        missed++;
+                    }
+                    if(!expected && solved){
+                        false_reach++;
+                    }
+                    if(!expected || !solved){
+                        continue;
+                    }
+
+                    Reference_Forward(results, tip);
+                    error = sqrt((tip[0] - x) * (tip[0] - x) + (tip[1] - y) * (tip[1] - y) + (tip[2] - z) * (tip[2] - z));
+                    errors[measured++] = (float)error;
+                    mean_error += error;
+                }
+            }
+        }
+    }
+
+    qsort(errors, measured, sizeof(errors[0]), Compare_Float);
+    p50 = measured ? errors[measured / 2] : 0;
+    p99 = measured ? errors[(uint32_t)((measured - 1) * 0.99)] : 0;
+    worst = measured ? errors[measured - 1] : 0;
+    mean_error = measured ? mean_error / measured : 0;
+
+    printf("Arm %u/%u/%u, grid step %u over %ux%ux%u, grabber 0 to 90 every %u deg: %u targets\n\n", BENCH_LINK_1, BENCH_LINK_2,
+           BENCH_LINK_WRIST, BENCH_STEP, BENCH_MAX_XY, BENCH_MAX_XY, BENCH_MAX_Z, BENCH_GRABBER_STEP, total);
+    printf("Speed         %.1f ns per solve, %.2f M solves per second (best of %u)\n", ns, 1e-3 / ns * 1e6, BENCH_PASSES);
+    printf("Reachable     %u (%.1f%%), unreachable %u, NaN results %u (%.1f%%)\n", reachable, 100.0 * reachable / total,
+           unreachable, nan_results, 100.0 * nan_results / total);
+    printf("Missed        %u (%.3f%% of reachable)\n", missed, reachable ? 100.0 * missed / reachable : 0.0);
+    printf("False reach   %u (%.3f%% of unreachable)\n", false_reach, unreachable ? 100.0 * false_reach / unreachable : 0.0);
+    printf("Tip error     mean %.3f  p50 %.3f  p99 %.3f  max %.3f units over %u solves\n", mean_error, p50, p99, worst, measured);
+    printf("\n");
+
+    //Gate
+    if(worst > BENCH_GATE_MAX_ERROR){
+        printf("FAIL max error %.3f > %.3f\n", worst, BENCH_GATE_MAX_ERROR);
+        failed = 1;
+    }
+    if(p99 > BENCH_GATE_P99_ERROR){
+        printf("FAIL p99 error %.3f > %.3f\n", p99, BENCH_GATE_P99_ERROR);
+        failed = 1;
+    }
+    if(reachable && (double)missed / reachable > BENCH_GATE_MISSED){
+        printf("FAIL missed %.4f > %.4f\n", (double)missed / reachable, BENCH_GATE_MISSED);
+        failed = 1;
+    }
+    if(unreachable && (double)false_reach / unreachable > BENCH_GATE_FALSE_REACH){
+        printf("FAIL false reach %.4f > %.4f\n", (double)false_reach / unreachable, BENCH_GATE_FALSE_REACH);
+        failed = 1;
+    }
+    if(BENCH_GATE_NS > 0 && ns > BENCH_GATE_NS){
+        printf("FAIL %.1f ns per solve > %u\n", ns, BENCH_GATE_NS);
+        failed = 1;
+    }
+    printf("%s\n", failed ? "Gate failed" : "Gate passed");
+
+    return(failed);
+}
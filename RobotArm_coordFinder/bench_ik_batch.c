@@ -0,0 +1,90 @@
+/**
+ * @file    bench_ik_batch.c
+ * @brief   Solves per second of Arm_Solve_Batch() against one Arm_Solve() call per target
+ * @details Host build, for example:
+ *              gcc -O2 -mavx2 -mfma -DCOORD_HOST -I. bench_ik_batch.c Coord_Batch.c Coord_Asimov.c Coord_Trig.c -lm -o bench_ik_batch
+ *          Drop -mavx2 -mfma for the SSE2 kernel, or add -DIK_BATCH_SCALAR for the scalar one.
+ *          BENCH_TARGETS random grabber positions around the arm are solved BENCH_PASSES times both ways. The batch
+ *          angles are then checked against Arm_Solve() on every target the batch found reachable.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "Coord_Asimov.h"
+#include "Coord_Batch.h"
+#include "bench_common.h"
+
+#define BENCH_TARGETS       4096        //Targets per batch (the size of one planner pass)
+#define BENCH_PASSES        200
+#define BENCH_TOLERANCE     0.01f       //Degrees, differences above this are counted as mismatches
+
+static uint16_t bench_x[BENCH_TARGETS], bench_y[BENCH_TARGETS], bench_z[BENCH_TARGETS];
+static float bench_grabber[BENCH_TARGETS];
+static float batch_base[BENCH_TARGETS], batch_shoulder[BENCH_TARGETS], batch_elbow[BENCH_TARGETS], batch_wrist[BENCH_TARGETS];
+static uint32_t batch_reachable[IK_BATCH_WORDS(BENCH_TARGETS)];
+static float single_results[BENCH_TARGETS][6];
+
+int main(void){
+    struct RobotArm arm;
+    struct IK_Scratch scratch;
+    struct IK_Batch_Angles angles = { batch_base, batch_shoulder, batch_elbow, batch_wrist };
+    double start, single_time, batch_time;
+    volatile float sink = 0;
+    int32_t num_reachable = 0;
+    uint32_t compared = 0, mismatched = 0;
+    float max_error = 0;
+
+    Arm_Init(&arm, BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+    srand(1);
+    for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+        bench_x[i] = (uint16_t)(rand() % 250);
+        bench_y[i] = (uint16_t)(rand() % 250);
+        bench_z[i] = (uint16_t)(rand() % 200);
+        bench_grabber[i] = (float)(rand() % 121);
+    }
+
+    start = Bench_Seconds();
+    for(uint32_t pass = 0; pass < BENCH_PASSES; pass++){
+        for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+            Arm_Solve(&arm, &scratch, bench_x[i], bench_y[i], bench_z[i], bench_grabber[i], single_results[i]);
+        }
+        sink += single_results[pass % BENCH_TARGETS][1];
+    }
+    single_time = Bench_Seconds() - start;
+
+    start = Bench_Seconds();
+    for(uint32_t pass = 0; pass < BENCH_PASSES; pass++){
+        num_reachable = Arm_Solve_Batch(&arm, bench_x, bench_y, bench_z, bench_grabber, BENCH_TARGETS, &angles, batch_reachable);
+        sink += batch_shoulder[pass % BENCH_TARGETS];
+    }
+    batch_time = Bench_Seconds() - start;
+
+    for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+        if(!IK_BATCH_REACHABLE(batch_reachable, i)){
+            continue;
+        }
+        float batch[4] = { batch_base[i], batch_shoulder[i], batch_elbow[i], batch_wrist[i] };
+        float error = 0;
+        for(uint32_t j = 0; j < 4; j++){
+            float diff = fabsf(batch[j] - single_results[i][j]);
+            error = (diff > error || isnan(diff)) ? diff : error;
+        }
+        compared++;
+        if(!(error <= BENCH_TOLERANCE)){
+            mismatched++;
+        }
+        else if(error > max_error){
+            max_error = error;
+        }
+    }
+
+    printf("%d targets x %d passes, %d reachable\n", BENCH_TARGETS, BENCH_PASSES, num_reachable);
+    printf("Arm_Solve()        %12.0f solves/s\n", (double)BENCH_TARGETS * BENCH_PASSES / single_time);
+    printf("Arm_Solve_Batch()  %12.0f solves/s  (%.1fx)\n", (double)BENCH_TARGETS * BENCH_PASSES / batch_time, single_time / batch_time);
+    printf("Largest difference %.6f degrees, %u of %u reachable targets differ by more than %.2f\n",
+           max_error, mismatched, compared, BENCH_TOLERANCE);
+    return(0);
+}
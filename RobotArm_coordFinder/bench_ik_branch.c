@@ -0,0 +1,175 @@
+/**
+ * @file    bench_ik_branch.c
+ * @brief   Joint travel of a pick and place walk with the elbow up solution only and with the nearest branch
+ *          (Coord_Branch.c), and the cost of picking
+ * @details Target build: add bench_ik_branch.c, Coord_Branch.c, Coord_Batch.c, Coord_Asimov.c and Coord_Trig.c to the
+ *          project (with ARM_MATH_CM4 and CMSIS-DSP for the batch lanes). Cycles are counted with SysTick.
+ *          Host build, for example:
+ *              gcc -O2 -mavx2 -DCOORD_HOST -I. bench_ik_branch.c Coord_Branch.c Coord_Batch.c Coord_Asimov.c Coord_Trig.c -lm -o bench_ik_branch
+ *          The host reports nanoseconds instead of cycles.
+ *
+ *          The targets are BENCH_TARGETS random ones whose elbow up solution is within bench_limits. Every branch of
+ *          them is put through Arm_Forward() and compared with the elbow up solution, to check the branches land on
+ *          the same grabber pose. Then the targets are visited in order from a home pose, once moving to the elbow up
+ *          solution every time and once to the nearest branch, both within bench_limits, so the two walks cover the
+ *          same moves. The servos move together, so the time of a move goes with its largest joint change.
+ *          The nearest branch is picked one move at a time, so it is not always ahead over a whole walk.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "Coord_Asimov.h"
+#include "Coord_Batch.h"
+#include "Coord_Branch.h"
+#include "bench_common.h"
+
+#define BENCH_TARGETS       1000
+
+//An arm with wide range servos: base -90 to 270, shoulder -20 to 200, elbow 30 to 330, wrist -120 to 120
+static const struct IK_Joint_Limits bench_limits = {
+    { -90.0f, -20.0f, 30.0f, -120.0f },
+    { 270.0f, 200.0f, 330.0f, 120.0f }
+};
+static const float home[4] = { 45.0f, 90.0f, 90.0f, 0.0f };
+static const float grabber_angles[4] = { 0.0f, 45.0f, 90.0f, 91.0f };
+
+static uint16_t target_x[BENCH_TARGETS], target_y[BENCH_TARGETS], target_z[BENCH_TARGETS];
+static float target_grabber[BENCH_TARGETS];
+static float batch_out[4][BENCH_TARGETS];
+static uint8_t batch_branches[BENCH_TARGETS];
+
+//Largest joint change of a move, and the sum of the changes
+static float Move_Cost(const float *from, const float *to, float *sum){
+    float largest = 0;
+
+    *sum = 0;
+    for(int j = 0; j < 4; j++){
+        float change = fabsf(to[j] - from[j]);
+        *sum += change;
+        if(change > largest) largest = change;
+    }
+    return(largest);
+}
+
+static float Distance(const float *a, const float *b){
+    return(sqrtf((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2])));
+}
+
+int main(void){
+    struct RobotArm arm;
+    struct IK_Scratch scratch;
+    struct IK_Solutions solutions;
+    struct IK_Batch_Angles batch = { batch_out[0], batch_out[1], batch_out[2], batch_out[3] };
+    float results[6], from[4], up_tip[3], up_wrist[3], tip[3], wrist[3];
+    float fk_worst = 0, sum, up_travel = 0, up_time = 0, up_worst = 0, near_travel = 0, near_time = 0, near_worst = 0;
+    uint32_t seed = 2024, count = 0, branch_counts[IK_BRANCHES] = { 0 }, solutions_total = 0, mismatches = 0;
+    uint32_t start, solve_time = 0, all_time = 0, nearest_time = 0, batch_time = 0;
+    int32_t batch_valid;
+
+    Bench_Init();
+
+    Arm_Init(&arm, BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+
+    //Random targets with an elbow up solution within the limits, so both walks can visit every one
+    while(count < BENCH_TARGETS){
+        seed = seed * 1664525u + 1013904223u;
+        target_x[count] = (uint16_t)((seed >> 8) % 280);
+        seed = seed * 1664525u + 1013904223u;
+        target_y[count] = (uint16_t)((seed >> 8) % 280);
+        seed = seed * 1664525u + 1013904223u;
+        target_z[count] = (uint16_t)((seed >> 8) % 240);
+        target_grabber[count] = grabber_angles[(seed >> 4) & 3];
+        Arm_Solve_All(&arm, &scratch, target_x[count], target_y[count], target_z[count], target_grabber[count], &bench_limits, &solutions);
+        if(solutions.Count && solutions.Branch[0] == IK_BRANCH_UP){
+            count++;
+        }
+    }
+
+    //Every branch without limits must put the grabber where the elbow up solution does
+    for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+        Arm_Solve(&arm, &scratch, target_x[i], target_y[i], target_z[i], target_grabber[i], results);
+        Arm_Forward(&arm, results, up_wrist, up_tip);
+        solutions_total += Arm_Solve_All(&arm, &scratch, target_x[i], target_y[i], target_z[i], target_grabber[i], NULL, &solutions);
+        for(uint32_t s = 0; s < solutions.Count; s++){
+            Arm_Forward(&arm, solutions.Angles[s], wrist, tip);
+            float error = Distance(tip, up_tip) > Distance(wrist, up_wrist) ? Distance(tip, up_tip) : Distance(wrist, up_wrist);
+            if(error > fk_worst) fk_worst = error;
+        }
+    }
+    printf("Branches without limits: %u for %u targets, worst wrist or tip distance from the elbow up pose %.4f units\n\n",
+           solutions_total, BENCH_TARGETS, fk_worst);
+
+    //The walk, elbow up only then nearest branch
+    for(int j = 0; j < 4; j++) from[j] = home[j];
+    for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+        start = Bench_Now();
+        Arm_Solve(&arm, &scratch, target_x[i], target_y[i], target_z[i], target_grabber[i], results);
+        solve_time += BENCH_ELAPSED(start, Bench_Now());
+
+        //The same solution, turned into the limits where a joint needs it
+        Arm_Solve_All(&arm, &scratch, target_x[i], target_y[i], target_z[i], target_grabber[i], &bench_limits, &solutions);
+        float largest = Move_Cost(from, solutions.Angles[0], &sum);
+        up_travel += sum;
+        up_time += largest;
+        if(largest > up_worst) up_worst = largest;
+        for(int j = 0; j < 4; j++) from[j] = solutions.Angles[0][j];
+    }
+
+    for(int j = 0; j < 4; j++) from[j] = home[j];
+    for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+        start = Bench_Now();
+        int branch = Arm_Solve_Nearest(&arm, &scratch, target_x[i], target_y[i], target_z[i], target_grabber[i], &bench_limits, from, NULL, results);
+        nearest_time += BENCH_ELAPSED(start, Bench_Now());
+        //Never off, the elbow up branch is within the limits
+        branch_counts[branch]++;
+
+        float largest = Move_Cost(from, results, &sum);
+        near_travel += sum;
+        near_time += largest;
+        if(largest > near_worst) near_worst = largest;
+        for(int j = 0; j < 4; j++) from[j] = results[j];
+    }
+
+    start = Bench_Now();
+    for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+        Arm_Solve_All(&arm, &scratch, target_x[i], target_y[i], target_z[i], target_grabber[i], &bench_limits, &solutions);
+    }
+    all_time = BENCH_ELAPSED(start, Bench_Now());
+
+    //The batch has to make the same picks (its lanes use their own polynomials, so allow a little in the angles)
+    start = Bench_Now();
+    batch_valid = Arm_Solve_Nearest_Batch(&arm, target_x, target_y, target_z, target_grabber, BENCH_TARGETS, &bench_limits, home, NULL,
+                                          &batch, batch_branches);
+    batch_time = BENCH_ELAPSED(start, Bench_Now());
+    for(int j = 0; j < 4; j++) from[j] = home[j];
+    for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+        int branch = Arm_Solve_Nearest(&arm, &scratch, target_x[i], target_y[i], target_z[i], target_grabber[i], &bench_limits, from, NULL, results);
+        if(branch < 0){
+            mismatches += (batch_branches[i] != IK_BRANCH_NONE);
+            continue;
+        }
+        if(batch_branches[i] != branch || fabsf(batch_out[1][i] - results[1]) > 0.01f || fabsf(batch_out[2][i] - results[2]) > 0.01f){
+            mismatches++;
+        }
+        for(int j = 0; j < 4; j++) from[j] = results[j];
+    }
+
+    printf("Walk of %u targets   Total travel deg  Move time (sum of largest change)  Worst move deg\n", BENCH_TARGETS);
+    printf("Elbow up only        %-16.0f  %-33.0f  %.1f\n", up_travel, up_time, up_worst);
+    printf("Nearest branch       %-16.0f  %-33.0f  %.1f\n", near_travel, near_time, near_worst);
+    printf("Picked: %u up, %u down, %u flipped up, %u flipped down. Batch: %d valid, %u picks differ from Arm_Solve_Nearest()\n\n",
+           branch_counts[IK_BRANCH_UP], branch_counts[IK_BRANCH_DOWN], branch_counts[IK_BRANCH_FLIP_UP], branch_counts[IK_BRANCH_FLIP_DOWN],
+           (int)batch_valid, mismatches);
+
+    printf("%s per target: Arm_Solve() %u, Arm_Solve_All() %u, Arm_Solve_Nearest() %u, Arm_Solve_Nearest_Batch() %u\n", BENCH_UNIT,
+           solve_time / BENCH_TARGETS, all_time / BENCH_TARGETS, nearest_time / BENCH_TARGETS, batch_time / BENCH_TARGETS);
+
+#ifndef COORD_HOST
+    while(1) {
+
+    }
+#endif
+    return(0);
+}
@@ -0,0 +1,142 @@
+/**
+ * @file    bench_ik_diff.c
+ * @brief   Tracking error and cost per step of the differential solver against a full Arm_Solve() per step
+ * @details Target build: add bench_ik_diff.c, Coord_Diff.c, Coord_Asimov.c and Coord_Trig.c to the project. Cycles are
+ *          counted with SysTick.
+ *          Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_ik_diff.c Coord_Diff.c Coord_Asimov.c Coord_Trig.c -lm -o bench_ik_diff
+ *          The host reports nanoseconds instead of cycles.
+ *
+ *          The target walks a smooth loop through the workspace in steps of under a unit, the fine moves the
+ *          differential solver is for. After every step the joint angles are put through a double precision forward
+ *          model of the arm and compared with the target. Arm_Jacobian() is checked against central differences of
+ *          the same model.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "Coord_Asimov.h"
+#include "Coord_Diff.h"
+#include "bench_common.h"
+
+#define BENCH_GRABBER       30.0f
+#define BENCH_STEPS         20000
+
+static const uint32_t anchor_intervals[] = { 1, 10, 50, 200 };
+
+//Grabber tip of the arm model in double: base, shoulder, elbow in degrees, grabber angle held at BENCH_GRABBER
+static void Reference_Tip(const double *angles, double *tip){
+    double wrist = (90.0 - BENCH_GRABBER) * M_PI / 180;
+    double base = angles[0] * M_PI / 180, shoulder = angles[1] * M_PI / 180;
+    double forearm = (angles[1] + angles[2] - 180.0) * M_PI / 180;
+    double reach = BENCH_LINK_1 * cos(shoulder) + BENCH_LINK_2 * cos(forearm) + BENCH_LINK_WRIST * sin(wrist);
+
+    tip[0] = reach * cos(base);
+    tip[1] = reach * sin(base);
+    tip[2] = BENCH_LINK_1 * sin(shoulder) + BENCH_LINK_2 * sin(forearm) - BENCH_LINK_WRIST * cos(wrist);
+}
+
+//Smooth loop about 40 units across, every step under a unit
+static void Bench_Move(uint32_t step, float *delta){
+    float t = (float)step * 0.02f;
+
+    delta[0] = 0.8f * cosf(t);
+    delta[1] = 0.6f * cosf(1.3f * t + 0.5f);
+    delta[2] = 0.5f * sinf(0.7f * t);
+}
+
+int main(void){
+    struct RobotArm arm;
+    struct IK_Scratch scratch;
+    struct IK_Diff diff;
+    float results[6], delta[3], jacobian[3][3];
+    double angles[3], tip[3], high[3], low[3], jacobian_error = 0;
+    double solve_worst = 0;
+    uint32_t start, solve_time = 0;
+
+    Bench_Init();
+
+    Arm_Init(&arm, BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+
+    //Arm_Jacobian() against central differences, over a spread of joint states
+    for(int base = 10; base <= 170; base += 40){
+        for(int shoulder = 20; shoulder <= 140; shoulder += 30){
+            for(int elbow = 30; elbow <= 170; elbow += 35){
+                float state[4] = { (float)base, (float)shoulder, (float)elbow, 90.0f - BENCH_GRABBER };
+
+                Arm_Jacobian(&arm, state, jacobian);
+                for(int j = 0; j < 3; j++){
+                    double h = 1e-4;
+                    angles[0] = base; angles[1] = shoulder; angles[2] = elbow;
+                    angles[j] += h;
+                    Reference_Tip(angles, high);
+                    angles[j] -= 2 * h;
+                    Reference_Tip(angles, low);
+                    for(int axis = 0; axis < 3; axis++){
+                        double error = fabs(jacobian[axis][j] - (high[axis] - low[axis]) / (2 * h));
+                        if(error > jacobian_error) jacobian_error = error;
+                    }
+                }
+            }
+        }
+    }
+    printf("Arm_Jacobian() worst error against central differences: %.2e units per degree\n\n", jacobian_error);
+
+    printf("Anchor every  Steps  Anchors  Worst tip error  Mean tip error  %-6s per step\n", BENCH_UNIT);
+    for(uint32_t a = 0; a < sizeof(anchor_intervals) / sizeof(anchor_intervals[0]); a++){
+        double worst = 0, sum = 0;
+        uint32_t step_time = 0;
+
+        if(Arm_Diff_Init(&diff, &arm, 150, 60, 80, BENCH_GRABBER, anchor_intervals[a]) != E_NO_ERROR){
+            printf("start out of reach\n");
+            return(1);
+        }
+        for(uint32_t i = 0; i < BENCH_STEPS; i++){
+            Bench_Move(i, delta);
+
+            start = Bench_Now();
+            Arm_Diff_Step(&diff, delta[0], delta[1], delta[2], results);
+            step_time += BENCH_ELAPSED(start, Bench_Now());
+
+            angles[0] = results[0]; angles[1] = results[1]; angles[2] = results[2];
+            Reference_Tip(angles, tip);
+            double error = sqrt((tip[0] - diff.Target[0]) * (tip[0] - diff.Target[0]) + (tip[1] - diff.Target[1]) * (tip[1] - diff.Target[1]) +
+                                (tip[2] - diff.Target[2]) * (tip[2] - diff.Target[2]));
+            sum += error;
+            if(error > worst) worst = error;
+        }
+        printf("%-12u  %-5u  %-7u  %-15.5f  %-14.5f  %u\n", anchor_intervals[a], BENCH_STEPS, diff.Anchors, worst,
+               sum / BENCH_STEPS, step_time / BENCH_STEPS);
+    }
+
+    //The full solve on the same walk, rounded to whole units the way it has to be called
+    if(Arm_Diff_Init(&diff, &arm, 150, 60, 80, BENCH_GRABBER, 0) != E_NO_ERROR){
+        return(1);
+    }
+    for(uint32_t i = 0; i < BENCH_STEPS; i++){
+        Bench_Move(i, delta);
+        diff.Target[0] += delta[0];
+        diff.Target[1] += delta[1];
+        diff.Target[2] += delta[2];
+
+        start = Bench_Now();
+        Arm_Solve(&arm, &scratch, (uint16_t)(diff.Target[0] + 0.5f), (uint16_t)(diff.Target[1] + 0.5f), (uint16_t)(diff.Target[2] + 0.5f), BENCH_GRABBER, results);
+        solve_time += BENCH_ELAPSED(start, Bench_Now());
+
+        angles[0] = results[0]; angles[1] = results[1]; angles[2] = results[2];
+        Reference_Tip(angles, tip);
+        double error = sqrt((tip[0] - diff.Target[0]) * (tip[0] - diff.Target[0]) + (tip[1] - diff.Target[1]) * (tip[1] - diff.Target[1]) +
+                            (tip[2] - diff.Target[2]) * (tip[2] - diff.Target[2]));
+        if(error > solve_worst) solve_worst = error;
+    }
+    printf("\nArm_Solve() every step: worst tip error %.5f (whole units in), %u %s per step\n", solve_worst, solve_time / BENCH_STEPS, BENCH_UNIT);
+
+#ifndef COORD_HOST
+    while(1) {
+
+    }
+#endif
+    return(0);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file    bench_ik_fixed.c
+ * @brief   Accuracy of Arm_Solve_Fixed() and Arm_Solve() against a double precision reference, and cycles per solve
+ * @details Target build: add bench_ik_fixed.c, Coord_Fixed.c, Coord_Asimov.c and Coord_Trig.c to the project. Cycles are counted
+ *          with SysTick, which a Cortex-M0+ has as well (it has no DWT cycle counter).
+ *          Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_ik_fixed.c Coord_Fixed.c Coord_Asimov.c Coord_Trig.c -lm -o bench_ik_fixed
+ *          The host reports nanoseconds per solve instead of cycles.
+ *
+ *          The workspace sweep covers every BENCH_STEP units of x, y and z and every BENCH_GRABBER_STEP degrees of
+ *          grabber angle. The reference follows the same steps in double with the real PI (wrist offsets rounded to
+ *          whole units), so any difference is the arithmetic of the solver under test.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "Coord_Asimov.h"
+#include "Coord_Fixed.h"
+#include "bench_common.h"
+
+#define BENCH_REACH         250         //Sweep x, y and z from 0 to this
+#define BENCH_STEP          10
+#define BENCH_GRABBER_STEP  15          //Grabber angles 0 to 90, plus one over 90 (straight wrist)
+#define BENCH_TIMED_SOLVES  1000
+
+struct error_stats {
+    double max[4];                      //Worst error of Base, Shoulder, Elbow and Wrist in degrees
+    double sum[4];
+    uint32_t compared;
+    uint32_t reach_mismatch;            //Reachable in one and not the other
+};
+
+static const char *joint_names[4] = { "Base", "Shoulder", "Elbow", "Wrist" };
+
+
+//Same steps as Arm_Solve() in double, real PI. Returns 0 when the target is out of reach
+static int Reference_Solve(uint16_t x, uint16_t y, uint16_t z, double grabber, double *angles){
+    const double l1 = BENCH_LINK_1, l2 = BENCH_LINK_2, lw = BENCH_LINK_WRIST;
+    double flat = sqrt((double)x * x + (double)y * y);
+    double wrist = 0, dx = 0, dy = 0, dz = 0;
+
+    if(flat == 0){
+        return(0);
+    }
+    double base = atan2((double)y, (double)x);
+    if(grabber <= 90){
+        wrist = (90 - grabber) * M_PI / 180;
+        dz = floor(lw * cos(wrist) + 0.5);
+        dx = floor(lw * sin(wrist) * cos(base) + 0.5);
+        dy = floor(lw * sin(wrist) * sin(base) + 0.5);
+    }
+    double ux = x - dx, uy = y - dy, uz = z + dz;
+    if(ux < 0 || uy < 0 || uz < 0){
+        return(0);
+    }
+    double flat2 = sqrt(ux * ux + uy * uy);
+    double dist_sqrd = ux * ux + uy * uy + uz * uz;
+    double dist = sqrt(dist_sqrd);
+    double shoulder_cos = (dist_sqrd + l1 * l1 - l2 * l2) / (2 * l1 * dist);
+    double elbow_cos = (l1 * l1 + l2 * l2 - dist_sqrd) / (2 * l1 * l2);
+    if(dist == 0 || fabs(shoulder_cos) > 1 || fabs(elbow_cos) > 1){
+        return(0);
+    }
+
+    angles[0] = base * 180 / M_PI;
+    angles[1] = (atan2(uz, flat2) + acos(shoulder_cos)) * 180 / M_PI;
+    angles[2] = acos(elbow_cos) * 180 / M_PI;
+    angles[3] = wrist * 180 / M_PI;
+    return(1);
+}
+
+static void Add_Error(struct error_stats *stats, int reachable, int ref_reachable, const double *angles, const double *ref){
+    if(reachable != ref_reachable){
+        stats->reach_mismatch++;
+        return;
+    }
+    if(!reachable){
+        return;
+    }
+    for(int j = 0; j < 4; j++){
+        double error = fabs(angles[j] - ref[j]);
+        stats->sum[j] += error;
+        if(error > stats->max[j]) stats->max[j] = error;
+    }
+    stats->compared++;
+}
+
+static void Print_Errors(const char *name, const struct error_stats *stats){
+    printf("%s: %u targets compared, %u reachability mismatches\n", name, stats->compared, stats->reach_mismatch);
+    for(int j = 0; j < 4; j++){
+        printf("    %-8s  max %.5f  mean %.5f degrees\n", joint_names[j], stats->max[j], stats->compared ? stats->sum[j] / stats->compared : 0);
+    }
+}
+
+int main(void){
+    static struct error_stats fixed_stats, float_stats;
+    struct RobotArm arm;
+    struct IK_Scratch scratch;
+    q16_t fixed_results[4];
+    float float_results[6];
+    double angles[4], ref[4];
+    uint32_t start, fixed_time = 0, float_time = 0;
+    volatile int32_t sink = 0;
+
+    Bench_Init();
+
+    Arm_Init(&arm, BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+
+    printf("Workspace sweep, arm %d/%d/%d\n", BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+    for(uint16_t x = 0; x <= BENCH_REACH; x += BENCH_STEP){
+        for(uint16_t y = 0; y <= BENCH_REACH; y += BENCH_STEP){
+            for(uint16_t z = 0; z <= BENCH_REACH; z += BENCH_STEP){
+                for(int grabber = 0; grabber <= 90 + BENCH_GRABBER_STEP; grabber += BENCH_GRABBER_STEP){
+                    int ref_reachable = Reference_Solve(x, y, z, grabber, ref);
+
+                    int reachable = (Arm_Solve_Fixed(&arm, x, y, z, Q16_FROM_INT(grabber), fixed_results) == E_NO_ERROR);
+                    for(int j = 0; j < 4; j++) angles[j] = fixed_results[j] / 65536.0;
+                    Add_Error(&fixed_stats, reachable, ref_reachable, angles, ref);
+
+                    Arm_Solve(&arm, &scratch, x, y, z, (float)grabber, float_results);
+                    reachable = !isnan(float_results[0]) && !isnan(float_results[1]) && !isnan(float_results[2]);
+                    for(int j = 0; j < 4; j++) angles[j] = float_results[j];
+                    Add_Error(&float_stats, reachable, ref_reachable, angles, ref);
+                }
+            }
+        }
+    }
+    Print_Errors("Arm_Solve_Fixed()", &fixed_stats);
+    Print_Errors("Arm_Solve() (float)", &float_stats);
+
+    //Time one reachable pose at a time so every solve runs the whole way through
+    for(uint32_t i = 0; i < BENCH_TIMED_SOLVES; i++){
+        uint16_t x = (uint16_t)(60 + (i % 50)), y = (uint16_t)(40 + (i % 37)), z = (uint16_t)(50 + (i % 29));
+        q16_t grabber = Q16_FROM_INT(i % 90);
+
+        start = Bench_Now();
+        Arm_Solve_Fixed(&arm, x, y, z, grabber, fixed_results);
+        fixed_time += BENCH_ELAPSED(start, Bench_Now());
+        sink += fixed_results[1];
+
+        start = Bench_Now();
+        Arm_Solve(&arm, &scratch, x, y, z, (float)(i % 90), float_results);
+        float_time += BENCH_ELAPSED(start, Bench_Now());
+        sink += (int32_t)float_results[1];
+    }
+    printf("\nArm_Solve_Fixed()    %u %s per solve\n", fixed_time / BENCH_TIMED_SOLVES, BENCH_UNIT);
+    printf("Arm_Solve() (float)  %u %s per solve\n", float_time / BENCH_TIMED_SOLVES, BENCH_UNIT);
+
+#ifndef COORD_HOST
+    while(1) {
+
+    }
+#endif
+    return(0);
+}
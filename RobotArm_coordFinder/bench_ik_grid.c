@@ -0,0 +1,132 @@
+/**
+ * @file    bench_ik_grid.c
+ * @brief   Memory, accuracy and speed of the IK grid (Coord_Grid.c) for several cell sizes
+ * @details Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_ik_grid.c Coord_Grid.c Coord_Asimov.c Coord_Trig.c -lm -o bench_ik_grid
+ *          For each cell size the grid is built for BENCH_ANGLES grabber angles, then BENCH_TARGETS random reachable
+ *          targets are looked up. Targets in a trusted cell are compared with Arm_Solve() (worst, 99th percentile
+ *          and mean error over the three joints) and timed against it. The rest fall back to Arm_Solve(), the
+ *          hit rate says how often that happens, and the last column is the cost per solve with the fallbacks in.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "Coord_Asimov.h"
+#include "Coord_Grid.h"
+#include "bench_common.h"
+
+#define BENCH_TARGETS       200000
+#define BENCH_ANGLES        4
+
+static const float grabber_angles[BENCH_ANGLES] = { 0, 30, 60, 90 };
+static const uint8_t cell_shifts[] = { 2, 3, 4, 5 };
+
+struct bench_target {
+    uint16_t x, y, z;
+    uint8_t angle;
+    float exact[3];
+};
+
+static int Compare_Float(const void *a, const void *b){
+    float fa = *(const float *)a, fb = *(const float *)b;
+    return((fa > fb) - (fa < fb));
+}
+
+int main(void){
+    static struct bench_target targets[BENCH_TARGETS];
+    static float errors[BENCH_TARGETS];
+    struct RobotArm arm;
+    struct IK_Scratch scratch;
+    struct IK_Grid grid;
+    float results[6];
+    uint32_t extent, seed = 12345, count = 0;
+    volatile float sink = 0;
+    double start, exact_time, build_time;
+
+    Arm_Init(&arm, BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+    extent = BENCH_LINK_1 + BENCH_LINK_2 + BENCH_LINK_WRIST;
+
+    //Random reachable targets and their exact solutions
+    while(count < BENCH_TARGETS){
+        struct bench_target *target = &targets[count];
+        seed = seed * 1664525u + 1013904223u;
+        target->x = (uint16_t)((seed >> 8) % (extent + 1));
+        seed = seed * 1664525u + 1013904223u;
+        target->y = (uint16_t)((seed >> 8) % (extent + 1));
+        seed = seed * 1664525u + 1013904223u;
+        target->z = (uint16_t)((seed >> 8) % (extent + 1));
+        target->angle = (uint8_t)((seed >> 4) % BENCH_ANGLES);
+        Arm_Solve(&arm, &scratch, target->x, target->y, target->z, grabber_angles[target->angle], results);
+        if(!isnan(results[0]) && !isnan(results[1]) && !isnan(results[2])){
+            target->exact[0] = results[0];
+            target->exact[1] = results[1];
+            target->exact[2] = results[2];
+            count++;
+        }
+    }
+
+    start = Bench_Seconds();
+    for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+        Arm_Solve(&arm, &scratch, targets[i].x, targets[i].y, targets[i].z, grabber_angles[targets[i].angle], results);
+        sink += results[1];
+    }
+    exact_time = (Bench_Seconds() - start) * 1e9 / BENCH_TARGETS;
+
+    printf("Arm %d/%d/%d, %d grabber angles, %d reachable targets, Arm_Solve() %.0f ns\n\n", BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST,
+           BENCH_ANGLES, BENCH_TARGETS, exact_time);
+    printf("Cell  KB (1 angle)  KB (%d)  Build s  Hit rate  Worst deg  99%% deg  Mean deg  Grid ns  Speedup  With fallback ns\n", BENCH_ANGLES);
+
+    for(uint32_t s = 0; s < sizeof(cell_shifts) / sizeof(cell_shifts[0]); s++){
+        uint32_t bytes = IK_Grid_Size(&arm, cell_shifts[s], BENCH_ANGLES);
+        void *memory = malloc(bytes);
+        uint32_t hits = 0;
+        double sum = 0, grid_time, mixed_time;
+
+        start = Bench_Seconds();
+        if(memory == NULL || IK_Grid_Build(&grid, &arm, cell_shifts[s], grabber_angles, BENCH_ANGLES, memory, bytes) != E_NO_ERROR){
+            printf("Cannot build %u unit cells\n", 1u << cell_shifts[s]);
+            return(1);
+        }
+        build_time = Bench_Seconds() - start;
+
+        for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+            if(IK_Grid_Solve(&grid, NULL, targets[i].x, targets[i].y, targets[i].z, grabber_angles[targets[i].angle], results) != E_NO_ERROR){
+                continue;
+            }
+            float error = 0;
+            for(int j = 0; j < 3; j++){
+                float e = fabsf(results[j] - targets[i].exact[j]);
+                if(e > error) error = e;
+            }
+            errors[hits++] = error;
+            sum += error;
+        }
+        qsort(errors, hits, sizeof(float), Compare_Float);
+
+        //Grid lookups only, then the mix a planner would see
+        start = Bench_Seconds();
+        for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+            if(IK_Grid_Solve(&grid, NULL, targets[i].x, targets[i].y, targets[i].z, grabber_angles[targets[i].angle], results) == E_NO_ERROR){
+                sink += results[1];
+            }
+        }
+        grid_time = (Bench_Seconds() - start) * 1e9 / BENCH_TARGETS;
+
+        start = Bench_Seconds();
+        for(uint32_t i = 0; i < BENCH_TARGETS; i++){
+            IK_Grid_Solve(&grid, &scratch, targets[i].x, targets[i].y, targets[i].z, grabber_angles[targets[i].angle], results);
+            sink += results[1];
+        }
+        mixed_time = (Bench_Seconds() - start) * 1e9 / BENCH_TARGETS;
+
+        printf("%-4u  %-12.1f  %-6.1f  %-7.2f  %-7.1f%%  %-9.3f  %-7.3f  %-8.4f  %-7.0f  %-7.1f  %.0f\n", 1u << cell_shifts[s],
+               IK_Grid_Size(&arm, cell_shifts[s], 1) / 1024.0, bytes / 1024.0, build_time, 100.0 * hits / BENCH_TARGETS,
+               hits ? errors[hits - 1] : 0, hits ? errors[(uint32_t)(hits * 0.99)] : 0, hits ? sum / hits : 0,
+               grid_time, exact_time / grid_time, mixed_time);
+        free(memory);
+    }
+    return(0);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file    bench_ik_trig.c
+ * @brief   Worst case error and calls per second of every Coord_Trig.c backend against libm
+ * @details Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_ik_trig.c Coord_Trig.c -lm -o bench_ik_trig
+ *          The error is measured against double precision acos/sin/cos over BENCH_SWEEP evenly spaced inputs
+ *          (cosines -1 to 1, angles -360 to 360 degrees) and compared with IK_TRIG_BUDGET_DEG. sin and cos errors
+ *          are values, and are also shown as the angle they correspond to near zero.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "Coord_Trig.h"
+#include "bench_common.h"
+
+#define BENCH_SWEEP         2000001
+#define BENCH_CALLS         10000000
+
+struct trig_backend {
+    const char *name;
+    float (*acos_deg)(float a);
+    float (*sin_deg)(float degrees);
+    float (*cos_deg)(float degrees);
+};
+
+static const struct trig_backend backends[] = {
+    { "libm", Trig_Acos_Deg_Libm, Trig_Sin_Deg_Libm, Trig_Cos_Deg_Libm },
+    { "poly", Trig_Acos_Deg_Poly, Trig_Sin_Deg_Poly, Trig_Cos_Deg_Poly },
+    { "lut",  Trig_Acos_Deg_Lut,  Trig_Sin_Deg_Lut,  Trig_Cos_Deg_Lut  },
+};
+
+//Calls per second of one function, inputs spread over its range so a table backend does not sit in the cache line
+static double Calls_Per_Second(float (*function)(float), float first, float last){
+    volatile float sink = 0;
+    float step = (last - first) / 1024;
+    double start = Bench_Seconds();
+
+    for(uint32_t i = 0; i < BENCH_CALLS; i++){
+        sink += function(first + step * (float)(i & 1023));
+    }
+    return(BENCH_CALLS / (Bench_Seconds() - start));
+}
+
+int main(void){
+    printf("Budget %.3f degrees\n\n", IK_TRIG_BUDGET_DEG);
+    printf("Backend  acos max (deg)  sin max         cos max         acos (M/s)  sin (M/s)  cos (M/s)\n");
+
+    for(uint32_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++){
+        const struct trig_backend *backend = &backends[b];
+        double acos_error = 0, sin_error = 0, cos_error = 0;
+
+        for(uint32_t i = 0; i < BENCH_SWEEP; i++){
+            float a = (float)(-1.0 + 2.0 * i / (BENCH_SWEEP - 1));
+            float degrees = (float)(-360.0 + 720.0 * i / (BENCH_SWEEP - 1));
+            double error;
+
+            error = fabs(backend->acos_deg(a) - acos((double)a) * 180.0 / M_PI);
+            if(error > acos_error) acos_error = error;
+            error = fabs(backend->sin_deg(degrees) - sin((double)degrees * M_PI / 180.0));
+            if(error > sin_error) sin_error = error;
+            error = fabs(backend->cos_deg(degrees) - cos((double)degrees * M_PI / 180.0));
+            if(error > cos_error) cos_error = error;
+        }
+
+        printf("%-7s  %-14.6f  %.1e (%.4f)  %.1e (%.4f)  %-10.1f  %-9.1f  %.1f  %s\n", backend->name, acos_error,
+               sin_error, sin_error * 180.0 / M_PI, cos_error, cos_error * 180.0 / M_PI,
+               Calls_Per_Second(backend->acos_deg, -1.0f, 1.0f) / 1e6,
+               Calls_Per_Second(backend->sin_deg, -360.0f, 360.0f) / 1e6,
+               Calls_Per_Second(backend->cos_deg, -360.0f, 360.0f) / 1e6,
+               (acos_error < IK_TRIG_BUDGET_DEG && sin_error * 180.0 / M_PI < IK_TRIG_BUDGET_DEG &&
+                cos_error * 180.0 / M_PI < IK_TRIG_BUDGET_DEG) ? "within budget" : "OVER BUDGET");
+    }
+    return(0);
+}
@@ -0,0 +1,201 @@
+/**
+ * @file    bench_plan.c
+ * @brief   Benchmark scenes for the motion planner (Coord_Plan.c): planning time, success and path checks
+ * @details Target build: add bench_plan.c, Coord_Plan.c, Coord_Branch.c, Coord_Batch.c, Coord_Asimov.c and Coord_Trig.c
+ *          to the project. Cycles are counted with SysTick, so plans over 2^24 cycles wrap.
+ *          Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_plan.c Coord_Plan.c Coord_Branch.c Coord_Batch.c Coord_Asimov.c Coord_Trig.c -lm -o bench_plan
+ *          The host reports nanoseconds instead of cycles.
+ *
+ *          Each scene is a work cell for a 120/120/60 arm with two zones to pick and place between. BENCH_QUERIES
+ *          random grabber positions, in one zone then the other, with a collision free branch are visited in turn,
+ *          each planned from where the last one ended. Every edge of every path is checked again with
+ *          BENCH_FINE_DEG steps: the edge checks cover the whole motion, so any hit there fails the bench. The scenes:
+ *              Open        No fixtures, the table only
+ *              Wall        Across the cell between the zones, reach over or round it
+ *              Shelf       Two shelves with posts, grabber level, from the lower shelf to the upper one
+ *              Pillars     3 x 3 columns, between two of the gaps
+ *              Bins        Two open bins, grabber down, in over one rim and out over the other
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "Coord_Asimov.h"
+#include "Coord_Branch.h"
+#include "Coord_Plan.h"
+#include "bench_common.h"
+
+#define BENCH_QUERIES       50
+#define BENCH_ARENA_BYTES   65536
+#define BENCH_MAX_WAYPOINTS 64
+#define BENCH_FINE_DEG      0.25f
+
+static const struct IK_Joint_Limits bench_limits = {
+    { -90.0f, -20.0f, 30.0f, -120.0f },
+    { 270.0f, 200.0f, 330.0f, 120.0f }
+};
+static const float link_radius[3] = { 10.0f, 8.0f, 6.0f };
+static const float home[4] = { 45.0f, 90.0f, 90.0f, 0.0f };
+
+static const struct Plan_Box wall[] = {
+    { { 100, -40, 0 }, { 110, 260, 80 } }
+};
+static const struct Plan_Box shelf[] = {
+    { { 150, 0, 70 }, { 260, 160, 76 } },           //Lower board
+    { { 150, 0, 150 }, { 260, 160, 156 } },         //Upper board
+    { { 150, 0, 0 }, { 156, 6, 156 } },             //Posts
+    { { 254, 0, 0 }, { 260, 6, 156 } },
+    { { 150, 154, 0 }, { 156, 160, 156 } },
+    { { 254, 154, 0 }, { 260, 160, 156 } }
+};
+static const struct Plan_Box pillars[] = {
+    { { 60, 0, 0 }, { 75, 15, 70 } }, { { 130, 0, 0 }, { 145, 15, 70 } }, { { 200, 0, 0 }, { 215, 15, 70 } },
+    { { 60, 80, 0 }, { 75, 95, 70 } }, { { 130, 80, 0 }, { 145, 95, 70 } }, { { 200, 80, 0 }, { 215, 95, 70 } },
+    { { 60, 160, 0 }, { 75, 175, 70 } }, { { 130, 160, 0 }, { 145, 175, 70 } }, { { 200, 160, 0 }, { 215, 175, 70 } }
+};
+static const struct Plan_Box bins[] = {
+    { { 140, 10, 0 }, { 250, 14, 60 } },            //Bin A walls
+    { { 140, 96, 0 }, { 250, 100, 60 } },
+    { { 140, 10, 0 }, { 144, 100, 60 } },
+    { { 246, 10, 0 }, { 250, 100, 60 } },
+    { { 20, 140, 0 }, { 24, 250, 60 } },            //Bin B walls
+    { { 106, 140, 0 }, { 110, 250, 60 } },
+    { { 20, 140, 0 }, { 110, 144, 60 } },
+    { { 20, 246, 0 }, { 110, 250, 60 } }
+};
+
+struct bench_scene {
+    const char *Name;
+    const struct Plan_Box *Boxes;
+    uint32_t Count;
+    struct Plan_Box Zones[2];           //Grabber positions are drawn from these in turn
+    float Grabber_Angle;
+};
+
+static const struct bench_scene scenes[] = {
+    { "Open", NULL, 0, { { { 60, 0, 0 }, { 200, 200, 150 } }, { { 60, 0, 0 }, { 200, 200, 150 } } }, 90.0f },
+    { "Wall", wall, sizeof(wall) / sizeof(wall[0]), { { { 30, 40, 0 }, { 70, 180, 40 } }, { { 140, 20, 0 }, { 190, 160, 40 } } }, 90.0f },
+    { "Shelf", shelf, sizeof(shelf) / sizeof(shelf[0]), { { { 190, 30, 25 }, { 240, 130, 55 } }, { { 190, 30, 100 }, { 240, 130, 135 } } }, 0.0f },
+    { "Pillars", pillars, sizeof(pillars) / sizeof(pillars[0]), { { { 155, 25, 0 }, { 185, 65, 40 } }, { { 85, 110, 0 }, { 115, 145, 40 } } }, 90.0f },
+    { "Bins", bins, sizeof(bins) / sizeof(bins[0]), { { { 160, 25, 10 }, { 230, 85, 40 } }, { { 35, 160, 10 }, { 95, 230, 40 } } }, 90.0f }
+};
+
+static uint64_t arena_memory[BENCH_ARENA_BYTES / 8];
+static float waypoints[BENCH_MAX_WAYPOINTS][4];
+
+//Configurations along an edge every BENCH_FINE_DEG that hit something
+static uint32_t Fine_Check(struct Planner *planner, const float *from, const float *to){
+    float largest = 0, angles[4];
+    uint32_t steps, hits = 0;
+
+    for(int j = 0; j < 4; j++){
+        largest = fmaxf(largest, fabsf(to[j] - from[j]));
+    }
+    steps = (uint32_t)ceilf(largest / BENCH_FINE_DEG);
+    for(uint32_t k = 0; k <= steps; k++){
+        for(int j = 0; j < 4; j++){
+            angles[j] = from[j] + (to[j] - from[j]) * ((float)k / (float)(steps ? steps : 1));
+        }
+        hits += !Plan_Config_Free(planner, angles);
+    }
+    return(hits);
+}
+
+int main(void){
+    struct RobotArm arm;
+    struct IK_Scratch scratch;
+    struct IK_Solutions solutions;
+    struct Plan_Arena arena;
+    struct Plan_Scene scene;
+    struct Planner planner, checker;
+    uint32_t all_fine_hits = 0, all_unsolved = 0;
+
+    Bench_Init();
+
+    Arm_Init(&arm, BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+    printf("%u queries per scene, arena %u bytes, links %.0f/%.0f/%.0f radius, edges checked every %.1f units\n\n", BENCH_QUERIES,
+           BENCH_ARENA_BYTES, link_radius[0], link_radius[1], link_radius[2], PLAN_CHECK_MOVE);
+    printf("Scene    Boxes  Solved  Mean %-6s  Worst %-6s  Waypoints  Nodes  Checks  Fine hits\n", BENCH_UNIT, BENCH_UNIT);
+
+    for(uint32_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++){
+        float from[4];
+        uint32_t seed = 99, solved = 0, total_time = 0, worst_time = 0, total_waypoints = 0, total_nodes = 0, total_checks = 0, fine_hits = 0;
+        uint32_t queries = 0, tries = 0;
+
+        Plan_Arena_Init(&arena, arena_memory, sizeof(arena_memory));
+        if(Plan_Scene_Build(&scene, &arena, scenes[s].Boxes, scenes[s].Count) != E_NO_ERROR ||
+           Plan_Init(&planner, &arm, &scene, &bench_limits, link_radius, &arena, 12345) != E_NO_ERROR){
+            printf("Cannot build %s\n", scenes[s].Name);
+            return(1);
+        }
+        checker = planner;
+        for(int j = 0; j < 4; j++) from[j] = home[j];
+
+        while(queries < BENCH_QUERIES && tries < 100000){
+            const struct Plan_Box *zone = &scenes[s].Zones[queries & 1];
+            uint16_t position[3];
+            int free_branch = 0;
+
+            //Random grabber position in the zone with at least one branch clear of the fixtures
+            tries++;
+            for(int a = 0; a < 3; a++){
+                seed = seed * 1664525u + 1013904223u;
+                position[a] = (uint16_t)(zone->Min[a] + (seed >> 8) % (uint32_t)(zone->Max[a] - zone->Min[a] + 1));
+            }
+            Arm_Solve_All(&arm, &scratch, position[0], position[1], position[2], scenes[s].Grabber_Angle, &bench_limits, &solutions);
+            for(uint32_t b = 0; b < solutions.Count; b++){
+                free_branch |= Plan_Config_Free(&checker, solutions.Angles[b]);
+            }
+            if(!free_branch){
+                continue;
+            }
+            queries++;
+
+            uint32_t start = Bench_Now();
+            int32_t count = Plan_To_Pose(&planner, from, position[0], position[1], position[2], scenes[s].Grabber_Angle, waypoints,
+                                         BENCH_MAX_WAYPOINTS);
+            uint32_t elapsed = BENCH_ELAPSED(start, Bench_Now());
+
+            total_time += elapsed;
+            if(elapsed > worst_time) worst_time = elapsed;
+            total_nodes += planner.Nodes;
+            total_checks += planner.Checks;
+            if(count <= 0){
+                continue;
+            }
+            solved++;
+            total_waypoints += (uint32_t)count;
+            for(int32_t w = 0; w + 1 < count; w++){
+                fine_hits += Fine_Check(&checker, waypoints[w], waypoints[w + 1]);
+            }
+            for(int j = 0; j < 4; j++) from[j] = waypoints[count - 1][j];
+        }
+
+        if(!queries){
+            printf("%-7s  no free grabber positions in the zones\n", scenes[s].Name);
+            continue;
+        }
+        printf("%-7s  %-5u  %2u/%-3u  %-9u  %-10u  %-9.1f  %-5u  %-6u  %u\n", scenes[s].Name, scenes[s].Count, solved, queries,
+               total_time / queries, worst_time, solved ? (float)total_waypoints / solved : 0.0f, total_nodes / queries,
+               total_checks / queries, fine_hits);
+        all_fine_hits += fine_hits;
+        all_unsolved += queries - solved;
+    }
+    printf("\nNodes and Checks are means per query. Fine hits are configurations on the paths that hit something when the\n"
+           "edges are checked every %.2f deg.\n", BENCH_FINE_DEG);
+    if(all_fine_hits){
+        printf("FAIL: %u configurations on planned paths hit something\n", all_fine_hits);
+    }
+    if(all_unsolved){
+        printf("FAIL: %u queries with a free goal were not solved\n", all_unsolved);
+    }
+
+#ifndef COORD_HOST
+    while(1) {
+
+    }
+#endif
+    return((all_fine_hits || all_unsolved) ? 1 : 0);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file    bench_profile.c
+ * @brief   Move times and limit checks of the joint profiles (Coord_Profile.c), and the cost of a sample
+ * @details Target build: add bench_profile.c and Coord_Profile.c to the project. Cycles are counted with SysTick.
+ *          Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_profile.c Coord_Profile.c -lm -o bench_profile
+ *          The host reports nanoseconds instead of cycles.
+ *
+ *          BENCH_MOVES random moves between servo angles are planned as S-curves and as trapezoids. Each is run
+ *          through Profile_Evaluate() every BENCH_CHECK_STEP seconds: the joint speeds and accelerations must stay
+ *          within the limits, the jerk (difference of the accelerations) too for the S-curve, and no joint may go
+ *          back or past its end angle. The samples must end on the end angles together. The acceleration at a float
+ *          time is off by up to about one float step of the time (1.2e-7 s at 1 s) times the jerk, which is 0.1% of
+ *          a 1e-4 s difference, so the sampled jerk can read a little over the limit (BENCH_TOL allows for it). The
+ *          planned jerk of each joint is checked against its limit exactly and counted with the faults. Times are compared with:
+ *              Slew bound      largest |To - From| / Velocity: the servos jumping to speed, what sending the
+ *                              target straight to them assumes
+ *              Each joint      slowest joint planned on its own: what synchronizing the joints costs
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "Coord_Profile.h"
+#include "bench_common.h"
+
+#define BENCH_MOVES         500
+#define BENCH_CHECK_STEP    1e-4f       //Seconds between checks
+#define BENCH_TOL           1.001f      //Limit ratio allowed for float rounding
+
+//Base, Shoulder, Elbow and Wrist: the shoulder carries the most and is the slowest
+static const struct Profile_Limits bench_limits = {
+    { 180.0f, 120.0f, 150.0f, 300.0f },
+    { 720.0f, 400.0f, 600.0f, 1500.0f },
+    { 6000.0f, 3000.0f, 5000.0f, 20000.0f }
+};
+
+//Worst limit ratios over a move, and whether it ever went back, past its end or did not end on it
+static void Check_Move(const struct Profile *profile, const struct Profile_Limits *limits, int check_jerk, float *worst, uint32_t *faults){
+    float angles[4], velocity[4], acceleration[4], last_angles[4], last_acceleration[4], last_t = 0;
+    struct Traj_Setpoint setpoint;
+
+    Profile_Evaluate(profile, 0, last_angles, NULL, last_acceleration);
+    //Times from the step count rather than summed, and the jerk over the spacing the floats actually have
+    for(uint32_t k = 1; (float)(k - 1) * BENCH_CHECK_STEP < profile->Duration; k++){
+        float t = (float)k * BENCH_CHECK_STEP;
+        Profile_Evaluate(profile, t, angles, velocity, acceleration);
+        for(int j = 0; j < 4; j++){
+            float ratio[3];
+            ratio[0] = fabsf(velocity[j]) / limits->Velocity[j];
+            ratio[1] = fabsf(acceleration[j]) / limits->Acceleration[j];
+            ratio[2] = check_jerk ? fabsf(acceleration[j] - last_acceleration[j]) / (t - last_t) / limits->Jerk[j] : 0;
+            for(int k = 0; k < 3; k++){
+                if(ratio[k] > worst[k]) worst[k] = ratio[k];
+            }
+
+            //Progress along the move only rises and stays between the ends
+            float delta = profile->To[j] - profile->From[j];
+            if((angles[j] - last_angles[j]) * delta < 0 || (angles[j] - profile->From[j]) * delta < 0 || (profile->To[j] - angles[j]) * delta < 0){
+                (*faults)++;
+            }
+            last_angles[j] = angles[j];
+            last_acceleration[j] = acceleration[j];
+        }
+        last_t = t;
+    }
+
+    Profile_Sample(profile, profile->Samples, &setpoint);
+    for(int j = 0; j < 4; j++){
+        if(setpoint.Angles[j] != profile->To[j]){
+            (*faults)++;
+        }
+        //The planned jerk is checked as it is, up to the rounding of the division that made it
+        if(check_jerk && fabsf(profile->Delta[j] * profile->Jerk) > limits->Jerk[j] * 1.000001f){
+            (*faults)++;
+        }
+    }
+}
+
+int main(void){
+    struct Profile profile;
+    struct Profile_Limits trapezoid = bench_limits;
+    struct Traj_Setpoint setpoint;
+    float from[4], to[4], single[4];
+    uint32_t seed = 77, start, plan_time = 0, sample_time = 0, samples = 0;
+
+    Bench_Init();
+
+    for(int j = 0; j < 4; j++){
+        trapezoid.Jerk[j] = 0;
+    }
+
+    printf("%u random moves at %u Hz     Mean s  Worst speed  Worst accel  Worst jerk  Faults  vs slew bound  vs each joint\n", BENCH_MOVES, TRAJ_RATE_HZ);
+    for(int shape = 0; shape < 2; shape++){
+        const struct Profile_Limits *limits = shape ? &trapezoid : &bench_limits;
+        float worst[3] = { 0, 0, 0 };
+        double total = 0, slew = 0, each = 0;
+        uint32_t faults = 0;
+
+        seed = 77;
+        for(uint32_t m = 0; m < BENCH_MOVES; m++){
+            float slew_time = 0, each_time = 0;
+
+            for(int j = 0; j < 4; j++){
+                seed = seed * 1664525u + 1013904223u;
+                from[j] = (float)((seed >> 8) % 18000) * 0.01f;
+                seed = seed * 1664525u + 1013904223u;
+                to[j] = (float)((seed >> 8) % 18000) * 0.01f;
+                slew_time = fmaxf(slew_time, fabsf(to[j] - from[j]) / limits->Velocity[j]);
+            }
+
+            //Each joint on its own
+            for(int j = 0; j < 4; j++){
+                for(int k = 0; k < 4; k++) single[k] = (k == j) ? to[k] : from[k];
+                Profile_Init(&profile, NULL);
+                Profile_Move(&profile, from, single, limits);
+                each_time = fmaxf(each_time, profile.Duration);
+            }
+
+            Profile_Init(&profile, NULL);
+            start = Bench_Now();
+            if(Profile_Move(&profile, from, to, limits) != E_NO_ERROR){
+                printf("Cannot plan move %u\n", m);
+                return(1);
+            }
+            plan_time += BENCH_ELAPSED(start, Bench_Now());
+
+            Check_Move(&profile, limits, !shape, worst, &faults);
+            total += profile.Duration;
+            slew += profile.Duration / slew_time;
+            each += profile.Duration / each_time;
+
+            start = Bench_Now();
+            for(uint32_t i = 0; i <= profile.Samples; i++){
+                Profile_Sample(&profile, i, &setpoint);
+            }
+            sample_time += BENCH_ELAPSED(start, Bench_Now());
+            samples += profile.Samples + 1;
+        }
+        printf("%-29s  %-6.3f  %-11.4f  %-11.4f  %-10.4f  %-6u  %-13.2f  %.3f\n", shape ? "Trapezoid (no jerk limit)" : "S-curve",
+               total / BENCH_MOVES, worst[0], worst[1], shape ? 0.0f : worst[2], faults, slew / BENCH_MOVES, each / BENCH_MOVES);
+        if(worst[0] > BENCH_TOL || worst[1] > BENCH_TOL || (!shape && worst[2] > BENCH_TOL) || faults){
+            printf("Limit or end check failed\n");
+        }
+    }
+    printf("\nWorst columns are the highest |value| / limit of any joint. Worst jerk is sampled, rounding of the sample times\n"
+           "can put it up to 0.1%% over the limit; the planned jerk is checked exactly (Faults). %s per Profile_Move() %u, per sample %u\n",
+           BENCH_UNIT, plan_time / (2 * BENCH_MOVES), sample_time / samples);
+
+#ifndef COORD_HOST
+    while(1) {
+
+    }
+#endif
+    return(0);
+}
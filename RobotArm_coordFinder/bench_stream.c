@@ -0,0 +1,178 @@
+/**
+ * @file    bench_stream.c
+ * @brief   Producer, solver and servo threads on one IK pipeline (Coord_Stream.c): consistency, drops and latency
+ * @details Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_stream.c Coord_Stream.c Coord_Asimov.c Coord_Trig.c -lm -lpthread -o bench_stream
+ *
+ *          Each scenario runs three threads for BENCH_SECONDS: the producer pushes a target every producer period,
+ *          the solver calls Stream_Solve() as fast as it can (yielding when the ring is empty), and the servo thread
+ *          calls Stream_Read() every servo period. Targets come from a table solved up front, so every read is
+ *          checked against the angles its Stamp should have: a read mixing two solves counts as torn. Stamps and
+ *          Numbers may only go up. Latency is from Stream_Push() to the first read that has the solution.
+ *          With fewer cores than threads the OS preempts the threads anywhere, the worst case for torn reads.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "Coord_Asimov.h"
+#include "Coord_Stream.h"
+#include "bench_common.h"
+
+#define BENCH_TARGETS       4096        //Target table, Stamp % BENCH_TARGETS picks the entry (power of 2)
+#define BENCH_STAMPS        65536       //Push times kept for the latency (power of 2)
+#define BENCH_SECONDS       1.0
+
+struct bench_scenario {
+    const char *name;
+    uint32_t producer_us;               //0 pushes back to back
+    uint32_t servo_us;
+};
+
+static const struct bench_scenario scenarios[] = {
+    { "camera 30 Hz, servo 1 kHz", 33333, 1000 },
+    { "camera 1 kHz, servo 1 kHz", 1000, 1000 },
+    { "producer 10 kHz, servo 500 Hz", 100, 2000 },
+    { "producer flood, servo 1 kHz", 0, 1000 },
+    { "producer flood, servo flood", 0, 0 }
+};
+
+static struct RobotArm arm;
+static struct IK_Stream stream;
+static uint16_t target_x[BENCH_TARGETS], target_y[BENCH_TARGETS], target_z[BENCH_TARGETS];
+static float target_grabber[BENCH_TARGETS];
+static float expected[BENCH_TARGETS][6];
+static double push_time[BENCH_STAMPS];
+static volatile int running;
+static const struct bench_scenario *scenario;
+
+//Servo results
+static uint32_t reads, torn, out_of_order, latency_count;
+static double latency_total, latency_worst;
+static uint32_t pushed;
+
+static void Sleep_Us(uint32_t us){
+    struct timespec ts = { us / 1000000, (long)(us % 1000000) * 1000 };
+    if(us){
+        nanosleep(&ts, NULL);
+    }
+    else{
+        sched_yield();
+    }
+}
+
+static void *Producer_Thread(void *arg){
+    uint32_t stamp = 0;
+    (void)arg;
+
+    while(running){
+        uint32_t t = stamp & (BENCH_TARGETS - 1);
+        push_time[stamp & (BENCH_STAMPS - 1)] = Bench_Seconds();
+        if(Stream_Push(&stream, target_x[t], target_y[t], target_z[t], target_grabber[t], stamp) == E_NO_ERROR){
+            stamp++;
+        }
+        Sleep_Us(scenario->producer_us);
+    }
+    pushed = stamp;
+    return(NULL);
+}
+
+static void *Solver_Thread(void *arg){
+    (void)arg;
+
+    while(running){
+        if(Stream_Solve(&stream) == 0){
+            sched_yield();
+        }
+    }
+    return(NULL);
+}
+
+static void *Servo_Thread(void *arg){
+    struct Stream_Solution solution;
+    uint32_t last_number = 0, last_stamp = 0;
+    (void)arg;
+
+    while(running){
+        if(Stream_Read(&stream, &solution) == E_NO_ERROR){
+            reads++;
+            if(memcmp(solution.Angles, expected[solution.Stamp & (BENCH_TARGETS - 1)], sizeof(solution.Angles))){
+                torn++;
+            }
+            if(solution.Number < last_number || solution.Stamp < last_stamp){
+                out_of_order++;
+            }
+            if(solution.Number != last_number){
+                double latency = Bench_Seconds() - push_time[solution.Stamp & (BENCH_STAMPS - 1)];
+                latency_total += latency;
+                latency_count++;
+                if(latency > latency_worst) latency_worst = latency;
+            }
+            last_number = solution.Number;
+            last_stamp = solution.Stamp;
+        }
+        Sleep_Us(scenario->servo_us);
+    }
+    return(NULL);
+}
+
+int main(void){
+    struct IK_Scratch scratch;
+    uint32_t seed = 5, failed = 0;
+
+    Arm_Init(&arm, BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+
+    //Reachable targets only, so every pushed target is published
+    for(uint32_t t = 0; t < BENCH_TARGETS;){
+        seed = seed * 1664525u + 1013904223u;
+        target_x[t] = (uint16_t)(20 + (seed >> 8) % 180);
+        seed = seed * 1664525u + 1013904223u;
+        target_y[t] = (uint16_t)(20 + (seed >> 8) % 180);
+        seed = seed * 1664525u + 1013904223u;
+        target_z[t] = (uint16_t)((seed >> 8) % 150);
+        target_grabber[t] = (float)((seed >> 4) % 91);
+        Arm_Solve(&arm, &scratch, target_x[t], target_y[t], target_z[t], target_grabber[t], expected[t]);
+        if(!isnan(expected[t][0]) && !isnan(expected[t][1]) && !isnan(expected[t][2])){
+            t++;
+        }
+    }
+
+    printf("%.1f s per scenario, ring %u slots\n\n", BENCH_SECONDS, STREAM_RING_SLOTS);
+    printf("Scenario                        Pushed    Dropped  Skipped   Solved   Reads     Torn  Order  Mean us  Worst us\n");
+    for(uint32_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++){
+        pthread_t threads[3];
+        double start;
+
+        scenario = &scenarios[s];
+        Stream_Init(&stream, &arm);
+        reads = torn = out_of_order = latency_count = pushed = 0;
+        latency_total = latency_worst = 0;
+
+        running = 1;
+        pthread_create(&threads[0], NULL, Servo_Thread, NULL);
+        pthread_create(&threads[1], NULL, Solver_Thread, NULL);
+        pthread_create(&threads[2], NULL, Producer_Thread, NULL);
+        start = Bench_Seconds();
+        while(Bench_Seconds() - start < BENCH_SECONDS){
+            Sleep_Us(10000);
+        }
+        running = 0;
+        for(int i = 0; i < 3; i++){
+            pthread_join(threads[i], NULL);
+        }
+
+        printf("%-30s  %-8u  %-7u  %-8u  %-7u  %-8u  %-4u  %-5u  %-7.1f  %.1f\n", scenario->name, pushed, stream.Dropped,
+               stream.Skipped, stream.Solved, reads, torn, out_of_order,
+               latency_count ? latency_total / latency_count * 1e6 : 0.0, latency_worst * 1e6);
+        failed |= torn | out_of_order | stream.Unreachable;
+    }
+    printf("\nSkipped targets were replaced by a newer one before the solver got to them. Torn and Order must be 0.\n");
+
+    return(failed ? 1 : 0);
+}
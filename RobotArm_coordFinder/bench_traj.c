@@ -0,0 +1,127 @@
+/**
+ * @file    bench_traj.c
+ * @brief   Cost per sample of the trajectory generator against the TRAJ_RATE_HZ sample period
+ * @details Target build: add bench_traj.c, Coord_Trajectory.c, Coord_Asimov.c and Coord_Trig.c to the project. Cycles
+ *          are counted with SysTick.
+ *          Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. bench_traj.c Coord_Trajectory.c Coord_Asimov.c Coord_Trig.c -lm -o bench_traj
+ *          The host reports nanoseconds instead of cycles.
+ *
+ *          Each path runs the way the servo and fill routines do at steady state: one setpoint out, then
+ *          Traj_Fill() tops the ring back up by one sample, timed. The worst of those has to fit in the sample period
+ *          along with everything else the core does, the mean is what the fill routine costs on average.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "Coord_Asimov.h"
+#include "Coord_Trajectory.h"
+#include "bench_common.h"
+
+struct bench_path {
+    const char *name;
+    uint8_t arc;
+    struct Traj_Pose start, end, center;
+    float speed;                        //Units per second
+};
+
+static const struct bench_path paths[] = {
+    { "line 100 u/s",             0, { 150,  40,  60, 30 }, { 60, 150, 120, 30 }, { 0, 0, 0, 0 },   100 },
+    { "line 800 u/s",             0, { 150,  40,  60, 30 }, { 60, 150, 120, 30 }, { 0, 0, 0, 0 },   800 },
+    { "line 100 u/s, turning",    0, { 150,  40,  60,  0 }, { 60, 150, 120, 60 }, { 0, 0, 0, 0 },   100 },
+    { "arc 100 u/s",              1, { 160,  40,  80, 45 }, { 40, 160,  80, 45 }, { 40, 40, 80, 0 }, 100 },
+};
+
+static struct Traj_Setpoint last_setpoint;
+static uint32_t out_of_order;
+
+#ifdef COORD_HOST
+#define BENCH_PERIOD                (1000000000u / TRAJ_RATE_HZ)
+#else
+#define BENCH_PERIOD                (SystemCoreClock / TRAJ_RATE_HZ)
+#endif
+
+//Stands in for the servo driver, checks the setpoints come out in order
+static void Bench_Output(const struct Traj_Setpoint *setpoint){
+    if(setpoint->Sample != 0 && setpoint->Sample != last_setpoint.Sample + 1){
+        out_of_order++;
+    }
+    last_setpoint = *setpoint;
+}
+
+int main(void){
+    static struct Trajectory traj;
+    struct RobotArm arm;
+    struct IK_Scratch scratch;
+    float expected[6];
+    uint32_t start, elapsed;
+
+    Bench_Init();
+
+    Arm_Init(&arm, BENCH_LINK_1, BENCH_LINK_2, BENCH_LINK_WRIST);
+
+    printf("Sample period %u %s (%d Hz), ring %d slots\n\n", BENCH_PERIOD, BENCH_UNIT, TRAJ_RATE_HZ, TRAJ_RING_SLOTS);
+    printf("Path                    Samples  Solved  Reused  Mean %-6s  Worst %-6s  Worst %%  End error (deg)\n", BENCH_UNIT, BENCH_UNIT);
+
+    for(uint32_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++){
+        const struct bench_path *path = &paths[p];
+        uint32_t total = 0, worst = 0, samples = 0;
+        float end_error = 0;
+        int rslt;
+
+        Traj_Init(&traj, &arm, Bench_Output);
+        out_of_order = 0;
+        if(path->arc){
+            rslt = Traj_Arc(&traj, &path->start, &path->end, &path->center, 0, path->speed);
+        }
+        else{
+            rslt = Traj_Line(&traj, &path->start, &path->end, 0, path->speed);
+        }
+        if(rslt != E_NO_ERROR){
+            printf("%-22s  rejected (%d)\n", path->name, rslt);
+            continue;
+        }
+
+        //Prime the ring the way the fill routine would before the servo routine starts taking setpoints
+        if(Traj_Fill(&traj) < 0){
+            printf("%-22s  out of reach\n", path->name);
+            continue;
+        }
+        while(Traj_Count(&traj)){
+            Traj_Routine(&traj);
+
+            start = Bench_Now();
+            rslt = Traj_Fill(&traj);
+            elapsed = BENCH_ELAPSED(start, Bench_Now());
+            if(rslt < 0){
+                printf("%-22s  out of reach at sample %u\n", path->name, traj.Next_Sample);
+                break;
+            }
+            if(rslt > 0){
+                total += elapsed;
+                samples++;
+                if(elapsed > worst) worst = elapsed;
+            }
+        }
+
+        //The last setpoint has to be the end pose exactly
+        Arm_Solve(&arm, &scratch, (uint16_t)(path->end.x + 0.5f), (uint16_t)(path->end.y + 0.5f), (uint16_t)(path->end.z + 0.5f), path->end.Grabber_Angle, expected);
+        for(int j = 0; j < 4; j++){
+            float error = fabsf(last_setpoint.Angles[j] - expected[j]);
+            if(error > end_error) end_error = error;
+        }
+
+        printf("%-22s  %-7u  %-6u  %-6u  %-11u  %-12u  %-7.2f  %.5f%s\n", path->name, traj.Samples + 1, traj.Solved, traj.Reused,
+               samples ? total / samples : 0, worst, 100.0 * worst / BENCH_PERIOD, end_error,
+               out_of_order ? "  OUT OF ORDER" : "");
+    }
+
+#ifndef COORD_HOST
+    while(1) {
+
+    }
+#endif
+    return(0);
+}
@@ -0,0 +1,215 @@
+/**
+ * @file    reach_map_gen_host.c
+ * @brief   Build a reachability map image (Coord_Reach.h) for one arm, check it, and write it as a file and as C
+ * @details Host build, for example:
+ *              gcc -O2 -DCOORD_HOST -I. reach_map_gen_host.c Coord_Reach.c Coord_Asimov.c Coord_Trig.c -lm -o reach_map_gen
+ *              ./reach_map_gen 120 120 60 [cell shift] [grabber angle step] [map.bin] [map.c]
+ *          Build it with the same -DIK_TRIG as the firmware, the map remembers the backend and Reach_Map_Attach()
+ *          refuses a mismatch. Defaults: cells of 8 units (shift 3), grabber angles 0 to 90 every 15 degrees plus the
+ *          straight wrist, reach_map.bin and reach_map.c.
+ *
+ *          Every whole unit position in the reach of the arm is run through Arm_Solve(). A position further than
+ *          BaseToElbow + ElbowToWrist + Wrist + 1 from the shoulder is out of reach without solving: the wrist joint
+ *          can be at most BaseToElbow + ElbowToWrist away and the rounded grabber offset at most Wrist + 0.87.
+ *
+ *          The written file is then mapped with mmap() and attached the way a host planner would use it, and every
+ *          BENCH_CHECK_STEP units of it is checked against Arm_Solve(). The solutions are also put back through
+ *          Arm_Forward() to check they land on the target. reach_map.c holds the same bytes as a const array for
+ *          flash:
+ *              extern const uint32_t Reach_Map_Image[];
+ *              extern const uint32_t Reach_Map_Image_Size;
+ *              Reach_Map_Attach(&map, Reach_Map_Image, Reach_Map_Image_Size, &arm);
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "Coord_Asimov.h"
+#include "Coord_Reach.h"
+#include "Coord_Trig.h"
+
+#define BENCH_CHECK_STEP    3           //Units between checked positions (not a divisor of the cell size on purpose)
+
+static int Reachable(const struct RobotArm *arm, struct IK_Scratch *scratch, uint32_t x, uint32_t y, uint32_t z, float grabber, float *results){
+    Arm_Solve(arm, scratch, (uint16_t)x, (uint16_t)y, (uint16_t)z, grabber, results);
+    return(!isnan(results[0]) && !isnan(results[1]) && !isnan(results[2]));
+}
+
+//State of one cell: solve every whole unit position in it
+static Reach_Result Cell_State(const struct RobotArm *arm, struct IK_Scratch *scratch, uint32_t cx, uint32_t cy, uint32_t cz, uint32_t shift, float grabber){
+    uint32_t size = 1u << shift, reachable = 0, total = 0;
+    double bound = (double)arm->Len_BaseToElbow + arm->Len_ElbowToWrist + arm->Len_Wrist + 1;
+    double bound_sqrd = bound * bound;
+    double near_x = (double)(cx << shift), near_y = (double)(cy << shift), near_z = (double)(cz << shift);
+    float results[6];
+
+    //Closest corner out of reach, so is the whole cell
+    if(near_x * near_x + near_y * near_y + near_z * near_z > bound_sqrd){
+        return(REACH_NO);
+    }
+
+    for(uint32_t z = cz << shift; z < (cz << shift) + size && z <= 65535; z++){
+        for(uint32_t y = cy << shift; y < (cy << shift) + size && y <= 65535; y++){
+            for(uint32_t x = cx << shift; x < (cx << shift) + size && x <= 65535; x++){
+                total++;
+                if((double)x * x + (double)y * y + (double)z * z <= bound_sqrd && Reachable(arm, scratch, x, y, z, grabber, results)){
+                    reachable++;
+                }
+                //Mixed already, the rest cannot change that
+                if(reachable && reachable != total){
+                    return(REACH_MAYBE);
+                }
+            }
+        }
+    }
+    return(reachable ? REACH_YES : REACH_NO);
+}
+
+static int Write_C(const char *name, const uint8_t *image, uint32_t size, const struct Reach_Map_Header *header){
+    FILE *file = fopen(name, "w");
+    uint32_t words = (size + 3) / 4;
+
+    if(file == NULL){
+        return(-1);
+    }
+    fprintf(file, "/* Generated by reach_map_gen_host.c: arm %u/%u/%u, cells of %u units, %u grabber angles from %g every %g%s, IK_TRIG %u */\n",
+            header->Len_BaseToElbow, header->Len_ElbowToWrist, header->Len_Wrist, 1u << header->Cell_Shift, header->Angled_Slices,
+            header->Angle_First, header->Angle_Step, header->Straight_Slice ? " and straight" : "", header->Trig);
+    fprintf(file, "#include <stdint.h>\n\n");
+    fprintf(file, "//uint32_t keeps the image 4 byte aligned, the bytes are little endian like the Cortex-M\n");
+    fprintf(file, "const uint32_t Reach_Map_Image_Size = %u;\n", size);
+    fprintf(file, "const uint32_t Reach_Map_Image[%u] = {\n", words);
+    for(uint32_t w = 0; w < words; w++){
+        uint32_t word = 0;
+        for(uint32_t b = 0; b < 4 && w * 4 + b < size; b++){
+            word |= (uint32_t)image[w * 4 + b] << (8 * b);
+        }
+        fprintf(file, "%s0x%08X,%s", (w % 8) ? " " : "    ", word, (w % 8 == 7 || w == words - 1) ? "\n" : "");
+    }
+    fprintf(file, "};\n");
+    fclose(file);
+    return(0);
+}
+
+int main(int argc, char **argv){
+    struct RobotArm arm;
+    struct IK_Scratch scratch;
+    struct Reach_Map_Header header;
+    struct Reach_Map map;
+    uint32_t shift = (argc > 4) ? (uint32_t)atoi(argv[4]) : 3;
+    float step = (argc > 5) ? (float)atof(argv[5]) : 15.0f;
+    const char *bin_name = (argc > 6) ? argv[6] : "reach_map.bin";
+    const char *c_name = (argc > 7) ? argv[7] : "reach_map.c";
+    uint32_t extent, size, counts[3] = { 0 }, checked = 0, wrong = 0, maybe = 0;
+    double fk_worst = 0;
+    uint8_t *image;
+    const void *mapped;
+    float results[6], tip[3], wrist[3];
+    int fd;
+
+    if(argc < 4 || shift > 8 || !(step > 0)){
+        printf("Usage: %s base_to_elbow elbow_to_wrist wrist [cell shift 0-8] [grabber angle step] [map.bin] [map.c]\n", argv[0]);
+        return(1);
+    }
+    Arm_Init(&arm, (uint16_t)atoi(argv[1]), (uint16_t)atoi(argv[2]), (uint16_t)atoi(argv[3]));
+    extent = (uint32_t)arm.Len_BaseToElbow + arm.Len_ElbowToWrist + arm.Len_Wrist + 1;
+    if(extent > 65535){
+        printf("Arm reaches past 65535 units\n");
+        return(1);
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.Magic = REACH_MAP_MAGIC;
+    header.Version = REACH_MAP_VERSION;
+    header.Cell_Shift = (uint8_t)shift;
+    header.Trig = IK_TRIG;
+    header.Cells[0] = header.Cells[1] = header.Cells[2] = (uint16_t)((extent >> shift) + 1);
+    header.Angle_First = 0;
+    header.Angle_Step = step;
+    header.Angled_Slices = (uint16_t)(90.0f / step + 1.001f);
+    header.Straight_Slice = 1;
+    header.Len_BaseToElbow = arm.Len_BaseToElbow;
+    header.Len_ElbowToWrist = arm.Len_ElbowToWrist;
+    header.Len_Wrist = arm.Len_Wrist;
+    size = Reach_Map_Size(&header);
+
+    image = calloc(1, size);
+    if(image == NULL){
+        return(1);
+    }
+    memcpy(image, &header, sizeof(header));
+
+    for(uint32_t slice = 0; slice <= header.Angled_Slices; slice++){
+        float grabber = (slice < header.Angled_Slices) ? header.Angle_First + slice * step : 91.0f;
+
+        for(uint32_t cz = 0; cz < header.Cells[2]; cz++){
+            for(uint32_t cy = 0; cy < header.Cells[1]; cy++){
+                for(uint32_t cx = 0; cx < header.Cells[0]; cx++){
+                    Reach_Result state = Cell_State(&arm, &scratch, cx, cy, cz, shift, grabber);
+                    Reach_Map_Set(image, slice, cx, cy, cz, state);
+                    counts[state]++;
+                }
+            }
+        }
+    }
+    printf("Arm %u/%u/%u, %u^3 cells of %u units, %u slices, %u bytes\n", arm.Len_BaseToElbow, arm.Len_ElbowToWrist, arm.Len_Wrist,
+           header.Cells[0], 1u << shift, header.Angled_Slices + 1, size);
+    printf("Cells: %u no, %u yes, %u maybe\n", counts[REACH_NO], counts[REACH_YES], counts[REACH_MAYBE]);
+
+    fd = open(bin_name, O_CREAT | O_TRUNC | O_RDWR, 0644);
+    if(fd < 0 || write(fd, image, size) != (ssize_t)size || Write_C(c_name, image, size, &header) != 0){
+        printf("Cannot write %s or %s\n", bin_name, c_name);
+        return(1);
+    }
+    free(image);
+
+    //Use the file the way a planner on the host would
+    mapped = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if(mapped == MAP_FAILED || Reach_Map_Attach(&map, mapped, size, &arm) != E_NO_ERROR){
+        printf("Cannot attach %s\n", bin_name);
+        return(1);
+    }
+
+    for(uint32_t slice = 0; slice <= header.Angled_Slices; slice++){
+        float grabber = (slice < header.Angled_Slices) ? header.Angle_First + slice * step : 91.0f;
+
+        for(uint32_t z = 0; z <= extent + BENCH_CHECK_STEP; z += BENCH_CHECK_STEP){
+            for(uint32_t y = 0; y <= extent + BENCH_CHECK_STEP; y += BENCH_CHECK_STEP){
+                for(uint32_t x = 0; x <= extent + BENCH_CHECK_STEP; x += BENCH_CHECK_STEP){
+                    Reach_Result state = Reach_Map_Lookup(&map, (uint16_t)x, (uint16_t)y, (uint16_t)z, grabber);
+                    int reachable = Reachable(&arm, &scratch, x, y, z, grabber, results);
+
+                    checked++;
+                    if(state == REACH_MAYBE){
+                        maybe++;
+                    }
+                    else if((state == REACH_YES) != reachable){
+                        wrong++;
+                    }
+
+                    if(reachable){
+                        double error = 0;
+                        Arm_Forward(&arm, results, wrist, tip);
+
+                        //Over 90 Arm_Solve() puts the wrist joint on the target
+                        float *point = (grabber > 90) ? wrist : tip;
+                        error = sqrt((point[0] - x) * (point[0] - x) + (point[1] - y) * (point[1] - y) + (point[2] - z) * (point[2] - z));
+                        if(error > fk_worst) fk_worst = error;
+                    }
+                }
+            }
+        }
+    }
+    printf("Checked %u positions against Arm_Solve(): %u wrong, %u maybe (%.1f%%)\n", checked, wrong, maybe, 100.0 * maybe / checked);
+    printf("Arm_Forward() of the solutions: worst distance from the target %.3f units (the solver rounds the grabber offset)\n", fk_worst);
+
+    munmap((void *)mapped, size);
+    close(fd);
+    return(wrong ? 1 : 0);
+}
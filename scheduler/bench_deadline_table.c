@@ -0,0 +1,101 @@
+/**
+ * @file    bench_deadline_table.c
+ * @brief   Countdown cost of the linked-list schedule against the struct-of-arrays deadline table
+ * @details Host build, for example:
+ *              gcc -O2 -mavx2 -DSCHEDULER_HOST -I. bench_deadline_table.c scheduler.c scheduler_chain.c circ_buff.c timebase.c \
+ *                  scheduler_timer_host.c scheduler_calibrate.c scheduler_trace.c scheduler_log.c deadline_table.c \
+ *                  -o bench_deadline_table -lpthread
+ *          Drop -mavx2 for the SSE2 kernel, or add -DDEADLINE_TABLE_16BIT for the 16-bit counters.
+ *          For 16, 256 and 4096 distinct deadlines, BENCH_UPDATES single tick updates are timed for:
+ *              linked list     scheduler_update(1) from scheduler.c, one node per deadline
+ *              table (scalar)  deadline_table_countdown_scalar()
+ *              table (vector)  deadline_table_update(), the path scheduler_compact.c uses
+ *          The periods are longer than the run, so nothing expires and only the countdown itself is measured.
+ */
+
+/* **** Includes **** */
+#include "scheduler.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "deadline_table.h"
+
+#define BENCH_UPDATES       50000       //Single tick updates per measurement
+#define BENCH_BASE_PERIOD   60000       //First deadline value, every deadline stays above BENCH_UPDATES
+#define BENCH_MAX_DEADLINES 4096
+
+static const uint32_t bench_sizes[] = {16, 256, 4096};
+
+dt_count_t counters[BENCH_MAX_DEADLINES] __attribute__((aligned(32)));
+dt_count_t periods[BENCH_MAX_DEADLINES];
+uint32_t expired[DEADLINE_TABLE_WORDS(BENCH_MAX_DEADLINES)];
+int32_t routine_ids[BENCH_MAX_DEADLINES];
+
+void Bench_Routine(){
+}
+
+uint64_t Now_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+//ns per update with the linked-list scheduler
+double Bench_Linked_List(uint32_t num_deadlines){
+    for(uint32_t i = 0; i < num_deadlines; i++){
+        routine_ids[i] = scheduler_addroutine(BENCH_BASE_PERIOD + i, Bench_Routine, LOW_PRIORITY_ROUTINE, 0);
+    }
+
+    uint64_t start = Now_ns();
+    for(uint32_t n = 0; n < BENCH_UPDATES; n++){
+        scheduler_update(1);
+    }
+    uint64_t elapsed = Now_ns() - start;
+
+    for(uint32_t i = 0; i < num_deadlines; i++){
+        scheduler_removeroutine(routine_ids[i]);
+    }
+    return((double)elapsed / BENCH_UPDATES);
+}
+
+//ns per update with the deadline table, either the full update or only the scalar countdown
+double Bench_Table(uint32_t num_deadlines, uint8_t scalar){
+    struct deadline_table table;
+    uint32_t expired_total = 0;
+
+    deadline_table_init(&table, counters, periods, expired, BENCH_MAX_DEADLINES);
+    for(uint32_t i = 0; i < num_deadlines; i++){
+        deadline_table_add(&table, BENCH_BASE_PERIOD + i);
+    }
+
+    uint64_t start = Now_ns();
+    for(uint32_t n = 0; n < BENCH_UPDATES; n++){
+        if(scalar){
+            expired_total += deadline_table_countdown_scalar(table.counters, table.count, 1, table.expired);
+        }
+        else{
+            expired_total += deadline_table_update(&table, 1);
+        }
+    }
+    uint64_t elapsed = Now_ns() - start;
+
+    if(expired_total){
+        printf("Error, %d deadlines expired during the run\n", expired_total);
+    }
+    return((double)elapsed / BENCH_UPDATES);
+}
+
+int main(void){
+    scheduler_init();
+
+    printf("Deadline countdown, ns per scheduler_update(1)\n");
+    printf("Deadlines\tLinked list\tTable scalar\tTable vector\tSpeedup\n");
+    for(uint32_t s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++){
+        uint32_t num_deadlines = bench_sizes[s];
+        double linked = Bench_Linked_List(num_deadlines);
+        double scalar = Bench_Table(num_deadlines, 1);
+        double vector = Bench_Table(num_deadlines, 0);
+        printf("%d\t\t%.1f\t\t%.1f\t\t%.1f\t\t%.1fx\n", num_deadlines, linked, scalar, vector, linked / vector);
+    }
+    return(0);
+}
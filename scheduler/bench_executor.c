@@ -0,0 +1,121 @@
+/**
+ * @file    bench_executor.c
+ * @brief   Throughput of the host work-stealing executor from 1 to N worker threads
+ * @details Host build, for example:
+ *              gcc -O2 -DSCHEDULER_HOST -DQUE_MAX_SIZE=4096 -I. bench_executor.c scheduler.c scheduler_chain.c \
+ *                  scheduler_executor_host.c circ_buff.c timebase.c scheduler_timer_host.c \
+ *                  scheduler_calibrate.c scheduler_trace.c scheduler_log.c -o bench_executor -lpthread
+ *              ./bench_executor [max workers]
+ *          BENCH_ROUTINES short routines (about BENCH_WORK_ITERATIONS steps of integer work each, split across the
+ *          three priorities) are all released on every tick. Each measurement runs BENCH_TICKS ticks and waits for the
+ *          workers to finish every tick before the next one, so the result is routines completed per second.
+ *          Every routine also checks that it is never running on two workers at once.
+ */
+
+/* **** Includes **** */
+#include "scheduler.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "scheduler_executor_host.h"
+
+#define BENCH_ROUTINES          3072        //1024 per priority, fits one worker's deques
+#define BENCH_TICKS             200
+#define BENCH_WORK_ITERATIONS   500
+
+#if !defined(QUE_MAX_SIZE) || QUE_MAX_SIZE < BENCH_ROUTINES
+#error "bench_executor.c must be built with -DQUE_MAX_SIZE=4096 so every routine fits in the ready que"
+#endif
+
+uint32_t running[BENCH_ROUTINES];           //Workers inside each routine right now
+uint32_t results[BENCH_ROUTINES];
+uint32_t reentered = 0;                     //Times a routine was found running on two workers
+uint32_t completed = 0;
+
+void Bench_Routine(uint32_t index){
+    if(__atomic_fetch_add(&running[index], 1, __ATOMIC_ACQUIRE)){
+        __atomic_fetch_add(&reentered, 1, __ATOMIC_RELAXED);
+    }
+
+    //Short piece of integer work
+    uint32_t x = index + 1;
+    for(int i = 0; i < BENCH_WORK_ITERATIONS; i++){
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+    results[index] = x;
+
+    __atomic_fetch_add(&completed, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&running[index], 1, __ATOMIC_RELEASE);
+}
+
+uint64_t Now_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+//Routines completed per second with this many workers
+double Bench_Workers(uint32_t num_workers, uint64_t *stolen){
+    struct executor_stats stats;
+
+    if(scheduler_executor_start(num_workers)){
+        return(0);
+    }
+    completed = 0;
+    uint64_t start = Now_ns();
+    for(int tick = 0; tick < BENCH_TICKS; tick++){
+        scheduler_update(1);
+        scheduler_executor_wait();
+    }
+    uint64_t elapsed = Now_ns() - start;
+
+    scheduler_executor_stop();
+    *stolen = 0;
+    for(uint32_t i = 0; i < num_workers; i++){
+        if(!scheduler_executor_get_stats(i, &stats)){
+            *stolen += stats.stolen;
+        }
+    }
+
+    if(completed != (uint32_t)BENCH_ROUTINES * BENCH_TICKS){
+        printf("Error, %d of %d routines completed\n", completed, BENCH_ROUTINES * BENCH_TICKS);
+    }
+    return((double)completed * 1e9 / elapsed);
+}
+
+int main(int argc, char **argv){
+    uint32_t max_workers = (argc > 1) ? (uint32_t)atoi(argv[1]) : (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    struct scheduler_stats stats;
+    uint64_t stolen;
+    double single = 0;
+
+    if(!max_workers || max_workers > EXECUTOR_MAX_WORKERS){
+        max_workers = 1;
+    }
+
+    scheduler_init();
+    for(uint32_t i = 0; i < BENCH_ROUTINES; i++){
+        scheduler_addroutine(1, Bench_Routine, (Scheduler_Priority)(i % 3), 1, i);
+    }
+
+    printf("%d routines released every tick, %d ticks\n", BENCH_ROUTINES, BENCH_TICKS);
+    printf("Workers\tRoutines/s\tSpeedup\tStolen\n");
+    for(uint32_t workers = 1; workers <= max_workers; workers = (workers < max_workers && workers * 2 > max_workers) ? max_workers : workers * 2){
+        double rate = Bench_Workers(workers, &stolen);
+        if(workers == 1){
+            single = rate;
+        }
+        printf("%d\t%.0f\t%.2fx\t%llu\n", workers, rate, rate / single, (unsigned long long)stolen);
+        if(workers == max_workers){
+            break;
+        }
+    }
+
+    scheduler_get_stats(&stats);
+    printf("\nReentered routines: %d, que overflows: %d\n", reentered, stats.que_overflows);
+    return(0);
+}
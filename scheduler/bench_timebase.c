@@ -0,0 +1,109 @@
+/**
+ * @file    bench_timebase.c
+ * @brief   Period accuracy and CPU overhead benchmark for the high resolution time base
+ * @details Build together with scheduler.c, scheduler_chain.c, scheduler_trace.c, scheduler_log.c, circ_buff.c, timebase.c,
+ *          scheduler_timer.c and scheduler_calibrate.c using -DSCHEDULER_TICK_US=100.
+ *          BENCH_ROUTINES routines are released every tick (10 kHz). Each one records the cycle count
+ *          between its own releases, and the idle loop in main() is timed with and without the scheduler
+ *          running to get the CPU time spent in the tick ISR.
+ */
+
+/* **** Includes **** */
+#include "scheduler.h"
+#include <stdio.h>
+#include "mxc_delay.h"
+#include "timebase.h"
+
+#if SCHEDULER_TICK_US != 100
+#error "bench_timebase.c must be built with -DSCHEDULER_TICK_US=100"
+#endif
+
+#define BENCH_ROUTINES      4           //Routines released every tick
+#define BENCH_SAMPLES       10000       //Periods to record per routine (1 second at 10 kHz)
+#define BENCH_IDLE_WINDOW   1           //Seconds to spin the idle loop for the overhead measurement
+
+struct period_stats {
+    uint32_t last_cycles;
+    uint32_t samples;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t sum_cycles;
+};
+
+volatile struct period_stats stats[BENCH_ROUTINES];
+
+void Period_Routine(uint32_t index){
+    uint32_t now = timebase_cycles();
+    volatile struct period_stats *s = &stats[index];
+
+    if(s->samples >= BENCH_SAMPLES){
+        return;
+    }
+    if(s->last_cycles){
+        uint32_t period = now - s->last_cycles;
+        if(period < s->min_cycles) s->min_cycles = period;
+        if(period > s->max_cycles) s->max_cycles = period;
+        s->sum_cycles += period;
+        s->samples++;
+    }
+    s->last_cycles = now;
+}
+
+//Count how many times a simple loop can spin in the window. Any time stolen by interrupts shows up as fewer iterations
+uint32_t Idle_Loop(uint32_t window_cycles){
+    uint32_t iterations = 0;
+    uint32_t start = timebase_cycles();
+    while((timebase_cycles() - start) < window_cycles){
+        iterations++;
+    }
+    return(iterations);
+}
+
+
+/* **************************************************************************** */
+
+int main(void)
+{
+    MXC_Delay(MXC_DELAY_SEC(2)); // Create window for debugger to connect after reset
+
+    printf("High resolution time base benchmark (%d us tick, %d routines)\n\n", SCHEDULER_TICK_US, BENCH_ROUTINES);
+
+    for(int i = 0; i < BENCH_ROUTINES; i++){
+        stats[i].min_cycles = 0xFFFFFFFF;
+        scheduler_addroutine(SCHEDULER_US(100), Period_Routine, HIGH_PRIORITY_ROUTINE, 1, i);
+    }
+
+    //Reference run with no timer interrupts
+    timebase_init();
+    uint32_t window = SystemCoreClock * BENCH_IDLE_WINDOW;
+    uint32_t idle_reference = Idle_Loop(window);
+
+    if(scheduler_init() != E_NO_ERROR) {
+        printf("ERROR: scheduler could not be initialized\n");
+        while(1);
+    }
+    uint32_t idle_loaded = Idle_Loop(window);
+
+    //Wait for every routine to finish sampling
+    for(int i = 0; i < BENCH_ROUTINES; i++){
+        while(stats[i].samples < BENCH_SAMPLES);
+    }
+
+    uint32_t expected = timebase_cycles_per_tick();
+    printf("Routine\tMean (us)\tMin (us)\tMax (us)\tWorst error (cycles)\n");
+    for(int i = 0; i < BENCH_ROUTINES; i++){
+        uint32_t mean = (uint32_t)(stats[i].sum_cycles / stats[i].samples);
+        int32_t early = (int32_t)(expected - stats[i].min_cycles);
+        int32_t late = (int32_t)(stats[i].max_cycles - expected);
+        printf("%d\t%d\t\t%d\t\t%d\t\t%d\n", i, timebase_cycles_to_us(mean), timebase_cycles_to_us(stats[i].min_cycles),
+               timebase_cycles_to_us(stats[i].max_cycles), (early > late) ? early : late);
+    }
+
+    //Overhead in hundredths of a percent
+    uint32_t overhead = (uint32_t)(10000 - (((uint64_t)idle_loaded * 10000) / idle_reference));
+    printf("\nCPU overhead at %d Hz: %d.%02d %%\n", 1000000 / SCHEDULER_TICK_US, overhead / 100, overhead % 100);
+
+    while(1) {
+
+    }
+}
@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "circ_buff.h"
+#include "scheduler_log.h"
 
 
 
@@ -28,7 +29,7 @@ uint32_t Add_Item(struct routine *function_index, struct circ_buff_t *buff){
     }
     //Buffer is full
     else{
-        printf("Buffer is full! %d was not added to the circular buffer\n");
+        SCHEDULER_LOG(LOG_BUFF_FULL, function_index->routine_id);
         return(-1);
     }
 }
@@ -36,8 +37,8 @@ uint32_t Add_Item(struct routine *function_index, struct circ_buff_t *buff){
 //Remove pointer from buffer
 struct routine *Remove_Item(struct circ_buff_t *buff){
     if(!buff->count){
-        printf("Trying to remove item from empty buffer!\n");
-        return(-1);
+        SCHEDULER_LOG(LOG_BUFF_EMPTY);
+        return(NULL);
     }
     else{
         buff->count--;
@@ -0,0 +1,254 @@
+#include "deadline_table.h"
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler_log.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#if defined(DEADLINE_TABLE_16BIT) && defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#endif
+
+
+void deadline_table_init(struct deadline_table *table, dt_count_t *counters, dt_count_t *periods, uint32_t *expired, uint32_t size){
+    table->counters = counters;
+    table->periods = periods;
+    table->expired = expired;
+    table->count = 0;
+    table->size = size;
+    table->scan_word = 0;
+    for(uint32_t w = 0; w < DEADLINE_TABLE_WORDS(size); w++){
+        expired[w] = 0;
+    }
+}
+
+int32_t deadline_table_add(struct deadline_table *table, uint32_t period){
+    if(table->count >= table->size){
+        SCHEDULER_LOG(LOG_DEADLINE_TABLE_FULL, table->size);
+        return(-1);
+    }
+    if(!period || period > DEADLINE_TABLE_MAX_PERIOD){
+        SCHEDULER_LOG(LOG_DEADLINE_RANGE, period);
+        return(-1);
+    }
+    uint32_t index = table->count++;
+    table->counters[index] = (dt_count_t)period;
+    table->periods[index] = (dt_count_t)period;
+    return(index);
+}
+
+int32_t deadline_table_remove(struct deadline_table *table, uint32_t index){
+    uint32_t last = --table->count;
+    if(index == last){
+        return(-1);
+    }
+    table->counters[index] = table->counters[last];
+    table->periods[index] = table->periods[last];
+    return(last);
+}
+
+uint32_t deadline_table_update(struct deadline_table *table, uint32_t elapsed_val){
+    uint32_t num_expired = deadline_table_countdown(table->counters, table->count, elapsed_val, table->expired);
+    table->scan_word = 0;
+    if(!num_expired){
+        return(0);
+    }
+
+    //Reload the expired entries, keeping the overshoot so the period does not drift
+    for(uint32_t w = 0; w < DEADLINE_TABLE_WORDS(table->count); w++){
+        uint32_t bits = table->expired[w];
+        while(bits){
+            uint32_t index = (w << 5) + __builtin_ctz(bits);
+            uint32_t period = table->periods[index];
+            table->counters[index] = (dt_count_t)(period - ((elapsed_val - table->counters[index]) % period));
+            bits &= bits - 1;
+        }
+    }
+    return(num_expired);
+}
+
+int32_t deadline_table_next_expired(struct deadline_table *table){
+    uint32_t words = DEADLINE_TABLE_WORDS(table->count);
+    while(table->scan_word < words){
+        uint32_t bits = table->expired[table->scan_word];
+        if(bits){
+            table->expired[table->scan_word] = bits & (bits - 1);
+            return((table->scan_word << 5) + __builtin_ctz(bits));
+        }
+        table->scan_word++;
+    }
+    return(-1);
+}
+
+uint32_t deadline_table_countdown_scalar(dt_count_t *counters, uint32_t count, uint32_t elapsed_val, uint32_t *expired){
+    uint32_t num_expired = 0;
+    uint32_t bits = 0;
+
+    for(uint32_t i = 0; i < count; i++){
+        uint32_t counter = counters[i];
+        uint32_t hit = (counter <= elapsed_val);
+        counters[i] = (dt_count_t)(counter - (elapsed_val & (hit - 1)));
+        bits |= hit << (i & 31);
+        num_expired += hit;
+        if((i & 31) == 31){
+            expired[i >> 5] = bits;
+            bits = 0;
+        }
+    }
+    if(count & 31){
+        expired[count >> 5] = bits;
+    }
+    return(num_expired);
+}
+
+#if !defined(DEADLINE_TABLE_16BIT) && defined(__AVX2__)
+//8 counters per step. max(c, e) == e is an unsigned c <= e
+uint32_t deadline_table_countdown(dt_count_t *counters, uint32_t count, uint32_t elapsed_val, uint32_t *expired){
+    uint32_t num_expired = 0;
+    uint32_t word = 0;                      //Mask word being built, stored once every 32 entries
+    uint32_t i = 0;
+    __m256i elapsed = _mm256_set1_epi32((int)elapsed_val);
+
+    for(; i + 8 <= count; i += 8){
+        __m256i counter = _mm256_loadu_si256((__m256i *)&counters[i]);
+        __m256i hit = _mm256_cmpeq_epi32(_mm256_max_epu32(counter, elapsed), elapsed);
+        __m256i next = _mm256_blendv_epi8(_mm256_sub_epi32(counter, elapsed), counter, hit);
+        _mm256_storeu_si256((__m256i *)&counters[i], next);
+        uint32_t bits = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(hit));
+        word |= bits << (i & 31);
+        if(!((i + 8) & 31)){
+            num_expired += word ? __builtin_popcount(word) : 0;
+            expired[i >> 5] = word;
+            word = 0;
+        }
+    }
+    num_expired += word ? __builtin_popcount(word) : 0;
+    if(i < count){
+        //Tail shares its first mask word with the vector part when count is not a multiple of 32
+        num_expired += deadline_table_countdown_scalar(&counters[i], count - i, elapsed_val, &expired[i >> 5]);
+        expired[i >> 5] = word | (expired[i >> 5] << (i & 31));
+    }
+    else if(i & 31){
+        expired[i >> 5] = word;
+    }
+    return(num_expired);
+}
+
+#elif !defined(DEADLINE_TABLE_16BIT) && defined(__SSE2__)
+//4 counters per step. SSE2 only has signed compares, so flip the sign bit first
+uint32_t deadline_table_countdown(dt_count_t *counters, uint32_t count, uint32_t elapsed_val, uint32_t *expired){
+    uint32_t num_expired = 0;
+    uint32_t word = 0;                      //Mask word being built, stored once every 32 entries
+    uint32_t i = 0;
+    __m128i elapsed = _mm_set1_epi32((int)elapsed_val);
+    __m128i bias = _mm_set1_epi32((int)0x80000000);
+    __m128i elapsed_biased = _mm_xor_si128(elapsed, bias);
+
+    for(; i + 4 <= count; i += 4){
+        __m128i counter = _mm_loadu_si128((__m128i *)&counters[i]);
+        __m128i running = _mm_cmpgt_epi32(_mm_xor_si128(counter, bias), elapsed_biased);
+        __m128i next = _mm_or_si128(_mm_and_si128(running, _mm_sub_epi32(counter, elapsed)), _mm_andnot_si128(running, counter));
+        _mm_storeu_si128((__m128i *)&counters[i], next);
+        uint32_t bits = (~(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(running))) & 0xF;
+        word |= bits << (i & 31);
+        if(!((i + 4) & 31)){
+            num_expired += word ? __builtin_popcount(word) : 0;
+            expired[i >> 5] = word;
+            word = 0;
+        }
+    }
+    num_expired += word ? __builtin_popcount(word) : 0;
+    if(i < count){
+        //Tail shares its first mask word with the vector part when count is not a multiple of 32
+        num_expired += deadline_table_countdown_scalar(&counters[i], count - i, elapsed_val, &expired[i >> 5]);
+        expired[i >> 5] = word | (expired[i >> 5] << (i & 31));
+    }
+    else if(i & 31){
+        expired[i >> 5] = word;
+    }
+    return(num_expired);
+}
+
+#elif defined(DEADLINE_TABLE_16BIT) && defined(__SSE2__)
+//8 counters per step. A saturating subtract that hits zero is an unsigned c <= e
+uint32_t deadline_table_countdown(dt_count_t *counters, uint32_t count, uint32_t elapsed_val, uint32_t *expired){
+    uint32_t num_expired = 0;
+    uint32_t word = 0;                      //Mask word being built, stored once every 32 entries
+    uint32_t i = 0;
+    __m128i elapsed = _mm_set1_epi16((short)((elapsed_val > 0xFFFF) ? 0xFFFF : elapsed_val));
+    __m128i zero = _mm_setzero_si128();
+
+    for(; i + 8 <= count; i += 8){
+        __m128i counter = _mm_loadu_si128((__m128i *)&counters[i]);
+        __m128i hit = _mm_cmpeq_epi16(_mm_subs_epu16(counter, elapsed), zero);
+        __m128i next = _mm_or_si128(_mm_and_si128(hit, counter), _mm_andnot_si128(hit, _mm_sub_epi16(counter, elapsed)));
+        _mm_storeu_si128((__m128i *)&counters[i], next);
+        uint32_t bits = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(hit, zero)) & 0xFF;
+        word |= bits << (i & 31);
+        if(!((i + 8) & 31)){
+            num_expired += word ? __builtin_popcount(word) : 0;
+            expired[i >> 5] = word;
+            word = 0;
+        }
+    }
+    num_expired += word ? __builtin_popcount(word) : 0;
+    if(i < count){
+        //Tail shares its first mask word with the vector part when count is not a multiple of 32
+        num_expired += deadline_table_countdown_scalar(&counters[i], count - i, elapsed_val, &expired[i >> 5]);
+        expired[i >> 5] = word | (expired[i >> 5] << (i & 31));
+    }
+    else if(i & 31){
+        expired[i >> 5] = word;
+    }
+    return(num_expired);
+}
+
+#elif defined(DEADLINE_TABLE_16BIT) && defined(__ARM_FEATURE_SIMD32)
+//2 counters per 32-bit word. USUB16 sets the GE bits of every halfword where elapsed >= counter, SEL then keeps those
+//counters as they are and takes the decremented value everywhere else. counters must be 4-byte aligned.
+//The GE bits are not an operand the compiler knows about, so the subtracts and both SELs that read them are one asm
+//block. Untested on hardware: check it against deadline_table_countdown_scalar() before relying on it
+uint32_t deadline_table_countdown(dt_count_t *counters, uint32_t count, uint32_t elapsed_val, uint32_t *expired){
+    uint32_t num_expired = 0;
+    uint32_t word = 0;                      //Mask word being built, stored once every 32 entries
+    uint32_t i = 0;
+    uint32_t elapsed = ((elapsed_val > 0xFFFF) ? 0xFFFF : elapsed_val) * 0x00010001;
+    uint32_t *pairs = (uint32_t *)counters;
+
+    for(; i + 2 <= count; i += 2){
+        uint32_t counter = pairs[i >> 1];
+        uint32_t next, hit;
+        __asm volatile(
+            "usub16 %[next], %[counter], %[elapsed]\n\t"
+            "usub16 %[hit], %[elapsed], %[counter]\n\t"
+            "sel    %[next], %[counter], %[next]\n\t"
+            "sel    %[hit], %[one], %[zero]"
+            : [next] "=&r" (next), [hit] "=&r" (hit)
+            : [counter] "r" (counter), [elapsed] "r" (elapsed), [one] "r" (0x00010001), [zero] "r" (0)
+            : "cc");
+        pairs[i >> 1] = next;
+        uint32_t bits = (hit & 1) | (hit >> 15);
+        word |= bits << (i & 31);
+        num_expired += bits - (bits >> 1);
+        if(!((i + 2) & 31)){
+            expired[i >> 5] = word;
+            word = 0;
+        }
+    }
+    if(i < count){
+        //Tail shares its first mask word with the vector part when count is not a multiple of 32
+        num_expired += deadline_table_countdown_scalar(&counters[i], count - i, elapsed_val, &expired[i >> 5]);
+        expired[i >> 5] = word | (expired[i >> 5] << (i & 31));
+    }
+    else if(i & 31){
+        expired[i >> 5] = word;
+    }
+    return(num_expired);
+}
+
+#else
+uint32_t deadline_table_countdown(dt_count_t *counters, uint32_t count, uint32_t elapsed_val, uint32_t *expired){
+    return(deadline_table_countdown_scalar(counters, count, elapsed_val, expired));
+}
+#endif
@@ -0,0 +1,94 @@
+#ifndef DEADLINE_TABLE_H
+#define DEADLINE_TABLE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Glossary for deadline_table.h and deadline_table.c
+ *
+ *  Deadline Table - Struct-of-arrays store for deadline counters. Entry i of every array belongs to the same deadline,
+ *                   and the active entries are always packed into 0..count-1 so one pass covers all of them.
+ *  Expired Mask   - One bit per entry, set by deadline_table_update() for every deadline that expired on this update.
+ *
+ * The countdown pass is a subtract, compare and blend over the counter array:
+ *      SSE2 / AVX2     4 / 8 counters per step on the host
+ *      Cortex-M4 DSP   2 counters per step with USUB16/SEL when built with DEADLINE_TABLE_16BIT
+ *      Scalar          everything else
+ * Expired entries are reloaded afterwards by scanning the expired mask, so only the rare expired lanes pay for the
+ * modulo that keeps the period from drifting.
+ */
+
+#ifdef DEADLINE_TABLE_16BIT
+typedef uint16_t dt_count_t;                //Deadlines limited to 65535 ticks, two counters per 32-bit word
+#define DEADLINE_TABLE_MAX_PERIOD   0xFFFF
+#else
+typedef uint32_t dt_count_t;
+#define DEADLINE_TABLE_MAX_PERIOD   0xFFFFFFFF
+#endif
+
+#define DEADLINE_TABLE_WORDS(size)  (((size) + 31) / 32)   //Expired mask words needed for a table of this size
+
+/*
+*   Deadline table. The arrays are owned by the caller so the table can live in a static block
+*/
+struct deadline_table {
+    dt_count_t *counters;                   //Ticks left until each deadline expires
+    dt_count_t *periods;                    //Reload value of each deadline
+    uint32_t *expired;                      //Expired mask from the last update
+    uint32_t count;                         //Active entries (always packed at the front)
+    uint32_t size;                          //Capacity of the arrays
+    uint32_t scan_word;                     //Next expired mask word for deadline_table_next_expired()
+};
+
+/**
+* @brief        Attach storage to an empty table
+* @param[in]    table - Table to initialize
+* @param[in]    counters - Array of size entries (pad to a multiple of 8 entries for the vector pass)
+* @param[in]    periods - Array of size entries
+* @param[in]    expired - Array of DEADLINE_TABLE_WORDS(size) words
+* @param[in]    size - Number of entries the arrays can hold
+*/
+void deadline_table_init(struct deadline_table *table, dt_count_t *counters, dt_count_t *periods, uint32_t *expired, uint32_t size);
+
+/**
+* @brief        Add a deadline at the end of the table
+* @param[in]    period - Deadline value in ticks (1 to DEADLINE_TABLE_MAX_PERIOD)
+*
+* @return       Index of the new entry (Success), -1 (Table full or period out of range)
+*/
+int32_t deadline_table_add(struct deadline_table *table, uint32_t period);
+
+/**
+* @brief        Remove an entry. The last entry is moved into its place to keep the table packed
+* @param[in]    index - Entry to remove
+*
+* @return       Old index of the entry that was moved into index, or -1 if nothing moved
+*/
+int32_t deadline_table_remove(struct deadline_table *table, uint32_t index);
+
+/**
+* @brief        Count every deadline down by elapsed_val, reload the expired ones and set their bits in table->expired
+* @param[in]    elapsed_val - Ticks since the last update
+*
+* @return       Number of expired entries
+*/
+uint32_t deadline_table_update(struct deadline_table *table, uint32_t elapsed_val);
+
+/**
+* @brief        Pop the next expired entry found by the last deadline_table_update()
+*
+* @return       Entry index, or -1 once every expired entry has been returned
+*/
+int32_t deadline_table_next_expired(struct deadline_table *table);
+
+/**
+* @brief        Countdown kernels. Subtract elapsed_val from every counter that has not expired and set the expired bits.
+*               Expired counters are left unchanged for the caller to reload. deadline_table_countdown() uses the
+*               widest instruction set available, the scalar version is kept for reference and benchmarking.
+*
+* @return       Number of expired entries
+*/
+uint32_t deadline_table_countdown(dt_count_t *counters, uint32_t count, uint32_t elapsed_val, uint32_t *expired);
+uint32_t deadline_table_countdown_scalar(dt_count_t *counters, uint32_t count, uint32_t elapsed_val, uint32_t *expired);
+
+#endif
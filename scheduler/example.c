@@ -47,6 +47,8 @@
 #include "mxc_delay.h"
 #include "nvic_table.h"
 #include "tmr.h"
+#include "scheduler_chain.h"
+#include "scheduler_queue.h"
 
 //Test GPIOs for verification
 mxc_gpio_cfg_t gpio_out1;
@@ -54,46 +56,77 @@ mxc_gpio_cfg_t gpio_out2;
 mxc_gpio_cfg_t gpio_out3;
 mxc_gpio_cfg_t gpio_out4;
 
-void SysTick_Handler(void)
-{
-    scheduler_update();
-}
+//Messages passed between the tasks. They are written and read in place inside the queue slots
+struct status_msg {
+    uint32_t count;
+    uint32_t indicator;
+};
+
+struct sample_msg {
+    uint32_t data[5];
+    char text[16];
+};
+
+struct scheduler_queue *status_queue;   //Task1 -> Task5, polled
+struct scheduler_queue *sample_queue;   //Task4 -> Task3, every message releases Task3
 
-int count1, count2, count3, count4, count5, indicator;
 void Task1(uint32_t delay,uint32_t extraVal){
+    static uint32_t count, indicator;
     MXC_GPIO_OutSet(gpio_out1.port,gpio_out1.mask);
-    count1++;
+    count++;
     indicator+=extraVal;
+    struct status_msg *status = scheduler_queue_reserve(status_queue);
+    if(status){
+        status->count = count;
+        status->indicator = indicator;
+        scheduler_queue_commit(status_queue);
+    }
     for(int i=0;i<delay;i++);
     MXC_GPIO_OutClr(gpio_out1.port,gpio_out1.mask);
 }
 void Task2(uint32_t test1, uint32_t test2, uint32_t test3, uint32_t test4){
     MXC_GPIO_OutSet(gpio_out2.port,gpio_out2.mask);
-    count2++;
     printf("Test Variables = %d, %d, %d, %d\n",test1,test2,test3,test4);
     for(int i=0;i<150000;i++);
     MXC_GPIO_OutClr(gpio_out2.port,gpio_out2.mask);
 }
-void Task3(uint32_t *test_data, char *sample_string ){
+void Task3(){
+    struct sample_msg *sample;
     MXC_GPIO_OutSet(gpio_out3.port,gpio_out3.mask);
-    printf("Test data from task 3: ");
-    for(int i = 0; i <5;i++){
-        printf("%d, ",test_data[i]);
+    while((sample = scheduler_queue_get(sample_queue)) != NULL){
+        printf("Test data from task 3: ");
+        for(int i = 0; i <5;i++){
+            printf("%d, ",sample->data[i]);
+        }
+        printf("\n\n");
+        printf("Sample string: %s", sample->text);
+        scheduler_queue_release(sample_queue);
     }
-    printf("\n\n");
-    printf("Sample string: %s", sample_string);
-    count3++;
     for(int i=0;i<150000;i++);
     MXC_GPIO_OutClr(gpio_out3.port,gpio_out3.mask);
 }
 void Task4(){
+    static uint32_t sequence;
     MXC_GPIO_OutSet(gpio_out4.port,gpio_out4.mask);
-    count4++;
+    //Fill the message straight into the slot, no copy on either side
+    struct sample_msg *sample = scheduler_queue_reserve(sample_queue);
+    if(sample){
+        for(int i = 0; i < 5; i++){
+            sample->data[i] = 10 + i + sequence;
+        }
+        strcpy(sample->text, "Hello world!\n");
+        scheduler_queue_commit(sample_queue);
+        sequence++;
+    }
     for(int i=0;i<150000;i++);
     MXC_GPIO_OutClr(gpio_out4.port,gpio_out4.mask);
 }
 void Task5(){
-    count5++;
+    struct status_msg *status;
+    while((status = scheduler_queue_get(status_queue)) != NULL){
+        printf("Task1 has run %d times (indicator %d)\n",status->count,status->indicator);
+        scheduler_queue_release(status_queue);
+    }
 }
 
 void GPIO_TestInit(){
@@ -127,17 +160,7 @@ void GPIO_TestInit(){
 
 int main(void)
 {
-    //Generate test data array
-    uint32_t sample_data[5];
-    sample_data[0] = 10;
-    sample_data[1] = 11;
-    sample_data[2] = 12;
-    sample_data[3] = 13;
-    sample_data[4] = 14;
-
-    //Test data string
-    char *sample_string = "Hello world!";
-
+    int32_t task3_id;
 
     MXC_Delay(MXC_DELAY_SEC(2)); // Create window for debugger to connect after reset
 
@@ -158,14 +181,18 @@ int main(void)
     //Provides 4 integer arguments
     scheduler_addroutine(2000,Task2,MEDIUM_PRIORITY_ROUTINE,4,6,5,4,3);
 
-    //Provides 2 pointers to string and integer array
-    scheduler_addroutine(1000,Task3,LOW_PRIORITY_ROUTINE,2,sample_data,sample_string);
+    //Only runs when Task4 posts a sample
+    task3_id = scheduler_addroutine_triggered(Task3,LOW_PRIORITY_ROUTINE,0);
 
-    //General Test Routine
+    //Produces the samples for Task3
     scheduler_addroutine(500,Task4,HIGH_PRIORITY_ROUTINE,0);
 
-    //Initialize the scheduler (1ms with 60MHz system clock)
-    if(scheduler_init(SYSTICK_DIVIDER_MS) != E_NO_ERROR) {
+    //Queues replace the globals and pointer arguments the tasks used to share
+    status_queue = scheduler_queue_create(sizeof(struct status_msg), 4, QUEUE_NO_CONSUMER);
+    sample_queue = scheduler_queue_create(sizeof(struct sample_msg), 4, task3_id);
+
+    //Initialize the scheduler (starts the TMR5 tick)
+    if(scheduler_init() != E_NO_ERROR) {
         printf("ERROR: Ticks is not valid");
         //LED_On(1);
     }
@@ -3,11 +3,26 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdarg.h>
-#include "nvic_table.h"
-#include "tmr.h"
 #include "circ_buff.h"
+#include "timebase.h"
+#include "scheduler_timer.h"
+#include "scheduler_chain.h"
+#include "scheduler_trace.h"
+#include "scheduler_log.h"
 
+#ifndef QUE_MAX_SIZE
 #define QUE_MAX_SIZE 100        //Only 100 routines can be scheudled to run at a time. If you exceed this number, then you are behind schedule
+#endif
+
+#ifndef LOAD_WINDOW_TICKS
+#define LOAD_WINDOW_TICKS SCHEDULER_MS(100)    //Length of the window used to measure utilization and move adaptive deadlines
+#endif
+#ifndef LOAD_QUE_THRESHOLD
+#define LOAD_QUE_THRESHOLD BUFF_SIZE            //Ready que depth that counts as overloaded regardless of utilization
+#endif
+#ifndef LOAD_HYSTERESIS
+#define LOAD_HYSTERESIS 10                      //Utilization has to drop this many percent under the load target before deadlines shrink again
+#endif
 
 //Globals
 struct scheduler main_schedule = {
@@ -22,12 +37,31 @@ struct routine_que current_que = {
     .priority_buffers = {0,0,0}
 };
 
+struct scheduler_stats current_stats = {
+    .utilization = 0,
+    .peak_que_depth = 0,
+    .que_overflows = 0,
+    .stretched_routines = 0,
+    .load_windows = 0
+};
+
+//Load window accumulators
+uint32_t load_window_ticks = 0;         //Ticks since the current load window started
+uint32_t load_busy_cycles = 0;          //Cycles spent inside routines since the current load window started
+uint32_t load_peak_depth = 0;           //Deepest ready que seen since the current load window started
+
+SCHEDULER_THREAD_LOCAL struct routine *running_routine = NULL;    //Routine being run on this thread (NULL between routines)
+int32_t (*external_release)(struct routine *routine) = NULL;    //Set while another dispatcher runs the routines (host executor)
+void (*routine_removed)(struct routine *routine) = NULL;        //Told about every routine before it is removed (message queues)
+
 
 /*** Public Functions ***/
 
 int32_t scheduler_init(void);
 //Returns positive routine ID or negative for error
 int32_t scheduler_addroutine(uint32_t deadline, void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...);
+//Returns positive routine ID or negative for error. Deadline moves between min_deadline and max_deadline with the measured load
+int32_t scheduler_addroutine_adaptive(uint32_t min_deadline, uint32_t max_deadline, uint8_t load_target, void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...);
 //Deletes routine and returns 0 for success, -1 for ID not found
 int32_t scheduler_removeroutine(uint32_t ID);
 //Placed inside the SysTick handler for updating the structure
@@ -38,6 +72,16 @@ void print_routines();
 void SCHEDULER_TEST();
 
 uint32_t scheduler_run_routines(void);
+//Copy the load measurements into the stats structure
+int32_t scheduler_get_stats(struct scheduler_stats *stats);
+//Current deadline of a routine (moves for adaptive routines)
+int32_t scheduler_get_deadline(uint32_t ID);
+//Put a routine in the ready que without waiting for its deadline
+int32_t scheduler_release_routine(uint32_t ID);
+//Find a routine once so it can be released without the search
+struct routine *scheduler_get_routine(uint32_t ID);
+//Release a routine from scheduler_get_routine() (inside the critical section)
+int32_t scheduler_release_routine_ptr(struct routine *routine);
 
 
 /*** Private Functions ***/
@@ -48,29 +92,34 @@ struct schedule_deadline *create_node(uint32_t deadline);
 int32_t add_function(struct schedule_deadline *routine ,void *function, Scheduler_Priority routine_priority, uint32_t *routine_arguments);
 //Run the routines sitting in the ready que
 void run_routines(Scheduler_Priority routine_priority);
+//Call one routine and clear its scheduled flag
+void run_routine(struct routine *routine);
 //Move routines into the ready que
 void stage_routine(struct schedule_deadline *node);
+//Move one routine into the ready que
+int32_t release_routine(struct routine *routine);
+//Find a routine by its ID
+struct routine *find_routine(uint32_t ID);
+//Find a routine by its ID and the deadline it is listed under
+struct routine *find_routine_deadline(uint32_t ID, struct schedule_deadline **deadline);
 //Remove a node from the main schedule
 void remove_node(struct schedule_deadline *node);
+//Copy up to 5 variadic arguments into a newly allocated argument list
+int32_t read_arguments(uint16_t num_args, va_list args, uint32_t **routine_arguments);
+//Close a load window and move the adaptive deadlines
+void update_load(uint32_t elapsed_val);
+void adapt_deadlines(uint32_t utilization, uint32_t peak_que_depth);
 
-//IRQ Stuff
-void OneshotTimerHandler(void);
-void Setup_Timer_ISR(void);
-void Setup_Timer_CONT(void);
 
 
 int32_t scheduler_init(){
     //initialize the buffers
     for(int i=0;i<3;i++){
-        current_que.priority_buffers[i] = (struct circ_buff_t *) malloc(sizeof(struct circ_buff_t ));
+        current_que.priority_buffers[i] = (struct circ_buff_t *) calloc(1, sizeof(struct circ_buff_t ));
     }
 
-    NVIC_SetVector(TMR5_IRQn, OneshotTimerHandler);
-    NVIC_EnableIRQ(TMR5_IRQn);
-    NVIC_SetPriority(TMR5_IRQn, 0);
-    Setup_Timer_ISR();
+    scheduler_timer_init();
 
-    NVIC_SetPriority (SysTick_IRQn, 0);
     return(0);
 }
 
@@ -81,23 +130,14 @@ int32_t scheduler_addroutine(uint32_t deadline, void *function, Scheduler_Priori
     struct schedule_deadline *current_timer;
     int32_t routine_id;
     uint32_t *routine_arguments = NULL;
+    int32_t rslt;
 
-
-    if(num_args){
-        if(num_args > 5){
-            printf("Error, too many arguments provided (maximum of 5)\n");
-            return(-1);
-        }
-        if((routine_arguments = calloc(5,sizeof(uint32_t)))==NULL){
-            printf("Error allocating memory for routine arguments\n");
-            return(-1);
-        }
-        va_list args;
-        va_start(args,num_args);
-        for(int i=0;i<num_args;i++){
-            routine_arguments[i] = va_arg(args,int);    //Possible issues caused here. Assumes int is a standard 32 bit allocation
-        }
-        va_end(args);
+    va_list args;
+    va_start(args,num_args);
+    rslt = read_arguments(num_args, args, &routine_arguments);
+    va_end(args);
+    if(rslt){
+        return(-1);
     }
 
     //List is empty
@@ -112,13 +152,13 @@ int32_t scheduler_addroutine(uint32_t deadline, void *function, Scheduler_Priori
     }
     //List not empty
     else{
-        //Check to see if there is already a timer for this deadline
+        //Check to see if there is already a timer for this deadline (adaptive deadlines move, so they are never shared)
         current_timer = main_schedule.head;
-        while(current_timer->routine_deadline != deadline && current_timer->next != NULL){
+        while((current_timer->routine_deadline != deadline || current_timer->max_deadline) && current_timer->next != NULL){
             current_timer = current_timer->next;
         }
         //No routine for this timer, create a new Node
-        if(current_timer->routine_deadline != deadline){
+        if(current_timer->routine_deadline != deadline || current_timer->max_deadline){
             if((current_timer = create_node(deadline))== NULL){
                 return(-1);
             }
@@ -136,17 +176,65 @@ int32_t scheduler_addroutine(uint32_t deadline, void *function, Scheduler_Priori
     }
 }
 
+int32_t scheduler_addroutine_adaptive(uint32_t min_deadline, uint32_t max_deadline, uint8_t load_target, void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...){
+
+    struct schedule_deadline *current_timer;
+    uint32_t *routine_arguments = NULL;
+    int32_t rslt;
+
+    if(!min_deadline || max_deadline < min_deadline || load_target > 100){
+        SCHEDULER_LOG(LOG_ADAPTIVE_INVALID, min_deadline, max_deadline, load_target);
+        return(-1);
+    }
+
+    va_list args;
+    va_start(args,num_args);
+    rslt = read_arguments(num_args, args, &routine_arguments);
+    va_end(args);
+    if(rslt){
+        return(-1);
+    }
+
+    //Every adaptive routine gets its own deadline so its period can move on its own
+    if((current_timer = create_node(min_deadline)) == NULL){
+        return(-1);
+    }
+    current_timer->min_deadline = min_deadline;
+    current_timer->max_deadline = max_deadline;
+    current_timer->load_target = load_target;
+
+    return(add_function(current_timer, function, routine_priority, routine_arguments));
+}
+
+int32_t read_arguments(uint16_t num_args, va_list args, uint32_t **routine_arguments){
+    *routine_arguments = NULL;
+    if(num_args){
+        if(num_args > 5){
+            SCHEDULER_LOG(LOG_TOO_MANY_ARGS);
+            return(-1);
+        }
+        if((*routine_arguments = calloc(5,sizeof(uint32_t)))==NULL){
+            SCHEDULER_LOG(LOG_ARGS_NO_MEMORY);
+            return(-1);
+        }
+        for(int i=0;i<num_args;i++){
+            (*routine_arguments)[i] = va_arg(args,int);    //Possible issues caused here. Assumes int is a standard 32 bit allocation
+        }
+    }
+    return(0);
+}
+
 struct schedule_deadline *create_node(uint32_t deadline){
     struct schedule_deadline *new_timer;
     struct routine *new_routine;
     if( (new_timer = (struct schedule_deadline *)malloc(sizeof(struct schedule_deadline))) == NULL){
         //error handler
-        printf("Cannot allocate memory for node\n");
+        SCHEDULER_LOG(LOG_NODE_NO_MEMORY);
         return (NULL);  
     }
     if( (new_routine = (struct routine *)malloc(sizeof(struct routine))) == NULL){
         //error handler
-        printf("Cannot allocate memory for routine\n");
+        SCHEDULER_LOG(LOG_ROUTINE_NO_MEMORY);
         return (NULL);
     }
     
@@ -155,6 +243,9 @@ struct schedule_deadline *create_node(uint32_t deadline){
     new_timer->deadline_counter = deadline;  //Current timer count set to routine_deadline value
     new_timer->routines_head = new_routine;   //We will initialize further in add_function   
     new_timer->routine_deadline = deadline;     //Keep the routine_deadline value so you can reset the counter
+    new_timer->min_deadline = 0;    //Fixed deadline unless scheduler_addroutine_adaptive() says otherwise
+    new_timer->max_deadline = 0;
+    new_timer->load_target = 0;
     new_timer->next = NULL;         //End of the list
 
     //Initialize the routine list
@@ -162,6 +253,7 @@ struct schedule_deadline *create_node(uint32_t deadline){
     new_routine->next = NULL;
     new_routine->routine_id = 0;
     new_routine->Arguments = NULL;
+    new_routine->chain = NULL;
 
 
     //Add the new node to the list
@@ -173,8 +265,8 @@ struct schedule_deadline *create_node(uint32_t deadline){
         while(temp->next != NULL && temp != NULL){
             temp = temp->next;
         }
+        temp->next = new_timer;
     }
-    temp->next = new_timer;
     return(new_timer);
 }
 
@@ -200,6 +292,7 @@ int32_t add_function(struct schedule_deadline *routine , void(*function), Schedu
         main_schedule.currentid++;
         //Keep track of how many functions
         routine->num_routines++;
+        SCHEDULER_TRACE_EVENT(TRACE_ROUTINE, new_routine->routine_id, routine_priority, routine->routine_deadline);
 
         return(new_routine->routine_id);
     }
@@ -210,7 +303,7 @@ int32_t add_function(struct schedule_deadline *routine , void(*function), Schedu
         struct routine *temp;
         if( (temp = (struct routine *)malloc(sizeof(struct routine))) == NULL){
             //error handler
-            printf("Cannot allocate memory for routine\n");
+            SCHEDULER_LOG(LOG_ROUTINE_NO_MEMORY);
             return (-1);
         }
         new_routine->next = temp;
@@ -225,8 +318,10 @@ int32_t add_function(struct schedule_deadline *routine , void(*function), Schedu
         temp->routine_priority = routine_priority;
         temp->Arguments = routine_arguments;
         temp->routine_scheduled_flag = 0;
+        temp->chain = NULL;
         //Keep track of how many functions
         routine->num_routines++;
+        SCHEDULER_TRACE_EVENT(TRACE_ROUTINE, temp->routine_id, routine_priority, routine->routine_deadline);
         return(temp->routine_id);
     }
 }
@@ -236,7 +331,7 @@ int32_t scheduler_removeroutine(uint32_t ID){
     
     //Task ID can't exist because it is too high or negative
     if(main_schedule.currentid < ID || ID < 0){
-        printf("%d is an invalid routine ID. Task could not be deleted. [ID out of Bounds]\n",ID);
+        SCHEDULER_LOG(LOG_REMOVE_OUT_OF_BOUNDS, ID);
         return(-1);
     }
 
@@ -249,15 +344,26 @@ int32_t scheduler_removeroutine(uint32_t ID){
     while(current_timer != NULL){
         current_routine = current_timer->routines_head;
         next_routine = current_routine;
-        while(next_routine->routine_id != ID && next_routine != NULL){
+        while(next_routine != NULL && next_routine->routine_id != ID){
             current_routine = next_routine;
             next_routine = current_routine->next;
         }
         //Task Found
-        if(next_routine->routine_id == ID){
+        if(next_routine != NULL){
+            SCHEDULER_TRACE_EVENT(TRACE_REMOVE, ID, next_routine->routine_priority, 0);
+            //Disconnect it from any chains before it is freed
+            if(next_routine->chain){
+                chain_remove(next_routine);
+            }
+            //Nothing may release it through a pointer kept from scheduler_get_routine() once it is freed
+            if(routine_removed){
+                SCHEDULER_ENTER_CRITICAL();
+                routine_removed(next_routine);
+                SCHEDULER_EXIT_CRITICAL();
+            }
             //It is the only routine at this deadline
             if(current_timer->num_routines == 1){
-                if(!next_routine->Arguments){
+                if(next_routine->Arguments){
                     free(next_routine->Arguments);
                 }
                 free(next_routine);
@@ -274,7 +380,7 @@ int32_t scheduler_removeroutine(uint32_t ID){
                     current_routine->next = next_routine->next;
                 }
                 current_timer->num_routines--;
-                if(!next_routine->Arguments){
+                if(next_routine->Arguments){
                     free(next_routine->Arguments);
                 }
                 free(next_routine);
@@ -285,7 +391,7 @@ int32_t scheduler_removeroutine(uint32_t ID){
             current_timer = current_timer->next;
         }
     }
-    printf("%d is an invalid routine ID. Task could not be deleted. [Could not find routine]\n",ID);
+    SCHEDULER_LOG(LOG_REMOVE_NOT_FOUND, ID);
     return(-1);
 }
 
@@ -312,59 +418,188 @@ void remove_node(struct schedule_deadline *node){
 
 //Placed inside the SysTick handler for updating the structure
 void scheduler_update(uint32_t elapsed_val){
+    if(elapsed_val){
+        SCHEDULER_TRACE_EVENT(TRACE_UPDATE, 0, 0, elapsed_val);
+    }
     current_que.updating_flag = 1;
     struct schedule_deadline *current_node;
     current_node = main_schedule.head;
     while(current_node != NULL){
-        current_node->deadline_counter = current_node->deadline_counter-elapsed_val;
+        //Routines without a deadline are only released by other routines
+        if(current_node->routine_deadline == SCHEDULER_NO_DEADLINE){
+            current_node = current_node->next;
+            continue;
+        }
         //Timer has expired, add routines to be executed and then reset timer
-        if(current_node->deadline_counter > current_node->routine_deadline){
+        if(current_node->deadline_counter <= elapsed_val){
             //Stage routines
             stage_routine(current_node);
-            //Reload timer
-            current_node->deadline_counter = current_node->routine_deadline;
+            //Reload timer. Keep the overshoot so the period stays at routine_deadline ticks when elapsed_val spans several ticks
+            uint32_t period = current_node->routine_deadline ? current_node->routine_deadline : 1;
+            current_node->deadline_counter = period - ((elapsed_val - current_node->deadline_counter) % period);
+        }
+        else{
+            current_node->deadline_counter = current_node->deadline_counter-elapsed_val;
         }
         //Traverse to the next deadline
         current_node = current_node->next;
     }
+    update_load(elapsed_val);
     current_que.updating_flag = 0;
 }
 
+void update_load(uint32_t elapsed_val){
+    load_window_ticks += elapsed_val;
+    if(load_window_ticks < LOAD_WINDOW_TICKS){
+        return;
+    }
+
+    //Close the window
+    uint64_t window_cycles = (uint64_t)load_window_ticks * timebase_cycles_per_tick();
+    uint32_t utilization = (uint32_t)(((uint64_t)__atomic_exchange_n(&load_busy_cycles, 0, __ATOMIC_RELAXED) * 100) / window_cycles);
+    if(utilization > 100){
+        utilization = 100;
+    }
+    current_stats.utilization = utilization;
+    current_stats.peak_que_depth = load_peak_depth;
+    current_stats.load_windows++;
+
+    adapt_deadlines(utilization, load_peak_depth);
+
+    //Start the next window
+    load_window_ticks = 0;
+    load_peak_depth = __atomic_load_n(&current_que.routine_count, __ATOMIC_RELAXED);
+}
+
+void adapt_deadlines(uint32_t utilization, uint32_t peak_que_depth){
+    struct schedule_deadline *current_node;
+    uint32_t stretched = 0;
+
+    current_node = main_schedule.head;
+    while(current_node != NULL){
+        if(current_node->max_deadline){
+            //Overloaded, back off by 25%
+            if(utilization > current_node->load_target || peak_que_depth > LOAD_QUE_THRESHOLD){
+                current_node->routine_deadline += (current_node->routine_deadline >> 2) + 1;
+                if(current_node->routine_deadline > current_node->max_deadline){
+                    current_node->routine_deadline = current_node->max_deadline;
+                }
+            }
+            //Load is well under the target, speed back up by 12.5%
+            else if(utilization + LOAD_HYSTERESIS < current_node->load_target){
+                uint32_t step = (current_node->routine_deadline >> 3) + 1;
+                if(current_node->routine_deadline - current_node->min_deadline > step){
+                    current_node->routine_deadline -= step;
+                }
+                else{
+                    current_node->routine_deadline = current_node->min_deadline;
+                }
+            }
+            //A shorter deadline must not leave the counter above it, or the next update would see it as expired
+            if(current_node->deadline_counter > current_node->routine_deadline){
+                current_node->deadline_counter = current_node->routine_deadline;
+            }
+            if(current_node->routine_deadline > current_node->min_deadline){
+                stretched++;
+            }
+        }
+        current_node = current_node->next;
+    }
+    current_stats.stretched_routines = stretched;
+}
+
+int32_t scheduler_get_stats(struct scheduler_stats *stats){
+    if(stats == NULL){
+        return(-1);
+    }
+    *stats = current_stats;
+    return(0);
+}
+
+struct routine *find_routine(uint32_t ID){
+    struct schedule_deadline *deadline;
+    return(find_routine_deadline(ID, &deadline));
+}
+
+struct routine *find_routine_deadline(uint32_t ID, struct schedule_deadline **deadline){
+    struct schedule_deadline *current_timer;
+    struct routine *current_routine;
+
+    current_timer = main_schedule.head;
+    while(current_timer != NULL){
+        current_routine = current_timer->routines_head;
+        while(current_routine != NULL){
+            if(current_routine->function_pointer != NULL && (uint32_t)current_routine->routine_id == ID){
+                *deadline = current_timer;
+                return(current_routine);
+            }
+            current_routine = current_routine->next;
+        }
+        current_timer = current_timer->next;
+    }
+    return(NULL);
+}
+
+int32_t scheduler_release_routine(uint32_t ID){
+    struct routine *routine;
+    int32_t rslt;
+
+    if((routine = find_routine(ID)) == NULL){
+        SCHEDULER_LOG(LOG_RELEASE_NOT_FOUND, ID);
+        return(-1);
+    }
+    SCHEDULER_ENTER_CRITICAL();
+    rslt = release_routine(routine);
+    SCHEDULER_EXIT_CRITICAL();
+    return(rslt);
+}
+
+struct routine *scheduler_get_routine(uint32_t ID){
+    return(find_routine(ID));
+}
+
+int32_t scheduler_release_routine_ptr(struct routine *routine){
+    return(release_routine(routine));
+}
+
+int32_t scheduler_get_deadline(uint32_t ID){
+    struct schedule_deadline *deadline;
+
+    if(find_routine_deadline(ID, &deadline) == NULL){
+        return(-1);
+    }
+    return(deadline->routine_deadline);
+}
+
 uint32_t scheduler_run_routines(void){
     
     
+    //Another dispatcher (the host executor threads) is running the routines
+    if(external_release){
+        return(0);
+    }
+
     while(current_que.updating_flag);
     //start timer
-    Setup_Timer_CONT();
-    MXC_TMR_Start(MXC_TMR5);
+    elapsed_timer_start();
     run_routines(HIGH_PRIORITY_ROUTINE);
     //update
-    //MXC_TMR_Stop(MXC_TMR5);
-    scheduler_update(MXC_TMR_GetCount(MXC_TMR5));
-    MXC_TMR5->cnt = 0;
+    scheduler_update(elapsed_timer_read());
 
-    //start timer
     run_routines(HIGH_PRIORITY_ROUTINE);
     run_routines(MEDIUM_PRIORITY_ROUTINE);
 
     //update
-    //MXC_TMR_Stop(MXC_TMR5);
-    scheduler_update(MXC_TMR_GetCount(MXC_TMR5));
-    MXC_TMR5->cnt = 0;
-
-    //start timer
-    MXC_TMR_Start(MXC_TMR5);  
+    scheduler_update(elapsed_timer_read());
 
     run_routines(HIGH_PRIORITY_ROUTINE);
     run_routines(MEDIUM_PRIORITY_ROUTINE);
     run_routines(LOW_PRIORITY_ROUTINE);
 
     //update
-    //MXC_TMR_Stop(MXC_TMR5);
-    scheduler_update(MXC_TMR_GetCount(MXC_TMR5));
-    MXC_TMR5->cnt = 0;
+    scheduler_update(elapsed_timer_read());
 
-    Setup_Timer_ISR();
+    elapsed_timer_stop();
 
     return(0);
 }
@@ -394,24 +629,48 @@ void run_routines(Scheduler_Priority routine_priority){
     current_que.priority_running_flag[routine_priority] = 1;
     while(((current_que.priority_buffers[routine_priority])->count)){
         current_routine = Remove_Item(current_que.priority_buffers[routine_priority]);
-        
-        if(current_routine->Arguments){
-            (*current_routine->function_pointer)(current_routine->Arguments[0],current_routine->Arguments[1],current_routine->Arguments[2],current_routine->Arguments[3],current_routine->Arguments[4]);
-        }
-        else {
-            (*current_routine->function_pointer)();
-        }
-        current_routine->routine_scheduled_flag = 0;
-        //decrement counter
-        current_que.routine_count--;
+        run_routine(current_routine);
     }
     current_que.priority_running_flag[routine_priority] = 0;
 }
 
+//Shared with the host executor threads, so the counters the tick ISR also touches are changed atomically
+void run_routine(struct routine *routine){
+    SCHEDULER_TRACE_EVENT(TRACE_DISPATCH, routine->routine_id, routine->routine_priority, 0);
+    uint32_t start_cycles = timebase_cycles();
+
+    running_routine = routine;
+    if(routine->Arguments){
+        (*routine->function_pointer)(routine->Arguments[0],routine->Arguments[1],routine->Arguments[2],routine->Arguments[3],routine->Arguments[4]);
+    }
+    else {
+        (*routine->function_pointer)();
+    }
+    uint32_t run_cycles = timebase_cycles() - start_cycles;
+    __atomic_fetch_add(&load_busy_cycles, run_cycles, __ATOMIC_RELAXED);
+    running_routine = NULL;
+    SCHEDULER_TRACE_EVENT(TRACE_COMPLETE, routine->routine_id, routine->routine_priority, timebase_cycles_to_us(run_cycles));
+    __atomic_store_n(&routine->routine_scheduled_flag, 0, __ATOMIC_RELEASE);
+    //decrement counter
+    __atomic_fetch_sub(&current_que.routine_count, 1, __ATOMIC_RELAXED);
+    //Release the routines waiting on this one
+    if(routine->chain){
+        chain_completed(routine);
+    }
+}
+
 //Move routines into the ready que
 void stage_routine(struct schedule_deadline *node){
     if(current_que.routine_count + node->num_routines > QUE_MAX_SIZE){
         //handle overflow
+        current_stats.que_overflows++;
+#if SCHEDULER_TRACE
+        if(trace_recording){
+            for(struct routine *skipped = node->routines_head; skipped != NULL; skipped = skipped->next){
+                trace_record(TRACE_RELEASE, skipped->routine_id, skipped->routine_priority, TRACE_OVERFLOW);
+            }
+        }
+#endif
     }
 
     else{
@@ -420,67 +679,39 @@ void stage_routine(struct schedule_deadline *node){
         
         //Traverse the linked list
         while(current_routine != NULL){
-            if(!current_routine->routine_scheduled_flag){
-                Add_Item(current_routine,current_que.priority_buffers[current_routine->routine_priority]);
-                current_routine->routine_scheduled_flag = 1;
-                current_que.routine_count++;
+            if(release_routine(current_routine) == 0 && current_routine->chain){
+                chain_released(current_routine);
             }
             current_routine = current_routine->next;
         }
     }
 }
 
-void Setup_Timer_CONT(){
-    mxc_tmr_cfg_t tmr;
-
-    MXC_TMR_Shutdown(MXC_TMR5);
-    
-    tmr.pres = TMR_PRES_8;
-    tmr.mode = TMR_MODE_CONTINUOUS;
-    tmr.bitMode = TMR_BIT_MODE_32;
-    tmr.clock = MXC_TMR_8K_CLK;
-    //tmr.cmp_cnt = 8;      //SystemCoreClock*(1/interval_time);
-    tmr.pol = 0;
-    
-    if (MXC_TMR_Init(MXC_TMR5, &tmr, true) != E_NO_ERROR) {
-        printf("Failed one-shot timer Initialization.\n");
-        return;
+int32_t release_routine(struct routine *routine){
+    //Hand the routine to the other dispatcher instead of the ready que
+    if(external_release){
+        int32_t rslt = external_release(routine);
+        SCHEDULER_TRACE_EVENT(TRACE_RELEASE, routine->routine_id, routine->routine_priority, (rslt == 0) ? TRACE_RELEASED : (rslt == 1) ? TRACE_MISSED : TRACE_OVERFLOW);
+        return(rslt);
     }
-}
-
-void Setup_Timer_ISR(){
-    // Declare variables
-    mxc_tmr_cfg_t tmr;
-
-    MXC_TMR_Shutdown(MXC_TMR5);
-    
-    tmr.pres = TMR_PRES_1;
-    tmr.mode = TMR_MODE_ONESHOT;
-    tmr.bitMode = TMR_BIT_MODE_32;
-    tmr.clock = MXC_TMR_8K_CLK;
-    tmr.cmp_cnt = 8;      //1ms
-    tmr.pol = 0;
-    
-    if (MXC_TMR_Init(MXC_TMR5, &tmr, true) != E_NO_ERROR) {
-        printf("Failed one-shot timer Initialization.\n");
-        return;
+    if(routine->routine_scheduled_flag){
+        SCHEDULER_TRACE_EVENT(TRACE_RELEASE, routine->routine_id, routine->routine_priority, TRACE_MISSED);
+        return(1);
     }
-
-    NVIC_SetVector(TMR5_IRQn, OneshotTimerHandler);
-    NVIC_EnableIRQ(TMR5_IRQn);
-    NVIC_SetPriority(TMR5_IRQn, 0);
-    MXC_TMR_EnableInt(MXC_TMR5);
-    MXC_TMR_Start(MXC_TMR5);
-}
-
-void OneshotTimerHandler(){
-    scheduler_update(1);
-    scheduler_run_routines();   //Always returns 0 on first call
-    NVIC_SetVector(TMR5_IRQn, OneshotTimerHandler);
-    NVIC_EnableIRQ(TMR5_IRQn);
+    if(Add_Item(routine,current_que.priority_buffers[routine->routine_priority]) == (uint32_t)-1){
+        current_stats.que_overflows++;
+        SCHEDULER_TRACE_EVENT(TRACE_RELEASE, routine->routine_id, routine->routine_priority, TRACE_OVERFLOW);
+        return(-1);
+    }
+    SCHEDULER_TRACE_EVENT(TRACE_RELEASE, routine->routine_id, routine->routine_priority, TRACE_RELEASED);
+    routine->routine_scheduled_flag = 1;
+    current_que.routine_count++;
+    if(current_que.routine_count > load_peak_depth){
+        load_peak_depth = current_que.routine_count;
+    }
+    return(0);
 }
 
-
 void SCHEDULER_TEST(){
 
 
@@ -3,9 +3,12 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#ifndef SCHEDULER_HOST
 #include "mxc_sys.h"
 #include "nvic_table.h"
+#endif
 #include "circ_buff.h"
+#include "timebase.h"
 
 /* Glossary for scheduler.h and scheduler.c 
  * 
@@ -24,6 +27,22 @@ typedef enum
 } SysTick_Scaler;
 
 
+#define SCHEDULER_NO_DEADLINE   0xFFFFFFFF  //Deadline of routines that are only released by other routines (see scheduler_chain.h)
+
+/* Interrupts are masked while the ready que is changed outside of the timer ISR. The host port has no interrupts
+ * but may run routines on several threads (scheduler_executor_host.c), so it takes a lock instead */
+#ifdef SCHEDULER_HOST
+void scheduler_host_lock(void);
+void scheduler_host_unlock(void);
+#define SCHEDULER_ENTER_CRITICAL()  scheduler_host_lock()
+#define SCHEDULER_EXIT_CRITICAL()   scheduler_host_unlock()
+#define SCHEDULER_THREAD_LOCAL      __thread
+#else
+#define SCHEDULER_ENTER_CRITICAL()  uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define SCHEDULER_EXIT_CRITICAL()   __set_PRIMASK(primask)
+#define SCHEDULER_THREAD_LOCAL
+#endif
+
 /* Type for High, Medium, and Low priorities. High priority routines run first, then medium, then low. No preemption allowed */
 typedef enum
 { 
@@ -40,6 +59,9 @@ volatile struct schedule_deadline {
     uint32_t routine_deadline;              //Deadline value (Number of ms between each time routines are scheduled)
     uint32_t deadline_counter;              //Current Counter Value (Routines are scheudled once count_timer=0
     uint32_t num_routines;              //Number of routines to run each time interval expires
+    uint32_t min_deadline;              //Adaptive deadlines only: shortest allowed routine_deadline
+    uint32_t max_deadline;              //Adaptive deadlines only: longest allowed routine_deadline (0 for a fixed deadline)
+    uint8_t load_target;                //Adaptive deadlines only: utilization (percent) above which routine_deadline is stretched
     struct routine *routines_head;      //Points to the head of a list of routines to be executed once interval has expired
     struct schedule_deadline *next;         //Pointer to the next deadline structure (Linked List format)
 };
@@ -64,6 +86,7 @@ volatile struct routine{
     void (* function_pointer)();           //Fucntion Pointer to routine that must be run
     uint32_t *Arguments;                   //place to add arguments in future
     Scheduler_Priority routine_priority;   //Routine Priority
+    struct routine_chain *chain;           //Chain state when the routine is connected to other routines (NULL otherwise)
     struct routine *next;                  //Pointer to the next routine for a given deadline (Linked List format)
 };
 
@@ -78,6 +101,17 @@ volatile struct routine_que{
     struct circ_buff_t *priority_buffers[3];
 };
 
+/*
+*   Load measurements from the last completed load window (LOAD_WINDOW_TICKS). Read with scheduler_get_stats()
+*/
+struct scheduler_stats {
+    uint32_t utilization;               //Percent of the last load window spent running routines
+    uint32_t peak_que_depth;            //Most routines waiting in the ready que during the last load window
+    uint32_t que_overflows;             //Number of deadlines that expired while the ready que was full (routines skipped)
+    uint32_t stretched_routines;        //Number of adaptive routines currently running slower than their min_deadline
+    uint32_t load_windows;              //Number of load windows completed since the scheduler started
+};
+
 /**
 * @brief        Initialize the SystTick timer with a given clock divider
 * @param[in]    SYSTICK_DIVIDER - Defines how many clock cycles to count before triggering a SysTick ISR (SystTick period = clock_counter / 60 MHz)
@@ -88,7 +122,7 @@ int32_t scheduler_init();
 
 /**
 * @brief        Add a routine to the scheduler to execute at the provided deadline
-* @param[in]    deadline - Number of SysTick interrupt routines to wait before routine is executed
+* @param[in]    deadline - Number of scheduler ticks (SCHEDULER_TICK_US each) to wait before routine is executed. Use SCHEDULER_US()/SCHEDULER_MS() to convert
 * @param[in]    function_pointer - Function pointer to the routine that you want to run at defined deadline
 * @param[in]    routine_priority - Priority of routine (High, Medium, Low)
 * @param[in]    num_ars - Number of arguments required by the routine (MAX VALUE OF 5 arguments per routine)
@@ -98,6 +132,22 @@ int32_t scheduler_init();
 */
 int32_t scheduler_addroutine(uint32_t deadline, void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...);
 
+/**
+* @brief        Add a routine whose deadline follows the system load. The deadline starts at min_deadline, is stretched by 25%
+*               (up to max_deadline) after every load window where utilization passes load_target or the ready que backs up,
+*               and shrinks back towards min_deadline once utilization falls LOAD_HYSTERESIS percent under load_target
+* @param[in]    min_deadline - Shortest period in scheduler ticks
+* @param[in]    max_deadline - Longest period in scheduler ticks
+* @param[in]    load_target - Utilization (0-100 percent) the routine is allowed to run at before it is slowed down
+* @param[in]    function_pointer - Function pointer to the routine that you want to run
+* @param[in]    routine_priority - Priority of routine (High, Medium, Low)
+* @param[in]    num_ars - Number of arguments required by the routine (MAX VALUE OF 5 arguments per routine)
+* @param[in]    ... - Up to 5 arguments to add (same rules as scheduler_addroutine)
+*
+* @return       Positive Number (routine ID) (Success), Negative Number (Failure)
+*/
+int32_t scheduler_addroutine_adaptive(uint32_t min_deadline, uint32_t max_deadline, uint8_t load_target, void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...);
+
 /**
 * @brief        Remove a routine from the scheduler
 * @param[in]    ID - ID number assigned to the routine when it was added
@@ -106,6 +156,33 @@ int32_t scheduler_addroutine(uint32_t deadline, void *function, Scheduler_Priori
 */
 int32_t scheduler_removeroutine(uint32_t ID);
 
+/**
+* @brief        Put a routine in the ready que now, without waiting for its deadline. Safe to call from an ISR
+* @param[in]    ID - ID number assigned to the routine when it was added
+*
+* @return       0 (Success), -1 (ID not found or ready que full), 1 (Routine was already waiting in the ready que)
+*/
+int32_t scheduler_release_routine(uint32_t ID);
+
+/**
+* @brief        Look a routine up once, for code that releases it too often to search for it every time (message
+*               queues). The pointer stays good until scheduler_removeroutine(), which passes it to routine_removed
+*               before the routine is gone
+* @param[in]    ID - ID number assigned to the routine when it was added
+*
+* @return       Routine (Success), NULL (ID not found)
+*/
+struct routine *scheduler_get_routine(uint32_t ID);
+
+/**
+* @brief        scheduler_release_routine() for a routine from scheduler_get_routine(), without the search. Call it
+*               inside SCHEDULER_ENTER_CRITICAL() so the routine cannot be removed while it is released
+* @param[in]    routine - Routine from scheduler_get_routine()
+*
+* @return       0 (Success), -1 (Ready que full), 1 (Routine was already waiting in the ready que)
+*/
+int32_t scheduler_release_routine_ptr(struct routine *routine);
+
 /**
 * @brief        Function placed in SysTick ISR. Decrements the deadline counters, reloads 
 *               deadline counters and adds routines to ready que when defined deadline expires
@@ -129,4 +206,20 @@ void SCHEDULER_TEST();
 */
 uint32_t scheduler_run_routines(void);
 
+/**
+* @brief        Read the load measurements from the last completed load window
+* @param[out]   stats - Structure to copy the measurements into
+*
+* @return       0 (Success), -1 (Failure)
+*/
+int32_t scheduler_get_stats(struct scheduler_stats *stats);
+
+/**
+* @brief        Read the current deadline of a routine. Adaptive routines report the stretched value
+* @param[in]    ID - ID number assigned to the routine when it was added
+*
+* @return       Deadline in scheduler ticks (Success), -1 (ID not found)
+*/
+int32_t scheduler_get_deadline(uint32_t ID);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "scheduler_calibrate.h"
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler.h"
+#include "timebase.h"
+#include "scheduler_log.h"
+#ifndef SCHEDULER_HOST
+#include "rtc.h"
+#endif
+
+#define CALIBRATE_ONE       (1ULL << 32)        //Scale of exactly one tick per raw tick
+
+//Globals
+static uint8_t calibrating = 0;
+static uint32_t window_ticks = 0;               //Raw ticks per window
+static uint32_t window_count = 0;               //Raw ticks counted in the current window
+static uint64_t total_raw = 0;                  //Raw ticks since scheduler_calibrate_start()
+static uint64_t total_corrected = 0;            //Ticks handed to the scheduler over the same span
+static uint64_t start_us = 0;                   //Reference at scheduler_calibrate_start()
+static uint64_t scale = CALIBRATE_ONE;          //Scheduler ticks per raw tick, Q32.32
+static uint64_t fraction = 0;                   //Part of a tick carried into the next call, Q0.32
+static struct calibrate_stats current_calibration;
+
+
+/*** Private Functions ***/
+
+#ifdef CALIBRATE_REFERENCE_US
+uint64_t CALIBRATE_REFERENCE_US(void);
+#define calibrate_reference_us CALIBRATE_REFERENCE_US
+#else
+static uint64_t calibrate_reference_us(void){
+#ifdef SCHEDULER_HOST
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000ULL + (uint64_t)now.tv_nsec / 1000);
+#else
+    uint32_t sec, ssec, check;
+
+    //The registers report E_BUSY while the RTC updates them. Read the seconds again in case they rolled over
+    //between the two reads
+    do {
+        while(MXC_RTC_GetSeconds(&sec) != E_NO_ERROR);
+        while(MXC_RTC_GetSubSeconds(&ssec) != E_NO_ERROR);
+        while(MXC_RTC_GetSeconds(&check) != E_NO_ERROR);
+    } while(check != sec);
+
+    return((uint64_t)sec * 1000000ULL + ((uint64_t)ssec * 1000000ULL) / CALIBRATE_RTC_SSEC_HZ);
+#endif
+}
+#endif
+
+//End of a window: compare everything counted since the start against the reference. Runs once per window, so the
+//software double precision math on a Cortex-M4 costs a few microseconds every CALIBRATE_WINDOW_MS
+static void calibrate_window(void){
+    uint64_t reference_us = calibrate_reference_us() - start_us;
+    double nominal_us = (double)total_raw * SCHEDULER_TICK_US;
+    double corrected_us = (double)total_corrected * SCHEDULER_TICK_US;
+    double error = (nominal_us - (double)reference_us) / (double)reference_us;
+
+    if(!reference_us || error > CALIBRATE_MAX_PPM * 1e-6 || error < -CALIBRATE_MAX_PPM * 1e-6){
+        SCHEDULER_ENTER_CRITICAL();
+        current_calibration.rejected++;
+        SCHEDULER_EXIT_CRITICAL();
+        return;
+    }
+
+    //Measuring from the start instead of per window keeps the read resolution of the reference (244 us for the RTC
+    //sub-seconds) from limiting the rate: it shrinks to under 1 ppm after a few minutes. The ticks lost or gained
+    //before the rate was known are paid back over the next window so the schedule lines up with the reference again
+    double rate = (double)reference_us / nominal_us;
+    double owed = (double)reference_us / SCHEDULER_TICK_US - (double)total_corrected - (double)fraction / (double)CALIBRATE_ONE;
+    double catch_up = owed / window_ticks;
+    if(catch_up > CALIBRATE_MAX_PPM * 1e-6){
+        catch_up = CALIBRATE_MAX_PPM * 1e-6;
+    }
+    else if(catch_up < -CALIBRATE_MAX_PPM * 1e-6){
+        catch_up = -CALIBRATE_MAX_PPM * 1e-6;
+    }
+    scale = (uint64_t)((rate + catch_up) * (double)CALIBRATE_ONE + 0.5);
+
+    SCHEDULER_ENTER_CRITICAL();
+    current_calibration.error_ppb = (int32_t)(error * 1e9);
+    current_calibration.residual_ppb = (int32_t)((corrected_us - (double)reference_us) / (double)reference_us * 1e9);
+    current_calibration.reference_us = reference_us;
+    current_calibration.windows++;
+    SCHEDULER_EXIT_CRITICAL();
+}
+
+
+/*** Public Functions ***/
+
+int32_t scheduler_calibrate_start(uint32_t window_ms){
+    if(!window_ms){
+        window_ms = CALIBRATE_WINDOW_MS;
+    }
+    if(SCHEDULER_MS(window_ms) < 2){
+        SCHEDULER_LOG(LOG_CALIBRATE_WINDOW, window_ms);
+        return(-1);
+    }
+
+    SCHEDULER_ENTER_CRITICAL();
+    window_ticks = SCHEDULER_MS(window_ms);
+    window_count = 0;
+    total_raw = 0;
+    total_corrected = 0;
+    current_calibration.error_ppb = 0;
+    current_calibration.residual_ppb = 0;
+    current_calibration.windows = 0;
+    current_calibration.rejected = 0;
+    current_calibration.reference_us = 0;
+    start_us = calibrate_reference_us();
+    calibrating = 1;
+    SCHEDULER_EXIT_CRITICAL();
+    return(0);
+}
+
+void scheduler_calibrate_stop(void){
+    SCHEDULER_ENTER_CRITICAL();
+    calibrating = 0;
+    scale = CALIBRATE_ONE;
+    fraction = 0;
+    SCHEDULER_EXIT_CRITICAL();
+}
+
+uint32_t scheduler_calibrate_ticks(uint32_t raw_ticks){
+    //raw_ticks * scale stays inside 64 bits for anything under 2^31 ticks
+    fraction += (uint64_t)raw_ticks * scale;
+    uint32_t ticks = (uint32_t)(fraction >> 32);
+    fraction &= 0xFFFFFFFFULL;
+
+    if(calibrating && raw_ticks){
+        total_raw += raw_ticks;
+        total_corrected += ticks;
+        window_count += raw_ticks;
+        if(window_count >= window_ticks){
+            window_count = 0;
+            calibrate_window();
+        }
+    }
+    return(ticks);
+}
+
+int32_t scheduler_calibrate_get_stats(struct calibrate_stats *stats){
+    if(stats == NULL){
+        return(-1);
+    }
+    SCHEDULER_ENTER_CRITICAL();
+    *stats = current_calibration;
+    SCHEDULER_EXIT_CRITICAL();
+    return(0);
+}
@@ -0,0 +1,81 @@
+#ifndef SCHEDULER_CALIBRATE_H
+#define SCHEDULER_CALIBRATE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "timebase.h"
+
+/* Glossary for scheduler_calibrate.h and scheduler_calibrate.c
+ *
+ *  Raw Tick       - Tick counted by the timer glue (TMR5 or the cycle counter). Its real length depends on the
+ *                   oscillator behind the timer, e.g. the 8 kHz clock can be off by a fraction of a percent.
+ *  Reference      - Clock trusted to keep wall time: the RTC running from the 32.768 kHz crystal on the target,
+ *                   CLOCK_MONOTONIC on a host build (-DSCHEDULER_HOST).
+ *  Window         - Number of raw ticks between two reads of the reference. The correction is recomputed at the
+ *                   end of every window from everything measured since scheduler_calibrate_start().
+ *  Scale          - Scheduler ticks per raw tick in Q32.32 (1 << 32 is exactly one tick). Raw ticks are multiplied
+ *                   by the scale and the fraction of a tick left over is carried into the next call, so the
+ *                   correction is applied without ever losing or rounding away time.
+ *  ppb            - Parts per billion (1000 ppb = 1 ppm, 1 ppm is 86 ms a day)
+ *
+ * The timer glue passes every elapsed tick count through scheduler_calibrate_ticks() before handing it to
+ * scheduler_update(). Until calibration is started the scale is exactly one and ticks pass through unchanged.
+ * The RTC must already be running (MXC_RTC_Init() and MXC_RTC_Start()) before scheduler_calibrate_start().
+ */
+
+#ifndef CALIBRATE_WINDOW_MS
+#define CALIBRATE_WINDOW_MS     10000       //Reference is read once every 10 s of scheduler time
+#endif
+#ifndef CALIBRATE_MAX_PPM
+#define CALIBRATE_MAX_PPM       50000       //Windows measuring more than 5% of error are thrown away (reference not running)
+#endif
+#ifndef CALIBRATE_RTC_SSEC_HZ
+#define CALIBRATE_RTC_SSEC_HZ   4096        //RTC sub-second counts per second (12 bit sub-second register)
+#endif
+
+/* The reference can be replaced with any clock that returns microseconds, e.g. a GPS PPS counter:
+ * build with -DCALIBRATE_REFERENCE_US=My_Clock_us and provide uint64_t My_Clock_us(void) */
+
+/*
+*   Measured error of the tick. Read with scheduler_calibrate_get_stats()
+*/
+struct calibrate_stats {
+    int32_t error_ppb;                  //Raw ticks against the reference since the start, positive when the timer runs fast
+    int32_t residual_ppb;               //Corrected ticks against the reference over the same span (what the routines see)
+    uint32_t windows;                   //Windows used for the correction
+    uint32_t rejected;                  //Windows thrown away for measuring more than CALIBRATE_MAX_PPM
+    uint64_t reference_us;              //Reference time measured since scheduler_calibrate_start()
+};
+
+/**
+* @brief        Latch the reference and start measuring the tick. Any earlier measurement is discarded, the last
+*               correction stays applied until the first window ends
+* @param[in]    window_ms - Scheduler time between reads of the reference (0 for CALIBRATE_WINDOW_MS)
+*
+* @return       0 (Success), -1 (Failure)
+*/
+int32_t scheduler_calibrate_start(uint32_t window_ms);
+
+/**
+* @brief        Stop measuring. The ticks go back to running uncorrected
+*/
+void scheduler_calibrate_stop(void);
+
+/**
+* @brief        Apply the correction to a number of raw ticks. Called by the timer glue with every elapsed count,
+*               from the tick interrupt context
+* @param[in]    raw_ticks - Ticks counted by the timer since the previous call
+*
+* @return       Corrected ticks to pass to scheduler_update()
+*/
+uint32_t scheduler_calibrate_ticks(uint32_t raw_ticks);
+
+/**
+* @brief        Copy the measured error
+* @param[out]   stats - Structure to copy the measurement into
+*
+* @return       0 (Success), -1 (Failure)
+*/
+int32_t scheduler_calibrate_get_stats(struct calibrate_stats *stats);
+
+#endif
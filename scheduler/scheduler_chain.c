@@ -0,0 +1,242 @@
+#include "scheduler_chain.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include "scheduler.h"
+#include "timebase.h"
+#include "scheduler_log.h"
+
+//Provided by scheduler.c
+extern SCHEDULER_THREAD_LOCAL struct routine *running_routine;
+int32_t read_arguments(uint16_t num_args, va_list args, uint32_t **routine_arguments);
+struct schedule_deadline *create_node(uint32_t deadline);
+int32_t add_function(struct schedule_deadline *routine ,void *function, Scheduler_Priority routine_priority, uint32_t *routine_arguments);
+int32_t release_routine(struct routine *routine);
+struct routine *find_routine(uint32_t ID);
+
+//Globals
+struct routine_chain *chain_list = NULL;     //Every routine that has chain state
+
+
+/*** Public Functions ***/
+
+//Add a routine that is only released by other routines
+int32_t scheduler_addroutine_triggered(void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...);
+//Release to_ID every time from_ID completes
+int32_t scheduler_chain_connect(uint32_t from_ID, uint32_t to_ID);
+//Publish and read payloads from inside a running routine
+int32_t scheduler_chain_publish(void *payload);
+void *scheduler_chain_input(uint32_t input);
+//Copy the latency of a chained routine
+int32_t scheduler_chain_get_stats(uint32_t ID, struct chain_stats *stats);
+//Hooks called by scheduler.c
+void chain_released(struct routine *routine);
+void chain_completed(struct routine *routine);
+void chain_remove(struct routine *routine);
+
+
+/*** Private Functions ***/
+
+//Get the chain state of a routine, allocating it the first time
+struct routine_chain *get_chain(struct routine *routine);
+//Record the latency of a routine that was released by its inputs
+void record_latency(struct routine_chain *chain);
+
+
+int32_t scheduler_addroutine_triggered(void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...){
+    struct schedule_deadline *current_timer;
+    uint32_t *routine_arguments = NULL;
+    int32_t rslt;
+
+    va_list args;
+    va_start(args,num_args);
+    rslt = read_arguments(num_args, args, &routine_arguments);
+    va_end(args);
+    if(rslt){
+        return(-1);
+    }
+
+    //The node is skipped by scheduler_update(), so the routine never runs on its own
+    if((current_timer = create_node(SCHEDULER_NO_DEADLINE)) == NULL){
+        return(-1);
+    }
+    return(add_function(current_timer, function, routine_priority, routine_arguments));
+}
+
+struct routine_chain *get_chain(struct routine *routine){
+    struct routine_chain *chain;
+
+    if(routine->chain){
+        return(routine->chain);
+    }
+    if((chain = (struct routine_chain *)calloc(1, sizeof(struct routine_chain))) == NULL){
+        SCHEDULER_LOG(LOG_CHAIN_NO_MEMORY);
+        return(NULL);
+    }
+    chain->owner = routine;
+    chain->stats.min_us = 0xFFFFFFFF;
+    chain->next = chain_list;
+    chain_list = chain;
+    routine->chain = chain;
+    return(chain);
+}
+
+int32_t scheduler_chain_connect(uint32_t from_ID, uint32_t to_ID){
+    struct routine *from;
+    struct routine *to;
+    struct routine_chain *from_chain;
+    struct routine_chain *to_chain;
+    struct chain_link *new_link;
+
+    if((from = find_routine(from_ID)) == NULL || (to = find_routine(to_ID)) == NULL || from == to){
+        SCHEDULER_LOG(LOG_CHAIN_CONNECT, from_ID, to_ID);
+        return(-1);
+    }
+    if((from_chain = get_chain(from)) == NULL || (to_chain = get_chain(to)) == NULL){
+        return(-1);
+    }
+    if(to_chain->num_inputs >= CHAIN_MAX_INPUTS){
+        SCHEDULER_LOG(LOG_CHAIN_INPUTS_FULL, to_ID, CHAIN_MAX_INPUTS);
+        return(-1);
+    }
+    if((new_link = (struct chain_link *)malloc(sizeof(struct chain_link))) == NULL){
+        SCHEDULER_LOG(LOG_CHAIN_LINK_NO_MEMORY);
+        return(-1);
+    }
+
+    new_link->target = to;
+    new_link->input = to_chain->num_inputs++;
+    to_chain->inputs_connected |= (uint8_t)(1U << new_link->input);
+
+    //Link is live as soon as it is on the list, so fill it in first
+    SCHEDULER_ENTER_CRITICAL();
+    new_link->next = from_chain->links;
+    from_chain->links = new_link;
+    SCHEDULER_EXIT_CRITICAL();
+    return(new_link->input);
+}
+
+int32_t scheduler_chain_publish(void *payload){
+    if(running_routine == NULL || running_routine->chain == NULL){
+        return(-1);
+    }
+    running_routine->chain->payload = payload;
+    return(0);
+}
+
+void *scheduler_chain_input(uint32_t input){
+    if(running_routine == NULL || running_routine->chain == NULL || input >= running_routine->chain->num_inputs){
+        return(NULL);
+    }
+    return(running_routine->chain->inputs[input]);
+}
+
+int32_t scheduler_chain_get_stats(uint32_t ID, struct chain_stats *stats){
+    struct routine *routine;
+
+    if(stats == NULL || (routine = find_routine(ID)) == NULL || routine->chain == NULL || !routine->chain->num_inputs){
+        return(-1);
+    }
+    *stats = routine->chain->stats;
+    if(!stats->completions){
+        stats->min_us = 0;
+    }
+    return(0);
+}
+
+//Released by its deadline, so this routine starts a new chain
+void chain_released(struct routine *routine){
+    routine->chain->release_cycles = timebase_cycles();
+}
+
+void chain_completed(struct routine *routine){
+    struct routine_chain *chain = routine->chain;
+    struct chain_link *link;
+
+    if(chain->num_inputs){
+        record_latency(chain);
+    }
+
+    //Several routines feeding the same target can complete at once on the host executor
+    SCHEDULER_ENTER_CRITICAL();
+    link = chain->links;
+    while(link != NULL){
+        struct routine_chain *target = link->target->chain;
+
+        target->inputs[link->input] = chain->payload;
+        //Latency is measured from the oldest input, so keep the earliest release time until the target is released
+        if(!target->inputs_ready || (int32_t)(chain->release_cycles - target->release_cycles) < 0){
+            target->release_cycles = chain->release_cycles;
+        }
+        target->inputs_ready |= (uint8_t)(1U << link->input);
+
+        //Every input has completed, release the target
+        if(target->inputs_ready == target->inputs_connected){
+            target->inputs_ready = 0;
+            if(release_routine(link->target)){
+                target->stats.missed++;
+            }
+        }
+        link = link->next;
+    }
+    SCHEDULER_EXIT_CRITICAL();
+}
+
+void record_latency(struct routine_chain *chain){
+    uint32_t cycles = timebase_cycles() - chain->release_cycles;
+    uint32_t latency = timebase_cycles_to_us(cycles);
+
+    chain->sum_cycles += cycles;
+    chain->stats.completions++;
+    chain->stats.last_us = latency;
+    if(latency < chain->stats.min_us){
+        chain->stats.min_us = latency;
+    }
+    if(latency > chain->stats.max_us){
+        chain->stats.max_us = latency;
+    }
+    chain->stats.avg_us = timebase_cycles_to_us((uint32_t)(chain->sum_cycles / chain->stats.completions));
+}
+
+void chain_remove(struct routine *routine){
+    struct routine_chain *chain = routine->chain;
+    struct routine_chain **current_chain;
+    struct chain_link **current_link;
+    struct chain_link *link;
+
+    SCHEDULER_ENTER_CRITICAL();
+    //Drop every link that releases this routine
+    for(struct routine_chain *other = chain_list; other != NULL; other = other->next){
+        current_link = &other->links;
+        while(*current_link != NULL){
+            if((*current_link)->target == routine){
+                link = *current_link;
+                *current_link = link->next;
+                free(link);
+            }
+            else{
+                current_link = &(*current_link)->next;
+            }
+        }
+    }
+    //Take this chain off the list
+    current_chain = &chain_list;
+    while(*current_chain != chain){
+        current_chain = &(*current_chain)->next;
+    }
+    *current_chain = chain->next;
+    routine->chain = NULL;
+    SCHEDULER_EXIT_CRITICAL();
+
+    //Free the links out of this routine. Routines it fed keep their other input numbers and stop waiting on this one
+    while(chain->links != NULL){
+        link = chain->links;
+        chain->links = link->next;
+        link->target->chain->inputs_connected &= (uint8_t)~(1U << link->input);
+        link->target->chain->inputs_ready &= (uint8_t)~(1U << link->input);
+        link->target->chain->inputs[link->input] = NULL;
+        free(link);
+    }
+    free(chain);
+}
@@ -0,0 +1,124 @@
+#ifndef SCHEDULER_CHAIN_H
+#define SCHEDULER_CHAIN_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler.h"
+
+/* Glossary for scheduler_chain.h and scheduler_chain.c
+ *
+ *  Chain          - Routines connected so that one routine finishing releases the next one into the ready que,
+ *                   e.g. read sensor -> compute IK -> command servos -> log. Only the first routine needs a deadline.
+ *  Input          - One connection into a routine. A routine with several inputs (fan-in) is released once every
+ *                   input has completed since it last ran.
+ *  Payload        - Pointer a routine publishes while it runs. It is handed to the inputs of every routine it
+ *                   releases, so the data itself is never copied.
+ *  Latency        - Time from the release of the oldest routine at the start of the chain to the completion of a
+ *                   chained routine. Read it on the last routine of a chain to get the end-to-end latency.
+ *
+ * Chains are built on scheduler.c (not scheduler_compact.c). A released routine runs in the same
+ * scheduler_run_routines() pass when its priority is the same or lower than the routine that released it.
+ */
+
+#ifndef CHAIN_MAX_INPUTS
+#define CHAIN_MAX_INPUTS    8           //Most inputs one routine can wait on
+#endif
+#if CHAIN_MAX_INPUTS > 8
+#error "CHAIN_MAX_INPUTS is at most 8, inputs_connected and inputs_ready are 8-bit masks"
+#endif
+
+/*
+*   Latency of a chained routine, in microseconds. Read with scheduler_chain_get_stats()
+*/
+struct chain_stats {
+    uint32_t completions;               //Number of times the routine has run after being released by its inputs
+    uint32_t last_us;                   //Latency of the most recent run
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t avg_us;
+    uint32_t missed;                    //Releases dropped because the routine was still waiting in the ready que
+};
+
+/*
+*   One connection between two routines. Kept on the routine that releases the target
+*/
+struct chain_link {
+    struct routine *target;             //Routine released by this connection
+    uint8_t input;                      //Input of the target this connection fills
+    struct chain_link *next;
+};
+
+/*
+*   Chain state of a routine. Allocated the first time the routine is connected to another one
+*/
+struct routine_chain {
+    struct routine *owner;
+    struct chain_link *links;           //Routines waiting on this one (Linked List format)
+    void *payload;                      //Published by the owner while it runs, handed to every link when it completes
+    void *inputs[CHAIN_MAX_INPUTS];     //Payloads received from the routines connected into the owner
+    uint8_t num_inputs;                 //Input numbers handed out so far
+    uint8_t inputs_connected;           //One bit per input that still has a routine connected to it
+    uint8_t inputs_ready;               //One bit per input that has completed since the owner was last released
+    uint32_t release_cycles;            //Cycle count when the oldest routine at the head of the chain was released
+    uint64_t sum_cycles;                //Latency accumulator for chain_stats.avg_us
+    struct chain_stats stats;
+    struct routine_chain *next;         //Every chain state is on one list so removed routines can be unlinked
+};
+
+/**
+* @brief        Add a routine that has no deadline. It only runs when the routines connected to it complete
+*               (or when scheduler_release_routine() is called)
+* @param[in]    function_pointer - Function pointer to the routine
+* @param[in]    routine_priority - Priority of routine (High, Medium, Low)
+* @param[in]    num_ars - Number of arguments required by the routine (MAX VALUE OF 5 arguments per routine)
+* @param[in]    ... - Up to 5 arguments to add (same rules as scheduler_addroutine)
+*
+* @return       Positive Number (routine ID) (Success), Negative Number (Failure)
+*/
+int32_t scheduler_addroutine_triggered(void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...);
+
+/**
+* @brief        Release to_ID every time from_ID completes. Connecting several routines into the same to_ID makes it
+*               wait for all of them (fan-in). Inputs are numbered in the order they are connected
+* @param[in]    from_ID - Routine that completes first
+* @param[in]    to_ID - Routine to release
+*
+* @return       Input number of the new connection on to_ID (Success), -1 (Failure)
+*/
+int32_t scheduler_chain_connect(uint32_t from_ID, uint32_t to_ID);
+
+/**
+* @brief        Publish a payload from inside the running routine. Every routine it releases receives the pointer.
+*               The data must stay valid until those routines have run (double buffer it if the producer runs again first)
+* @param[in]    payload - Pointer to hand downstream
+*
+* @return       0 (Success), -1 (Not called from a chained routine)
+*/
+int32_t scheduler_chain_publish(void *payload);
+
+/**
+* @brief        Read a payload from inside the running routine
+* @param[in]    input - Input number returned by scheduler_chain_connect()
+*
+* @return       Payload published by the routine connected to this input, NULL if there is none
+*/
+void *scheduler_chain_input(uint32_t input);
+
+/**
+* @brief        Read the latency of a chained routine. On the last routine of a chain this is the end-to-end latency
+* @param[in]    ID - Routine with at least one input
+* @param[out]   stats - Structure to copy the measurements into
+*
+* @return       0 (Success), -1 (Failure)
+*/
+int32_t scheduler_chain_get_stats(uint32_t ID, struct chain_stats *stats);
+
+/**
+* @brief        Hooks called by scheduler.c. chain_released() when a routine with chain state is put in the ready que by
+*               its deadline, chain_completed() when it returns, chain_remove() before it is freed
+*/
+void chain_released(struct routine *routine);
+void chain_completed(struct routine *routine);
+void chain_remove(struct routine *routine);
+
+#endif
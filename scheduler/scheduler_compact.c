@@ -0,0 +1,352 @@
+#include "scheduler_compact.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include "scheduler.h"
+#include "timebase.h"
+#include "scheduler_timer.h"
+#include "scheduler_log.h"
+
+//Globals
+struct compact_schedule compact_schedule;
+void (*routine_removed)(struct routine *routine) = NULL;        //Told about every routine before it is removed (message queues)
+
+
+/*** Public Functions ***/
+
+int32_t scheduler_init(void);
+//Returns positive routine ID or negative for error
+int32_t scheduler_addroutine(uint32_t deadline, void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...);
+//Deletes routine and returns 0 for success, -1 for ID not found
+int32_t scheduler_removeroutine(uint32_t ID);
+//Placed inside the timer handler for updating the structure
+void scheduler_update(uint32_t elapsed_val);
+//Print all of the active routines on the scheduler
+void print_routines();
+//Basic test program to make sure the scheduler can setup properly
+void SCHEDULER_TEST();
+
+uint32_t scheduler_run_routines(void);
+//Current deadline of a routine
+int32_t scheduler_get_deadline(uint32_t ID);
+//Put a routine in the ready que without waiting for its deadline
+int32_t scheduler_release_routine(uint32_t ID);
+//Routine slot as a handle, so it can be released without checking the ID
+struct routine *scheduler_get_routine(uint32_t ID);
+//Release a routine from scheduler_get_routine() (inside the critical section)
+int32_t scheduler_release_routine_ptr(struct routine *routine);
+//Size of the schedule table
+uint32_t compact_table_bytes(void);
+
+
+/*** Private Functions ***/
+
+//Build the free lists the first time the table is used
+void compact_init(void);
+//Find the deadline slot for this deadline value, or take a new one
+uint16_t compact_get_deadline(uint32_t deadline);
+//Run the routines sitting in the ready que
+void compact_run_routines(Scheduler_Priority routine_priority);
+//Move routines into the ready que
+void compact_stage_routine(uint16_t deadline_index);
+
+
+void compact_init(void){
+    if(compact_schedule.initialized){
+        return;
+    }
+
+    for(uint16_t i = 0; i < COMPACT_MAX_ROUTINES; i++){
+        compact_schedule.routines[i].function_pointer = NULL;
+        compact_schedule.routines[i].flags = 0;
+        compact_schedule.routines[i].next = (i + 1 < COMPACT_MAX_ROUTINES) ? i + 1 : COMPACT_NONE;
+    }
+    for(uint16_t i = 0; i < COMPACT_MAX_DEADLINES; i++){
+        compact_schedule.routines_head[i] = COMPACT_NONE;
+    }
+    deadline_table_init(&compact_schedule.deadline_table, compact_schedule.deadline_counter, compact_schedule.routine_deadline,
+                        compact_schedule.expired, COMPACT_MAX_DEADLINES);
+    for(uint16_t i = 0; i < COMPACT_MAX_ARGUMENTS; i++){
+        compact_schedule.arguments[i][0] = (i + 1 < COMPACT_MAX_ARGUMENTS) ? i + 1 : COMPACT_NONE;
+    }
+    for(int p = 0; p < 3; p++){
+        for(int w = 0; w < COMPACT_READY_WORDS; w++){
+            compact_schedule.ready[p][w] = 0;
+        }
+    }
+
+    compact_schedule.free_routines = 0;
+    compact_schedule.free_arguments = 0;
+    compact_schedule.routine_count = 0;
+    compact_schedule.updating_flag = 0;
+    compact_schedule.initialized = 1;
+}
+
+int32_t scheduler_init(){
+    compact_init();
+    scheduler_timer_init();
+    return(0);
+}
+
+uint16_t compact_get_deadline(uint32_t deadline){
+    struct deadline_table *table = &compact_schedule.deadline_table;
+    int32_t index;
+
+    //Check to see if there is already an entry for this deadline
+    for(uint32_t i = 0; i < table->count; i++){
+        if(table->periods[i] == deadline){
+            return((uint16_t)i);
+        }
+    }
+
+    //Add a new entry at the end of the table
+    if((index = deadline_table_add(table, deadline)) < 0){
+        return(COMPACT_NONE);
+    }
+    compact_schedule.routines_head[index] = COMPACT_NONE;
+    return((uint16_t)index);
+}
+
+int32_t scheduler_addroutine(uint32_t deadline, void *function, Scheduler_Priority routine_priority, uint16_t num_args, ...){
+    uint16_t routine_index;
+    uint16_t deadline_index;
+    uint16_t argument_index = COMPACT_NONE;
+
+    compact_init();
+
+    if(num_args > 5){
+        SCHEDULER_LOG(LOG_TOO_MANY_ARGS);
+        return(-1);
+    }
+    if((routine_index = compact_schedule.free_routines) == COMPACT_NONE){
+        SCHEDULER_LOG(LOG_COMPACT_NO_ROUTINES, COMPACT_MAX_ROUTINES);
+        return(-1);
+    }
+    if(num_args && (argument_index = compact_schedule.free_arguments) == COMPACT_NONE){
+        SCHEDULER_LOG(LOG_COMPACT_NO_ARGUMENTS, COMPACT_MAX_ARGUMENTS);
+        return(-1);
+    }
+    if((deadline_index = compact_get_deadline(deadline)) == COMPACT_NONE){
+        return(-1);
+    }
+
+    //Copy the arguments into their slot
+    if(num_args){
+        uint32_t *routine_arguments = compact_schedule.arguments[argument_index];
+        compact_schedule.free_arguments = (uint16_t)routine_arguments[0];
+        va_list args;
+        va_start(args,num_args);
+        for(int i=0;i<5;i++){
+            routine_arguments[i] = (i < num_args) ? va_arg(args,int) : 0;    //Assumes int is a standard 32 bit allocation
+        }
+        va_end(args);
+    }
+
+    //Fill in the routine and push it onto its deadline
+    struct compact_routine *new_routine = &compact_schedule.routines[routine_index];
+    compact_schedule.free_routines = new_routine->next;
+
+    new_routine->function_pointer = function;
+    new_routine->deadline = deadline_index;
+    new_routine->arguments = argument_index;
+    new_routine->flags = COMPACT_FLAG_IN_USE | (routine_priority & COMPACT_FLAG_PRIORITY);
+    new_routine->next = compact_schedule.routines_head[deadline_index];
+    compact_schedule.routines_head[deadline_index] = routine_index;
+
+    return(routine_index);
+}
+
+int32_t scheduler_removeroutine(uint32_t ID){
+    if(ID >= COMPACT_MAX_ROUTINES || !(compact_schedule.routines[ID].flags & COMPACT_FLAG_IN_USE)){
+        SCHEDULER_LOG(LOG_COMPACT_REMOVE_ID, ID);
+        return(-1);
+    }
+
+    struct compact_routine *old_routine = &compact_schedule.routines[ID];
+    uint16_t deadline_index = old_routine->deadline;
+
+    //The slot may be reused, so nothing may release it through a handle from scheduler_get_routine() any more
+    if(routine_removed){
+        SCHEDULER_ENTER_CRITICAL();
+        routine_removed((struct routine *)old_routine);
+        SCHEDULER_EXIT_CRITICAL();
+    }
+
+    //Unlink from the deadline
+    if(compact_schedule.routines_head[deadline_index] == ID){
+        compact_schedule.routines_head[deadline_index] = old_routine->next;
+    }
+    else{
+        uint16_t index = compact_schedule.routines_head[deadline_index];
+        while(compact_schedule.routines[index].next != ID){
+            index = compact_schedule.routines[index].next;
+        }
+        compact_schedule.routines[index].next = old_routine->next;
+    }
+
+    //Drop it from the ready que if it was waiting to run
+    uint32_t mask = 1UL << (ID & 31);
+    uint32_t *ready = &compact_schedule.ready[old_routine->flags & COMPACT_FLAG_PRIORITY][ID >> 5];
+    if(__atomic_fetch_and(ready, ~mask, __ATOMIC_RELAXED) & mask){
+        __atomic_fetch_sub(&compact_schedule.routine_count, 1, __ATOMIC_RELAXED);
+    }
+
+    //Give the argument slot back
+    if(old_routine->arguments != COMPACT_NONE){
+        compact_schedule.arguments[old_routine->arguments][0] = compact_schedule.free_arguments;
+        compact_schedule.free_arguments = old_routine->arguments;
+    }
+
+    old_routine->function_pointer = NULL;
+    old_routine->flags = 0;
+    old_routine->next = compact_schedule.free_routines;
+    compact_schedule.free_routines = ID;
+
+    //Last routine at this deadline, give the table entry back. The last entry moves into the hole, so repoint its routines
+    if(compact_schedule.routines_head[deadline_index] == COMPACT_NONE){
+        int32_t moved = deadline_table_remove(&compact_schedule.deadline_table, deadline_index);
+        if(moved >= 0){
+            uint16_t index = compact_schedule.routines_head[moved];
+            compact_schedule.routines_head[deadline_index] = index;
+            while(index != COMPACT_NONE){
+                compact_schedule.routines[index].deadline = deadline_index;
+                index = compact_schedule.routines[index].next;
+            }
+        }
+    }
+    return(0);
+}
+
+//Placed inside the timer handler for updating the structure
+void scheduler_update(uint32_t elapsed_val){
+    int32_t index;
+    compact_schedule.updating_flag = 1;
+    //One vectorized pass over the counters, then stage whatever expired
+    if(deadline_table_update(&compact_schedule.deadline_table, elapsed_val)){
+        while((index = deadline_table_next_expired(&compact_schedule.deadline_table)) >= 0){
+            compact_stage_routine((uint16_t)index);
+        }
+    }
+    compact_schedule.updating_flag = 0;
+}
+
+//Move routines into the ready que
+void compact_stage_routine(uint16_t deadline_index){
+    uint16_t index = compact_schedule.routines_head[deadline_index];
+    while(index != COMPACT_NONE){
+        struct compact_routine *current_routine = &compact_schedule.routines[index];
+        if(!(current_routine->flags & COMPACT_FLAG_SCHEDULED)){
+            current_routine->flags |= COMPACT_FLAG_SCHEDULED;
+            compact_schedule.ready[current_routine->flags & COMPACT_FLAG_PRIORITY][index >> 5] |= 1UL << (index & 31);
+            compact_schedule.routine_count++;
+        }
+        index = current_routine->next;
+    }
+}
+
+uint32_t scheduler_run_routines(void){
+    while(compact_schedule.updating_flag);
+
+    elapsed_timer_start();
+    compact_run_routines(HIGH_PRIORITY_ROUTINE);
+    scheduler_update(elapsed_timer_read());
+
+    compact_run_routines(HIGH_PRIORITY_ROUTINE);
+    compact_run_routines(MEDIUM_PRIORITY_ROUTINE);
+    scheduler_update(elapsed_timer_read());
+
+    compact_run_routines(HIGH_PRIORITY_ROUTINE);
+    compact_run_routines(MEDIUM_PRIORITY_ROUTINE);
+    compact_run_routines(LOW_PRIORITY_ROUTINE);
+    scheduler_update(elapsed_timer_read());
+
+    elapsed_timer_stop();
+    return(0);
+}
+
+//Run the routines sitting in the ready que, lowest slot first. The tick ISR sets bits in the same words, so they
+//are cleared atomically
+void compact_run_routines(Scheduler_Priority routine_priority){
+    uint32_t *ready = compact_schedule.ready[routine_priority];
+    for(int w = 0; w < COMPACT_READY_WORDS; w++){
+        uint32_t pending;
+        while((pending = __atomic_load_n(&ready[w], __ATOMIC_ACQUIRE))){
+            uint16_t index = (uint16_t)((w << 5) + __builtin_ctz(pending));
+            struct compact_routine *current_routine = &compact_schedule.routines[index];
+            __atomic_fetch_and(&ready[w], ~(1UL << (index & 31)), __ATOMIC_RELAXED);
+
+            if(current_routine->arguments != COMPACT_NONE){
+                uint32_t *arguments = compact_schedule.arguments[current_routine->arguments];
+                (*current_routine->function_pointer)(arguments[0],arguments[1],arguments[2],arguments[3],arguments[4]);
+            }
+            else{
+                (*current_routine->function_pointer)();
+            }
+            __atomic_fetch_and(&current_routine->flags, (uint16_t)~COMPACT_FLAG_SCHEDULED, __ATOMIC_RELEASE);
+            __atomic_fetch_sub(&compact_schedule.routine_count, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+int32_t scheduler_release_routine(uint32_t ID){
+    if(ID >= COMPACT_MAX_ROUTINES || !(compact_schedule.routines[ID].flags & COMPACT_FLAG_IN_USE)){
+        SCHEDULER_LOG(LOG_RELEASE_NOT_FOUND, ID);
+        return(-1);
+    }
+
+    int32_t rslt;
+    SCHEDULER_ENTER_CRITICAL();
+    rslt = scheduler_release_routine_ptr((struct routine *)&compact_schedule.routines[ID]);
+    SCHEDULER_EXIT_CRITICAL();
+    return(rslt);
+}
+
+struct routine *scheduler_get_routine(uint32_t ID){
+    if(ID >= COMPACT_MAX_ROUTINES || !(compact_schedule.routines[ID].flags & COMPACT_FLAG_IN_USE)){
+        return(NULL);
+    }
+    return((struct routine *)&compact_schedule.routines[ID]);
+}
+
+int32_t scheduler_release_routine_ptr(struct routine *routine){
+    struct compact_routine *current_routine = (struct compact_routine *)routine;
+    uint32_t ID = (uint32_t)(current_routine - compact_schedule.routines);
+
+    //The run loop clears these words without the critical section, so they are set atomically too
+    if(__atomic_fetch_or(&current_routine->flags, COMPACT_FLAG_SCHEDULED, __ATOMIC_ACQUIRE) & COMPACT_FLAG_SCHEDULED){
+        return(1);
+    }
+    __atomic_fetch_or(&compact_schedule.ready[current_routine->flags & COMPACT_FLAG_PRIORITY][ID >> 5], 1UL << (ID & 31), __ATOMIC_RELEASE);
+    __atomic_fetch_add(&compact_schedule.routine_count, 1, __ATOMIC_RELAXED);
+    return(0);
+}
+
+int32_t scheduler_get_deadline(uint32_t ID){
+    if(ID >= COMPACT_MAX_ROUTINES || !(compact_schedule.routines[ID].flags & COMPACT_FLAG_IN_USE)){
+        return(-1);
+    }
+    return(compact_schedule.routine_deadline[compact_schedule.routines[ID].deadline]);
+}
+
+uint32_t compact_table_bytes(void){
+    return(sizeof(struct compact_schedule));
+}
+
+//Print all of the active routines on the scheduler
+void print_routines(){
+    printf("Process ID\tInterval\n");
+    printf("_____________________________\n");
+    for(uint32_t deadline_index = 0; deadline_index < compact_schedule.deadline_table.count; deadline_index++){
+        uint16_t index = compact_schedule.routines_head[deadline_index];
+        while(index != COMPACT_NONE){
+            printf("%d\t\t%d\n",index,compact_schedule.routine_deadline[deadline_index]);
+            index = compact_schedule.routines[index].next;
+        }
+    }
+    printf("\nCompact table: %d bytes for %d routine slots\n\n", compact_table_bytes(), COMPACT_MAX_ROUTINES);
+}
+
+void SCHEDULER_TEST(){
+
+
+}
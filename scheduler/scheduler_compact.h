@@ -0,0 +1,82 @@
+#ifndef SCHEDULER_COMPACT_H
+#define SCHEDULER_COMPACT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler.h"
+#include "deadline_table.h"
+
+/* Compact layout for RAM-constrained builds. Link scheduler_compact.c instead of scheduler.c: the public
+ * scheduler_* API is the same, but every routine and deadline lives in one statically sized table and
+ * points at its neighbours with 16-bit indices instead of heap pointers.
+ *
+ * Bytes used on a 32-bit target:
+ *      struct compact_routine      12 bytes per routine slot
+ *      deadline table entry        10 bytes per distinct deadline slot (6 with DEADLINE_TABLE_16BIT), plus 1 mask bit
+ *      argument set                20 bytes per routine that takes arguments
+ *      ready que                   3 bits per routine slot (one bitmap per priority)
+ *
+ * With the defaults below (256 routines, 64 deadlines, 64 argument sets) the whole table is 5136 bytes,
+ * about 20.1 bytes per routine (4880 bytes with DEADLINE_TABLE_16BIT). Both include the padding that rounds
+ * the table up to the 16 byte alignment of the deadline counters. Adaptive routines and load statistics
+ * are only available in scheduler.c.
+ */
+
+#ifndef COMPACT_MAX_ROUTINES
+#define COMPACT_MAX_ROUTINES    256         //Routine slots (maximum 65535)
+#endif
+#ifndef COMPACT_MAX_DEADLINES
+#define COMPACT_MAX_DEADLINES   64          //Distinct deadline values that can be active at once
+#endif
+#ifndef COMPACT_MAX_ARGUMENTS
+#define COMPACT_MAX_ARGUMENTS   64          //Routines that can hold arguments at once
+#endif
+
+#define COMPACT_NONE                0xFFFF  //Index value that ends a list
+#define COMPACT_READY_WORDS         ((COMPACT_MAX_ROUTINES + 31) / 32)
+
+//Bit fields of compact_routine.flags
+#define COMPACT_FLAG_PRIORITY       0x0003  //Scheduler_Priority of the routine
+#define COMPACT_FLAG_SCHEDULED      0x0004  //Routine is in the ready que or running (same as routine_scheduled_flag)
+#define COMPACT_FLAG_IN_USE         0x0008  //Slot holds a routine
+
+/*
+*   One routine slot. Routine IDs are slot indices
+*/
+struct compact_routine {
+    void (* function_pointer)();            //Function Pointer to routine that must be run
+    uint16_t next;                          //Next routine on the same deadline (or next free slot)
+    uint16_t deadline;                      //Deadline table entry this routine belongs to
+    uint16_t arguments;                     //Index of the argument set (COMPACT_NONE for no arguments)
+    uint16_t flags;                         //Priority and state bits (COMPACT_FLAG_*)
+};
+
+/*
+*   The whole schedule in one contiguous block. Deadlines live in a struct-of-arrays deadline table: entry i of
+*   routines_head, deadline_counter and routine_deadline all belong to deadline i, and the active deadlines are
+*   packed into the front of the arrays
+*/
+struct compact_schedule {
+    struct compact_routine routines[COMPACT_MAX_ROUTINES];
+    dt_count_t deadline_counter[COMPACT_MAX_DEADLINES] __attribute__((aligned(16)));   //Ticks left for every deadline
+    dt_count_t routine_deadline[COMPACT_MAX_DEADLINES];                                 //Deadline values in scheduler ticks
+    uint32_t expired[DEADLINE_TABLE_WORDS(COMPACT_MAX_DEADLINES)];                      //Expired mask from the last update
+    struct deadline_table deadline_table;
+    uint32_t arguments[COMPACT_MAX_ARGUMENTS][5];
+    uint32_t ready[3][COMPACT_READY_WORDS]; //Ready que, one bit per routine slot for every priority
+    uint16_t routines_head[COMPACT_MAX_DEADLINES];                                      //First routine of every deadline
+    uint16_t free_routines;                 //Free list, linked through compact_routine.next
+    uint16_t free_arguments;                //Free list, linked through arguments[i][0]
+    uint16_t routine_count;                 //Routines waiting in the ready que
+    uint8_t updating_flag;
+    uint8_t initialized;
+};
+
+/**
+* @brief        Number of bytes taken by the compact schedule table
+*
+* @return       sizeof(struct compact_schedule)
+*/
+uint32_t compact_table_bytes(void);
+
+#endif
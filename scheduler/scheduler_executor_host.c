@@ -0,0 +1,247 @@
+#include "scheduler_executor_host.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include "scheduler.h"
+
+//Provided by scheduler.c
+extern struct routine_que current_que;
+extern struct scheduler_stats current_stats;
+extern uint32_t load_peak_depth;
+extern int32_t (*external_release)(struct routine *routine);
+void run_routine(struct routine *routine);
+
+/*
+*   Routines waiting on one worker for one priority. top is the oldest entry (stolen first), bottom the newest
+*/
+struct executor_deque {
+    struct routine *items[EXECUTOR_DEQUE_SIZE];
+    uint32_t top;
+    uint32_t bottom;
+};
+
+struct executor_worker {
+    pthread_t thread;
+    pthread_mutex_t lock;                   //Guards the three deques
+    struct executor_deque deques[3];
+    uint32_t index;
+    struct executor_stats stats;
+};
+
+//Globals
+static struct executor_worker workers[EXECUTOR_MAX_WORKERS];
+static uint32_t num_workers = 0;
+static uint8_t executor_running = 0;
+static uint32_t pending = 0;                //Routines sitting on a deque
+static uint32_t active = 0;                 //Routines being run by a worker
+static uint32_t sleepers = 0;               //Workers waiting on work_cond
+static uint32_t next_worker = 0;            //Round robin target for routines released outside the workers
+static pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static SCHEDULER_THREAD_LOCAL struct executor_worker *current_worker = NULL;
+
+
+/*** Private Functions ***/
+
+//Push on the bottom of a deque. Caller holds the worker lock
+static int32_t deque_push(struct executor_deque *deque, struct routine *routine){
+    if(deque->bottom - deque->top >= EXECUTOR_DEQUE_SIZE){
+        return(-1);
+    }
+    deque->items[deque->bottom % EXECUTOR_DEQUE_SIZE] = routine;
+    __atomic_store_n(&deque->bottom, deque->bottom + 1, __ATOMIC_RELAXED);
+    return(0);
+}
+
+//Owner end, newest first
+static struct routine *deque_pop(struct executor_deque *deque){
+    if(deque->bottom == deque->top){
+        return(NULL);
+    }
+    __atomic_store_n(&deque->bottom, deque->bottom - 1, __ATOMIC_RELAXED);
+    return(deque->items[deque->bottom % EXECUTOR_DEQUE_SIZE]);
+}
+
+//Thief end, oldest first
+static struct routine *deque_steal(struct executor_deque *deque){
+    if(deque->bottom == deque->top){
+        return(NULL);
+    }
+    struct routine *routine = deque->items[deque->top % EXECUTOR_DEQUE_SIZE];
+    __atomic_store_n(&deque->top, deque->top + 1, __ATOMIC_RELAXED);
+    return(routine);
+}
+
+//Highest priority first: every worker's deque is checked for a priority before any lower priority is taken
+static struct routine *find_work(struct executor_worker *self){
+    struct routine *routine;
+
+    for(int priority = HIGH_PRIORITY_ROUTINE; priority <= LOW_PRIORITY_ROUTINE; priority++){
+        pthread_mutex_lock(&self->lock);
+        routine = deque_pop(&self->deques[priority]);
+        pthread_mutex_unlock(&self->lock);
+        if(routine){
+            return(routine);
+        }
+        for(uint32_t i = 1; i < num_workers; i++){
+            struct executor_worker *victim = &workers[(self->index + i) % num_workers];
+            //Cheap look before taking the lock
+            if(__atomic_load_n(&victim->deques[priority].bottom, __ATOMIC_RELAXED) == __atomic_load_n(&victim->deques[priority].top, __ATOMIC_RELAXED)){
+                continue;
+            }
+            pthread_mutex_lock(&victim->lock);
+            routine = deque_steal(&victim->deques[priority]);
+            pthread_mutex_unlock(&victim->lock);
+            if(routine){
+                self->stats.stolen++;
+                return(routine);
+            }
+        }
+    }
+    return(NULL);
+}
+
+static void *worker_main(void *arg){
+    struct executor_worker *self = (struct executor_worker *)arg;
+    struct routine *routine;
+
+    current_worker = self;
+    while(__atomic_load_n(&executor_running, __ATOMIC_ACQUIRE)){
+        if((routine = find_work(self)) != NULL){
+            __atomic_fetch_add(&active, 1, __ATOMIC_SEQ_CST);
+            __atomic_fetch_sub(&pending, 1, __ATOMIC_SEQ_CST);
+            run_routine(routine);
+            __atomic_fetch_sub(&active, 1, __ATOMIC_SEQ_CST);
+            self->stats.executed++;
+            continue;
+        }
+
+        //Nothing anywhere, sleep until executor_submit() posts something
+        pthread_mutex_lock(&idle_lock);
+        __atomic_fetch_add(&sleepers, 1, __ATOMIC_SEQ_CST);
+        while(!__atomic_load_n(&pending, __ATOMIC_SEQ_CST) && __atomic_load_n(&executor_running, __ATOMIC_ACQUIRE)){
+            pthread_cond_wait(&work_cond, &idle_lock);
+        }
+        __atomic_fetch_sub(&sleepers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&idle_lock);
+    }
+    current_worker = NULL;
+    return(NULL);
+}
+
+
+/*** Public Functions ***/
+
+int32_t scheduler_executor_start(uint32_t workers_requested){
+    if(executor_running){
+        printf("Executor is already running\n");
+        return(-1);
+    }
+    if(!workers_requested || workers_requested > EXECUTOR_MAX_WORKERS){
+        printf("Error, invalid number of workers (%d, maximum of %d)\n",workers_requested,EXECUTOR_MAX_WORKERS);
+        return(-1);
+    }
+
+    num_workers = workers_requested;
+    pending = 0;
+    active = 0;
+    for(uint32_t i = 0; i < num_workers; i++){
+        struct executor_worker *worker = &workers[i];
+        worker->index = i;
+        worker->stats.executed = 0;
+        worker->stats.stolen = 0;
+        for(int p = 0; p < 3; p++){
+            worker->deques[p].top = 0;
+            worker->deques[p].bottom = 0;
+        }
+        pthread_mutex_init(&worker->lock, NULL);
+    }
+
+    __atomic_store_n(&executor_running, 1, __ATOMIC_RELEASE);
+    external_release = executor_submit;
+    for(uint32_t i = 0; i < num_workers; i++){
+        if(pthread_create(&workers[i].thread, NULL, worker_main, &workers[i])){
+            printf("Error starting executor worker %d\n",i);
+            num_workers = i;
+            scheduler_executor_stop();
+            return(-1);
+        }
+    }
+    return(0);
+}
+
+void scheduler_executor_wait(void){
+    while(__atomic_load_n(&pending, __ATOMIC_SEQ_CST) || __atomic_load_n(&active, __ATOMIC_SEQ_CST)){
+        sched_yield();
+    }
+}
+
+void scheduler_executor_stop(void){
+    if(!executor_running){
+        return;
+    }
+    scheduler_executor_wait();
+    external_release = NULL;
+
+    pthread_mutex_lock(&idle_lock);
+    __atomic_store_n(&executor_running, 0, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&work_cond);
+    pthread_mutex_unlock(&idle_lock);
+
+    for(uint32_t i = 0; i < num_workers; i++){
+        pthread_join(workers[i].thread, NULL);
+        pthread_mutex_destroy(&workers[i].lock);
+    }
+}
+
+uint8_t scheduler_executor_running(void){
+    return(__atomic_load_n(&executor_running, __ATOMIC_RELAXED));
+}
+
+int32_t scheduler_executor_get_stats(uint32_t worker, struct executor_stats *stats){
+    if(stats == NULL || worker >= num_workers){
+        return(-1);
+    }
+    *stats = workers[worker].stats;
+    return(0);
+}
+
+int32_t executor_submit(struct routine *routine){
+    struct executor_worker *worker;
+    uint32_t start;
+    int32_t rslt = -1;
+
+    //Same rule as the ready que: a routine that is queued or still running is not released again
+    if(__atomic_exchange_n(&routine->routine_scheduled_flag, 1, __ATOMIC_ACQ_REL)){
+        return(1);
+    }
+
+    //Keep work released by a worker on that worker, spread the rest
+    start = current_worker ? current_worker->index : __atomic_fetch_add(&next_worker, 1, __ATOMIC_RELAXED) % num_workers;
+    for(uint32_t i = 0; i < num_workers && rslt; i++){
+        worker = &workers[(start + i) % num_workers];
+        pthread_mutex_lock(&worker->lock);
+        rslt = deque_push(&worker->deques[routine->routine_priority], routine);
+        pthread_mutex_unlock(&worker->lock);
+    }
+    if(rslt){
+        __atomic_store_n(&routine->routine_scheduled_flag, 0, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&current_stats.que_overflows, 1, __ATOMIC_RELAXED);
+        return(-1);
+    }
+
+    uint32_t depth = __atomic_add_fetch(&current_que.routine_count, 1, __ATOMIC_RELAXED);
+    if(depth > load_peak_depth){
+        load_peak_depth = depth;
+    }
+
+    //Wake a sleeping worker. A worker either sees pending go up or is already counted in sleepers
+    __atomic_fetch_add(&pending, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&sleepers, __ATOMIC_SEQ_CST)){
+        pthread_mutex_lock(&idle_lock);
+        pthread_cond_signal(&work_cond);
+        pthread_mutex_unlock(&idle_lock);
+    }
+    return(0);
+}
@@ -0,0 +1,81 @@
+#ifndef SCHEDULER_EXECUTOR_HOST_H
+#define SCHEDULER_EXECUTOR_HOST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler.h"
+
+/* Glossary for scheduler_executor_host.h and scheduler_executor_host.c
+ *
+ *  Executor       - Pool of worker threads that runs the ready routines on a host build (-DSCHEDULER_HOST) in place of
+ *                   scheduler_run_routines(). Built on scheduler.c (not scheduler_compact.c).
+ *  Deque          - Every worker has one double ended que per priority. Routines released by a worker (chains, queues)
+ *                   go on the bottom of its own deque and are taken back off the bottom, so a chain stays on one core.
+ *                   Routines released by the tick go round robin across the workers.
+ *  Stealing       - A worker with nothing left takes the oldest routine off the top of another worker's deque.
+ *
+ * The rules of the single threaded scheduler are kept:
+ *      Non-reentrancy  routine_scheduled_flag is set when a routine is released and cleared when it returns, so a
+ *                      routine is never queued twice or run on two workers at once
+ *      Priority        a worker only starts a medium (low) priority routine when no high (high or medium) priority
+ *                      routine is waiting on any deque
+ * Link with -lpthread.
+ */
+
+#ifndef EXECUTOR_MAX_WORKERS
+#define EXECUTOR_MAX_WORKERS    64
+#endif
+#ifndef EXECUTOR_DEQUE_SIZE
+#define EXECUTOR_DEQUE_SIZE     1024        //Routines each worker can hold per priority
+#endif
+
+/*
+*   Per-worker counters. Read with scheduler_executor_get_stats()
+*/
+struct executor_stats {
+    uint64_t executed;                      //Routines this worker has run
+    uint64_t stolen;                        //Routines this worker took from another worker's deque
+};
+
+/**
+* @brief        Start the worker threads. From now on released routines go to the workers and scheduler_run_routines()
+*               returns straight away. Start it before the first tick so nothing is left in the single threaded ready que
+* @param[in]    num_workers - Number of threads (1 to EXECUTOR_MAX_WORKERS)
+*
+* @return       0 (Success), -1 (Failure)
+*/
+int32_t scheduler_executor_start(uint32_t num_workers);
+
+/**
+* @brief        Wait for every queued routine to finish, then stop and join the worker threads
+*/
+void scheduler_executor_stop(void);
+
+/**
+* @brief        Block until no routine is queued or running
+*/
+void scheduler_executor_wait(void);
+
+/**
+* @brief        1 while the worker threads are running the routines
+*/
+uint8_t scheduler_executor_running(void);
+
+/**
+* @brief        Read the counters of one worker. Valid while the workers run and after scheduler_executor_stop()
+* @param[in]    worker - Worker number (0 to num_workers - 1)
+* @param[out]   stats - Structure to copy the counters into
+*
+* @return       0 (Success), -1 (Failure)
+*/
+int32_t scheduler_executor_get_stats(uint32_t worker, struct executor_stats *stats);
+
+/**
+* @brief        Installed as release_routine()'s external_release hook while the executor runs. Sets
+*               routine_scheduled_flag and puts the routine on a deque
+*
+* @return       0 (Success), 1 (Routine was already queued or running), -1 (Every deque full)
+*/
+int32_t executor_submit(struct routine *routine);
+
+#endif
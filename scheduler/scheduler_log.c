@@ -0,0 +1,100 @@
+#include "scheduler_log.h"
+#include <stdio.h>
+#include <stdint.h>
+#include "timebase.h"
+
+#if (LOG_RING_ENTRIES & (LOG_RING_ENTRIES - 1)) != 0
+#error "LOG_RING_ENTRIES must be a power of 2"
+#endif
+
+#define LOG_MESSAGE_FORMAT(id, format)  format,
+
+//Globals
+static const char *const log_formats[LOG_NUM_MESSAGES] = {
+    SCHEDULER_LOG_MESSAGES(LOG_MESSAGE_FORMAT)
+};
+static struct log_entry log_ring[LOG_RING_ENTRIES];
+static volatile uint8_t log_ready[LOG_RING_ENTRIES];   //Set by the writer once an entry is complete, cleared by the drain
+static uint32_t log_head = 0;                           //Next entry a writer reserves (free running)
+static uint32_t log_tail = 0;                           //Next entry the drain reads (free running)
+static uint32_t log_dropped = 0;
+static uint32_t log_dropped_reported = 0;
+static void (*log_output)(const void *data, uint32_t length) = NULL;
+
+
+/*** Private Functions ***/
+
+static void log_print(const struct log_entry *entry){
+    const char *format = scheduler_log_format(entry->format_id);
+    if(format == NULL){
+        printf("Unknown log message %d\n", entry->format_id);
+        return;
+    }
+    printf(format, entry->args[0], entry->args[1], entry->args[2], entry->args[3]);
+}
+
+
+/*** Public Functions ***/
+
+int32_t scheduler_log_write(Scheduler_Log_ID format_id, const uint32_t *args, uint32_t num_args){
+    uint32_t head = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+    struct log_entry *entry;
+
+    //Reserve an entry. An ISR that takes one in between makes the compare and swap fail, so try again
+    do {
+        if(head - __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) >= LOG_RING_ENTRIES){
+            __atomic_fetch_add(&log_dropped, 1, __ATOMIC_RELAXED);
+            return(-1);
+        }
+    } while(!__atomic_compare_exchange_n(&log_head, &head, head + 1, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    entry = &log_ring[head & (LOG_RING_ENTRIES - 1)];
+    entry->sync = LOG_SYNC;
+    entry->num_args = (num_args < LOG_MAX_ARGS) ? (uint8_t)num_args : LOG_MAX_ARGS;
+    entry->format_id = (uint16_t)format_id;
+    entry->timestamp = timebase_cycles();
+    for(uint32_t i = 0; i < LOG_MAX_ARGS; i++){
+        entry->args[i] = (i < num_args) ? args[i] : 0;
+    }
+    //The drain may only see the flag once the entry is written
+    __atomic_store_n(&log_ready[head & (LOG_RING_ENTRIES - 1)], 1, __ATOMIC_RELEASE);
+    return(0);
+}
+
+void scheduler_log_drain(void){
+    uint32_t tail = log_tail;
+    uint32_t dropped;
+
+    //Entries are taken in order, so a writer that was interrupted half way holds the rest back until it finishes
+    while(__atomic_load_n(&log_ready[tail & (LOG_RING_ENTRIES - 1)], __ATOMIC_ACQUIRE)){
+        struct log_entry *entry = &log_ring[tail & (LOG_RING_ENTRIES - 1)];
+        if(log_output){
+            log_output(entry, sizeof(struct log_entry));
+        }
+        else{
+            log_print(entry);
+        }
+        log_ready[tail & (LOG_RING_ENTRIES - 1)] = 0;
+        tail++;
+        __atomic_store_n(&log_tail, tail, __ATOMIC_RELEASE);
+    }
+
+    //Report the messages lost since the last drain once there is room again
+    dropped = __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+    if(dropped != log_dropped_reported){
+        SCHEDULER_LOG(LOG_DROPPED, dropped - log_dropped_reported);
+        log_dropped_reported = dropped;
+    }
+}
+
+void scheduler_log_set_output(void (*write)(const void *data, uint32_t length)){
+    log_output = write;
+}
+
+uint32_t scheduler_log_dropped(void){
+    return(__atomic_load_n(&log_dropped, __ATOMIC_RELAXED));
+}
+
+const char *scheduler_log_format(uint32_t format_id){
+    return((format_id < LOG_NUM_MESSAGES) ? log_formats[format_id] : NULL);
+}
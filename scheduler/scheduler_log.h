@@ -0,0 +1,85 @@
+#ifndef SCHEDULER_LOG_H
+#define SCHEDULER_LOG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler_log_messages.h"
+
+/* Glossary for scheduler_log.h and scheduler_log.c
+ *
+ *  Deferred Log   - Messages are not formatted where they happen. SCHEDULER_LOG() stores the message ID, a cycle
+ *                   count and the raw arguments in a ring, which costs a few tens of cycles, so it is safe in an ISR
+ *                   or a hot path. Formatting and the UART happen later in scheduler_log_drain().
+ *  Log Ring       - LOG_RING_ENTRIES fixed size entries. Any number of writers (ISRs of any priority, routines, host
+ *                   threads) reserve entries with a compare and swap on the head index. Only scheduler_log_drain()
+ *                   reads them. A full ring drops the new message and counts it.
+ *  Binary Output  - With scheduler_log_set_output() the drain sends the entries as they are instead of formatting
+ *                   them, and scheduler_log_decode_host.c turns the capture into text on a PC.
+ *
+ * Add scheduler_log_drain() as a low priority routine:
+ *      scheduler_addroutine(SCHEDULER_MS(50), scheduler_log_drain, LOW_PRIORITY_ROUTINE, 0);
+ */
+
+#ifndef SCHEDULER_LOG_ENABLED
+#define SCHEDULER_LOG_ENABLED   1           //0 compiles every SCHEDULER_LOG() out
+#endif
+#ifndef LOG_RING_ENTRIES
+#define LOG_RING_ENTRIES        64          //Must be a power of 2 (24 bytes each)
+#endif
+
+#define LOG_MAX_ARGS            4
+#define LOG_SYNC                0xA5        //First byte of every entry, lets the decoder find the entries in a serial capture
+
+/*
+*   One logged message (24 bytes), also the record format of the binary output
+*/
+struct log_entry {
+    uint8_t sync;                       //LOG_SYNC
+    uint8_t num_args;
+    uint16_t format_id;                 //Scheduler_Log_ID
+    uint32_t timestamp;                 //timebase_cycles() when the message was logged
+    uint32_t args[LOG_MAX_ARGS];
+};
+
+/* Log a message from scheduler_log_messages.h with up to LOG_MAX_ARGS integer arguments:
+ *      SCHEDULER_LOG(LOG_I2C_READ, rslt, dev_addr, reg_addr); */
+#if SCHEDULER_LOG_ENABLED
+#define SCHEDULER_LOG(id, ...)      do { const uint32_t log_args_[] = { 0, ##__VA_ARGS__ }; \
+                                         scheduler_log_write((id), &log_args_[1], (sizeof(log_args_) / sizeof(uint32_t)) - 1); } while(0)
+#else
+#define SCHEDULER_LOG(id, ...)      do { } while(0)
+#endif
+
+/**
+* @brief        Store a message in the log ring. Use SCHEDULER_LOG() instead of calling this directly
+* @param[in]    format_id - Message from scheduler_log_messages.h
+* @param[in]    args - Raw arguments
+* @param[in]    num_args - Number of arguments (extra arguments past LOG_MAX_ARGS are not stored)
+*
+* @return       0 (Success), -1 (Ring full, message dropped)
+*/
+int32_t scheduler_log_write(Scheduler_Log_ID format_id, const uint32_t *args, uint32_t num_args);
+
+/**
+* @brief        Print (or send through the binary output) every message waiting in the ring. Run it as a low
+*               priority routine, never from an ISR
+*/
+void scheduler_log_drain(void);
+
+/**
+* @brief        Send the entries as binary instead of formatting them with printf
+* @param[in]    write - Called with each entry, e.g. a UART write. NULL goes back to printf
+*/
+void scheduler_log_set_output(void (*write)(const void *data, uint32_t length));
+
+/**
+* @brief        Number of messages dropped because the ring was full
+*/
+uint32_t scheduler_log_dropped(void);
+
+/**
+* @brief        Format string of a message, NULL for an unknown ID
+*/
+const char *scheduler_log_format(uint32_t format_id);
+
+#endif
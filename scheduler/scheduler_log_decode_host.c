@@ -0,0 +1,77 @@
+/**
+ * @file    scheduler_log_decode_host.c
+ * @brief   Turn a capture of the binary log output (scheduler_log_set_output()) back into text
+ * @details Host build, for example:
+ *              gcc -O2 -DSCHEDULER_HOST -I. scheduler_log_decode_host.c scheduler_log.c -o scheduler_log_decode
+ *              ./scheduler_log_decode capture.bin [core clock in Hz]
+ *          Reads the file (or stdin when the name is -), finds every entry by its LOG_SYNC byte and prints it with
+ *          the format string from scheduler_log_messages.h. With the core clock the cycle count of each entry is
+ *          printed as microseconds since the first entry, otherwise as raw cycles. Bytes that do not line up with
+ *          an entry (a capture started half way through one) are skipped.
+ */
+
+/* **** Includes **** */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scheduler_log.h"
+
+int main(int argc, char **argv){
+    FILE *file;
+    struct log_entry entry;
+    uint8_t bytes[sizeof(struct log_entry)];
+    uint32_t have = 0;
+    uint32_t last_timestamp = 0;              //Cycle count of the previous entry
+    uint64_t elapsed_cycles = 0;
+    uint32_t decoded = 0, skipped = 0;
+    double core_hz = (argc > 2) ? atof(argv[2]) : 0;
+
+    if(argc < 2){
+        printf("Usage: %s capture.bin [core clock in Hz]\n", argv[0]);
+        return(1);
+    }
+    file = strcmp(argv[1], "-") ? fopen(argv[1], "rb") : stdin;
+    if(file == NULL){
+        printf("Cannot open %s\n", argv[1]);
+        return(1);
+    }
+
+    while(1){
+        size_t got = fread(bytes + have, 1, sizeof(bytes) - have, file);
+        have += (uint32_t)got;
+        if(have < sizeof(bytes)){
+            break;
+        }
+        memcpy(&entry, bytes, sizeof(entry));
+
+        //Not an entry, slide forward one byte
+        if(entry.sync != LOG_SYNC || entry.num_args > LOG_MAX_ARGS || scheduler_log_format(entry.format_id) == NULL){
+            memmove(bytes, bytes + 1, --have);
+            skipped++;
+            continue;
+        }
+        have = 0;
+
+        //The cycle counter wraps every 2^32 cycles, so add up the differences
+        if(decoded){
+            elapsed_cycles += (uint32_t)(entry.timestamp - last_timestamp);
+        }
+        last_timestamp = entry.timestamp;
+        decoded++;
+
+        if(core_hz > 0){
+            printf("[%12.1f us] ", (double)elapsed_cycles * 1e6 / core_hz);
+        }
+        else{
+            printf("[%12llu] ", (unsigned long long)elapsed_cycles);
+        }
+        printf(scheduler_log_format(entry.format_id), entry.args[0], entry.args[1], entry.args[2], entry.args[3]);
+    }
+
+    if(file != stdin){
+        fclose(file);
+    }
+    fprintf(stderr, "%u messages decoded, %u bytes skipped\n", decoded, skipped);
+    return(0);
+}
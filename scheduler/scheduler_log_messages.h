@@ -0,0 +1,77 @@
+#ifndef SCHEDULER_LOG_MESSAGES_H
+#define SCHEDULER_LOG_MESSAGES_H
+
+/* Every message that can go through SCHEDULER_LOG(). The call site stores the ID and up to LOG_MAX_ARGS 32-bit
+ * arguments, and the format string is only looked at when the message is printed, by scheduler_log_drain() on the
+ * target or by scheduler_log_decode_host.c on a PC. Both sides build their table from this list, so only add
+ * messages at the end and never reuse an ID, or older captures will decode with the wrong text.
+ * Arguments are raw 32-bit values: %d, %u, %x and %c only (no %s, no 64-bit values, no floating point). */
+
+#define SCHEDULER_LOG_MESSAGES(X) \
+    /* Log */ \
+    X(LOG_DROPPED,              "%u log messages were dropped (log ring full)\n") \
+    /* circ_buff.c */ \
+    X(LOG_BUFF_FULL,            "Buffer is full! Routine %d was not added to the circular buffer\n") \
+    X(LOG_BUFF_EMPTY,           "Trying to remove item from empty buffer!\n") \
+    /* scheduler.c */ \
+    X(LOG_ADAPTIVE_INVALID,     "Error, invalid adaptive deadline (%d to %d, %d%% load)\n") \
+    X(LOG_TOO_MANY_ARGS,        "Error, too many arguments provided (maximum of 5)\n") \
+    X(LOG_ARGS_NO_MEMORY,       "Error allocating memory for routine arguments\n") \
+    X(LOG_NODE_NO_MEMORY,       "Cannot allocate memory for node\n") \
+    X(LOG_ROUTINE_NO_MEMORY,    "Cannot allocate memory for routine\n") \
+    X(LOG_REMOVE_OUT_OF_BOUNDS, "%d is an invalid routine ID. Task could not be deleted. [ID out of Bounds]\n") \
+    X(LOG_REMOVE_NOT_FOUND,     "%d is an invalid routine ID. Task could not be deleted. [Could not find routine]\n") \
+    X(LOG_RELEASE_NOT_FOUND,    "%d is an invalid routine ID. Task could not be released.\n") \
+    /* dev_i2c.c */ \
+    X(LOG_I2C_INIT,             "Error initializing the I2C Port 2 (Error: %d)\n") \
+    X(LOG_I2C_FREQUENCY,        "Error setting I2C speed (Error: %d)\n") \
+    X(LOG_I2C_WRITE,            "Error (%d) writing data: Device = 0x%X; Register = 0x%X\n") \
+    X(LOG_I2C_WRITE_NACK,       "Write was not acknowledged: Device = 0x%X; Register = 0x%X\n") \
+    X(LOG_I2C_READ,             "Error (%d) reading data: Device = 0x%X; Register = 0x%X\n") \
+    X(LOG_I2C_READ_NACK,        "Read was not acknowledged: Device = 0x%X; Register = 0x%X\n") \
+    X(LOG_I2C_NO_MEMORY,        "Error allocating the I2C write buffer (%d bytes)\n") \
+    /* MAX77958.c */ \
+    X(LOG_MAX77958_INIT,        "Error initializing MAX77958! Error Code: %d\n") \
+    X(LOG_MAX77958_ID,          "MAX77958 Device ID does not match! Expected Device ID: 0x%X but got 0x%X\n") \
+    X(LOG_MAX77958_READY,       "MAX77958 initialized succesfully and Device ID confirmed\n") \
+    X(LOG_MAX77958_WRITE_REG,   "Bad I2C write at register: 0x%X\n") \
+    X(LOG_MAX77958_READ_REG,    "Bad I2C read at register: 0x%X\n") \
+    X(LOG_MAX77958_WRITE_OP,    "Error writing OpCode %d (Error Code: %d)\n") \
+    X(LOG_MAX77958_READ_OP,     "Error reading OpCode (Error Code: %d)\n") \
+    X(LOG_MAX77958_NOT_FIXED,   "Trying to set a non fixed-out PDO\n") \
+    X(LOG_MAX77958_NO_PDO,      "Could not find Fixed PDO with %d mV and %d mA capabilities\n") \
+    /* scheduler_compact.c */ \
+    X(LOG_COMPACT_NO_ROUTINES,  "No free routine slots (COMPACT_MAX_ROUTINES = %d)\n") \
+    X(LOG_COMPACT_NO_ARGUMENTS, "No free argument slots (COMPACT_MAX_ARGUMENTS = %d)\n") \
+    X(LOG_COMPACT_REMOVE_ID,    "%d is an invalid routine ID. Task could not be deleted.\n") \
+    /* deadline_table.c */ \
+    X(LOG_DEADLINE_TABLE_FULL,  "Deadline table is full (%d entries)\n") \
+    X(LOG_DEADLINE_RANGE,       "Deadline %d is out of range for the deadline table\n") \
+    /* scheduler_queue.c */ \
+    X(LOG_QUEUE_INVALID,        "Error, invalid queue (%d slots of %d bytes)\n") \
+    X(LOG_QUEUE_NONE_FREE,      "No free queues (QUEUE_MAX_QUEUES = %d)\n") \
+    X(LOG_QUEUE_POOL_EXHAUSTED, "Queue pool exhausted, %d bytes needed and %d free (QUEUE_POOL_BYTES)\n") \
+    /* scheduler_chain.c */ \
+    X(LOG_CHAIN_NO_MEMORY,      "Cannot allocate memory for chain\n") \
+    X(LOG_CHAIN_CONNECT,        "Error, cannot connect routine %d to routine %d\n") \
+    X(LOG_CHAIN_INPUTS_FULL,    "Error, routine %d already has %d inputs (CHAIN_MAX_INPUTS)\n") \
+    X(LOG_CHAIN_LINK_NO_MEMORY, "Cannot allocate memory for chain link\n") \
+    /* scheduler_calibrate.c */ \
+    X(LOG_CALIBRATE_WINDOW,     "Error, calibration window of %d ms is too short\n") \
+    /* scheduler_trace.c */ \
+    X(LOG_TRACE_NO_ROOM,        "Error, trace buffer has no room for events\n") \
+    X(LOG_TRACE_RUNNING,        "Error, stop the trace before saving it\n") \
+    X(LOG_TRACE_HEADER,         "Error writing the trace header\n") \
+    X(LOG_TRACE_EVENTS,         "Error writing the trace events\n") \
+    /* scheduler_queue.c */ \
+    X(LOG_QUEUE_NO_CONSUMER,    "Error, queue consumer %d is not a routine\n")
+
+#define LOG_MESSAGE_ID(id, format)      id,
+
+typedef enum
+{
+    SCHEDULER_LOG_MESSAGES(LOG_MESSAGE_ID)
+    LOG_NUM_MESSAGES
+} Scheduler_Log_ID;
+
+#endif
@@ -0,0 +1,144 @@
+#include "scheduler_queue.h"
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler.h"
+#include "scheduler_log.h"
+
+/* The slot has to be written before the head moves and read before the tail moves. Cortex-M4 does not reorder
+ * normal memory accesses, so the barrier is there to stop the compiler from doing it */
+#ifdef SCHEDULER_HOST
+#define QUEUE_BARRIER()     __sync_synchronize()
+#else
+#define QUEUE_BARRIER()     __DMB()
+#endif
+
+//Globals
+static uint32_t queue_pool[QUEUE_POOL_BYTES / 4];   //Word aligned so every slot is word aligned
+static uint32_t queue_pool_used = 0;                //Bytes of queue_pool handed out
+static struct scheduler_queue queues[QUEUE_MAX_QUEUES];
+static uint32_t num_queues = 0;
+
+//Provided by scheduler.c (or scheduler_compact.c)
+extern void (*routine_removed)(struct routine *routine);
+
+
+/*** Private Functions ***/
+
+//head and tail run from 0 to 2 * num_slots - 1 so a full queue and an empty queue look different
+static inline uint32_t queue_used(struct scheduler_queue *queue, uint16_t head, uint16_t tail){
+    return((head >= tail) ? (uint32_t)(head - tail) : (uint32_t)(head + 2 * queue->num_slots - tail));
+}
+
+static inline uint16_t queue_next(struct scheduler_queue *queue, uint16_t index){
+    return((index + 1 == 2 * queue->num_slots) ? 0 : index + 1);
+}
+
+//Called inside the critical section before a routine is removed, so no commit releases it afterwards
+static void queue_routine_removed(struct routine *routine){
+    for(uint32_t i = 0; i < num_queues; i++){
+        if(queues[i].consumer == routine){
+            queues[i].consumer = NULL;
+        }
+    }
+}
+
+static inline uint8_t *queue_slot(struct scheduler_queue *queue, uint16_t index){
+    return(queue->slots + (uint32_t)((index >= queue->num_slots) ? index - queue->num_slots : index) * queue->slot_size);
+}
+
+
+struct scheduler_queue *scheduler_queue_create(uint16_t slot_size, uint16_t num_slots, int32_t consumer_ID){
+    struct scheduler_queue *queue;
+    uint32_t size = (slot_size + 3) & ~3UL;
+    uint32_t bytes = size * num_slots;
+
+    if(!slot_size || !num_slots || num_slots > 32767){
+        SCHEDULER_LOG(LOG_QUEUE_INVALID, num_slots, slot_size);
+        return(NULL);
+    }
+    if(num_queues >= QUEUE_MAX_QUEUES){
+        SCHEDULER_LOG(LOG_QUEUE_NONE_FREE, QUEUE_MAX_QUEUES);
+        return(NULL);
+    }
+    if(bytes > QUEUE_POOL_BYTES - queue_pool_used){
+        SCHEDULER_LOG(LOG_QUEUE_POOL_EXHAUSTED, bytes, QUEUE_POOL_BYTES - queue_pool_used);
+        return(NULL);
+    }
+
+    //Looked up once here so a commit (often from an ISR) does not search the schedule
+    struct routine *consumer = NULL;
+    if(consumer_ID != QUEUE_NO_CONSUMER && (consumer_ID < 0 || (consumer = scheduler_get_routine((uint32_t)consumer_ID)) == NULL)){
+        SCHEDULER_LOG(LOG_QUEUE_NO_CONSUMER, consumer_ID);
+        return(NULL);
+    }
+
+    queue = &queues[num_queues++];
+    queue->slots = (uint8_t *)queue_pool + queue_pool_used;
+    queue->slot_size = (uint16_t)size;
+    queue->num_slots = num_slots;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->consumer_ID = consumer_ID;
+    queue->consumer = consumer;
+    queue->full_count = 0;
+    queue_pool_used += bytes;
+    routine_removed = queue_routine_removed;
+    return(queue);
+}
+
+void *scheduler_queue_reserve(struct scheduler_queue *queue){
+    uint16_t head = queue->head;
+    if(queue_used(queue, head, queue->tail) >= queue->num_slots){
+        queue->full_count++;
+        return(NULL);
+    }
+    return(queue_slot(queue, head));
+}
+
+int32_t scheduler_queue_commit(struct scheduler_queue *queue){
+    uint16_t head = queue->head;
+    if(queue_used(queue, head, queue->tail) >= queue->num_slots){
+        return(-1);
+    }
+    //Message has to be in memory before the consumer can see the slot
+    QUEUE_BARRIER();
+    queue->head = queue_next(queue, head);
+
+    //The consumer cannot be removed while it is released
+    if(queue->consumer_ID != QUEUE_NO_CONSUMER){
+        SCHEDULER_ENTER_CRITICAL();
+        if(queue->consumer){
+            scheduler_release_routine_ptr(queue->consumer);
+        }
+        SCHEDULER_EXIT_CRITICAL();
+    }
+    return(0);
+}
+
+void *scheduler_queue_get(struct scheduler_queue *queue){
+    uint16_t tail = queue->tail;
+    if(tail == queue->head){
+        return(NULL);
+    }
+    QUEUE_BARRIER();
+    return(queue_slot(queue, tail));
+}
+
+int32_t scheduler_queue_release(struct scheduler_queue *queue){
+    uint16_t tail = queue->tail;
+    if(tail == queue->head){
+        return(-1);
+    }
+    //Finish reading the message before the producer can reuse the slot
+    QUEUE_BARRIER();
+    queue->tail = queue_next(queue, tail);
+    return(0);
+}
+
+uint32_t scheduler_queue_count(struct scheduler_queue *queue){
+    return(queue_used(queue, queue->head, queue->tail));
+}
+
+uint32_t scheduler_queue_pool_free(void){
+    return(QUEUE_POOL_BYTES - queue_pool_used);
+}
@@ -0,0 +1,95 @@
+#ifndef SCHEDULER_QUEUE_H
+#define SCHEDULER_QUEUE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler.h"
+
+/* Glossary for scheduler_queue.h and scheduler_queue.c
+ *
+ *  Message Queue  - Fixed number of fixed size slots carved out of one static pool. Messages are written and read in
+ *                   place, so a message is never copied between the producer and the consumer.
+ *  Producer       - Context that fills slots: scheduler_queue_reserve(), write the message, scheduler_queue_commit()
+ *  Consumer       - Context that reads slots: scheduler_queue_get(), read the message, scheduler_queue_release()
+ *
+ * Each queue has one producer context and one consumer context (an ISR and a routine, or two routines). The producer
+ * only moves the head index and the consumer only moves the tail index, so neither side needs to mask interrupts for
+ * the slots and a slot is never visible to the consumer until it has been committed. A commit only masks them while it
+ * releases the consumer routine, which is looked up once when the queue is created. Queues that are posted to from more than one
+ * context need SCHEDULER_ENTER_CRITICAL()/SCHEDULER_EXIT_CRITICAL() around reserve and commit.
+ */
+
+#ifndef QUEUE_POOL_BYTES
+#define QUEUE_POOL_BYTES    2048        //Static memory shared by the slots of every queue
+#endif
+#ifndef QUEUE_MAX_QUEUES
+#define QUEUE_MAX_QUEUES    8
+#endif
+
+#define QUEUE_NO_CONSUMER   -1          //consumer_ID for a queue that is polled instead of releasing a routine
+
+/*
+*   One message queue. Create with scheduler_queue_create()
+*/
+struct scheduler_queue {
+    uint8_t *slots;                     //First slot in the pool
+    uint16_t slot_size;                 //Bytes per slot (rounded up to a multiple of 4)
+    uint16_t num_slots;
+    volatile uint16_t head;             //Next slot the producer commits (0 to 2 * num_slots - 1, only written by the producer)
+    volatile uint16_t tail;             //Next slot the consumer releases (0 to 2 * num_slots - 1, only written by the consumer)
+    int32_t consumer_ID;                //Routine released on every commit, or QUEUE_NO_CONSUMER
+    struct routine *consumer;           //consumer_ID looked up once, NULL once it is removed from the scheduler
+    uint32_t full_count;                //Reserves that failed because every slot was in use
+};
+
+/**
+* @brief        Create a queue with slots taken from the static pool
+* @param[in]    slot_size - Size of one message in bytes
+* @param[in]    num_slots - Number of messages the queue can hold (1 to 32767)
+* @param[in]    consumer_ID - Routine to put in the ready que when a message is committed, or QUEUE_NO_CONSUMER. It has
+*               to be added to the scheduler first. Commits stop releasing it once it is removed
+*
+* @return       Queue (Success), NULL (Pool or queue table exhausted, or consumer_ID not found)
+*/
+struct scheduler_queue *scheduler_queue_create(uint16_t slot_size, uint16_t num_slots, int32_t consumer_ID);
+
+/**
+* @brief        Get the next free slot to write a message into. Calling it again before scheduler_queue_commit()
+*               returns the same slot
+*
+* @return       Pointer to the slot (Success), NULL (Queue full)
+*/
+void *scheduler_queue_reserve(struct scheduler_queue *queue);
+
+/**
+* @brief        Hand the reserved slot to the consumer and release the consumer routine if the queue has one
+*
+* @return       0 (Success), -1 (Nothing reserved because the queue is full)
+*/
+int32_t scheduler_queue_commit(struct scheduler_queue *queue);
+
+/**
+* @brief        Get the oldest committed message. The slot stays valid until scheduler_queue_release()
+*
+* @return       Pointer to the message (Success), NULL (Queue empty)
+*/
+void *scheduler_queue_get(struct scheduler_queue *queue);
+
+/**
+* @brief        Give the slot returned by scheduler_queue_get() back to the producer
+*
+* @return       0 (Success), -1 (Queue empty)
+*/
+int32_t scheduler_queue_release(struct scheduler_queue *queue);
+
+/**
+* @brief        Number of committed messages waiting for the consumer
+*/
+uint32_t scheduler_queue_count(struct scheduler_queue *queue);
+
+/**
+* @brief        Bytes of QUEUE_POOL_BYTES still free for new queues
+*/
+uint32_t scheduler_queue_pool_free(void);
+
+#endif
@@ -0,0 +1,408 @@
+/**
+ * @file    scheduler_replay_host.c
+ * @brief   Feed a recording made with scheduler_trace.c back through scheduler.c on a virtual clock
+ * @details Host build, for example:
+ *              gcc -O2 -DSCHEDULER_HOST -I. scheduler_replay_host.c scheduler.c scheduler_chain.c circ_buff.c \
+ *                  timebase.c scheduler_trace.c scheduler_log.c -o scheduler_replay
+ *              ./scheduler_replay recording.bin [-p ID=ticks] [-r ID=priority] [-d ID=us] [-s percent]
+ *          Every routine in the recording is added to a fresh schedule with its recorded deadline and priority.
+ *          The tool stands in for the timer glue: time only moves when a synthetic routine "runs", by the
+ *          duration recorded for that routine (each recorded run in turn), and the tick interrupt comes at the
+ *          next tick boundary after the routines return. Routines without a deadline (chained, released by a
+ *          queue or an ISR) are released at the ticks they were released in the recording.
+ *              -p ID=ticks     Replay the routine with another deadline
+ *              -r ID=priority  Replay the routine at another priority (0 high, 1 medium, 2 low)
+ *              -d ID=us        Replace the recorded durations of the routine with a fixed run time
+ *              -s percent      Scale every duration, e.g. -s 150 for a 50% slower processor
+ *          The recording and the replay are measured the same way and printed side by side: releases,
+ *          missed releases (deadline expired while the routine was still waiting or running), ready que
+ *          overflows and the longest wait in ticks from release to start.
+ */
+
+/* **** Includes **** */
+#include "scheduler.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scheduler_trace.h"
+
+#define REPLAY_TRACE_EVENTS     65536       //Replay events are analysed every time this buffer fills
+
+/*
+*   What happened to one routine, in the recording or the replay
+*/
+struct replay_result {
+    uint32_t releases;
+    uint32_t missed;
+    uint32_t overflows;
+    uint32_t runs;
+    uint32_t max_wait;                  //Longest time in ticks from release to start
+    uint64_t run_us;                    //Sum of the recorded run times
+    uint32_t release_tick;              //Tick of the release the routine is waiting on
+    uint8_t waiting;
+};
+
+/*
+*   One routine of the recording and how to replay it
+*/
+struct replay_routine {
+    uint8_t known;                      //Seen in a TRACE_ROUTINE event
+    uint32_t deadline;
+    uint8_t priority;
+    int32_t replay_ID;                  //ID given by scheduler_addroutine() in the replay
+    uint32_t *durations;                //Recorded run times in microseconds
+    uint32_t num_durations;
+    uint32_t next_duration;
+    int64_t fixed_us;                   //-d override, -1 to use the recorded run times
+    struct replay_result recorded;
+    struct replay_result replayed;
+};
+
+/*
+*   Release of a routine without a deadline, replayed at the same tick
+*/
+struct replay_release {
+    uint32_t tick;
+    uint16_t routine_id;
+};
+
+//Globals
+struct replay_routine *routines;
+uint32_t num_routines = 0;             //Highest recorded routine ID + 1
+uint32_t *replay_to_recorded;           //Replay routine ID -> recorded routine ID
+uint32_t num_replay_IDs = 0;
+uint32_t tick_us = 1000;
+uint32_t scale_percent = 100;
+uint64_t virtual_us = 0;                //The virtual clock
+uint64_t accounted_us = 0;              //Virtual time already handed to the scheduler as whole ticks
+uint64_t replay_ticks = 0;              //Ticks handed to the scheduler
+uint64_t analysed_tick = 0;             //Tick counter of the analysis, in whichever timeline is being analysed
+
+
+/*** Virtual Timer Glue (replaces scheduler_timer_host.c) ***/
+
+void scheduler_host_lock(void){
+}
+
+void scheduler_host_unlock(void){
+}
+
+void scheduler_timer_init(void){
+    timebase_init();
+}
+
+void elapsed_timer_start(void){
+}
+
+uint32_t elapsed_timer_read(void){
+    uint32_t ticks = (uint32_t)((virtual_us - accounted_us) / tick_us);
+    accounted_us += (uint64_t)ticks * tick_us;
+    replay_ticks += ticks;
+    return(ticks);
+}
+
+void elapsed_timer_stop(void){
+}
+
+
+/*** Analysis ***/
+
+//Shared by the recording and the replay so both are measured the same way
+void Analyse_Events(struct trace_event *events, uint32_t num_events, uint8_t replay){
+    for(uint32_t i = 0; i < num_events; i++){
+        struct trace_event *event = &events[i];
+        struct replay_result *result;
+
+        if(event->type == TRACE_UPDATE){
+            analysed_tick += event->value;
+            continue;
+        }
+        if(replay){
+            if(event->routine_id >= num_replay_IDs){
+                continue;
+            }
+            result = &routines[replay_to_recorded[event->routine_id]].replayed;
+        }
+        else{
+            if(event->routine_id >= num_routines){
+                continue;
+            }
+            result = &routines[event->routine_id].recorded;
+        }
+
+        switch(event->type){
+            case TRACE_RELEASE:
+                if(event->value == TRACE_RELEASED){
+                    result->releases++;
+                    result->release_tick = (uint32_t)analysed_tick;
+                    result->waiting = 1;
+                }
+                else if(event->value == TRACE_MISSED){
+                    result->missed++;
+                }
+                else{
+                    result->overflows++;
+                }
+                break;
+            case TRACE_DISPATCH:
+                if(result->waiting){
+                    uint32_t wait = (uint32_t)analysed_tick - result->release_tick;
+                    if(wait > result->max_wait){
+                        result->max_wait = wait;
+                    }
+                    result->waiting = 0;
+                }
+                break;
+            case TRACE_COMPLETE:
+                result->runs++;
+                result->run_us += event->value;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+
+/*** Replay ***/
+
+void Replay_Routine(uint32_t index){
+    struct replay_routine *routine = &routines[index];
+    uint64_t run_us = 0;
+
+    if(routine->fixed_us >= 0){
+        run_us = (uint64_t)routine->fixed_us;
+    }
+    else if(routine->num_durations){
+        run_us = routine->durations[routine->next_duration];
+        routine->next_duration = (routine->next_duration + 1) % routine->num_durations;
+    }
+    virtual_us += (run_us * scale_percent) / 100;
+}
+
+int32_t Load_Recording(const char *path, struct trace_header *header, struct trace_event **events){
+    FILE *file;
+
+    if((file = fopen(path, "rb")) == NULL){
+        printf("Cannot open %s\n", path);
+        return(-1);
+    }
+    if(fread(header, sizeof(*header), 1, file) != 1 || header->magic != TRACE_MAGIC || header->version != TRACE_VERSION
+        || header->event_size != sizeof(struct trace_event)){
+        printf("%s is not a scheduler recording\n", path);
+        fclose(file);
+        return(-1);
+    }
+    if((*events = malloc((header->num_events + 1) * sizeof(struct trace_event))) == NULL
+        || fread(*events, sizeof(struct trace_event), header->num_events, file) != header->num_events){
+        printf("%s is truncated\n", path);
+        fclose(file);
+        return(-1);
+    }
+    fclose(file);
+    return(0);
+}
+
+//Find every routine, its recorded durations and the releases of routines without a deadline
+int32_t Build_Routines(struct trace_event *events, uint32_t num_events, struct replay_release **releases, uint32_t *num_releases){
+    uint32_t tick = 0;
+
+    for(uint32_t i = 0; i < num_events; i++){
+        if(events[i].type != TRACE_UPDATE && events[i].routine_id >= num_routines){
+            num_routines = events[i].routine_id + 1;
+        }
+    }
+    if((routines = calloc(num_routines + 1, sizeof(struct replay_routine))) == NULL
+        || (*releases = calloc(num_events + 1, sizeof(struct replay_release))) == NULL){
+        printf("Error allocating memory for the replay\n");
+        return(-1);
+    }
+    for(uint32_t i = 0; i < num_routines; i++){
+        routines[i].fixed_us = -1;
+    }
+
+    *num_releases = 0;
+    for(uint32_t i = 0; i < num_events; i++){
+        struct replay_routine *routine = &routines[events[i].routine_id];
+        switch(events[i].type){
+            case TRACE_UPDATE:
+                tick += events[i].value;
+                break;
+            case TRACE_ROUTINE:
+                routine->known = 1;
+                routine->deadline = events[i].value;
+                routine->priority = events[i].priority;
+                break;
+            case TRACE_RELEASE:
+                if(routine->known && routine->deadline == SCHEDULER_NO_DEADLINE){
+                    (*releases)[*num_releases].tick = tick;
+                    (*releases)[*num_releases].routine_id = events[i].routine_id;
+                    (*num_releases)++;
+                }
+                break;
+            case TRACE_COMPLETE:
+                routine->num_durations++;
+                break;
+            default:
+                break;
+        }
+    }
+
+    for(uint32_t i = 0; i < num_routines; i++){
+        if(routines[i].num_durations && (routines[i].durations = malloc(routines[i].num_durations * sizeof(uint32_t))) == NULL){
+            printf("Error allocating memory for the replay\n");
+            return(-1);
+        }
+        routines[i].num_durations = 0;
+    }
+    for(uint32_t i = 0; i < num_events; i++){
+        if(events[i].type == TRACE_COMPLETE){
+            struct replay_routine *routine = &routines[events[i].routine_id];
+            routine->durations[routine->num_durations++] = events[i].value;
+        }
+    }
+    return(0);
+}
+
+int32_t Parse_Options(int argc, char **argv){
+    uint32_t ID, value;
+
+    for(int i = 2; i < argc; i++){
+        if(i + 1 >= argc){
+            printf("Missing value for %s\n", argv[i]);
+            return(-1);
+        }
+        if(!strcmp(argv[i], "-s")){
+            scale_percent = (uint32_t)atoi(argv[++i]);
+            continue;
+        }
+        if(sscanf(argv[i + 1], "%u=%u", &ID, &value) != 2 || ID >= num_routines || !routines[ID].known){
+            printf("Invalid routine option %s %s\n", argv[i], argv[i + 1]);
+            return(-1);
+        }
+        if(!strcmp(argv[i], "-p") && value){
+            routines[ID].deadline = value;
+        }
+        else if(!strcmp(argv[i], "-r") && value <= LOW_PRIORITY_ROUTINE){
+            routines[ID].priority = (uint8_t)value;
+        }
+        else if(!strcmp(argv[i], "-d")){
+            routines[ID].fixed_us = value;
+        }
+        else{
+            printf("Invalid option %s %s\n", argv[i], argv[i + 1]);
+            return(-1);
+        }
+        i++;
+    }
+    return(0);
+}
+
+void Print_Results(uint32_t recorded_deadline[], uint8_t recorded_priority[]){
+    uint32_t missed[2] = {0, 0};
+
+    printf("\n%-5s| %-44s| %-44s|\n", "", "Recorded", "Replayed");
+    printf("%-5s| %-3s %-10s %-8s %-6s %-8s %-4s | %-3s %-10s %-8s %-6s %-8s %-4s | %s\n", "ID",
+        "Pri", "Deadline", "Releases", "Missed", "Overflow", "Wait", "Pri", "Deadline", "Releases", "Missed", "Overflow", "Wait", "Avg us");
+    for(uint32_t i = 0; i < num_routines; i++){
+        struct replay_routine *routine = &routines[i];
+        struct replay_result *rec = &routine->recorded;
+        struct replay_result *rep = &routine->replayed;
+        if(!routine->known){
+            continue;
+        }
+        printf("%-5u| %-3u %-10d %-8u %-6u %-8u %-4u | %-3u %-10d %-8u %-6u %-8u %-4u | %llu\n", i,
+            recorded_priority[i], (int32_t)recorded_deadline[i], rec->releases, rec->missed, rec->overflows, rec->max_wait,
+            routine->priority, (int32_t)routine->deadline, rep->releases, rep->missed, rep->overflows, rep->max_wait,
+            rec->runs ? (unsigned long long)(rec->run_us / rec->runs) : 0ULL);
+        missed[0] += rec->missed + rec->overflows;
+        missed[1] += rep->missed + rep->overflows;
+    }
+    printf("\nDeadline misses: %u recorded, %u replayed\n", missed[0], missed[1]);
+}
+
+int main(int argc, char **argv){
+    struct trace_header header;
+    struct trace_event *events;
+    struct trace_event *replay_events;
+    struct replay_release *releases;
+    uint32_t num_releases;
+    uint32_t next_release = 0;
+    uint32_t *recorded_deadline;
+    uint8_t *recorded_priority;
+
+    if(argc < 2){
+        printf("Usage: %s recording.bin [-p ID=ticks] [-r ID=priority] [-d ID=us] [-s percent]\n", argv[0]);
+        return(1);
+    }
+    if(Load_Recording(argv[1], &header, &events) || Build_Routines(events, header.num_events, &releases, &num_releases)){
+        return(1);
+    }
+    tick_us = header.tick_us;
+
+    //The recording, measured before the options change anything
+    if((recorded_deadline = calloc(num_routines + 1, sizeof(uint32_t))) == NULL
+        || (recorded_priority = calloc(num_routines + 1, sizeof(uint8_t))) == NULL){
+        printf("Error allocating memory for the replay\n");
+        return(1);
+    }
+    for(uint32_t i = 0; i < num_routines; i++){
+        recorded_deadline[i] = routines[i].deadline;
+        recorded_priority[i] = routines[i].priority;
+    }
+    analysed_tick = 0;
+    Analyse_Events(events, header.num_events, 0);
+    uint64_t recorded_ticks = analysed_tick;
+    printf("%u events (%u dropped), %llu ticks of %u us\n", header.num_events, header.dropped, (unsigned long long)recorded_ticks, tick_us);
+    if(Parse_Options(argc, argv)){
+        return(1);
+    }
+
+    //Same schedule on a fresh scheduler
+    scheduler_init();
+    if((replay_to_recorded = calloc(num_routines + 1, sizeof(uint32_t))) == NULL
+        || (replay_events = malloc(REPLAY_TRACE_EVENTS * sizeof(struct trace_event))) == NULL){
+        printf("Error allocating memory for the replay\n");
+        return(1);
+    }
+    for(uint32_t i = 0; i < num_routines; i++){
+        if(!routines[i].known){
+            continue;
+        }
+        if((routines[i].replay_ID = scheduler_addroutine(routines[i].deadline, Replay_Routine, (Scheduler_Priority)routines[i].priority, 1, i)) < 0){
+            return(1);
+        }
+        replay_to_recorded[routines[i].replay_ID] = i;
+        num_replay_IDs = routines[i].replay_ID + 1;
+    }
+
+    //Tick interrupts on the virtual clock until the replay covers as many ticks as the recording
+    analysed_tick = 0;
+    scheduler_trace_start(replay_events, REPLAY_TRACE_EVENTS);
+    while(replay_ticks < recorded_ticks){
+        //Idle until the next tick boundary unless the routines already ran past it
+        if(virtual_us < accounted_us + tick_us){
+            virtual_us = accounted_us + tick_us;
+        }
+        uint32_t elapsed = elapsed_timer_read();
+        while(next_release < num_releases && releases[next_release].tick <= replay_ticks){
+            scheduler_release_routine(routines[releases[next_release].routine_id].replay_ID);
+            next_release++;
+        }
+        scheduler_update(elapsed);
+        scheduler_run_routines();
+
+        //Analyse the replay in pieces so it can run for as long as the recording did
+        if(scheduler_trace_count() > REPLAY_TRACE_EVENTS / 2){
+            scheduler_trace_stop();
+            Analyse_Events(replay_events, scheduler_trace_count(), 1);
+            scheduler_trace_start(replay_events, REPLAY_TRACE_EVENTS);
+        }
+    }
+    scheduler_trace_stop();
+    Analyse_Events(replay_events, scheduler_trace_count(), 1);
+
+    Print_Results(recorded_deadline, recorded_priority);
+    return(0);
+}
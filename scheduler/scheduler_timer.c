@@ -0,0 +1,121 @@
+#include "scheduler_timer.h"
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler.h"
+#include "nvic_table.h"
+#include "tmr.h"
+#include "timebase.h"
+#include "scheduler_calibrate.h"
+
+
+void scheduler_timer_init(void){
+    timebase_init();
+
+#if SCHEDULER_HIGH_RES
+    NVIC_SetVector(TMR5_IRQn, PeriodicTimerHandler);
+#else
+    NVIC_SetVector(TMR5_IRQn, OneshotTimerHandler);
+#endif
+    NVIC_EnableIRQ(TMR5_IRQn);
+    NVIC_SetPriority(TMR5_IRQn, 0);
+    Setup_Timer_ISR();
+
+    NVIC_SetPriority (SysTick_IRQn, 0);
+}
+
+void Setup_Timer_CONT(){
+    mxc_tmr_cfg_t tmr;
+
+    MXC_TMR_Shutdown(MXC_TMR5);
+    
+    tmr.pres = TMR_PRES_8;
+    tmr.mode = TMR_MODE_CONTINUOUS;
+    tmr.bitMode = TMR_BIT_MODE_32;
+    tmr.clock = MXC_TMR_8K_CLK;
+    //tmr.cmp_cnt = 8;      //SystemCoreClock*(1/interval_time);
+    tmr.pol = 0;
+    
+    if (MXC_TMR_Init(MXC_TMR5, &tmr, true) != E_NO_ERROR) {
+        printf("Failed one-shot timer Initialization.\n");
+        return;
+    }
+}
+
+void Setup_Timer_ISR(){
+    // Declare variables
+    mxc_tmr_cfg_t tmr;
+
+    MXC_TMR_Shutdown(MXC_TMR5);
+    
+    tmr.pres = TMR_PRES_1;
+    tmr.bitMode = TMR_BIT_MODE_32;
+    tmr.pol = 0;
+#if SCHEDULER_HIGH_RES
+    //Free running on the peripheral clock, interrupt once every tick
+    tmr.mode = TMR_MODE_CONTINUOUS;
+    tmr.clock = MXC_TMR_APB_CLK;
+    tmr.cmp_cnt = (uint32_t)(((uint64_t)PeripheralClock * SCHEDULER_TICK_US) / 1000000);
+#else
+    tmr.mode = TMR_MODE_ONESHOT;
+    tmr.clock = MXC_TMR_8K_CLK;
+    tmr.cmp_cnt = 8 * (SCHEDULER_TICK_US / 1000);      //8 counts per ms
+#endif
+    
+    if (MXC_TMR_Init(MXC_TMR5, &tmr, true) != E_NO_ERROR) {
+        printf("Failed one-shot timer Initialization.\n");
+        return;
+    }
+
+#if SCHEDULER_HIGH_RES
+    NVIC_SetVector(TMR5_IRQn, PeriodicTimerHandler);
+#else
+    NVIC_SetVector(TMR5_IRQn, OneshotTimerHandler);
+#endif
+    NVIC_EnableIRQ(TMR5_IRQn);
+    NVIC_SetPriority(TMR5_IRQn, 0);
+    MXC_TMR_EnableInt(MXC_TMR5);
+    MXC_TMR_Start(MXC_TMR5);
+}
+
+void OneshotTimerHandler(){
+    scheduler_update(scheduler_calibrate_ticks(1));
+    scheduler_run_routines();   //Always returns 0 on first call
+    NVIC_SetVector(TMR5_IRQn, OneshotTimerHandler);
+    NVIC_EnableIRQ(TMR5_IRQn);
+}
+
+void PeriodicTimerHandler(){
+    MXC_TMR_ClearFlags(MXC_TMR5);
+    //Ticks are counted by the cycle counter, so a tick that was pended while routines ran is not counted twice
+    scheduler_update(scheduler_calibrate_ticks(timebase_elapsed_ticks()));
+    scheduler_run_routines();
+}
+
+#if SCHEDULER_HIGH_RES
+//TMR5 keeps running as the tick source, elapsed time comes from the cycle counter
+void elapsed_timer_start(void){
+}
+
+uint32_t elapsed_timer_read(void){
+    return(scheduler_calibrate_ticks(timebase_elapsed_ticks()));
+}
+
+void elapsed_timer_stop(void){
+}
+#else
+//Restart TMR5 as a continuous 1ms counter while routines run, then go back to the one-shot tick
+void elapsed_timer_start(void){
+    Setup_Timer_CONT();
+    MXC_TMR_Start(MXC_TMR5);
+}
+
+uint32_t elapsed_timer_read(void){
+    uint32_t elapsed = MXC_TMR_GetCount(MXC_TMR5) / (SCHEDULER_TICK_US / 1000);
+    MXC_TMR5->cnt = 0;
+    return(scheduler_calibrate_ticks(elapsed));
+}
+
+void elapsed_timer_stop(void){
+    Setup_Timer_ISR();
+}
+#endif
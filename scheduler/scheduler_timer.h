@@ -0,0 +1,48 @@
+#ifndef SCHEDULER_TIMER_H
+#define SCHEDULER_TIMER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "timebase.h"
+
+/* TMR5 and cycle counter glue shared by scheduler.c and scheduler_compact.c. Both call back into
+ * scheduler_update() and scheduler_run_routines(), so exactly one of them must be linked.
+ * Host builds (-DSCHEDULER_HOST) link scheduler_timer_host.c in place of scheduler_timer.c. */
+
+/**
+* @brief        Start the time base and the TMR5 tick interrupt
+*/
+void scheduler_timer_init(void);
+
+/**
+* @brief        Configure TMR5 to interrupt once every scheduler tick
+*/
+void Setup_Timer_ISR(void);
+
+/**
+* @brief        Configure TMR5 as a continuous 1ms counter (used to time routines when SCHEDULER_HIGH_RES is 0)
+*/
+void Setup_Timer_CONT(void);
+
+/**
+* @brief        TMR5 interrupt handlers. One-shot for millisecond ticks, periodic for SCHEDULER_HIGH_RES
+*/
+void OneshotTimerHandler(void);
+void PeriodicTimerHandler(void);
+
+/**
+* @brief        Measure the time spent running routines. elapsed_timer_read() returns the ticks since
+*               elapsed_timer_start() or the previous elapsed_timer_read()
+*/
+void elapsed_timer_start(void);
+uint32_t elapsed_timer_read(void);
+void elapsed_timer_stop(void);
+
+#ifdef SCHEDULER_HOST
+/**
+* @brief        Host stand-in for the TMR5 interrupt. Sleeps for one tick, then updates the schedule and runs the ready routines
+*/
+void scheduler_host_tick(void);
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+#include "scheduler_timer.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "scheduler.h"
+#include "timebase.h"
+#include "scheduler_calibrate.h"
+
+/* Host port of the timer glue (build with -DSCHEDULER_HOST and link this file instead of scheduler_timer.c).
+ * There is no TMR5 interrupt, so the application calls scheduler_host_tick() from its main loop. */
+
+//Stands in for masking interrupts (SCHEDULER_ENTER_CRITICAL)
+static pthread_mutex_t host_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+void scheduler_host_lock(void){
+    pthread_mutex_lock(&host_lock);
+}
+
+void scheduler_host_unlock(void){
+    pthread_mutex_unlock(&host_lock);
+}
+
+
+void scheduler_timer_init(void){
+    timebase_init();
+}
+
+void Setup_Timer_ISR(void){
+}
+
+void Setup_Timer_CONT(void){
+}
+
+void OneshotTimerHandler(void){
+    scheduler_update(scheduler_calibrate_ticks(1));
+    scheduler_run_routines();
+}
+
+void PeriodicTimerHandler(void){
+    scheduler_update(scheduler_calibrate_ticks(timebase_elapsed_ticks()));
+    scheduler_run_routines();
+}
+
+void scheduler_host_tick(void){
+    //Sleep for one tick, then do what the periodic interrupt does on the target
+    struct timespec tick = {
+        .tv_sec = SCHEDULER_TICK_US / 1000000,
+        .tv_nsec = (SCHEDULER_TICK_US % 1000000) * 1000L
+    };
+    nanosleep(&tick, NULL);
+    PeriodicTimerHandler();
+}
+
+void elapsed_timer_start(void){
+}
+
+uint32_t elapsed_timer_read(void){
+    return(scheduler_calibrate_ticks(timebase_elapsed_ticks()));
+}
+
+void elapsed_timer_stop(void){
+}
@@ -0,0 +1,100 @@
+#include "scheduler_trace.h"
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler.h"
+#include "scheduler_log.h"
+
+//Provided by scheduler.c
+extern struct scheduler main_schedule;
+
+//Globals
+volatile uint8_t trace_recording = 0;
+static struct trace_event trace_default_buffer[TRACE_DEFAULT_EVENTS];
+static struct trace_event *trace_buffer = trace_default_buffer;
+static uint32_t trace_size = TRACE_DEFAULT_EVENTS;
+static uint32_t trace_next = 0;                 //Next free event, keeps counting past trace_size so the overflow is known
+static uint32_t trace_dropped = 0;
+
+
+int32_t scheduler_trace_start(struct trace_event *buffer, uint32_t num_events){
+    struct schedule_deadline *current_timer;
+    struct routine *current_routine;
+
+    if(buffer != NULL && !num_events){
+        SCHEDULER_LOG(LOG_TRACE_NO_ROOM);
+        return(-1);
+    }
+
+    trace_recording = 0;
+    trace_buffer = buffer ? buffer : trace_default_buffer;
+    trace_size = buffer ? num_events : TRACE_DEFAULT_EVENTS;
+    trace_next = 0;
+    trace_dropped = 0;
+
+    //Current schedule first, so the replay knows every routine and its deadline
+    current_timer = main_schedule.head;
+    while(current_timer != NULL){
+        current_routine = current_timer->routines_head;
+        while(current_routine != NULL){
+            if(current_routine->function_pointer != NULL){
+                trace_record(TRACE_ROUTINE, current_routine->routine_id, current_routine->routine_priority, current_timer->routine_deadline);
+            }
+            current_routine = current_routine->next;
+        }
+        current_timer = current_timer->next;
+    }
+
+    __atomic_store_n(&trace_recording, 1, __ATOMIC_RELEASE);
+    return(0);
+}
+
+void scheduler_trace_stop(void){
+    __atomic_store_n(&trace_recording, 0, __ATOMIC_RELEASE);
+}
+
+uint32_t scheduler_trace_count(void){
+    uint32_t count = __atomic_load_n(&trace_next, __ATOMIC_RELAXED);
+    return((count < trace_size) ? count : trace_size);
+}
+
+int32_t scheduler_trace_save(int32_t (*write)(uint32_t offset, const void *data, uint32_t length)){
+    struct trace_header header;
+
+    if(write == NULL){
+        return(-1);
+    }
+    if(trace_recording){
+        SCHEDULER_LOG(LOG_TRACE_RUNNING);
+        return(-1);
+    }
+
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.event_size = sizeof(struct trace_event);
+    header.tick_us = SCHEDULER_TICK_US;
+    header.num_events = scheduler_trace_count();
+    header.dropped = trace_dropped;
+
+    if(write(0, &header, sizeof(header))){
+        SCHEDULER_LOG(LOG_TRACE_HEADER);
+        return(-1);
+    }
+    if(header.num_events && write(sizeof(header), trace_buffer, header.num_events * sizeof(struct trace_event))){
+        SCHEDULER_LOG(LOG_TRACE_EVENTS);
+        return(-1);
+    }
+    return(sizeof(header) + header.num_events * sizeof(struct trace_event));
+}
+
+void trace_record(Trace_Event_Type type, uint32_t routine_id, uint32_t priority, uint32_t value){
+    //One atomic add reserves the slot, so an interrupt landing between two events cannot overwrite either of them
+    uint32_t index = __atomic_fetch_add(&trace_next, 1, __ATOMIC_RELAXED);
+    if(index >= trace_size){
+        __atomic_fetch_add(&trace_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    trace_buffer[index].value = value;
+    trace_buffer[index].routine_id = (uint16_t)routine_id;
+    trace_buffer[index].type = (uint8_t)type;
+    trace_buffer[index].priority = (uint8_t)priority;
+}
@@ -0,0 +1,110 @@
+#ifndef SCHEDULER_TRACE_H
+#define SCHEDULER_TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "scheduler.h"
+
+/* Glossary for scheduler_trace.h and scheduler_trace.c
+ *
+ *  Recording      - Timeline of what scheduler.c did, written as 8 byte events into a RAM buffer while the
+ *                   application runs. Saved afterwards through a write function (flash, UART, a file on the host).
+ *  Event          - One thing the scheduler did: ticks passed to scheduler_update(), a routine put in the ready que
+ *                   (or refused), a routine starting, a routine finishing and how long it ran.
+ *  Replay         - scheduler_replay_host.c feeds a saved recording back through scheduler.c on a virtual clock,
+ *                   so periods, priorities and routine durations can be changed and the deadline misses compared
+ *                   against the field.
+ *
+ * Recording stops when the buffer is full; the events that did not fit are counted in dropped. Events are
+ * reserved with one atomic add, so the tick ISR, the routines and the host executor threads can all record
+ * without masking interrupts. Build with -DSCHEDULER_TRACE=0 to take the hooks out of scheduler.c altogether.
+ */
+
+#ifndef SCHEDULER_TRACE
+#define SCHEDULER_TRACE         1
+#endif
+#ifndef TRACE_DEFAULT_EVENTS
+#define TRACE_DEFAULT_EVENTS    512         //Events in the static buffer used when scheduler_trace_start() gets NULL (4 KB)
+#endif
+
+#define TRACE_MAGIC             0x43525453  //"STRC"
+#define TRACE_VERSION           1
+
+typedef enum
+{
+    TRACE_ROUTINE   = 0,        //Routine on the schedule. value = deadline in ticks (SCHEDULER_NO_DEADLINE if only released by others)
+    TRACE_UPDATE    = 1,        //scheduler_update() was called. value = elapsed ticks (calls with 0 ticks are not recorded)
+    TRACE_RELEASE   = 2,        //Routine offered to the ready que. value = TRACE_RELEASED, TRACE_MISSED or TRACE_OVERFLOW
+    TRACE_DISPATCH  = 3,        //Routine started
+    TRACE_COMPLETE  = 4,        //Routine returned. value = run time in microseconds
+    TRACE_REMOVE    = 5         //Routine taken off the schedule
+} Trace_Event_Type;
+
+#define TRACE_RELEASED          0           //Routine put in the ready que
+#define TRACE_MISSED            1           //Routine was still waiting or running, so this release was lost
+#define TRACE_OVERFLOW          2           //Ready que was full
+
+/*
+*   One recorded event (8 bytes)
+*/
+struct trace_event {
+    uint32_t value;                     //Meaning depends on type (see Trace_Event_Type)
+    uint16_t routine_id;                //Routine the event is about (0 for TRACE_UPDATE)
+    uint8_t type;                       //Trace_Event_Type
+    uint8_t priority;                   //Scheduler_Priority of the routine
+};
+
+/*
+*   Written in front of the events by scheduler_trace_save()
+*/
+struct trace_header {
+    uint32_t magic;                     //TRACE_MAGIC
+    uint16_t version;                   //TRACE_VERSION
+    uint16_t event_size;                //sizeof(struct trace_event)
+    uint32_t tick_us;                   //SCHEDULER_TICK_US of the build that made the recording
+    uint32_t num_events;
+    uint32_t dropped;                   //Events lost because the buffer was full
+};
+
+#if SCHEDULER_TRACE
+extern volatile uint8_t trace_recording;
+#define SCHEDULER_TRACE_EVENT(type, routine_id, priority, value)   do { if(trace_recording){ trace_record((type), (routine_id), (priority), (value)); } } while(0)
+#else
+#define SCHEDULER_TRACE_EVENT(type, routine_id, priority, value)
+#endif
+
+/**
+* @brief        Start a new recording. Every routine already on the schedule is written first so the replay
+*               can rebuild it
+* @param[in]    buffer - Memory to record into, or NULL for the static TRACE_DEFAULT_EVENTS buffer
+* @param[in]    num_events - Size of buffer in events (ignored when buffer is NULL)
+*
+* @return       0 (Success), -1 (Failure)
+*/
+int32_t scheduler_trace_start(struct trace_event *buffer, uint32_t num_events);
+
+/**
+* @brief        Stop recording. The events stay in the buffer until the next scheduler_trace_start()
+*/
+void scheduler_trace_stop(void);
+
+/**
+* @brief        Write the header and the recorded events. Stop the recording first
+* @param[in]    write - Called with consecutive pieces of the recording, e.g. a wrapper around MXC_FLC_Write()
+*                       or fwrite(). Returns 0 on success
+*
+* @return       Bytes written (Success), -1 (Failure)
+*/
+int32_t scheduler_trace_save(int32_t (*write)(uint32_t offset, const void *data, uint32_t length));
+
+/**
+* @brief        Number of events recorded so far
+*/
+uint32_t scheduler_trace_count(void);
+
+/**
+* @brief        Append one event. Called through SCHEDULER_TRACE_EVENT() by scheduler.c
+*/
+void trace_record(Trace_Event_Type type, uint32_t routine_id, uint32_t priority, uint32_t value);
+
+#endif
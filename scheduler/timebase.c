@@ -0,0 +1,51 @@
+#include "timebase.h"
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef SCHEDULER_HOST
+#define TIMEBASE_HZ     1000000000UL        //Nanosecond "cycles"
+#else
+#include "mxc_device.h"
+#define TIMEBASE_HZ     SystemCoreClock
+#endif
+
+//Globals
+static uint32_t cycles_per_tick = 0;       //Core cycles in one scheduler tick (TIMEBASE_HZ * SCHEDULER_TICK_US / 1e6)
+static uint32_t last_cycles = 0;           //CYCCNT value at the last call to timebase_elapsed_ticks()
+static uint32_t carry_cycles = 0;          //Cycles left over from the last conversion that did not make up a whole tick
+
+
+void timebase_init(void){
+#ifndef SCHEDULER_HOST
+    //Turn on the trace block and start the cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    cycles_per_tick = (uint32_t)(((uint64_t)TIMEBASE_HZ * SCHEDULER_TICK_US) / 1000000);
+    if(!cycles_per_tick){
+        cycles_per_tick = 1;
+    }
+
+    last_cycles = timebase_cycles();
+    carry_cycles = 0;
+}
+
+uint32_t timebase_elapsed_ticks(void){
+    uint32_t now = timebase_cycles();
+    uint32_t elapsed = (now - last_cycles) + carry_cycles;   //Unsigned subtraction handles CYCCNT wrap around
+    last_cycles = now;
+
+    uint32_t ticks = elapsed / cycles_per_tick;
+    carry_cycles = elapsed - (ticks * cycles_per_tick);
+    return(ticks);
+}
+
+uint32_t timebase_cycles_per_tick(void){
+    return(cycles_per_tick);
+}
+
+uint32_t timebase_cycles_to_us(uint32_t cycles){
+    return((uint32_t)(((uint64_t)cycles * 1000000) / TIMEBASE_HZ));
+}
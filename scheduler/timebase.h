@@ -0,0 +1,78 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#ifdef SCHEDULER_HOST
+#include <time.h>
+#else
+#include "mxc_device.h"
+#endif
+
+/* Glossary for timebase.h and timebase.c
+ *
+ *  Tick           - Smallest unit of time the scheduler counts. Every deadline is stored as a number of ticks.
+ *  Cycle          - One core clock cycle, counted by the DWT cycle counter (CYCCNT). Host builds (SCHEDULER_HOST)
+ *                   count nanoseconds of CLOCK_MONOTONIC instead.
+ *
+ */
+
+/* Scheduler tick period in microseconds. Override at build time (-DSCHEDULER_TICK_US=100) for sub-millisecond routines.
+ * Values of 1000 and above must be whole milliseconds and keep TMR5 on the 8 kHz clock. Anything smaller moves TMR5 onto the peripheral clock
+ * and measures elapsed time with the DWT cycle counter instead of restarting the timer. */
+#ifndef SCHEDULER_TICK_US
+#define SCHEDULER_TICK_US   1000
+#endif
+
+#if SCHEDULER_TICK_US < 1000
+#define SCHEDULER_HIGH_RES  1
+#else
+#define SCHEDULER_HIGH_RES  0
+#endif
+
+/* Convert a period into scheduler ticks (rounded to the nearest tick, never less than 1 tick) */
+#define SCHEDULER_US(us)    (((us) < SCHEDULER_TICK_US) ? 1 : (((us) + (SCHEDULER_TICK_US/2)) / SCHEDULER_TICK_US))
+#define SCHEDULER_MS(ms)    SCHEDULER_US((ms) * 1000UL)
+
+/**
+* @brief        Enable the DWT cycle counter and latch the current cycle count as the start of the first tick
+*/
+void timebase_init(void);
+
+/**
+* @brief        Read the free running core cycle counter
+*
+* @return       Current CYCCNT value (wraps every 2^32 cycles)
+*/
+static inline uint32_t timebase_cycles(void){
+#ifdef SCHEDULER_HOST
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint32_t)((uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec));
+#else
+    return(DWT->CYCCNT);
+#endif
+}
+
+/**
+* @brief        Number of whole ticks elapsed since the previous call. The leftover cycles are carried into the next call
+*               so no time is lost to rounding. Must be called at least once every 2^32 core cycles.
+*
+* @return       Elapsed ticks
+*/
+uint32_t timebase_elapsed_ticks(void);
+
+/**
+* @brief        Number of core cycles in one scheduler tick
+*/
+uint32_t timebase_cycles_per_tick(void);
+
+/**
+* @brief        Convert a cycle count into microseconds
+* @param[in]    cycles - Number of core clock cycles
+*
+* @return       Microseconds
+*/
+uint32_t timebase_cycles_to_us(uint32_t cycles);
+
+#endif